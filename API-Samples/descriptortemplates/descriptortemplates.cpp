@@ -0,0 +1,245 @@
+/*
+ * Vulkan Samples
+ *
+ * Copyright (C) 2015-2016 Valve Corporation
+ * Copyright (C) 2015-2016 LunarG, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+VULKAN_SAMPLE_SHORT_DESCRIPTION
+Write many descriptor sets from packed structs through a descriptor template.
+*/
+
+#include <util_init.hpp>
+#include <util_descriptor.hpp>
+#include <assert.h>
+#include <cstdlib>
+
+// This sample writes the same descriptors into many sets of one layout,
+// first building the writes by hand and updating one set per call, then
+// building them by hand for all sets and updating them in one call, and last
+// letting a descriptor template build the writes from a packed struct per
+// set.  It prints how many sets each way updates per second.
+
+#define SET_COUNT 1024
+#define ROUNDS 1000
+#define TEXTURES_PER_SET 4
+#define LIGHTS_PER_SET 2
+
+/* What one set holds, in the order init_packed_descriptor_template lays out
+ * the bindings below */
+struct set_descriptors {
+    VkDescriptorBufferInfo transform;
+    VkDescriptorImageInfo textures[TEXTURES_PER_SET];
+    VkDescriptorBufferInfo lights[LIGHTS_PER_SET];
+};
+
+static double sets_per_second(timestamp_t ms) {
+    if (ms == 0)
+        ms = 1;
+    return (double)SET_COUNT * ROUNDS / ((double)ms / 1000.0);
+}
+
+int sample_main() {
+    VkResult U_ASSERT_ONLY res;
+    struct sample_info info = {};
+    char sample_title[] = "Descriptor Templates Sample";
+
+    init_global_layer_properties(info);
+    init_instance(info, sample_title);
+    init_enumerate_device(info);
+    init_device(info);
+    init_command_pool(info);
+    init_command_buffer(info);
+    execute_begin_command_buffer(info);
+    init_device_queue(info);
+    init_texture(info);
+    init_uniform_buffer(info);
+    execute_end_command_buffer(info);
+    execute_queue_command_buffer(info);
+
+    /* VULKAN_KEY_START */
+
+    VkDescriptorSetLayoutBinding layout_bindings[3];
+    layout_bindings[0].binding = 0;
+    layout_bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    layout_bindings[0].descriptorCount = 1;
+    layout_bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    layout_bindings[0].pImmutableSamplers = NULL;
+    layout_bindings[1].binding = 1;
+    layout_bindings[1].descriptorType =
+        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    layout_bindings[1].descriptorCount = TEXTURES_PER_SET;
+    layout_bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    layout_bindings[1].pImmutableSamplers = NULL;
+    layout_bindings[2].binding = 2;
+    layout_bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    layout_bindings[2].descriptorCount = LIGHTS_PER_SET;
+    layout_bindings[2].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    layout_bindings[2].pImmutableSamplers = NULL;
+
+    VkDescriptorSetLayoutCreateInfo layout_info = {};
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.pNext = NULL;
+    layout_info.bindingCount = 3;
+    layout_info.pBindings = layout_bindings;
+
+    VkDescriptorSetLayout layout;
+    res = vkCreateDescriptorSetLayout(info.device, &layout_info, NULL, &layout);
+    assert(res == VK_SUCCESS);
+
+    VkDescriptorPoolSize type_count[2];
+    type_count[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    type_count[0].descriptorCount = SET_COUNT * (1 + LIGHTS_PER_SET);
+    type_count[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    type_count[1].descriptorCount = SET_COUNT * TEXTURES_PER_SET;
+
+    VkDescriptorPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.pNext = NULL;
+    pool_info.maxSets = SET_COUNT;
+    pool_info.poolSizeCount = 2;
+    pool_info.pPoolSizes = type_count;
+
+    VkDescriptorPool pool;
+    res = vkCreateDescriptorPool(info.device, &pool_info, NULL, &pool);
+    assert(res == VK_SUCCESS);
+
+    std::vector<VkDescriptorSetLayout> layouts(SET_COUNT, layout);
+    VkDescriptorSetAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.pNext = NULL;
+    alloc_info.descriptorPool = pool;
+    alloc_info.descriptorSetCount = SET_COUNT;
+    alloc_info.pSetLayouts = layouts.data();
+
+    std::vector<VkDescriptorSet> sets(SET_COUNT);
+    res = vkAllocateDescriptorSets(info.device, &alloc_info, sets.data());
+    assert(res == VK_SUCCESS);
+
+    /* What the app keeps for each set, the same in every set here */
+    std::vector<struct set_descriptors> set_data(SET_COUNT);
+    for (int s = 0; s < SET_COUNT; s++) {
+        set_data[s].transform = info.uniform_data.buffer_info;
+        for (int i = 0; i < TEXTURES_PER_SET; i++)
+            set_data[s].textures[i] = info.texture_data.image_info;
+        for (int i = 0; i < LIGHTS_PER_SET; i++)
+            set_data[s].lights[i] = info.uniform_data.buffer_info;
+    }
+
+    /* Writes built by hand, one update per set */
+    timestamp_t start = get_milliseconds();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int s = 0; s < SET_COUNT; s++) {
+            VkWriteDescriptorSet writes[3];
+            writes[0] = {};
+            writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[0].dstSet = sets[s];
+            writes[0].dstBinding = 0;
+            writes[0].descriptorCount = 1;
+            writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            writes[0].pBufferInfo = &set_data[s].transform;
+            writes[1] = {};
+            writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[1].dstSet = sets[s];
+            writes[1].dstBinding = 1;
+            writes[1].descriptorCount = TEXTURES_PER_SET;
+            writes[1].descriptorType =
+                VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            writes[1].pImageInfo = set_data[s].textures;
+            writes[2] = {};
+            writes[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writes[2].dstSet = sets[s];
+            writes[2].dstBinding = 2;
+            writes[2].descriptorCount = LIGHTS_PER_SET;
+            writes[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            writes[2].pBufferInfo = set_data[s].lights;
+            vkUpdateDescriptorSets(info.device, 3, writes, 0, NULL);
+        }
+    }
+    timestamp_t per_set_ms = get_milliseconds() - start;
+
+    /* Writes built by hand, all sets in one update */
+    std::vector<VkWriteDescriptorSet> writes;
+    start = get_milliseconds();
+    for (int r = 0; r < ROUNDS; r++) {
+        writes.clear();
+        for (int s = 0; s < SET_COUNT; s++) {
+            VkWriteDescriptorSet write = {};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.dstSet = sets[s];
+            write.dstBinding = 0;
+            write.descriptorCount = 1;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            write.pBufferInfo = &set_data[s].transform;
+            writes.push_back(write);
+            write.dstBinding = 1;
+            write.descriptorCount = TEXTURES_PER_SET;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            write.pBufferInfo = NULL;
+            write.pImageInfo = set_data[s].textures;
+            writes.push_back(write);
+            write.dstBinding = 2;
+            write.descriptorCount = LIGHTS_PER_SET;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            write.pImageInfo = NULL;
+            write.pBufferInfo = set_data[s].lights;
+            writes.push_back(write);
+        }
+        vkUpdateDescriptorSets(info.device, (uint32_t)writes.size(),
+                               writes.data(), 0, NULL);
+    }
+    timestamp_t batched_ms = get_milliseconds() - start;
+
+    /* The template, built once from the layout */
+    struct descriptor_template tmpl;
+    init_packed_descriptor_template(tmpl, 3, layout_bindings);
+    assert(tmpl.data_size == sizeof(struct set_descriptors));
+
+    start = get_milliseconds();
+    for (int r = 0; r < ROUNDS; r++)
+        execute_descriptor_template_update(info, tmpl, SET_COUNT, sets.data(),
+                                           set_data.data(),
+                                           sizeof(struct set_descriptors));
+    timestamp_t template_ms = get_milliseconds() - start;
+
+    printf("%d sets of 3 bindings, %d times\n", SET_COUNT, ROUNDS);
+    printf("  update per set:       %6llu ms, %10.0f sets/s\n", per_set_ms,
+           sets_per_second(per_set_ms));
+    printf("  batched by hand:      %6llu ms, %10.0f sets/s\n", batched_ms,
+           sets_per_second(batched_ms));
+    printf("  template:             %6llu ms, %10.0f sets/s\n", template_ms,
+           sets_per_second(template_ms));
+
+    destroy_descriptor_template(tmpl);
+
+    /* VULKAN_KEY_END */
+
+    vkDestroyDescriptorPool(info.device, pool, NULL);
+    vkDestroyDescriptorSetLayout(info.device, layout, NULL);
+    destroy_uniform_buffer(info);
+    destroy_textures(info);
+    destroy_command_buffer(info);
+    destroy_command_pool(info);
+    destroy_device(info);
+    destroy_instance(info);
+    return 0;
+}
@@ -0,0 +1,184 @@
+/*
+ * Vulkan Samples
+ *
+ * Copyright (C) 2015-2016 Valve Corporation
+ * Copyright (C) 2015-2016 LunarG, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+VULKAN_SAMPLE_SHORT_DESCRIPTION
+Upload many textures through a staging buffer and report the throughput.
+*/
+
+#include <util_init.hpp>
+#include <assert.h>
+#include <cstdlib>
+
+// This sample uploads the same ppm file into many optimally tiled images,
+// once waiting for each texture's copy before starting the next, and once
+// letting the upload engine batch the copies and keep several batches in
+// flight.  It prints the throughput of each, along with how long reading
+// the file alone takes.
+
+#define TEXTURE_COUNT 128
+
+static double megabytes_per_second(uint64_t bytes, timestamp_t ms) {
+    if (ms == 0)
+        ms = 1;
+    return (double)bytes / (1024.0 * 1024.0) / ((double)ms / 1000.0);
+}
+
+int sample_main() {
+    VkResult U_ASSERT_ONLY res;
+    bool U_ASSERT_ONLY pass;
+    struct sample_info info = {};
+    char sample_title[] = "Upload Textures Sample";
+
+    init_global_layer_properties(info);
+    init_instance(info, sample_title);
+    init_enumerate_device(info);
+    init_device(info);
+    init_device_queue(info);
+
+    /* VULKAN_KEY_START */
+
+    std::string filename = get_base_data_dir();
+    filename.append("lunarg.ppm");
+
+    int width, height;
+    if (!read_ppm(filename.c_str(), width, height, 0, NULL)) {
+        std::cout << "Could not read texture file lunarg.ppm\n";
+        exit(-1);
+    }
+    const VkDeviceSize texture_size = (VkDeviceSize)width * height * 4;
+
+    /* Create the images all uploads go to */
+    VkImageCreateInfo image_create_info = {};
+    image_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_create_info.pNext = NULL;
+    image_create_info.imageType = VK_IMAGE_TYPE_2D;
+    image_create_info.format = VK_FORMAT_R8G8B8A8_UNORM;
+    image_create_info.extent.width = width;
+    image_create_info.extent.height = height;
+    image_create_info.extent.depth = 1;
+    image_create_info.mipLevels = 1;
+    image_create_info.arrayLayers = 1;
+    image_create_info.samples = NUM_SAMPLES;
+    image_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    image_create_info.usage =
+        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    image_create_info.queueFamilyIndexCount = 0;
+    image_create_info.pQueueFamilyIndices = NULL;
+    image_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    image_create_info.flags = 0;
+
+    VkImage images[TEXTURE_COUNT];
+    VkDeviceMemory mems[TEXTURE_COUNT];
+    for (int i = 0; i < TEXTURE_COUNT; i++) {
+        res = vkCreateImage(info.device, &image_create_info, NULL, &images[i]);
+        assert(res == VK_SUCCESS);
+
+        VkMemoryRequirements mem_reqs;
+        vkGetImageMemoryRequirements(info.device, images[i], &mem_reqs);
+
+        VkMemoryAllocateInfo mem_alloc = {};
+        mem_alloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        mem_alloc.pNext = NULL;
+        mem_alloc.allocationSize = mem_reqs.size;
+        mem_alloc.memoryTypeIndex = 0;
+        pass = memory_type_from_properties(info, mem_reqs.memoryTypeBits,
+                                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                           &mem_alloc.memoryTypeIndex);
+        assert(pass);
+
+        res = vkAllocateMemory(info.device, &mem_alloc, NULL, &mems[i]);
+        assert(res == VK_SUCCESS);
+        res = vkBindImageMemory(info.device, images[i], mems[i], 0);
+        assert(res == VK_SUCCESS);
+    }
+
+    init_upload_engine(info);
+    const uint64_t total_bytes = texture_size * TEXTURE_COUNT;
+
+    /* Reading the file alone, for comparison */
+    std::vector<unsigned char> pixels(texture_size);
+    timestamp_t start = get_milliseconds();
+    for (int i = 0; i < TEXTURE_COUNT; i++) {
+        if (!read_ppm(filename.c_str(), width, height, width * 4,
+                      pixels.data())) {
+            std::cout << "Could not load texture file lunarg.ppm\n";
+            exit(-1);
+        }
+    }
+    timestamp_t read_ms = get_milliseconds() - start;
+
+    /* One submit, and one wait, per texture */
+    start = get_milliseconds();
+    for (int i = 0; i < TEXTURE_COUNT; i++) {
+        struct upload_region region = execute_upload_alloc(info, texture_size);
+        read_ppm(filename.c_str(), width, height, width * 4,
+                 (unsigned char *)region.data);
+        execute_upload_to_image(info, region, images[i], width, height,
+                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        execute_wait_uploads(info);
+    }
+    timestamp_t serial_ms = get_milliseconds() - start;
+    uint32_t serial_submits = info.upload.submits;
+
+    /* Batched copies, reading into one part of the staging buffer while
+     * copies out of the others are in flight */
+    info.upload.submits = 0;
+    info.upload.stalls = 0;
+    start = get_milliseconds();
+    for (int i = 0; i < TEXTURE_COUNT; i++) {
+        struct upload_region region = execute_upload_alloc(info, texture_size);
+        read_ppm(filename.c_str(), width, height, width * 4,
+                 (unsigned char *)region.data);
+        execute_upload_to_image(info, region, images[i], width, height,
+                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+    execute_wait_uploads(info);
+    timestamp_t batched_ms = get_milliseconds() - start;
+
+    printf("%d textures of %dx%d, %.1f MB\n", TEXTURE_COUNT, width, height,
+           (double)total_bytes / (1024.0 * 1024.0));
+    printf("  read_ppm only:        %6llu ms, %8.1f MB/s\n", read_ms,
+           megabytes_per_second(total_bytes, read_ms));
+    printf("  wait per texture:     %6llu ms, %8.1f MB/s, %u submits\n",
+           serial_ms, megabytes_per_second(total_bytes, serial_ms),
+           serial_submits);
+    printf("  batched:              %6llu ms, %8.1f MB/s, %u submits, %u "
+           "stalls\n",
+           batched_ms, megabytes_per_second(total_bytes, batched_ms),
+           info.upload.submits, info.upload.stalls);
+
+    /* VULKAN_KEY_END */
+
+    destroy_upload_engine(info);
+    for (int i = 0; i < TEXTURE_COUNT; i++) {
+        vkDestroyImage(info.device, images[i], NULL);
+        vkFreeMemory(info.device, mems[i], NULL);
+    }
+    destroy_device(info);
+    destroy_instance(info);
+    return 0;
+}
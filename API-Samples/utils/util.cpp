@@ -30,12 +30,15 @@ samples utility functions
 */
 
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
+#include <algorithm>
 #include <cstdlib>
 #include <iomanip>
 #include <iostream>
 #include "util.hpp"
 #include "SPIRV/GlslangToSpv.h"
+#include "spirv_cache.h"
 
 // For timestamp code (get_milliseconds)
 #ifdef WIN32
@@ -202,18 +205,20 @@ bool read_ppm(char const *const filename, int &width, int &height,
     }
 
     // Read the four values from file, accounting with any and all whitepace
-    fscanf(fPtr, "%s %s %s %s ", magicStr, widthStr, heightStr, formatStr);
+    fscanf(fPtr, "%2s %5s %5s %5s ", magicStr, widthStr, heightStr, formatStr);
 
     // Kick out if comments present
     if (magicStr[0] == '#' || widthStr[0] == '#' || heightStr[0] == '#' ||
         formatStr[0] == '#') {
         printf("Unhandled comment in PPM file\n");
+        fclose(fPtr);
         return false;
     }
 
     // Only one magic value is valid
     if (strncmp(magicStr, "P6", sizeof(magicStr))) {
         printf("Unhandled PPM magic number: %s\n", magicStr);
+        fclose(fPtr);
         return false;
     }
 
@@ -224,31 +229,51 @@ bool read_ppm(char const *const filename, int &width, int &height,
     static const int saneDimension = 32768; //??
     if (width <= 0 || width > saneDimension) {
         printf("Width seems wrong.  Update read_ppm if not: %u\n", width);
+        fclose(fPtr);
         return false;
     }
     if (height <= 0 || height > saneDimension) {
         printf("Height seems wrong.  Update read_ppm if not: %u\n", height);
+        fclose(fPtr);
         return false;
     }
 
     if (dataPtr == nullptr) {
         // If no destination pointer, caller only wanted dimensions
+        fclose(fPtr);
         return true;
     }
 
-    // Now read the data
-    for (int y = 0; y < height; y++) {
-        unsigned char *rowPtr = dataPtr;
-        for (int x = 0; x < width; x++) {
-            fread(rowPtr, 3, 1, fPtr);
-            rowPtr[3] = 255; /* Alpha of 1 */
-            rowPtr += 4;
+    // Now read the data, a band of rows per fread, and widen each RGB texel
+    // to RGBA
+    const size_t srcPitch = (size_t)width * 3;
+    const int bandRows = std::max(1, std::min(height, (int)(1 << 20) / width));
+    std::vector<unsigned char> band(srcPitch * bandRows);
+    bool ok = true;
+    for (int y = 0; y < height && ok; y += bandRows) {
+        const int rows = std::min(bandRows, height - y);
+        if (fread(band.data(), srcPitch, rows, fPtr) != (size_t)rows) {
+            printf("Truncated PPM file: %s\n", filename);
+            ok = false;
+            break;
+        }
+
+        for (int row = 0; row < rows; row++) {
+            // Fixed-size, branch-free body that compilers vectorize
+            const unsigned char *src = band.data() + srcPitch * row;
+            unsigned char *dst = dataPtr;
+            for (int x = 0; x < width; x++) {
+                dst[4 * x + 0] = src[3 * x + 0];
+                dst[4 * x + 1] = src[3 * x + 1];
+                dst[4 * x + 2] = src[3 * x + 2];
+                dst[4 * x + 3] = 255; /* Alpha of 1 */
+            }
+            dataPtr += rowPitch;
         }
-        dataPtr += rowPitch;
     }
     fclose(fPtr);
 
-    return true;
+    return ok;
 }
 
 void init_resources(TBuiltInResource &Resources) {
@@ -381,42 +406,52 @@ void finalize_glslang() { glslang::FinalizeProcess(); }
 //
 bool GLSLtoSPV(const VkShaderStageFlagBits shader_type, const char *pshader,
                std::vector<unsigned int> &spirv) {
-    glslang::TProgram &program = *new glslang::TProgram;
-    const char *shaderStrings[1];
-    TBuiltInResource Resources;
-    init_resources(Resources);
-
     // Enable SPIR-V and Vulkan rules when parsing GLSL
     EShMessages messages = (EShMessages)(EShMsgSpvRules | EShMsgVulkanRules);
 
     EShLanguage stage = FindLanguage(shader_type);
-    glslang::TShader *shader = new glslang::TShader(stage);
+
+    // Skip the compile if this shader was compiled before, by this process
+    // or, with VK_SPIRV_CACHE_DIR set, an earlier one
+    const uint64_t cache_key = spirv_cache::Key(stage, messages, pshader);
+    if (spirv_cache::Lookup(cache_key, spirv))
+        return true;
+
+    const char *shaderStrings[1];
+    TBuiltInResource Resources;
+    init_resources(Resources);
+
+    glslang::TShader shader(stage);
+    glslang::TProgram program;
 
     shaderStrings[0] = pshader;
-    shader->setStrings(shaderStrings, 1);
+    shader.setStrings(shaderStrings, 1);
 
-    if (!shader->parse(&Resources, 100, false, messages)) {
-        puts(shader->getInfoLog());
-        puts(shader->getInfoDebugLog());
+    if (!shader.parse(&Resources, 100, false, messages)) {
+        puts(shader.getInfoLog());
+        puts(shader.getInfoDebugLog());
         return false; // something didn't work
     }
 
-    program.addShader(shader);
+    program.addShader(&shader);
 
     //
     // Program-level processing...
     //
 
     if (!program.link(messages)) {
-        puts(shader->getInfoLog());
-        puts(shader->getInfoDebugLog());
+        puts(shader.getInfoLog());
+        puts(shader.getInfoDebugLog());
         return false;
     }
 
     glslang::GlslangToSpv(*program.getIntermediate(stage), spirv);
 
+    spirv_cache::Store(cache_key, spirv);
+
     return true;
 }
+
 void wait_seconds(int seconds) {
 #ifdef WIN32
     Sleep(seconds * 1000);
@@ -439,7 +474,7 @@ timestamp_t get_milliseconds() {
 #else
     struct timeval now;
     gettimeofday(&now, NULL);
-    return (now.tv_usec / 1000) + (timestamp_t)now.tv_sec;
+    return (now.tv_usec / 1000) + (timestamp_t)now.tv_sec * 1000;
 #endif
 }
 
@@ -106,6 +106,66 @@ struct texture_object {
     int32_t tex_width, tex_height;
 };
 
+/*
+ * Number of batches of copies the upload engine can have in flight.  Its
+ * staging buffer is split into one part per batch.
+ */
+#define UPLOAD_BATCH_COUNT 4
+
+/* Default size of the upload engine's staging buffer */
+#define UPLOAD_STAGING_SIZE (16 * 1024 * 1024)
+
+/*
+ * A batch of copies out of one part of the upload engine's staging buffer,
+ * recorded into one command buffer and submitted with one fence.
+ */
+struct upload_batch {
+    VkCommandBuffer cmd;
+    VkFence fence;
+    VkDeviceSize used;
+    bool recording;
+    bool submitted;
+
+    /* Staging for uploads larger than a part, freed with the batch */
+    std::vector<VkBuffer> large_bufs;
+    std::vector<VkDeviceMemory> large_mems;
+};
+
+/*
+ * Where an upload's data is to be written before it is copied.
+ */
+struct upload_region {
+    VkBuffer buf;
+    VkDeviceSize offset;
+    void *data;
+};
+
+/*
+ * Uploads image and buffer data through a persistently mapped staging
+ * buffer.  Copies are recorded into the current batch, which is submitted
+ * when its part of the staging buffer fills up or when it is flushed, without
+ * waiting for it.  A part is only waited on when the engine comes back around
+ * to reuse it, so reading files into one part overlaps the copies out of the
+ * others.
+ */
+struct upload_engine {
+    VkCommandPool cmd_pool;
+    VkBuffer buf;
+    VkDeviceMemory mem;
+    unsigned char *mapped;
+    VkDeviceSize part_size;
+    VkDeviceSize alignment;
+
+    struct upload_batch batches[UPLOAD_BATCH_COUNT];
+    uint32_t current;
+
+    /* Totals since the engine was initialized */
+    uint64_t bytes;
+    uint32_t copies;
+    uint32_t submits;
+    uint32_t stalls;
+};
+
 /*
  * Keep each of our swap chain buffers' image, command buffer and view in one
  * spot
@@ -194,6 +254,7 @@ struct sample_info {
     } texture_data;
     VkDeviceMemory stagingMemory;
     VkImage stagingImage;
+    struct upload_engine upload;
 
     struct {
         VkBuffer buf;
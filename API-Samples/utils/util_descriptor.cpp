@@ -0,0 +1,237 @@
+/*
+ * Vulkan Samples
+ *
+ * Copyright (C) 2016 Valve Corporation
+ * Copyright (C) 2016 LunarG, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+VULKAN_SAMPLE_DESCRIPTION
+samples descriptor template utility functions
+*/
+
+#include <assert.h>
+#include <string.h>
+#include "util_descriptor.hpp"
+
+enum descriptor_info_kind {
+    DESCRIPTOR_INFO_IMAGE,
+    DESCRIPTOR_INFO_BUFFER,
+    DESCRIPTOR_INFO_TEXEL_VIEW,
+};
+
+static descriptor_info_kind get_descriptor_info_kind(VkDescriptorType type) {
+    switch (type) {
+    case VK_DESCRIPTOR_TYPE_SAMPLER:
+    case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+    case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+    case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+    case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+        return DESCRIPTOR_INFO_IMAGE;
+    case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+    case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+        return DESCRIPTOR_INFO_TEXEL_VIEW;
+    default:
+        return DESCRIPTOR_INFO_BUFFER;
+    }
+}
+
+static size_t get_descriptor_info_size(descriptor_info_kind kind) {
+    switch (kind) {
+    case DESCRIPTOR_INFO_IMAGE:
+        return sizeof(VkDescriptorImageInfo);
+    case DESCRIPTOR_INFO_TEXEL_VIEW:
+        return sizeof(VkBufferView);
+    default:
+        return sizeof(VkDescriptorBufferInfo);
+    }
+}
+
+void init_descriptor_template(struct descriptor_template &tmpl,
+                              uint32_t entry_count,
+                              const struct descriptor_template_entry *entries) {
+    tmpl.entries.assign(entries, entries + entry_count);
+    tmpl.set_writes.resize(entry_count);
+    tmpl.gathered.resize(entry_count);
+    tmpl.image_info_count = 0;
+    tmpl.buffer_info_count = 0;
+    tmpl.texel_view_count = 0;
+    tmpl.data_size = 0;
+
+    for (uint32_t i = 0; i < entry_count; i++) {
+        const struct descriptor_template_entry &entry = entries[i];
+        assert(entry.count > 0);
+
+        VkWriteDescriptorSet &write = tmpl.set_writes[i];
+        write = {};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.pNext = NULL;
+        write.dstSet = VK_NULL_HANDLE;
+        write.dstBinding = entry.binding;
+        write.dstArrayElement = entry.array_element;
+        write.descriptorCount = entry.count;
+        write.descriptorType = entry.type;
+
+        /* An array of infos can only be pointed at where it is if there is
+         * nothing between its elements */
+        descriptor_info_kind kind = get_descriptor_info_kind(entry.type);
+        size_t info_size = get_descriptor_info_size(kind);
+        bool gathered = entry.count > 1 && entry.stride != info_size;
+        tmpl.gathered[i] = gathered;
+        if (gathered) {
+            if (kind == DESCRIPTOR_INFO_IMAGE)
+                tmpl.image_info_count += entry.count;
+            else if (kind == DESCRIPTOR_INFO_BUFFER)
+                tmpl.buffer_info_count += entry.count;
+            else
+                tmpl.texel_view_count += entry.count;
+        }
+
+        size_t end = entry.offset + (entry.count - 1) * entry.stride + info_size;
+        if (end > tmpl.data_size)
+            tmpl.data_size = end;
+    }
+
+    tmpl.writes.clear();
+    tmpl.image_infos.clear();
+    tmpl.buffer_infos.clear();
+    tmpl.texel_views.clear();
+}
+
+void init_packed_descriptor_template(
+    struct descriptor_template &tmpl, uint32_t binding_count,
+    const VkDescriptorSetLayoutBinding *bindings) {
+    /* The infos of each binding follow those of the one before, as an array
+     * of descriptorCount infos.  Samplers that are immutable in the layout
+     * have nothing to write, and take no space. */
+    std::vector<struct descriptor_template_entry> entries;
+    size_t offset = 0;
+    for (uint32_t i = 0; i < binding_count; i++) {
+        const VkDescriptorSetLayoutBinding &binding = bindings[i];
+        if (binding.descriptorCount == 0)
+            continue;
+        if (binding.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER &&
+            binding.pImmutableSamplers)
+            continue;
+
+        size_t info_size = get_descriptor_info_size(
+            get_descriptor_info_kind(binding.descriptorType));
+        /* Every info type holds a 64-bit handle */
+        offset = (offset + 7) & ~(size_t)7;
+
+        struct descriptor_template_entry entry;
+        entry.binding = binding.binding;
+        entry.array_element = 0;
+        entry.count = binding.descriptorCount;
+        entry.type = binding.descriptorType;
+        entry.offset = offset;
+        entry.stride = info_size;
+        entries.push_back(entry);
+
+        offset += info_size * binding.descriptorCount;
+    }
+
+    init_descriptor_template(tmpl, (uint32_t)entries.size(), entries.data());
+    tmpl.data_size = (offset + 7) & ~(size_t)7;
+}
+
+void execute_descriptor_template_update(struct sample_info &info,
+                                        struct descriptor_template &tmpl,
+                                        uint32_t set_count,
+                                        const VkDescriptorSet *sets,
+                                        const void *data, size_t data_stride) {
+    const uint32_t entry_count = (uint32_t)tmpl.entries.size();
+    if (set_count == 0 || entry_count == 0)
+        return;
+
+    /* Size everything up front, nothing may move once writes point at it */
+    tmpl.writes.resize((size_t)set_count * entry_count);
+    tmpl.image_infos.resize((size_t)set_count * tmpl.image_info_count);
+    tmpl.buffer_infos.resize((size_t)set_count * tmpl.buffer_info_count);
+    tmpl.texel_views.resize((size_t)set_count * tmpl.texel_view_count);
+
+    VkWriteDescriptorSet *write = tmpl.writes.data();
+    VkDescriptorImageInfo *image_info = tmpl.image_infos.data();
+    VkDescriptorBufferInfo *buffer_info = tmpl.buffer_infos.data();
+    VkBufferView *texel_view = tmpl.texel_views.data();
+
+    for (uint32_t s = 0; s < set_count; s++) {
+        const char *set_data = (const char *)data + s * data_stride;
+        memcpy(write, tmpl.set_writes.data(),
+               entry_count * sizeof(VkWriteDescriptorSet));
+
+        for (uint32_t e = 0; e < entry_count; e++, write++) {
+            const struct descriptor_template_entry &entry = tmpl.entries[e];
+            const char *src = set_data + entry.offset;
+            write->dstSet = sets[s];
+
+            switch (get_descriptor_info_kind(entry.type)) {
+            case DESCRIPTOR_INFO_IMAGE:
+                if (!tmpl.gathered[e]) {
+                    write->pImageInfo = (const VkDescriptorImageInfo *)src;
+                    break;
+                }
+                write->pImageInfo = image_info;
+                for (uint32_t i = 0; i < entry.count; i++)
+                    memcpy(image_info++, src + i * entry.stride,
+                           sizeof(VkDescriptorImageInfo));
+                break;
+            case DESCRIPTOR_INFO_BUFFER:
+                if (!tmpl.gathered[e]) {
+                    write->pBufferInfo = (const VkDescriptorBufferInfo *)src;
+                    break;
+                }
+                write->pBufferInfo = buffer_info;
+                for (uint32_t i = 0; i < entry.count; i++)
+                    memcpy(buffer_info++, src + i * entry.stride,
+                           sizeof(VkDescriptorBufferInfo));
+                break;
+            case DESCRIPTOR_INFO_TEXEL_VIEW:
+                if (!tmpl.gathered[e]) {
+                    write->pTexelBufferView = (const VkBufferView *)src;
+                    break;
+                }
+                write->pTexelBufferView = texel_view;
+                for (uint32_t i = 0; i < entry.count; i++)
+                    memcpy(texel_view++, src + i * entry.stride,
+                           sizeof(VkBufferView));
+                break;
+            }
+        }
+    }
+
+    vkUpdateDescriptorSets(info.device, (uint32_t)tmpl.writes.size(),
+                           tmpl.writes.data(), 0, NULL);
+}
+
+void destroy_descriptor_template(struct descriptor_template &tmpl) {
+    std::vector<struct descriptor_template_entry>().swap(tmpl.entries);
+    std::vector<VkWriteDescriptorSet>().swap(tmpl.set_writes);
+    std::vector<bool>().swap(tmpl.gathered);
+    std::vector<VkWriteDescriptorSet>().swap(tmpl.writes);
+    std::vector<VkDescriptorImageInfo>().swap(tmpl.image_infos);
+    std::vector<VkDescriptorBufferInfo>().swap(tmpl.buffer_infos);
+    std::vector<VkBufferView>().swap(tmpl.texel_views);
+    tmpl.image_info_count = 0;
+    tmpl.buffer_info_count = 0;
+    tmpl.texel_view_count = 0;
+    tmpl.data_size = 0;
+}
@@ -0,0 +1,89 @@
+/*
+ * Vulkan Samples
+ *
+ * Copyright (C) 2016 Valve Corporation
+ * Copyright (C) 2016 LunarG, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef UTIL_DESCRIPTOR
+#define UTIL_DESCRIPTOR
+
+#include "util_init.hpp"
+
+// Make sure functions start with init, execute, or destroy to assist codegen
+
+/*
+ * One run of descriptors in a set, written from the infos found in the app's
+ * data: count descriptors of one type, starting at array_element of binding,
+ * taking their VkDescriptorImageInfo, VkDescriptorBufferInfo or VkBufferView
+ * from offset in the data and every stride bytes after that.
+ */
+struct descriptor_template_entry {
+    uint32_t binding;
+    uint32_t array_element;
+    uint32_t count;
+    VkDescriptorType type;
+    size_t offset;
+    size_t stride;
+};
+
+/*
+ * Writes whole descriptor sets of one layout from a packed struct per set,
+ * any number of sets in one vkUpdateDescriptorSets call.  The writes are
+ * built once, when the template is initialized, and only have their set and
+ * infos filled in per update.  Entries whose infos are tightly packed in the
+ * app's data are pointed at in place; others are gathered into the
+ * template's own arrays.
+ */
+struct descriptor_template {
+    std::vector<struct descriptor_template_entry> entries;
+
+    /* The writes for one set, and how many infos one set gathers */
+    std::vector<VkWriteDescriptorSet> set_writes;
+    std::vector<bool> gathered;
+    uint32_t image_info_count;
+    uint32_t buffer_info_count;
+    uint32_t texel_view_count;
+
+    /* Size of the packed struct init_packed_descriptor_template lays out */
+    size_t data_size;
+
+    /* Reused from one update to the next */
+    std::vector<VkWriteDescriptorSet> writes;
+    std::vector<VkDescriptorImageInfo> image_infos;
+    std::vector<VkDescriptorBufferInfo> buffer_infos;
+    std::vector<VkBufferView> texel_views;
+};
+
+void init_descriptor_template(struct descriptor_template &tmpl,
+                              uint32_t entry_count,
+                              const struct descriptor_template_entry *entries);
+void init_packed_descriptor_template(
+    struct descriptor_template &tmpl, uint32_t binding_count,
+    const VkDescriptorSetLayoutBinding *bindings);
+void execute_descriptor_template_update(struct sample_info &info,
+                                        struct descriptor_template &tmpl,
+                                        uint32_t set_count,
+                                        const VkDescriptorSet *sets,
+                                        const void *data, size_t data_stride);
+void destroy_descriptor_template(struct descriptor_template &tmpl);
+
+#endif
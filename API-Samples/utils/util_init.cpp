@@ -1696,7 +1696,7 @@ void init_image(struct sample_info &info, texture_object &texObj,
                                         &formatProps);
 
     /* See if we can use a linear tiled image for a texture, if not, we will
-     * need a staging image for the texture data */
+     * stage the texture data through the upload engine */
     bool needStaging = (!(formatProps.linearTilingFeatures &
                           VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
                            ? true
@@ -1715,8 +1715,7 @@ void init_image(struct sample_info &info, texture_object &texObj,
     image_create_info.samples = NUM_SAMPLES;
     image_create_info.tiling = VK_IMAGE_TILING_LINEAR;
     image_create_info.initialLayout = VK_IMAGE_LAYOUT_PREINITIALIZED;
-    image_create_info.usage = needStaging ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT
-                                          : VK_IMAGE_USAGE_SAMPLED_BIT;
+    image_create_info.usage = VK_IMAGE_USAGE_SAMPLED_BIT;
     image_create_info.queueFamilyIndexCount = 0;
     image_create_info.pQueueFamilyIndices = NULL;
     image_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
@@ -1728,191 +1727,167 @@ void init_image(struct sample_info &info, texture_object &texObj,
     mem_alloc.allocationSize = 0;
     mem_alloc.memoryTypeIndex = 0;
 
-    VkImage mappableImage;
-    VkDeviceMemory mappableMemory;
-
     VkMemoryRequirements mem_reqs;
 
-    /* Create a mappable image.  It will be the texture if linear images are ok
-     * to be textures or it will be the staging image if they are not. */
-    res = vkCreateImage(info.device, &image_create_info, NULL, &mappableImage);
-    assert(res == VK_SUCCESS);
-
-    vkGetImageMemoryRequirements(info.device, mappableImage, &mem_reqs);
-    assert(res == VK_SUCCESS);
-
-    mem_alloc.allocationSize = mem_reqs.size;
-
-    /* Find the memory type that is host mappable */
-    pass = memory_type_from_properties(info, mem_reqs.memoryTypeBits,
-                                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
-                                       &mem_alloc.memoryTypeIndex);
-    assert(pass);
-
-    /* allocate memory */
-    res = vkAllocateMemory(info.device, &mem_alloc, NULL, &(mappableMemory));
-    assert(res == VK_SUCCESS);
-
-    /* bind memory */
-    res = vkBindImageMemory(info.device, mappableImage, mappableMemory, 0);
-    assert(res == VK_SUCCESS);
-
-    set_image_layout(info, mappableImage, VK_IMAGE_ASPECT_COLOR_BIT,
-                     VK_IMAGE_LAYOUT_PREINITIALIZED, VK_IMAGE_LAYOUT_GENERAL);
-
-    res = vkEndCommandBuffer(info.cmd);
-    assert(res == VK_SUCCESS);
-    const VkCommandBuffer cmd_bufs[] = {info.cmd};
-    VkFenceCreateInfo fenceInfo;
-    VkFence cmdFence;
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.pNext = NULL;
-    fenceInfo.flags = 0;
-    vkCreateFence(info.device, &fenceInfo, NULL, &cmdFence);
-
-    VkSubmitInfo submit_info[1] = {};
-    submit_info[0].pNext = NULL;
-    submit_info[0].sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info[0].waitSemaphoreCount = 0;
-    submit_info[0].pWaitSemaphores = NULL;
-    submit_info[0].pWaitDstStageMask = NULL;
-    submit_info[0].commandBufferCount = 1;
-    submit_info[0].pCommandBuffers = cmd_bufs;
-    submit_info[0].signalSemaphoreCount = 0;
-    submit_info[0].pSignalSemaphores = NULL;
-
-    /* Queue the command buffer for execution */
-    res = vkQueueSubmit(info.queue, 1, submit_info, cmdFence);
-    assert(res == VK_SUCCESS);
-
-    VkImageSubresource subres = {};
-    subres.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    subres.mipLevel = 0;
-    subres.arrayLayer = 0;
-
-    VkSubresourceLayout layout;
-    void *data;
-
-    /* Get the subresource layout so we know what the row pitch is */
-    vkGetImageSubresourceLayout(info.device, mappableImage, &subres, &layout);
+    if (needStaging) {
+        /* Linear images cannot be our texture, so create an optimally tiled
+         * image and copy to it from the upload engine's staging buffer */
+        image_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+        image_create_info.usage =
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
-    /* Make sure command buffer is finished before mapping */
-    do {
         res =
-            vkWaitForFences(info.device, 1, &cmdFence, VK_TRUE, FENCE_TIMEOUT);
-    } while (res == VK_TIMEOUT);
-    assert(res == VK_SUCCESS);
+            vkCreateImage(info.device, &image_create_info, NULL, &texObj.image);
+        assert(res == VK_SUCCESS);
 
-    vkDestroyFence(info.device, cmdFence, NULL);
+        vkGetImageMemoryRequirements(info.device, texObj.image, &mem_reqs);
 
-    res = vkMapMemory(info.device, mappableMemory, 0, mem_reqs.size, 0, &data);
-    assert(res == VK_SUCCESS);
+        mem_alloc.allocationSize = mem_reqs.size;
 
-    /* Read the ppm file into the mappable image's memory */
-    if (!read_ppm(filename.c_str(), texObj.tex_width, texObj.tex_height,
-                  layout.rowPitch, (unsigned char *)data)) {
-        std::cout << "Could not load texture file lunarg.ppm\n";
-        exit(-1);
-    }
+        /* Find memory type - dont specify any mapping requirements */
+        pass = memory_type_from_properties(info, mem_reqs.memoryTypeBits,
+                                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                           &mem_alloc.memoryTypeIndex);
+        assert(pass);
 
-    vkUnmapMemory(info.device, mappableMemory);
+        res = vkAllocateMemory(info.device, &mem_alloc, NULL, &texObj.mem);
+        assert(res == VK_SUCCESS);
 
-    VkCommandBufferBeginInfo cmd_buf_info = {};
-    cmd_buf_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    cmd_buf_info.pNext = NULL;
-    cmd_buf_info.flags = 0;
-    cmd_buf_info.pInheritanceInfo = NULL;
+        res = vkBindImageMemory(info.device, texObj.image, texObj.mem, 0);
+        assert(res == VK_SUCCESS);
 
-    res = vkResetCommandBuffer(info.cmd, 0);
-    res = vkBeginCommandBuffer(info.cmd, &cmd_buf_info);
-    assert(res == VK_SUCCESS);
+        /* Read the ppm file straight into the staging buffer */
+        const uint32_t row_pitch = texObj.tex_width * 4;
+        struct upload_region region = execute_upload_alloc(
+            info, (VkDeviceSize)row_pitch * texObj.tex_height);
+        if (!read_ppm(filename.c_str(), texObj.tex_width, texObj.tex_height,
+                      row_pitch, (unsigned char *)region.data)) {
+            std::cout << "Could not load texture file lunarg.ppm\n";
+            exit(-1);
+        }
 
-    if (!needStaging) {
-        /* If we can use the linear tiled image as a texture, just do it */
-        texObj.image = mappableImage;
-        texObj.mem = mappableMemory;
         texObj.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        set_image_layout(info, texObj.image, VK_IMAGE_ASPECT_COLOR_BIT,
-                         VK_IMAGE_LAYOUT_GENERAL, texObj.imageLayout);
-        /* No staging resources to free later */
+        execute_upload_to_image(info, region, texObj.image, texObj.tex_width,
+                                texObj.tex_height, texObj.imageLayout);
+
+        /* Submit the copy without waiting for it, the commands that use the
+         * texture are submitted later to the same queue */
+        execute_flush_uploads(info);
+
+        /* The upload engine owns the staging resources */
         info.stagingImage = VK_NULL_HANDLE;
         info.stagingMemory = VK_NULL_HANDLE;
     } else {
-        /* The mappable image cannot be our texture, so create an optimally
-         * tiled image and blit to it */
-        image_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
-        image_create_info.usage =
-            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-        image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        /* Create a mappable image, it will be the texture */
+        VkImage mappableImage;
+        VkDeviceMemory mappableMemory;
 
-        res =
-            vkCreateImage(info.device, &image_create_info, NULL, &texObj.image);
+        res = vkCreateImage(info.device, &image_create_info, NULL,
+                            &mappableImage);
         assert(res == VK_SUCCESS);
 
-        vkGetImageMemoryRequirements(info.device, texObj.image, &mem_reqs);
+        vkGetImageMemoryRequirements(info.device, mappableImage, &mem_reqs);
 
         mem_alloc.allocationSize = mem_reqs.size;
 
-        /* Find memory type - dont specify any mapping requirements */
+        /* Find the memory type that is host mappable */
         pass = memory_type_from_properties(info, mem_reqs.memoryTypeBits,
-                                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
                                            &mem_alloc.memoryTypeIndex);
         assert(pass);
 
         /* allocate memory */
-        res = vkAllocateMemory(info.device, &mem_alloc, NULL, &texObj.mem);
+        res =
+            vkAllocateMemory(info.device, &mem_alloc, NULL, &(mappableMemory));
         assert(res == VK_SUCCESS);
 
         /* bind memory */
-        res = vkBindImageMemory(info.device, texObj.image, texObj.mem, 0);
+        res = vkBindImageMemory(info.device, mappableImage, mappableMemory, 0);
         assert(res == VK_SUCCESS);
 
-        /* Since we're going to blit from the mappable image, set its layout to
-         * SOURCE_OPTIMAL. Side effect is that this will create info.cmd */
         set_image_layout(info, mappableImage, VK_IMAGE_ASPECT_COLOR_BIT,
-                         VK_IMAGE_LAYOUT_GENERAL,
-                         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+                         VK_IMAGE_LAYOUT_PREINITIALIZED,
+                         VK_IMAGE_LAYOUT_GENERAL);
 
-        /* Since we're going to blit to the texture image, set its layout to
-         * DESTINATION_OPTIMAL */
-        set_image_layout(info, texObj.image, VK_IMAGE_ASPECT_COLOR_BIT,
-                         VK_IMAGE_LAYOUT_UNDEFINED,
-                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-        VkImageCopy copy_region;
-        copy_region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        copy_region.srcSubresource.mipLevel = 0;
-        copy_region.srcSubresource.baseArrayLayer = 0;
-        copy_region.srcSubresource.layerCount = 1;
-        copy_region.srcOffset.x = 0;
-        copy_region.srcOffset.y = 0;
-        copy_region.srcOffset.z = 0;
-        copy_region.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        copy_region.dstSubresource.mipLevel = 0;
-        copy_region.dstSubresource.baseArrayLayer = 0;
-        copy_region.dstSubresource.layerCount = 1;
-        copy_region.dstOffset.x = 0;
-        copy_region.dstOffset.y = 0;
-        copy_region.dstOffset.z = 0;
-        copy_region.extent.width = texObj.tex_width;
-        copy_region.extent.height = texObj.tex_height;
-        copy_region.extent.depth = 1;
-
-        /* Put the copy command into the command buffer */
-        vkCmdCopyImage(info.cmd, mappableImage,
-                       VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, texObj.image,
-                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy_region);
-
-        /* Set the layout for the texture image from DESTINATION_OPTIMAL to
-         * SHADER_READ_ONLY */
+        res = vkEndCommandBuffer(info.cmd);
+        assert(res == VK_SUCCESS);
+        const VkCommandBuffer cmd_bufs[] = {info.cmd};
+        VkFenceCreateInfo fenceInfo;
+        VkFence cmdFence;
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fenceInfo.pNext = NULL;
+        fenceInfo.flags = 0;
+        vkCreateFence(info.device, &fenceInfo, NULL, &cmdFence);
+
+        VkSubmitInfo submit_info[1] = {};
+        submit_info[0].pNext = NULL;
+        submit_info[0].sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info[0].waitSemaphoreCount = 0;
+        submit_info[0].pWaitSemaphores = NULL;
+        submit_info[0].pWaitDstStageMask = NULL;
+        submit_info[0].commandBufferCount = 1;
+        submit_info[0].pCommandBuffers = cmd_bufs;
+        submit_info[0].signalSemaphoreCount = 0;
+        submit_info[0].pSignalSemaphores = NULL;
+
+        /* Queue the command buffer for execution */
+        res = vkQueueSubmit(info.queue, 1, submit_info, cmdFence);
+        assert(res == VK_SUCCESS);
+
+        VkImageSubresource subres = {};
+        subres.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        subres.mipLevel = 0;
+        subres.arrayLayer = 0;
+
+        VkSubresourceLayout layout;
+        void *data;
+
+        /* Get the subresource layout so we know what the row pitch is */
+        vkGetImageSubresourceLayout(info.device, mappableImage, &subres,
+                                    &layout);
+
+        /* Make sure command buffer is finished before mapping */
+        do {
+            res = vkWaitForFences(info.device, 1, &cmdFence, VK_TRUE,
+                                  FENCE_TIMEOUT);
+        } while (res == VK_TIMEOUT);
+        assert(res == VK_SUCCESS);
+
+        vkDestroyFence(info.device, cmdFence, NULL);
+
+        res = vkMapMemory(info.device, mappableMemory, 0, mem_reqs.size, 0,
+                          &data);
+        assert(res == VK_SUCCESS);
+
+        /* Read the ppm file into the mappable image's memory */
+        if (!read_ppm(filename.c_str(), texObj.tex_width, texObj.tex_height,
+                      layout.rowPitch, (unsigned char *)data)) {
+            std::cout << "Could not load texture file lunarg.ppm\n";
+            exit(-1);
+        }
+
+        vkUnmapMemory(info.device, mappableMemory);
+
+        VkCommandBufferBeginInfo cmd_buf_info = {};
+        cmd_buf_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        cmd_buf_info.pNext = NULL;
+        cmd_buf_info.flags = 0;
+        cmd_buf_info.pInheritanceInfo = NULL;
+
+        res = vkResetCommandBuffer(info.cmd, 0);
+        res = vkBeginCommandBuffer(info.cmd, &cmd_buf_info);
+        assert(res == VK_SUCCESS);
+
+        /* We can use the linear tiled image as a texture, just do it */
+        texObj.image = mappableImage;
+        texObj.mem = mappableMemory;
         texObj.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
         set_image_layout(info, texObj.image, VK_IMAGE_ASPECT_COLOR_BIT,
-                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                         texObj.imageLayout);
-
-        /* Remember staging resources to free later */
-        info.stagingImage = mappableImage;
-        info.stagingMemory = mappableMemory;
+                         VK_IMAGE_LAYOUT_GENERAL, texObj.imageLayout);
+        /* No staging resources to free later */
+        info.stagingImage = VK_NULL_HANDLE;
+        info.stagingMemory = VK_NULL_HANDLE;
     }
 
     VkImageViewCreateInfo view_info = {};
@@ -1954,6 +1929,376 @@ void init_texture(struct sample_info &info, const char *textureName) {
     info.texture_data.image_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
 }
 
+void init_upload_engine(struct sample_info &info, VkDeviceSize size) {
+    VkResult U_ASSERT_ONLY res;
+    bool U_ASSERT_ONLY pass;
+    struct upload_engine &upload = info.upload;
+
+    /* Offsets of copies to images must be multiples of the texel size and of
+     * 4; use the optimal alignment when it is larger */
+    upload.alignment = 16;
+    if (info.gpu_props.limits.optimalBufferCopyOffsetAlignment >
+        upload.alignment)
+        upload.alignment =
+            info.gpu_props.limits.optimalBufferCopyOffsetAlignment;
+    upload.part_size = size / UPLOAD_BATCH_COUNT;
+    upload.part_size -= upload.part_size % upload.alignment;
+    assert(upload.part_size > 0);
+
+    VkCommandPoolCreateInfo cmd_pool_info = {};
+    cmd_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    cmd_pool_info.pNext = NULL;
+    cmd_pool_info.queueFamilyIndex = info.graphics_queue_family_index;
+    cmd_pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT |
+                          VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    res = vkCreateCommandPool(info.device, &cmd_pool_info, NULL,
+                              &upload.cmd_pool);
+    assert(res == VK_SUCCESS);
+
+    VkCommandBufferAllocateInfo cmd_info = {};
+    cmd_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmd_info.pNext = NULL;
+    cmd_info.commandPool = upload.cmd_pool;
+    cmd_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmd_info.commandBufferCount = 1;
+
+    VkFenceCreateInfo fence_info = {};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fence_info.pNext = NULL;
+    fence_info.flags = 0;
+
+    for (uint32_t i = 0; i < UPLOAD_BATCH_COUNT; i++) {
+        struct upload_batch &batch = upload.batches[i];
+        res = vkAllocateCommandBuffers(info.device, &cmd_info, &batch.cmd);
+        assert(res == VK_SUCCESS);
+        res = vkCreateFence(info.device, &fence_info, NULL, &batch.fence);
+        assert(res == VK_SUCCESS);
+        batch.used = 0;
+        batch.recording = false;
+        batch.submitted = false;
+    }
+    upload.current = 0;
+
+    VkBufferCreateInfo buf_info = {};
+    buf_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buf_info.pNext = NULL;
+    buf_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    buf_info.size = upload.part_size * UPLOAD_BATCH_COUNT;
+    buf_info.queueFamilyIndexCount = 0;
+    buf_info.pQueueFamilyIndices = NULL;
+    buf_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    buf_info.flags = 0;
+    res = vkCreateBuffer(info.device, &buf_info, NULL, &upload.buf);
+    assert(res == VK_SUCCESS);
+
+    VkMemoryRequirements mem_reqs;
+    vkGetBufferMemoryRequirements(info.device, upload.buf, &mem_reqs);
+
+    VkMemoryAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.pNext = NULL;
+    alloc_info.memoryTypeIndex = 0;
+    alloc_info.allocationSize = mem_reqs.size;
+
+    /* Coherent memory needs no flushes after the CPU writes to it */
+    pass = memory_type_from_properties(info, mem_reqs.memoryTypeBits,
+                                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                           VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                       &alloc_info.memoryTypeIndex);
+    assert(pass);
+
+    res = vkAllocateMemory(info.device, &alloc_info, NULL, &upload.mem);
+    assert(res == VK_SUCCESS);
+
+    res = vkBindBufferMemory(info.device, upload.buf, upload.mem, 0);
+    assert(res == VK_SUCCESS);
+
+    /* Stays mapped until the engine is destroyed */
+    void *data;
+    res = vkMapMemory(info.device, upload.mem, 0, VK_WHOLE_SIZE, 0, &data);
+    assert(res == VK_SUCCESS);
+    upload.mapped = (unsigned char *)data;
+
+    upload.bytes = 0;
+    upload.copies = 0;
+    upload.submits = 0;
+    upload.stalls = 0;
+}
+
+/* Makes the current batch ready to take copies, waiting for the copies last
+ * made out of its part of the staging buffer if need be */
+static struct upload_batch &begin_upload_batch(struct sample_info &info) {
+    VkResult U_ASSERT_ONLY res;
+    struct upload_engine &upload = info.upload;
+    struct upload_batch &batch = upload.batches[upload.current];
+
+    if (batch.recording)
+        return batch;
+
+    if (batch.submitted) {
+        if (vkGetFenceStatus(info.device, batch.fence) != VK_SUCCESS) {
+            upload.stalls++;
+            do {
+                res = vkWaitForFences(info.device, 1, &batch.fence, VK_TRUE,
+                                      FENCE_TIMEOUT);
+            } while (res == VK_TIMEOUT);
+            assert(res == VK_SUCCESS);
+        }
+        res = vkResetFences(info.device, 1, &batch.fence);
+        assert(res == VK_SUCCESS);
+
+        for (size_t i = 0; i < batch.large_bufs.size(); i++) {
+            vkDestroyBuffer(info.device, batch.large_bufs[i], NULL);
+            vkFreeMemory(info.device, batch.large_mems[i], NULL);
+        }
+        batch.large_bufs.clear();
+        batch.large_mems.clear();
+        batch.submitted = false;
+    }
+
+    VkCommandBufferBeginInfo cmd_buf_info = {};
+    cmd_buf_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    cmd_buf_info.pNext = NULL;
+    cmd_buf_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    cmd_buf_info.pInheritanceInfo = NULL;
+    res = vkBeginCommandBuffer(batch.cmd, &cmd_buf_info);
+    assert(res == VK_SUCCESS);
+
+    batch.used = 0;
+    batch.recording = true;
+
+    return batch;
+}
+
+/* The region is only good until the next call; record its copy first */
+struct upload_region execute_upload_alloc(struct sample_info &info,
+                                          VkDeviceSize size) {
+    VkResult U_ASSERT_ONLY res;
+    bool U_ASSERT_ONLY pass;
+    struct upload_engine &upload = info.upload;
+    struct upload_region region;
+
+    if (upload.buf == VK_NULL_HANDLE)
+        init_upload_engine(info);
+
+    struct upload_batch *batch = &begin_upload_batch(info);
+
+    if (size > upload.part_size) {
+        /* Too large for any part, give it a staging buffer of its own */
+        VkBufferCreateInfo buf_info = {};
+        buf_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buf_info.pNext = NULL;
+        buf_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        buf_info.size = size;
+        buf_info.queueFamilyIndexCount = 0;
+        buf_info.pQueueFamilyIndices = NULL;
+        buf_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        buf_info.flags = 0;
+        res = vkCreateBuffer(info.device, &buf_info, NULL, &region.buf);
+        assert(res == VK_SUCCESS);
+
+        VkMemoryRequirements mem_reqs;
+        vkGetBufferMemoryRequirements(info.device, region.buf, &mem_reqs);
+
+        VkMemoryAllocateInfo alloc_info = {};
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.pNext = NULL;
+        alloc_info.memoryTypeIndex = 0;
+        alloc_info.allocationSize = mem_reqs.size;
+        pass = memory_type_from_properties(
+            info, mem_reqs.memoryTypeBits,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            &alloc_info.memoryTypeIndex);
+        assert(pass);
+
+        VkDeviceMemory mem;
+        res = vkAllocateMemory(info.device, &alloc_info, NULL, &mem);
+        assert(res == VK_SUCCESS);
+        res = vkBindBufferMemory(info.device, region.buf, mem, 0);
+        assert(res == VK_SUCCESS);
+        res = vkMapMemory(info.device, mem, 0, VK_WHOLE_SIZE, 0, &region.data);
+        assert(res == VK_SUCCESS);
+
+        batch->large_bufs.push_back(region.buf);
+        batch->large_mems.push_back(mem);
+        region.offset = 0;
+
+        return region;
+    }
+
+    VkDeviceSize offset = (batch->used + upload.alignment - 1) /
+                          upload.alignment * upload.alignment;
+    if (offset + size > upload.part_size) {
+        /* This part is full, send its copies on and move to the next */
+        execute_flush_uploads(info);
+        batch = &begin_upload_batch(info);
+        offset = 0;
+    }
+    batch->used = offset + size;
+
+    region.buf = upload.buf;
+    region.offset = upload.part_size * upload.current + offset;
+    region.data = upload.mapped + region.offset;
+
+    return region;
+}
+
+void execute_upload_to_image(struct sample_info &info,
+                             const struct upload_region &region, VkImage image,
+                             uint32_t width, uint32_t height,
+                             VkImageLayout final_layout) {
+    struct upload_engine &upload = info.upload;
+    struct upload_batch &batch = begin_upload_batch(info);
+
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.pNext = NULL;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(batch.cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL,
+                         1, &barrier);
+
+    VkBufferImageCopy copy_region = {};
+    copy_region.bufferOffset = region.offset;
+    copy_region.bufferRowLength = 0;
+    copy_region.bufferImageHeight = 0;
+    copy_region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    copy_region.imageSubresource.mipLevel = 0;
+    copy_region.imageSubresource.baseArrayLayer = 0;
+    copy_region.imageSubresource.layerCount = 1;
+    copy_region.imageOffset.x = 0;
+    copy_region.imageOffset.y = 0;
+    copy_region.imageOffset.z = 0;
+    copy_region.imageExtent.width = width;
+    copy_region.imageExtent.height = height;
+    copy_region.imageExtent.depth = 1;
+    vkCmdCopyBufferToImage(batch.cmd, region.buf, image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
+                           &copy_region);
+
+    /* Later submissions to the queue wait for the copy before they read the
+     * image */
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask =
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = final_layout;
+    vkCmdPipelineBarrier(batch.cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, NULL, 0,
+                         NULL, 1, &barrier);
+
+    upload.bytes += (uint64_t)width * height * 4;
+    upload.copies++;
+}
+
+void execute_upload_to_buffer(struct sample_info &info,
+                              const struct upload_region &region, VkBuffer buf,
+                              VkDeviceSize offset, VkDeviceSize size) {
+    struct upload_engine &upload = info.upload;
+    struct upload_batch &batch = begin_upload_batch(info);
+
+    VkBufferCopy copy_region = {};
+    copy_region.srcOffset = region.offset;
+    copy_region.dstOffset = offset;
+    copy_region.size = size;
+    vkCmdCopyBuffer(batch.cmd, region.buf, buf, 1, &copy_region);
+
+    VkBufferMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.pNext = NULL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buf;
+    barrier.offset = offset;
+    barrier.size = size;
+    vkCmdPipelineBarrier(batch.cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, NULL, 1,
+                         &barrier, 0, NULL);
+
+    upload.bytes += size;
+    upload.copies++;
+}
+
+void execute_flush_uploads(struct sample_info &info) {
+    VkResult U_ASSERT_ONLY res;
+    struct upload_engine &upload = info.upload;
+
+    if (upload.buf == VK_NULL_HANDLE)
+        return;
+
+    struct upload_batch &batch = upload.batches[upload.current];
+    if (!batch.recording)
+        return;
+
+    res = vkEndCommandBuffer(batch.cmd);
+    assert(res == VK_SUCCESS);
+
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.pNext = NULL;
+    submit_info.waitSemaphoreCount = 0;
+    submit_info.pWaitSemaphores = NULL;
+    submit_info.pWaitDstStageMask = NULL;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &batch.cmd;
+    submit_info.signalSemaphoreCount = 0;
+    submit_info.pSignalSemaphores = NULL;
+    res = vkQueueSubmit(info.queue, 1, &submit_info, batch.fence);
+    assert(res == VK_SUCCESS);
+
+    batch.recording = false;
+    batch.submitted = true;
+    upload.submits++;
+
+    upload.current = (upload.current + 1) % UPLOAD_BATCH_COUNT;
+}
+
+void execute_wait_uploads(struct sample_info &info) {
+    VkResult U_ASSERT_ONLY res;
+    struct upload_engine &upload = info.upload;
+
+    if (upload.buf == VK_NULL_HANDLE)
+        return;
+
+    execute_flush_uploads(info);
+
+    for (uint32_t i = 0; i < UPLOAD_BATCH_COUNT; i++) {
+        struct upload_batch &batch = upload.batches[i];
+        if (!batch.submitted)
+            continue;
+
+        do {
+            res = vkWaitForFences(info.device, 1, &batch.fence, VK_TRUE,
+                                  FENCE_TIMEOUT);
+        } while (res == VK_TIMEOUT);
+        assert(res == VK_SUCCESS);
+        res = vkResetFences(info.device, 1, &batch.fence);
+        assert(res == VK_SUCCESS);
+
+        for (size_t j = 0; j < batch.large_bufs.size(); j++) {
+            vkDestroyBuffer(info.device, batch.large_bufs[j], NULL);
+            vkFreeMemory(info.device, batch.large_mems[j], NULL);
+        }
+        batch.large_bufs.clear();
+        batch.large_mems.clear();
+        batch.submitted = false;
+    }
+}
+
 void init_viewports(struct sample_info &info) {
     info.viewport.height = (float)info.height;
     info.viewport.width = (float)info.width;
@@ -2115,4 +2460,21 @@ void destroy_textures(struct sample_info &info) {
     if (info.stagingMemory) {
         vkFreeMemory(info.device, info.stagingMemory, NULL);
     }
+    destroy_upload_engine(info);
+}
+
+void destroy_upload_engine(struct sample_info &info) {
+    struct upload_engine &upload = info.upload;
+
+    if (upload.buf == VK_NULL_HANDLE)
+        return;
+
+    execute_wait_uploads(info);
+
+    for (uint32_t i = 0; i < UPLOAD_BATCH_COUNT; i++)
+        vkDestroyFence(info.device, upload.batches[i].fence, NULL);
+    vkDestroyCommandPool(info.device, upload.cmd_pool, NULL);
+    vkDestroyBuffer(info.device, upload.buf, NULL);
+    vkFreeMemory(info.device, upload.mem, NULL);
+    upload.buf = VK_NULL_HANDLE;
 }
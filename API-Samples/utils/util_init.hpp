@@ -85,6 +85,19 @@ void init_sampler(struct sample_info &info, VkSampler &sampler);
 void init_image(struct sample_info &info, texture_object &texObj,
                 const char *textureName);
 void init_texture(struct sample_info &info, const char *textureName = nullptr);
+void init_upload_engine(struct sample_info &info,
+                        VkDeviceSize size = UPLOAD_STAGING_SIZE);
+struct upload_region execute_upload_alloc(struct sample_info &info,
+                                          VkDeviceSize size);
+void execute_upload_to_image(struct sample_info &info,
+                             const struct upload_region &region, VkImage image,
+                             uint32_t width, uint32_t height,
+                             VkImageLayout final_layout);
+void execute_upload_to_buffer(struct sample_info &info,
+                              const struct upload_region &region, VkBuffer buf,
+                              VkDeviceSize offset, VkDeviceSize size);
+void execute_flush_uploads(struct sample_info &info);
+void execute_wait_uploads(struct sample_info &info);
 void init_viewports(struct sample_info &info);
 void init_scissors(struct sample_info &info);
 void init_fence(struct sample_info &info, VkFence &fence);
@@ -106,6 +119,7 @@ void destroy_pipeline_cache(struct sample_info &info);
 void destroy_descriptor_pool(struct sample_info &info);
 void destroy_vertex_buffer(struct sample_info &info);
 void destroy_textures(struct sample_info &info);
+void destroy_upload_engine(struct sample_info &info);
 void destroy_framebuffers(struct sample_info &info);
 void destroy_shaders(struct sample_info &info);
 void destroy_renderpass(struct sample_info &info);
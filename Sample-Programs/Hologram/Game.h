@@ -50,6 +50,9 @@ public:
         bool no_tick;
         bool no_render;
         bool no_present;
+
+        // where the pipeline cache is kept between runs, if anywhere
+        std::string pipeline_cache;
     };
     const Settings &settings() const { return settings_; }
 
@@ -123,6 +126,9 @@ private:
                 settings_.no_render = true;
             } else if (*it == "-np") {
                 settings_.no_present = true;
+            } else if (*it == "--pipeline-cache") {
+                ++it;
+                settings_.pipeline_cache = *it;
             }
         }
     }
@@ -21,12 +21,15 @@
  */
 
 #include <array>
+#include <chrono>
+#include <sstream>
 
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "Helpers.h"
 #include "Hologram.h"
+#include "MeshBlob.h"
 #include "Meshes.h"
 #include "Shell.h"
 
@@ -41,11 +44,19 @@ struct ShaderParamBlock {
     float view_projection[4 * 4];
 };
 
+// per-object part of ShaderParamBlock for instanced drawing; packed since
+// it is indexed by instance rather than bound at an offset
+struct InstanceParamBlock {
+    float light_pos[4];
+    float light_color[4];
+    float model[4 * 4];
+};
+
 } // namespace
 
 Hologram::Hologram(const std::vector<std::string> &args)
     : Game("Hologram", args), multithread_(true), use_push_constants_(false),
-      sim_paused_(false), sim_(5000), camera_(2.5f), frame_data_(),
+      use_instancing_(false), sim_paused_(false), sim_(5000), camera_(2.5f), frame_data_(),
       render_pass_clear_value_({{ 0.0f, 0.1f, 0.2f, 1.0f }}),
       render_pass_begin_info_(),
       primary_cmd_begin_info_(), primary_cmd_submit_info_()
@@ -55,8 +66,16 @@ Hologram::Hologram(const std::vector<std::string> &args)
             multithread_ = false;
         else if (*it == "-p")
             use_push_constants_ = true;
+        else if (*it == "-i")
+            use_instancing_ = true;
+        else if (*it == "--mesh-cache")
+            mesh_cache_ = *++it;
     }
 
+    // instanced drawing pushes only the view projection
+    if (use_instancing_)
+        use_push_constants_ = false;
+
     init_workers();
 }
 
@@ -115,7 +134,7 @@ void Hologram::attach_shell(Shell &sh)
     for (uint32_t i = 0; i < mem_props.memoryTypeCount; i++)
         mem_flags_.push_back(mem_props.memoryTypes[i].propertyFlags);
 
-    meshes_ = new Meshes(dev_, mem_flags_);
+    create_meshes();
 
     create_render_pass();
     create_shader_modules();
@@ -170,6 +189,29 @@ void Hologram::detach_shell()
     Game::detach_shell();
 }
 
+void Hologram::create_meshes()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    // build the meshes only when there is no cached blob to map
+    MeshBlob blob;
+    bool loaded = !mesh_cache_.empty() && blob.load(mesh_cache_);
+    if (!loaded) {
+        blob.build();
+        if (!mesh_cache_.empty() && !blob.save(mesh_cache_))
+            shell_->log(Shell::LOG_WARN, "cannot write mesh cache");
+    }
+
+    meshes_ = new Meshes(dev_, mem_flags_, blob);
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::stringstream ss;
+    ss << "meshes " << (loaded ? "loaded from " + mesh_cache_ : std::string("built"))
+       << " and uploaded in " << elapsed.count() << " ms (" << blob.size() << " bytes)";
+    shell_->log(Shell::LOG_INFO, ss.str().c_str());
+}
+
 void Hologram::create_render_pass()
 {
     VkAttachmentDescription attachment = {};
@@ -224,7 +266,11 @@ void Hologram::create_shader_modules()
 {
     VkShaderModuleCreateInfo sh_info = {};
     sh_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    if (use_push_constants_) {
+    if (use_instancing_) {
+#include "Hologram.instanced.vert.h"
+        sh_info.codeSize = sizeof(Hologram_instanced_vert);
+        sh_info.pCode = Hologram_instanced_vert;
+    } else if (use_push_constants_) {
 #include "Hologram.push_constant.vert.h"
         sh_info.codeSize = sizeof(Hologram_push_constant_vert);
         sh_info.pCode = Hologram_push_constant_vert;
@@ -268,7 +314,16 @@ void Hologram::create_pipeline_layout()
     VkPipelineLayoutCreateInfo pipeline_layout_info = {};
     pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 
-    if (use_push_constants_) {
+    if (use_instancing_) {
+        push_const_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        push_const_range.offset = 0;
+        push_const_range.size = sizeof(camera_.view_projection);
+
+        pipeline_layout_info.pushConstantRangeCount = 1;
+        pipeline_layout_info.pPushConstantRanges = &push_const_range;
+        pipeline_layout_info.setLayoutCount = 1;
+        pipeline_layout_info.pSetLayouts = &desc_set_layout_;
+    } else if (use_push_constants_) {
         push_const_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
         push_const_range.offset = 0;
         push_const_range.size = sizeof(ShaderParamBlock);
@@ -364,7 +419,12 @@ void Hologram::create_pipeline()
     pipeline_info.layout = pipeline_layout_;
     pipeline_info.renderPass = render_pass_;
     pipeline_info.subpass = 0;
-    vk::assert_success(vk::CreateGraphicsPipelines(dev_, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &pipeline_));
+
+    double ms = shell_->pipeline_cache().create_graphics_pipeline(pipeline_info, pipeline_);
+
+    std::stringstream ss;
+    ss << "pipeline created in " << ms << " ms";
+    shell_->log(Shell::LOG_INFO, ss.str().c_str());
 }
 
 void Hologram::create_frame_data(int count)
@@ -463,15 +523,21 @@ void Hologram::create_command_buffers()
 
 void Hologram::create_buffers()
 {
-    VkDeviceSize object_data_size = sizeof(ShaderParamBlock);
-    // align object data to device limit
-    const VkDeviceSize &alignment =
-        physical_dev_props_.limits.minStorageBufferOffsetAlignment;
-    if (object_data_size % alignment)
-        object_data_size += alignment - (object_data_size % alignment);
-
-    // update simulation
-    sim_.set_frame_data_size(object_data_size);
+    VkDeviceSize object_data_size;
+    if (use_instancing_) {
+        object_data_size = sizeof(InstanceParamBlock);
+        init_instances();
+    } else {
+        object_data_size = sizeof(ShaderParamBlock);
+        // align object data to device limit
+        const VkDeviceSize &alignment =
+            physical_dev_props_.limits.minStorageBufferOffsetAlignment;
+        if (object_data_size % alignment)
+            object_data_size += alignment - (object_data_size % alignment);
+
+        // update simulation
+        sim_.set_frame_data_size(object_data_size);
+    }
 
     VkBufferCreateInfo buf_info = {};
     buf_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -704,6 +770,13 @@ void Hologram::update_simulation(const Worker &worker)
 void Hologram::draw_objects(Worker &worker)
 {
     auto &data = frame_data_[frame_data_index_];
+
+    // the primary command buffer draws all instances
+    if (use_instancing_) {
+        write_instances(data, worker.object_begin_, worker.object_end_);
+        return;
+    }
+
     auto cmd = data.worker_cmds[worker.index_];
 
     VkCommandBufferInheritanceInfo inherit_info = {};
@@ -747,6 +820,62 @@ void Hologram::draw_objects(Worker &worker)
     }
 }
 
+void Hologram::init_instances()
+{
+    const auto &objects = sim_.objects();
+
+    mesh_instance_counts_.assign(Meshes::MESH_COUNT, 0);
+    for (const auto &obj : objects)
+        mesh_instance_counts_[obj.mesh]++;
+
+    mesh_first_instances_.assign(Meshes::MESH_COUNT, 0);
+    for (int i = 1; i < Meshes::MESH_COUNT; i++)
+        mesh_first_instances_[i] = mesh_first_instances_[i - 1] + mesh_instance_counts_[i - 1];
+
+    std::vector<uint32_t> next(mesh_first_instances_);
+    instance_indices_.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); i++)
+        instance_indices_[i] = next[objects[i].mesh]++;
+}
+
+void Hologram::write_instances(FrameData &data, int begin, int end) const
+{
+    InstanceParamBlock *instances = reinterpret_cast<InstanceParamBlock *>(data.base);
+
+    for (int i = begin; i < end; i++) {
+        const auto &obj = sim_.objects()[i];
+        InstanceParamBlock *params = &instances[instance_indices_[i]];
+
+        memcpy(params->light_pos, glm::value_ptr(obj.light_pos), sizeof(obj.light_pos));
+        memcpy(params->light_color, glm::value_ptr(obj.light_color), sizeof(obj.light_color));
+        memcpy(params->model, glm::value_ptr(obj.model), sizeof(obj.model));
+    }
+}
+
+void Hologram::draw_instances(const FrameData &data, VkCommandBuffer cmd) const
+{
+    vk::CmdSetViewport(cmd, 0, 1, &viewport_);
+    vk::CmdSetScissor(cmd, 0, 1, &scissor_);
+
+    vk::CmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_);
+
+    const uint32_t offset = 0;
+    vk::CmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+            pipeline_layout_, 0, 1, &data.desc_set, 1, &offset);
+    vk::CmdPushConstants(cmd, pipeline_layout_, VK_SHADER_STAGE_VERTEX_BIT,
+            0, sizeof(camera_.view_projection), glm::value_ptr(camera_.view_projection));
+
+    meshes_->cmd_bind_buffers(cmd);
+
+    for (int i = 0; i < Meshes::MESH_COUNT; i++) {
+        if (!mesh_instance_counts_[i])
+            continue;
+
+        meshes_->cmd_draw(cmd, static_cast<Meshes::Type>(i),
+                mesh_instance_counts_[i], mesh_first_instances_[i]);
+    }
+}
+
 void Hologram::on_key(Key key)
 {
     switch (key) {
@@ -810,15 +939,23 @@ void Hologram::on_frame(float frame_pred)
 
     render_pass_begin_info_.framebuffer = framebuffers_[back.image_index];
     render_pass_begin_info_.renderArea.extent = extent_;
-    vk::CmdBeginRenderPass(data.primary_cmd, &render_pass_begin_info_,
-            VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
     // record render pass commands
     for (auto &worker : workers_)
         worker->wait_idle();
-    vk::CmdExecuteCommands(data.primary_cmd,
-            static_cast<uint32_t>(data.worker_cmds.size()),
-            data.worker_cmds.data());
+    if (use_instancing_) {
+        vk::CmdBeginRenderPass(data.primary_cmd, &render_pass_begin_info_,
+                VK_SUBPASS_CONTENTS_INLINE);
+
+        draw_instances(data, data.primary_cmd);
+    } else {
+        vk::CmdBeginRenderPass(data.primary_cmd, &render_pass_begin_info_,
+                VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+        vk::CmdExecuteCommands(data.primary_cmd,
+                static_cast<uint32_t>(data.worker_cmds.size()),
+                data.worker_cmds.data());
+    }
 
     vk::CmdEndRenderPass(data.primary_cmd);
     vk::EndCommandBuffer(data.primary_cmd);
@@ -117,6 +117,9 @@ private:
 
     bool multithread_;
     bool use_push_constants_;
+    bool use_instancing_;
+    // where the mesh blob is cached, if anywhere
+    std::string mesh_cache_;
 
     // called mostly by on_key
     void update_camera();
@@ -128,6 +131,7 @@ private:
     std::vector<std::unique_ptr<Worker>> workers_;
 
     // called by attach_shell
+    void create_meshes();
     void create_render_pass();
     void create_shader_modules();
     void create_descriptor_set_layout();
@@ -190,6 +194,17 @@ private:
     void update_simulation(const Worker &worker);
     void draw_object(const Simulation::Object &obj, FrameData &data, VkCommandBuffer cmd) const;
     void draw_objects(Worker &worker);
+    void write_instances(FrameData &data, int begin, int end) const;
+
+    // Instanced drawing writes the objects' parameters grouped by mesh so
+    // that each mesh is drawn by one instanced draw.  Meshes do not change,
+    // so each object's instance index is fixed.
+    void init_instances();
+    void draw_instances(const FrameData &data, VkCommandBuffer cmd) const;
+
+    std::vector<uint32_t> instance_indices_;
+    std::vector<uint32_t> mesh_instance_counts_;
+    std::vector<uint32_t> mesh_first_instances_;
 };
 
 #endif // HOLOGRAM_H
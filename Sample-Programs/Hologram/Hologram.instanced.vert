@@ -0,0 +1,36 @@
+#version 310 es
+
+layout(location = 0) in vec3 in_pos;
+layout(location = 1) in vec3 in_normal;
+
+struct instance_params {
+	vec3 light_pos;
+	vec3 light_color;
+	mat4 model;
+};
+
+layout(std140, set = 0, binding = 0) readonly buffer instance_block {
+	instance_params instances[];
+} params;
+
+layout(std140, push_constant) uniform frame_block {
+	mat4 view_projection;
+} frame;
+
+out vec3 color;
+
+void main()
+{
+	instance_params inst = params.instances[gl_InstanceIndex];
+
+	vec3 world_light = vec3(inst.model * vec4(inst.light_pos, 1.0));
+	vec3 world_pos = vec3(inst.model * vec4(in_pos, 1.0));
+	vec3 world_normal = mat3(inst.model) * in_normal;
+
+	vec3 light_dir = world_light - world_pos;
+	float brightness = dot(light_dir, world_normal) / length(light_dir) / length(world_normal);
+	brightness = abs(brightness);
+
+	gl_Position = frame.view_projection * vec4(world_pos, 1.0);
+	color = inst.light_color * brightness;
+}
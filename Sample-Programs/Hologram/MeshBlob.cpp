@@ -0,0 +1,645 @@
+/*
+ * Copyright (C) 2016 Google, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "FileUtil.h"
+#include "Meshes.h"
+#include "MeshBlob.h"
+
+namespace {
+
+class Mesh {
+public:
+    struct Position {
+        float x;
+        float y;
+        float z;
+    };
+
+    struct Normal {
+        float x;
+        float y;
+        float z;
+    };
+
+    struct Face {
+        int v0;
+        int v1;
+        int v2;
+    };
+
+    static uint32_t vertex_stride()
+    {
+        // Position + Normal
+        const int comp_count = 6;
+
+        return sizeof(float) * comp_count;
+    }
+
+    void build(const std::vector<std::array<float, 6>> &vertices, const std::vector<std::array<int, 3>> &faces)
+    {
+        positions_.reserve(vertices.size());
+        normals_.reserve(vertices.size());
+        for (const auto &v : vertices) {
+            positions_.emplace_back(Position{ v[0], v[1], v[2] });
+            normals_.emplace_back(Normal{ v[3], v[4], v[5] });
+        }
+
+        faces_.reserve(faces.size());
+        for (const auto &f : faces)
+            faces_.emplace_back(Face{ f[0], f[1], f[2] });
+    }
+
+    uint32_t vertex_count() const
+    {
+        return positions_.size();
+    }
+
+    // radius of the bounding sphere centered at the origin
+    float bounding_radius() const
+    {
+        float max_len2 = 0.0f;
+        for (const auto &pos : positions_)
+            max_len2 = std::max(max_len2, pos.x * pos.x + pos.y * pos.y + pos.z * pos.z);
+
+        return std::sqrt(max_len2);
+    }
+
+    VkDeviceSize vertex_buffer_size() const
+    {
+        return vertex_stride() * vertex_count();
+    }
+
+    void vertex_buffer_write(void *data) const
+    {
+        float *dst = reinterpret_cast<float *>(data);
+        for (size_t i = 0; i < positions_.size(); i++) {
+            const Position &pos = positions_[i];
+            const Normal &normal = normals_[i];
+            dst[0] = pos.x;
+            dst[1] = pos.y;
+            dst[2] = pos.z;
+            dst[3] = normal.x;
+            dst[4] = normal.y;
+            dst[5] = normal.z;
+            dst += 6;
+        }
+    }
+
+    uint32_t index_count() const
+    {
+        return faces_.size() * 3;
+    }
+
+    VkDeviceSize index_buffer_size() const
+    {
+        return sizeof(uint32_t) * index_count();
+    }
+
+    void index_buffer_write(void *data) const
+    {
+        uint32_t *dst = reinterpret_cast<uint32_t *>(data);
+        for (const auto &face : faces_) {
+            dst[0] = face.v0;
+            dst[1] = face.v1;
+            dst[2] = face.v2;
+            dst += 3;
+        }
+    }
+
+    std::vector<Position> positions_;
+    std::vector<Normal> normals_;
+    std::vector<Face> faces_;
+};
+
+class BuildPyramid {
+public:
+    BuildPyramid(Mesh &mesh)
+    {
+        const std::vector<std::array<float, 6>> vertices = {
+            //      position                normal
+            {  0.0f,  0.0f,  1.0f,    0.0f,  0.0f,  1.0f },
+            { -1.0f, -1.0f, -1.0f,   -1.0f, -1.0f, -1.0f },
+            {  1.0f, -1.0f, -1.0f,    1.0f, -1.0f, -1.0f },
+            {  1.0f,  1.0f, -1.0f,    1.0f,  1.0f, -1.0f },
+            { -1.0f,  1.0f, -1.0f,   -1.0f,  1.0f, -1.0f },
+        };
+
+        const std::vector<std::array<int, 3>> faces = {
+            { 0, 1, 2 },
+            { 0, 2, 3 },
+            { 0, 3, 4 },
+            { 0, 4, 1 },
+            { 1, 4, 3 },
+            { 1, 3, 2 },
+        };
+
+        mesh.build(vertices, faces);
+    }
+};
+
+class BuildIcosphere {
+public:
+    BuildIcosphere(Mesh &mesh) : mesh_(mesh), radius_(1.0f)
+    {
+        const int tessellate_level = 2;
+
+        build_icosahedron();
+        for (int i = 0; i < tessellate_level; i++)
+            tessellate();
+    }
+
+private:
+    void build_icosahedron()
+    {
+        // https://en.wikipedia.org/wiki/Regular_icosahedron
+        const float l1 = std::sqrt(2.0f / (5.0f + std::sqrt(5.0f))) * radius_;
+        const float l2 = std::sqrt(2.0f / (5.0f - std::sqrt(5.0f))) * radius_;
+        // vertices are from three golden rectangles
+        const std::vector<std::array<float, 6>> icosahedron_vertices = {
+            //   position           normal
+            { -l1, -l2, 0.0f,   -l1, -l2, 0.0f, },
+            {  l1, -l2, 0.0f,    l1, -l2, 0.0f, },
+            {  l1,  l2, 0.0f,    l1,  l2, 0.0f, },
+            { -l1,  l2, 0.0f,   -l1,  l2, 0.0f, },
+
+            { -l2, 0.0f, -l1,   -l2, 0.0f, -l1, },
+            {  l2, 0.0f, -l1,    l2, 0.0f, -l1, },
+            {  l2, 0.0f,  l1,    l2, 0.0f,  l1, },
+            { -l2, 0.0f,  l1,   -l2, 0.0f,  l1, },
+
+            { 0.0f, -l1, -l2,   0.0f, -l1, -l2, },
+            { 0.0f,  l1, -l2,   0.0f,  l1, -l2, },
+            { 0.0f,  l1,  l2,   0.0f,  l1,  l2, },
+            { 0.0f, -l1,  l2,   0.0f, -l1,  l2, },
+        };
+        const std::vector<std::array<int, 3>> icosahedron_faces = {
+            // triangles sharing vertex 0
+            {  0,  1, 11 },
+            {  0, 11,  7 },
+            {  0,  7,  4 },
+            {  0,  4,  8 },
+            {  0,  8,  1 },
+            // adjacent triangles
+            { 11,  1,  6 },
+            {  7, 11, 10 },
+            {  4,  7,  3 },
+            {  8,  4,  9 },
+            {  1,  8,  5 },
+            // triangles sharing vertex 2
+            {  2,  3, 10 },
+            {  2, 10,  6 },
+            {  2,  6,  5 },
+            {  2,  5,  9 },
+            {  2,  9,  3 },
+            // adjacent triangles
+            { 10,  3,  7 },
+            {  6, 10, 11 },
+            {  5,  6,  1 },
+            {  9,  5,  8 },
+            {  3,  9,  4 },
+        };
+
+        mesh_.build(icosahedron_vertices, icosahedron_faces);
+    }
+
+    void tessellate()
+    {
+        size_t middle_point_count = mesh_.faces_.size() * 3 / 2;
+        size_t final_face_count = mesh_.faces_.size() * 4;
+
+        std::vector<Mesh::Face> faces;
+        faces.reserve(final_face_count);
+
+        middle_points_.clear();
+        middle_points_.reserve(middle_point_count);
+
+        mesh_.positions_.reserve(mesh_.vertex_count() + middle_point_count);
+        mesh_.normals_.reserve(mesh_.vertex_count() + middle_point_count);
+
+        for (const auto &f : mesh_.faces_) {
+            int v0 = f.v0;
+            int v1 = f.v1;
+            int v2 = f.v2;
+
+            int v01 = add_middle_point(v0, v1);
+            int v12 = add_middle_point(v1, v2);
+            int v20 = add_middle_point(v2, v0);
+
+            faces.emplace_back(Mesh::Face{ v0, v01, v20 });
+            faces.emplace_back(Mesh::Face{ v1, v12, v01 });
+            faces.emplace_back(Mesh::Face{ v2, v20, v12 });
+            faces.emplace_back(Mesh::Face{ v01, v12, v20 });
+        }
+
+        mesh_.faces_.swap(faces);
+    }
+
+    int add_middle_point(int a, int b)
+    {
+        uint64_t key = (a < b) ? ((uint64_t) a << 32 | b) : ((uint64_t) b << 32 | a);
+        auto it = middle_points_.find(key);
+        if (it != middle_points_.end())
+            return it->second;
+
+        const Mesh::Position &pos_a = mesh_.positions_[a];
+        const Mesh::Position &pos_b = mesh_.positions_[b];
+        Mesh::Position pos_mid = {
+            (pos_a.x + pos_b.x) / 2.0f,
+            (pos_a.y + pos_b.y) / 2.0f,
+            (pos_a.z + pos_b.z) / 2.0f,
+        };
+        float scale = radius_ / std::sqrt(pos_mid.x * pos_mid.x +
+                                          pos_mid.y * pos_mid.y +
+                                          pos_mid.z * pos_mid.z);
+        pos_mid.x *= scale;
+        pos_mid.y *= scale;
+        pos_mid.z *= scale;
+
+        Mesh::Normal normal_mid = { pos_mid.x, pos_mid.y, pos_mid.z };
+        normal_mid.x /= radius_;
+        normal_mid.y /= radius_;
+        normal_mid.z /= radius_;
+
+        mesh_.positions_.emplace_back(pos_mid);
+        mesh_.normals_.emplace_back(normal_mid);
+
+        int mid = mesh_.vertex_count() - 1;
+        middle_points_.emplace(std::make_pair(key, mid));
+
+        return mid;
+    }
+
+    Mesh &mesh_;
+    const float radius_;
+    std::unordered_map<uint64_t, uint32_t> middle_points_;
+};
+
+class BuildTeapot {
+public:
+    BuildTeapot(Mesh &mesh)
+    {
+#include "Meshes.teapot.h"
+        const int position_count = sizeof(teapot_positions) / sizeof(teapot_positions[0]);
+        const int index_count = sizeof(teapot_indices) / sizeof(teapot_indices[0]);
+        assert(position_count % 3 == 0 && index_count % 3 == 0);
+
+        Mesh::Position translate;
+        float scale;
+        get_transform(teapot_positions, position_count, translate, scale);
+
+        for (int i = 0; i < position_count; i += 3) {
+            mesh.positions_.emplace_back(Mesh::Position{
+                (teapot_positions[i + 0] + translate.x) * scale,
+                (teapot_positions[i + 1] + translate.y) * scale,
+                (teapot_positions[i + 2] + translate.z) * scale,
+            });
+
+            mesh.normals_.emplace_back(Mesh::Normal{
+                teapot_normals[i + 0],
+                teapot_normals[i + 1],
+                teapot_normals[i + 2],
+            });
+        }
+
+        for (int i = 0; i < index_count; i += 3) {
+            mesh.faces_.emplace_back(Mesh::Face{
+                teapot_indices[i + 0],
+                teapot_indices[i + 1],
+                teapot_indices[i + 2]
+            });
+        }
+    }
+
+    void get_transform(const float *positions, int position_count,
+                       Mesh::Position &translate, float &scale)
+    {
+        float min[3] = {
+            positions[0],
+            positions[1],
+            positions[2],
+        };
+        float max[3] = {
+            positions[0],
+            positions[1],
+            positions[2],
+        };
+        for (int i = 3; i < position_count; i += 3) {
+            for (int j = 0; j < 3; j++) {
+                if (min[j] > positions[i + j])
+                    min[j] = positions[i + j];
+                if (max[j] < positions[i + j])
+                    max[j] = positions[i + j];
+            }
+        }
+
+        translate.x = -(min[0] + max[0]) / 2.0f;
+        translate.y = -(min[1] + max[1]) / 2.0f;
+        translate.z = -(min[2] + max[2]) / 2.0f;
+
+        float extents[3] = {
+            max[0] + translate.x,
+            max[1] + translate.y,
+            max[2] + translate.z,
+        };
+
+        float max_extent = extents[0];
+        if (max_extent < extents[1])
+            max_extent = extents[1];
+        if (max_extent < extents[2])
+            max_extent = extents[2];
+
+        scale = 1.0f / max_extent;
+    }
+};
+
+void build_mesh(Meshes::Type type, Mesh &mesh)
+{
+    switch (type) {
+    case Meshes::MESH_PYRAMID: {
+        BuildPyramid build_pyramid(mesh);
+        break;
+    }
+    case Meshes::MESH_ICOSPHERE: {
+        BuildIcosphere build_icosphere(mesh);
+        break;
+    }
+    case Meshes::MESH_TEAPOT: {
+        BuildTeapot build_teapot(mesh);
+        break;
+    }
+    default:
+        assert(!"unknown mesh");
+        break;
+    }
+}
+
+const char blob_magic[4] = { 'S', 'M', 'S', 'H' };
+// bump whenever the meshes or the layout change so that saved blobs are
+// rebuilt
+const uint32_t blob_version = 1;
+
+struct BlobLayout {
+    size_t draws_offset;
+    size_t radii_offset;
+    size_t vertex_offset;
+    size_t index_offset;
+    size_t size;
+};
+
+size_t align(size_t offset, size_t alignment)
+{
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+BlobLayout get_blob_layout(uint32_t mesh_count, size_t vertex_size, size_t index_size)
+{
+    BlobLayout layout;
+    layout.draws_offset = sizeof(MeshBlob::Header);
+    layout.radii_offset = layout.draws_offset + sizeof(VkDrawIndexedIndirectCommand) * mesh_count;
+    layout.vertex_offset = align(layout.radii_offset + sizeof(float) * mesh_count, 16);
+    layout.index_offset = align(layout.vertex_offset + vertex_size, 16);
+    layout.size = layout.index_offset + index_size;
+
+    return layout;
+}
+
+} // namespace
+
+MeshBlob::MeshBlob() : data_(nullptr), size_(0), mapped_(false)
+{
+}
+
+MeshBlob::~MeshBlob()
+{
+    clear();
+}
+
+void MeshBlob::clear()
+{
+    if (mapped_) {
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+#else
+        munmap(const_cast<uint8_t *>(data_), size_);
+#endif
+        mapped_ = false;
+    }
+
+    storage_.clear();
+    data_ = nullptr;
+    size_ = 0;
+}
+
+const VkDrawIndexedIndirectCommand *MeshBlob::draw_commands() const
+{
+    return reinterpret_cast<const VkDrawIndexedIndirectCommand *>(
+            data_ + get_blob_layout(header().mesh_count, 0, 0).draws_offset);
+}
+
+const float *MeshBlob::radii() const
+{
+    return reinterpret_cast<const float *>(
+            data_ + get_blob_layout(header().mesh_count, 0, 0).radii_offset);
+}
+
+void MeshBlob::build()
+{
+    clear();
+
+    std::array<Mesh, Meshes::MESH_COUNT> meshes;
+    std::array<float, Meshes::MESH_COUNT> radii;
+    for (int i = 0; i < Meshes::MESH_COUNT; i++) {
+        build_mesh(static_cast<Meshes::Type>(i), meshes[i]);
+        radii[i] = meshes[i].bounding_radius();
+    }
+
+    std::array<VkDrawIndexedIndirectCommand, Meshes::MESH_COUNT> draws;
+    std::array<size_t, Meshes::MESH_COUNT> vertex_offsets;
+    std::array<size_t, Meshes::MESH_COUNT> index_offsets;
+    uint32_t first_index = 0;
+    int32_t vertex_offset = 0;
+    size_t vertex_size = 0;
+    size_t index_size = 0;
+    for (int i = 0; i < Meshes::MESH_COUNT; i++) {
+        const Mesh &mesh = meshes[i];
+
+        VkDrawIndexedIndirectCommand &draw = draws[i];
+        draw.indexCount = mesh.index_count();
+        draw.instanceCount = 1;
+        draw.firstIndex = first_index;
+        draw.vertexOffset = vertex_offset;
+        draw.firstInstance = 0;
+
+        vertex_offsets[i] = vertex_size;
+        index_offsets[i] = index_size;
+
+        first_index += mesh.index_count();
+        vertex_offset += mesh.vertex_count();
+        vertex_size += mesh.vertex_buffer_size();
+        index_size += mesh.index_buffer_size();
+    }
+
+    const BlobLayout layout = get_blob_layout(Meshes::MESH_COUNT, vertex_size, index_size);
+    storage_.assign(layout.size, 0);
+
+    Header header = {};
+    std::memcpy(header.magic, blob_magic, sizeof(header.magic));
+    header.version = blob_version;
+    header.mesh_count = Meshes::MESH_COUNT;
+    header.vertex_stride = Mesh::vertex_stride();
+    header.vertex_offset = layout.vertex_offset;
+    header.vertex_size = vertex_size;
+    header.index_offset = layout.index_offset;
+    header.index_size = index_size;
+
+    std::memcpy(&storage_[0], &header, sizeof(header));
+    std::memcpy(&storage_[layout.draws_offset], draws.data(), sizeof(draws[0]) * draws.size());
+    std::memcpy(&storage_[layout.radii_offset], radii.data(), sizeof(radii[0]) * radii.size());
+
+    uint8_t *vertices = &storage_[layout.vertex_offset];
+    uint8_t *indices = &storage_[layout.index_offset];
+    for (int i = 0; i < Meshes::MESH_COUNT; i++) {
+        meshes[i].vertex_buffer_write(vertices + vertex_offsets[i]);
+        meshes[i].index_buffer_write(indices + index_offsets[i]);
+    }
+
+    data_ = storage_.data();
+    size_ = storage_.size();
+}
+
+bool MeshBlob::load(const std::string &filename)
+{
+    clear();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER file_size;
+    HANDLE mapping = NULL;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+        mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping)
+        return false;
+
+    // the view keeps the file mapped
+    const void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!data)
+        return false;
+
+    size_t size = static_cast<size_t>(file_size.QuadPart);
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+        data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping outlives the descriptor
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    size_t size = static_cast<size_t>(info.st_size);
+#endif
+
+    data_ = static_cast<const uint8_t *>(data);
+    size_ = size;
+    mapped_ = true;
+
+    if (!validate()) {
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool MeshBlob::validate() const
+{
+    if (size_ < sizeof(Header))
+        return false;
+
+    const Header &h = header();
+    if (std::memcmp(h.magic, blob_magic, sizeof(h.magic)) != 0 ||
+        h.version != blob_version ||
+        h.mesh_count != Meshes::MESH_COUNT ||
+        h.vertex_stride != Mesh::vertex_stride() ||
+        h.vertex_size > size_ || h.index_size > size_)
+        return false;
+
+    const BlobLayout layout = get_blob_layout(h.mesh_count, h.vertex_size, h.index_size);
+    if (h.vertex_offset != layout.vertex_offset ||
+        h.index_offset != layout.index_offset ||
+        size_ != layout.size)
+        return false;
+
+    // a damaged file must not draw from outside the buffers
+    const uint64_t vertex_count = h.vertex_size / h.vertex_stride;
+    const uint64_t index_count = h.index_size / sizeof(uint32_t);
+    const uint32_t *indices = static_cast<const uint32_t *>(this->indices());
+    const VkDrawIndexedIndirectCommand *draws = draw_commands();
+    for (uint32_t i = 0; i < h.mesh_count; i++) {
+        const VkDrawIndexedIndirectCommand &draw = draws[i];
+        if (static_cast<uint64_t>(draw.firstIndex) + draw.indexCount > index_count ||
+            draw.vertexOffset < 0)
+            return false;
+
+        for (uint32_t j = 0; j < draw.indexCount; j++) {
+            if (draw.vertexOffset + static_cast<uint64_t>(indices[draw.firstIndex + j]) >= vertex_count)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool MeshBlob::save(const std::string &filename) const
+{
+    if (empty())
+        return false;
+
+    return replace_file(filename, data_, size_);
+}
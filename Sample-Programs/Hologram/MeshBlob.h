@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2016 Google, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MESH_BLOB_H
+#define MESH_BLOB_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// Hologram's meshes laid out the way they are uploaded: a Header, one
+// VkDrawIndexedIndirectCommand and bounding radius per mesh, the interleaved
+// vertices of all meshes and then their 32-bit indices.  Vertices and
+// indices are 16-byte aligned, so a blob saved to a file can be mapped and
+// copied straight into the vertex and index buffers.
+class MeshBlob {
+public:
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t mesh_count;
+        uint32_t vertex_stride;
+        uint64_t vertex_offset;
+        uint64_t vertex_size;
+        uint64_t index_offset;
+        uint64_t index_size;
+    };
+
+    MeshBlob();
+    ~MeshBlob();
+
+    MeshBlob(const MeshBlob &) = delete;
+    MeshBlob &operator=(const MeshBlob &) = delete;
+
+    // builds the meshes procedurally
+    void build();
+
+    // Maps a blob saved earlier.  Returns false and leaves the blob empty
+    // when the file is missing, truncated or from other meshes.
+    bool load(const std::string &filename);
+
+    // writes to a temporary file renamed over filename, so that a blob
+    // being loaded is never seen half written
+    bool save(const std::string &filename) const;
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+
+    const Header &header() const { return *reinterpret_cast<const Header *>(data_); }
+    const VkDrawIndexedIndirectCommand *draw_commands() const;
+    const float *radii() const;
+    const void *vertices() const { return data_ + header().vertex_offset; }
+    const void *indices() const { return data_ + header().index_offset; }
+
+private:
+    void clear();
+    bool validate() const;
+
+    // built blobs live in storage_, loaded ones in a read-only mapping
+    std::vector<uint8_t> storage_;
+    const uint8_t *data_;
+    size_t size_;
+    bool mapped_;
+};
+
+#endif // MESH_BLOB_H
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2016 Google, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "FileUtil.h"
+#include "Helpers.h"
+#include "PipelineCache.h"
+
+namespace {
+
+// VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+struct CacheHeader {
+    uint32_t header_size;
+    uint32_t header_version;
+    uint32_t vendor_id;
+    uint32_t device_id;
+    uint8_t uuid[VK_UUID_SIZE];
+};
+
+} // namespace
+
+PipelineCache::PipelineCache() : dev_(VK_NULL_HANDLE), phy_props_(), cache_(VK_NULL_HANDLE)
+{
+}
+
+PipelineCache::~PipelineCache()
+{
+    destroy();
+}
+
+PipelineCache::LoadResult PipelineCache::create(VkPhysicalDevice phy, VkDevice dev, const std::string &filename)
+{
+    dev_ = dev;
+    vk::GetPhysicalDeviceProperties(phy, &phy_props_);
+    filename_ = filename;
+    loaded_data_.clear();
+
+    LoadResult result = LOAD_NO_FILE;
+    if (!filename_.empty()) {
+        std::vector<uint8_t> data;
+        if (!read_file(data)) {
+            result = LOAD_MISSING;
+        } else if (!header_matches(data)) {
+            result = LOAD_MISMATCH;
+        } else {
+            loaded_data_.swap(data);
+            result = LOAD_OK;
+        }
+    }
+
+    VkPipelineCacheCreateInfo cache_info = {};
+    cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cache_info.initialDataSize = loaded_data_.size();
+    cache_info.pInitialData = loaded_data_.empty() ? nullptr : loaded_data_.data();
+    vk::assert_success(vk::CreatePipelineCache(dev_, &cache_info, nullptr, &cache_));
+
+    return result;
+}
+
+void PipelineCache::destroy()
+{
+    if (cache_ == VK_NULL_HANDLE)
+        return;
+
+    if (!filename_.empty()) {
+        size_t size = 0;
+        std::vector<uint8_t> data;
+        if (vk::GetPipelineCacheData(dev_, cache_, &size, nullptr) == VK_SUCCESS) {
+            data.resize(size);
+            if (vk::GetPipelineCacheData(dev_, cache_, &size, data.data()) != VK_SUCCESS)
+                data.clear();
+            data.resize(size);
+        }
+
+        // nothing new was compiled
+        if (!data.empty() && data != loaded_data_)
+            replace_file(filename_, data.data(), data.size());
+    }
+
+    vk::DestroyPipelineCache(dev_, cache_, nullptr);
+    cache_ = VK_NULL_HANDLE;
+    loaded_data_.clear();
+}
+
+double PipelineCache::create_graphics_pipeline(const VkGraphicsPipelineCreateInfo &info, VkPipeline &pipeline) const
+{
+    auto start = std::chrono::steady_clock::now();
+    vk::assert_success(vk::CreateGraphicsPipelines(dev_, cache_, 1, &info, nullptr, &pipeline));
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count();
+}
+
+bool PipelineCache::read_file(std::vector<uint8_t> &data) const
+{
+    std::FILE *fp = std::fopen(filename_.c_str(), "rb");
+    if (!fp)
+        return false;
+
+    bool ok = std::fseek(fp, 0, SEEK_END) == 0;
+    long size = ok ? std::ftell(fp) : -1;
+    ok = size > 0 && std::fseek(fp, 0, SEEK_SET) == 0;
+    if (ok) {
+        data.resize(size);
+        ok = std::fread(data.data(), 1, data.size(), fp) == data.size();
+    }
+
+    std::fclose(fp);
+
+    return ok;
+}
+
+bool PipelineCache::header_matches(const std::vector<uint8_t> &data) const
+{
+    CacheHeader header;
+    if (data.size() < sizeof(header))
+        return false;
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    return header.header_size >= sizeof(header) &&
+           header.header_size <= data.size() &&
+           header.header_version == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           header.vendor_id == phy_props_.vendorID &&
+           header.device_id == phy_props_.deviceID &&
+           std::memcmp(header.uuid, phy_props_.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
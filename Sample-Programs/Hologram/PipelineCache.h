@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2016 Google, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PIPELINE_CACHE_H
+#define PIPELINE_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// A VkPipelineCache kept in a file between runs.  The file is only used when
+// its header names the device the cache is created on; otherwise the cache
+// starts empty.  The cache is written back, through a temporary file renamed
+// into place, when it is destroyed.
+class PipelineCache {
+public:
+    PipelineCache();
+    ~PipelineCache();
+
+    PipelineCache(const PipelineCache &) = delete;
+    PipelineCache &operator=(const PipelineCache &) = delete;
+
+    enum LoadResult {
+        LOAD_NO_FILE,       // no file name given
+        LOAD_MISSING,       // nothing saved yet
+        LOAD_MISMATCH,      // saved by another driver or device
+        LOAD_OK,
+    };
+
+    // creates the cache, primed from filename when it is not empty
+    LoadResult create(VkPhysicalDevice phy, VkDevice dev, const std::string &filename);
+
+    // writes the cache back unless it is unchanged, and destroys it
+    void destroy();
+
+    VkPipelineCache handle() const { return cache_; }
+    const std::string &filename() const { return filename_; }
+    size_t loaded_size() const { return loaded_data_.size(); }
+
+    // creates a pipeline against the cache and returns the time taken in
+    // milliseconds
+    double create_graphics_pipeline(const VkGraphicsPipelineCreateInfo &info, VkPipeline &pipeline) const;
+
+private:
+    bool read_file(std::vector<uint8_t> &data) const;
+    bool header_matches(const std::vector<uint8_t> &data) const;
+
+    VkDevice dev_;
+    VkPhysicalDeviceProperties phy_props_;
+    std::string filename_;
+    std::vector<uint8_t> loaded_data_;
+    VkPipelineCache cache_;
+};
+
+#endif // PIPELINE_CACHE_H
@@ -32,7 +32,8 @@
 
 Shell::Shell(Game &game)
     : game_(game), settings_(game.settings()), ctx_(),
-      game_tick_(1.0f / settings_.ticks_per_second), game_time_(game_tick_)
+      game_tick_(1.0f / settings_.ticks_per_second), game_time_(game_tick_),
+      start_time_(std::chrono::steady_clock::now()), first_frame_presented_(false)
 {
     // require generic WSI extensions
     instance_extensions_.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
@@ -286,6 +287,7 @@ void Shell::create_context()
     vk::GetDeviceQueue(ctx_.dev, ctx_.game_queue_family, 0, &ctx_.game_queue);
     vk::GetDeviceQueue(ctx_.dev, ctx_.present_queue_family, 0, &ctx_.present_queue);
 
+    create_pipeline_cache();
     create_back_buffers();
 
     // initialize ctx_.{surface,format} before attach_shell
@@ -305,6 +307,9 @@ void Shell::destroy_context()
 
     game_.detach_shell();
 
+    // every pipeline is gone; write back what they added to the cache
+    pipeline_cache_.destroy();
+
     destroy_back_buffers();
 
     ctx_.game_queue = VK_NULL_HANDLE;
@@ -351,6 +356,28 @@ void Shell::create_dev()
     vk::assert_success(vk::CreateDevice(ctx_.physical_dev, &dev_info, nullptr, &ctx_.dev));
 }
 
+void Shell::create_pipeline_cache()
+{
+    const std::string &filename = settings_.pipeline_cache;
+
+    std::stringstream ss;
+    switch (pipeline_cache_.create(ctx_.physical_dev, ctx_.dev, filename)) {
+    case PipelineCache::LOAD_OK:
+        ss << "pipeline cache: loaded " << pipeline_cache_.loaded_size() << " bytes from " << filename;
+        break;
+    case PipelineCache::LOAD_MISSING:
+        ss << "pipeline cache: " << filename << " not found, starting empty";
+        break;
+    case PipelineCache::LOAD_MISMATCH:
+        ss << "pipeline cache: " << filename << " is for another device or driver, starting empty";
+        break;
+    case PipelineCache::LOAD_NO_FILE:
+    default:
+        return;
+    }
+    log(LOG_INFO, ss.str().c_str());
+}
+
 void Shell::create_back_buffers()
 {
     VkSemaphoreCreateInfo sem_info = {};
@@ -560,6 +587,8 @@ void Shell::present_back_buffer()
 
     if (settings_.no_present) {
         fake_present();
+        if (!first_frame_presented_)
+            log_first_frame();
         return;
     }
 
@@ -576,6 +605,21 @@ void Shell::present_back_buffer()
 
     vk::assert_success(vk::QueueSubmit(ctx_.present_queue, 0, nullptr, buf.present_fence));
     ctx_.back_buffers.push(buf);
+
+    if (!first_frame_presented_)
+        log_first_frame();
+}
+
+void Shell::log_first_frame()
+{
+    first_frame_presented_ = true;
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start_time_;
+
+    std::stringstream ss;
+    ss << "first frame presented after " << elapsed.count() << " ms (pipeline cache "
+       << (pipeline_cache_.loaded_size() > 0 ? "warm" : "cold") << ")";
+    log(LOG_INFO, ss.str().c_str());
 }
 
 void Shell::fake_present()
@@ -23,12 +23,14 @@
 #ifndef SHELL_H
 #define SHELL_H
 
+#include <chrono>
 #include <queue>
 #include <vector>
 #include <stdexcept>
 #include <vulkan/vulkan.h>
 
 #include "Game.h"
+#include "PipelineCache.h"
 
 class Game;
 
@@ -72,6 +74,9 @@ public:
     };
     const Context &context() const { return ctx_; }
 
+    // valid while the context is
+    const PipelineCache &pipeline_cache() const { return pipeline_cache_; }
+
     enum LogPriority {
         LOG_DEBUG,
         LOG_INFO,
@@ -145,6 +150,7 @@ private:
 
     // called by create_context
     void create_dev();
+    void create_pipeline_cache();
     void create_back_buffers();
     void destroy_back_buffers();
     virtual VkSurfaceKHR create_surface(VkInstance instance) = 0;
@@ -152,11 +158,16 @@ private:
     void destroy_swapchain();
 
     void fake_present();
+    void log_first_frame();
 
     Context ctx_;
+    PipelineCache pipeline_cache_;
 
     const float game_tick_;
     float game_time_;
+
+    const std::chrono::steady_clock::time_point start_time_;
+    bool first_frame_presented_;
 };
 
 #endif // SHELL_H
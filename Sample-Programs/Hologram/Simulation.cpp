@@ -22,10 +22,19 @@
 
 #include <cassert>
 #include <cmath>
+#include <algorithm>
 #include <array>
-#include <glm/gtc/matrix_transform.hpp>
+#include <limits>
 #include "Simulation.h"
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#define SIMULATION_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMULATION_SSE2
+#endif
+
 namespace {
 
 class MeshPicker {
@@ -96,232 +105,414 @@ private:
     std::uniform_real_distribution<float> blue_;
 };
 
-} // namespace
+enum CurveType {
+    CURVE_RANDOM,
+    CURVE_CIRCLE,
+    CURVE_COUNT,
+};
 
-Animation::Animation(unsigned int rng_seed, float scale)
-    : rng_(rng_seed), dir_(-1.0f, 1.0f), speed_(0.1f, 1.0f)
-{
-    float x = dir_(rng_);
-    float y = dir_(rng_);
-    float z = dir_(rng_);
-    if (std::abs(x) + std::abs(y) + std::abs(z) == 0.0f)
-        x = 1.0f;
+// Lanes wrap a SIMD register, or a single float for the scalar fallback,
+// behind the handful of operations the update kernel needs.  Masks are lanes
+// with all bits set or clear.
+struct ScalarLanes {
+    static const int width = 1;
 
-    current_.axis = glm::normalize(glm::vec3(x, y, z));
+    float v;
 
-    current_.speed = speed_(rng_);
-    current_.scale = scale;
+    static ScalarLanes set(float f) { return { f }; }
+    static ScalarLanes load(const float *p) { return { *p }; }
+    void store(float *p) const { *p = v; }
 
-    current_.matrix = glm::scale(glm::mat4(1.0f), glm::vec3(current_.scale));
-}
+    friend ScalarLanes operator+(ScalarLanes a, ScalarLanes b) { return { a.v + b.v }; }
+    friend ScalarLanes operator-(ScalarLanes a, ScalarLanes b) { return { a.v - b.v }; }
+    friend ScalarLanes operator*(ScalarLanes a, ScalarLanes b) { return { a.v * b.v }; }
 
-glm::mat4 Animation::transformation(float t)
-{
-    current_.matrix = glm::rotate(current_.matrix, current_.speed * t, current_.axis);
+    static ScalarLanes round(ScalarLanes a) { return { std::floor(a.v + 0.5f) }; }
+    static ScalarLanes greater(ScalarLanes a, ScalarLanes b) { return { a.v > b.v ? 1.0f : 0.0f }; }
+    static ScalarLanes either(ScalarLanes a, ScalarLanes b) { return { (a.v != 0.0f || b.v != 0.0f) ? 1.0f : 0.0f }; }
+    static ScalarLanes select(ScalarLanes mask, ScalarLanes a, ScalarLanes b) { return mask.v != 0.0f ? a : b; }
+
+    // m holds the 16 elements of one mat4 per lane, column-major
+    static void store_mat4(glm::mat4 *const *dst, const ScalarLanes (&m)[16])
+    {
+        float *out = &(*dst[0])[0][0];
+        for (int e = 0; e < 16; e++)
+            out[e] = m[e].v;
+    }
+};
 
-    return current_.matrix;
+#if defined(SIMULATION_SSE2) || defined(SIMULATION_AVX)
+
+static inline void store_mat4_sse(glm::mat4 *const *dst, const __m128 (&m)[16])
+{
+    for (int col = 0; col < 4; col++) {
+        __m128 r0 = m[col * 4 + 0];
+        __m128 r1 = m[col * 4 + 1];
+        __m128 r2 = m[col * 4 + 2];
+        __m128 r3 = m[col * 4 + 3];
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        _mm_storeu_ps(&(*dst[0])[col][0], r0);
+        _mm_storeu_ps(&(*dst[1])[col][0], r1);
+        _mm_storeu_ps(&(*dst[2])[col][0], r2);
+        _mm_storeu_ps(&(*dst[3])[col][0], r3);
+    }
 }
 
-class Curve {
-public:
-    virtual ~Curve() {}
-    virtual glm::vec3 evaluate(float t) = 0;
-};
+#endif
 
-namespace {
+#if defined(SIMULATION_SSE2)
 
-enum CurveType {
-    CURVE_RANDOM,
-    CURVE_CIRCLE,
-    CURVE_COUNT,
-};
+struct SimdLanes {
+    static const int width = 4;
 
-class RandomCurve : public Curve {
-public:
-    RandomCurve(unsigned int rng_seed)
-        : rng_(rng_seed), direction_(-0.3f, 0.3f), duration_(1.0f, 5.0f),
-          segment_start_(0.0f), segment_direction_(0.0f),
-          time_start_(0.0f), time_duration_(0.0f)
-    {
-    }
+    __m128 v;
 
-    glm::vec3 evaluate(float t)
-    {
-        if (t >= time_start_ + time_duration_)
-            new_segment(t);
+    static SimdLanes set(float f) { return { _mm_set1_ps(f) }; }
+    static SimdLanes load(const float *p) { return { _mm_loadu_ps(p) }; }
+    void store(float *p) const { _mm_storeu_ps(p, v); }
 
-        pos_ += unit_dir_ * (t - last_);
-        last_ = t;
+    friend SimdLanes operator+(SimdLanes a, SimdLanes b) { return { _mm_add_ps(a.v, b.v) }; }
+    friend SimdLanes operator-(SimdLanes a, SimdLanes b) { return { _mm_sub_ps(a.v, b.v) }; }
+    friend SimdLanes operator*(SimdLanes a, SimdLanes b) { return { _mm_mul_ps(a.v, b.v) }; }
 
-        return pos_;
+    // round to nearest under the default rounding mode
+    static SimdLanes round(SimdLanes a) { return { _mm_cvtepi32_ps(_mm_cvtps_epi32(a.v)) }; }
+    static SimdLanes greater(SimdLanes a, SimdLanes b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+    static SimdLanes either(SimdLanes a, SimdLanes b) { return { _mm_or_ps(a.v, b.v) }; }
+    static SimdLanes select(SimdLanes mask, SimdLanes a, SimdLanes b)
+    {
+        return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) };
     }
 
-private:
-    void new_segment(float time_start)
+    static void store_mat4(glm::mat4 *const *dst, const SimdLanes (&m)[16])
     {
-        segment_start_ += segment_direction_;
-        segment_direction_ = glm::vec3(direction_(rng_),
-                                       direction_(rng_),
-                                       direction_(rng_));
+        __m128 v[16];
+        for (int e = 0; e < 16; e++)
+            v[e] = m[e].v;
+        store_mat4_sse(dst, v);
+    }
+};
 
-        time_start_ = time_start;
-        time_duration_ = duration_(rng_);
+#elif defined(SIMULATION_AVX)
 
-        unit_dir_ = segment_direction_ / time_duration_;
-        pos_ = segment_start_;
-        last_ = time_start_;
-    }
+struct SimdLanes {
+    static const int width = 8;
 
-    std::mt19937 rng_;
-    std::uniform_real_distribution<float> direction_;
-    std::uniform_real_distribution<float> duration_;
+    __m256 v;
 
-    glm::vec3 segment_start_;
-    glm::vec3 segment_direction_;
-    float time_start_;
-    float time_duration_;
+    static SimdLanes set(float f) { return { _mm256_set1_ps(f) }; }
+    static SimdLanes load(const float *p) { return { _mm256_loadu_ps(p) }; }
+    void store(float *p) const { _mm256_storeu_ps(p, v); }
 
-    glm::vec3 unit_dir_;
-    glm::vec3 pos_;
-    float last_;
-};
+    friend SimdLanes operator+(SimdLanes a, SimdLanes b) { return { _mm256_add_ps(a.v, b.v) }; }
+    friend SimdLanes operator-(SimdLanes a, SimdLanes b) { return { _mm256_sub_ps(a.v, b.v) }; }
+    friend SimdLanes operator*(SimdLanes a, SimdLanes b) { return { _mm256_mul_ps(a.v, b.v) }; }
 
-class CircleCurve : public Curve {
-public:
-    CircleCurve(float radius, glm::vec3 axis)
-        : r_(radius)
+    static SimdLanes round(SimdLanes a) { return { _mm256_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC) }; }
+    static SimdLanes greater(SimdLanes a, SimdLanes b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+    static SimdLanes either(SimdLanes a, SimdLanes b) { return { _mm256_or_ps(a.v, b.v) }; }
+    static SimdLanes select(SimdLanes mask, SimdLanes a, SimdLanes b) { return { _mm256_blendv_ps(b.v, a.v, mask.v) }; }
+
+    static void store_mat4(glm::mat4 *const *dst, const SimdLanes (&m)[16])
     {
-        glm::vec3 a;
-
-        if (axis.x != 0.0f) {
-            a.x = -axis.z / axis.x;
-            a.y = 0.0f;
-            a.z = 1.0f;
-        } else if (axis.y != 0.0f) {
-            a.x = 1.0f;
-            a.y = -axis.x / axis.y;
-            a.z = 0.0f;
-        } else {
-            a.x = 1.0f;
-            a.y = 0.0f;
-            a.z = -axis.x / axis.z;
+        __m128 lo[16], hi[16];
+        for (int e = 0; e < 16; e++) {
+            lo[e] = _mm256_castps256_ps128(m[e].v);
+            hi[e] = _mm256_extractf128_ps(m[e].v, 1);
         }
-
-        a_ = glm::normalize(a);
-        b_ = glm::normalize(glm::cross(a_, axis));
+        store_mat4_sse(dst, lo);
+        store_mat4_sse(dst + 4, hi);
     }
+};
 
-    glm::vec3 evaluate(float t)
-    {
-        return (a_ * (glm::vec3(std::cos(t)) - glm::vec3(1.0f)) + b_ * glm::vec3(std::sin(t))) *
-            glm::vec3(r_);
-    }
+#else
 
-private:
-    float r_;
-    glm::vec3 a_;
-    glm::vec3 b_;
-};
+typedef ScalarLanes SimdLanes;
 
-} // namespace
+#endif
+
+const float pi = 3.14159265f;
 
-Path::Path(unsigned int rng_seed)
-    : rng_(rng_seed), type_(0, CURVE_COUNT - 1), duration_(5.0f, 20.0f)
+// x - 2pi * k, the equivalent angle in [-pi, pi]
+template <typename Lanes>
+Lanes wrap_angle(Lanes x)
 {
-    // trigger a subpath generation
-    current_.end = -1.0f;
-    current_.now = 0.0f;
+    return x - Lanes::set(2.0f * pi) * Lanes::round(x * Lanes::set(0.5f / pi));
 }
 
-glm::vec3 Path::position(float t)
+// sin and cos of x in [-pi, pi].  x is folded into [-pi/2, pi/2], where the
+// Taylor series below are accurate to about 1e-7, without any branches so
+// every lane takes the same path.
+template <typename Lanes>
+void sin_cos(Lanes x, Lanes &s, Lanes &c)
+{
+    const Lanes one = Lanes::set(1.0f);
+
+    Lanes above = Lanes::greater(x, Lanes::set(0.5f * pi));
+    Lanes below = Lanes::greater(Lanes::set(-0.5f * pi), x);
+    x = Lanes::select(above, Lanes::set(pi) - x, Lanes::select(below, Lanes::set(-pi) - x, x));
+    Lanes cos_sign = Lanes::select(Lanes::either(above, below), Lanes::set(-1.0f), one);
+
+    Lanes x2 = x * x;
+    s = x * (one + x2 * (Lanes::set(-1.0f / 6.0f) +
+                x2 * (Lanes::set(1.0f / 120.0f) +
+                x2 * (Lanes::set(-1.0f / 5040.0f) +
+                x2 * (Lanes::set(1.0f / 362880.0f) +
+                x2 * Lanes::set(-1.0f / 39916800.0f))))));
+    c = cos_sign * (one + x2 * (Lanes::set(-1.0f / 2.0f) +
+                x2 * (Lanes::set(1.0f / 24.0f) +
+                x2 * (Lanes::set(-1.0f / 720.0f) +
+                x2 * (Lanes::set(1.0f / 40320.0f) +
+                x2 * (Lanes::set(-1.0f / 3628800.0f) +
+                x2 * Lanes::set(1.0f / 479001600.0f)))))));
+}
+
+} // namespace
+
+Simulation::Simulation(int object_count)
+    : random_dev_()
 {
-    current_.now += t;
+    MeshPicker mesh;
+    ColorPicker color(random_dev_());
+
+    objects_.reserve(object_count);
+    rngs_.reserve(object_count);
+    for (auto array : { &axis_x_, &axis_y_, &axis_z_, &speed_, &scale_, &angle_,
+                        &path_now_, &path_start_, &path_end_, &origin_x_, &origin_y_, &origin_z_,
+                        &curve_type_, &c0_x_, &c0_y_, &c0_z_, &c1_x_, &c1_y_, &c1_z_, &curve_t0_, &curve_t1_ })
+        array->resize(object_count);
+
+    for (int i = 0; i < object_count; i++) {
+        Meshes::Type type = mesh.pick();
 
-    while (current_.now >= current_.end)
-        generate_subpath();
+        objects_.emplace_back(Object{
+            type,
+            glm::vec3(0.5 + 0.5 * (float) i / object_count),
+            color.pick(),
+            0,
+            glm::mat4(1.0f),
+        });
 
-    return current_.origin + current_.curve->evaluate(current_.now - current_.start);
+        rngs_.emplace_back(random_dev_());
+        std::minstd_rand &rng = rngs_.back();
+
+        std::uniform_real_distribution<float> dir(-1.0f, 1.0f);
+        float x = dir(rng);
+        float y = dir(rng);
+        float z = dir(rng);
+        if (std::abs(x) + std::abs(y) + std::abs(z) == 0.0f)
+            x = 1.0f;
+        glm::vec3 axis = glm::normalize(glm::vec3(x, y, z));
+
+        axis_x_[i] = axis.x;
+        axis_y_[i] = axis.y;
+        axis_z_[i] = axis.z;
+        speed_[i] = std::uniform_real_distribution<float>(0.1f, 1.0f)(rng);
+        scale_[i] = mesh.scale(type);
+        angle_[i] = 0.0f;
+
+        init_path(i);
+    }
 }
 
-void Path::generate_subpath()
+void Simulation::set_frame_data_size(uint32_t size)
 {
-    float duration = duration_(rng_);
-    CurveType type = static_cast<CurveType>(type_(rng_));
+    uint32_t offset = 0;
+    for (auto &obj : objects_) {
+        obj.frame_data_offset = offset;
+        offset += size;
+    }
+}
 
-    if (current_.curve) {
-        current_.origin += current_.curve->evaluate(current_.end - current_.start);
-        current_.start = current_.end;
+void Simulation::init_path(int i)
+{
+    std::uniform_real_distribution<float> origin(0.0f, 2.0f);
+    origin_x_[i] = origin(rngs_[i]);
+    origin_y_[i] = origin(rngs_[i]);
+    origin_z_[i] = origin(rngs_[i]);
+
+    path_now_[i] = 0.0f;
+    path_start_[i] = 0.0f;
+    path_end_[i] = 0.0f;
+
+    // no curve yet: the first update starts a subpath from the origin
+    curve_type_[i] = CURVE_RANDOM;
+    c0_x_[i] = c0_y_[i] = c0_z_[i] = 0.0f;
+    c1_x_[i] = c1_y_[i] = c1_z_[i] = 0.0f;
+    curve_t0_[i] = 0.0f;
+    curve_t1_[i] = 0.0f;
+}
+
+glm::vec3 Simulation::evaluate_curve(int i, float t) const
+{
+    float f0, f1;
+    if (curve_type_[i] == CURVE_CIRCLE) {
+        f0 = std::cos(t) - 1.0f;
+        f1 = std::sin(t);
     } else {
-        std::uniform_real_distribution<float> origin(0.0f, 2.0f);
-        current_.origin = glm::vec3(origin(rng_), origin(rng_), origin(rng_));
-        current_.start = current_.now;
+        f0 = 1.0f;
+        f1 = t - curve_t0_[i];
     }
 
-    current_.end = current_.start + duration;
+    return glm::vec3(c0_x_[i], c0_y_[i], c0_z_[i]) * f0 +
+           glm::vec3(c1_x_[i], c1_y_[i], c1_z_[i]) * f1;
+}
+
+void Simulation::generate_subpath(int i)
+{
+    std::minstd_rand &rng = rngs_[i];
 
-    Curve *curve;
+    float duration = std::uniform_real_distribution<float>(5.0f, 20.0f)(rng);
+    CurveType type = static_cast<CurveType>(std::uniform_int_distribution<>(0, CURVE_COUNT - 1)(rng));
+
+    // continue from where the previous curve ended
+    glm::vec3 end = evaluate_curve(i, path_end_[i] - path_start_[i]);
+    origin_x_[i] += end.x;
+    origin_y_[i] += end.y;
+    origin_z_[i] += end.z;
+    path_start_[i] = path_end_[i];
+    path_end_[i] = path_start_[i] + duration;
+
+    curve_type_[i] = static_cast<float>(type);
 
     switch (type) {
     case CURVE_RANDOM:
-        curve = new RandomCurve(rng_());
+        c0_x_[i] = c0_y_[i] = c0_z_[i] = 0.0f;
+        c1_x_[i] = c1_y_[i] = c1_z_[i] = 0.0f;
+        curve_t0_[i] = 0.0f;
+        curve_t1_[i] = 0.0f;
+        generate_random_segment(i, 0.0f);
         break;
     case CURVE_CIRCLE:
         {
             std::uniform_real_distribution<float> dir(-1.0f, 1.0f);
-            glm::vec3 axis(dir(rng_), dir(rng_), dir(rng_));
+            glm::vec3 axis(dir(rng), dir(rng), dir(rng));
             if (axis.x == 0.0f && axis.y == 0.0f && axis.z == 0.0f)
                 axis.x = 1.0f;
 
-            std::uniform_real_distribution<float> radius_(0.02f, 0.2f);
-            curve = new CircleCurve(radius_(rng_), axis);
+            float r = std::uniform_real_distribution<float>(0.02f, 0.2f)(rng);
+
+            glm::vec3 a;
+            if (axis.x != 0.0f) {
+                a.x = -axis.z / axis.x;
+                a.y = 0.0f;
+                a.z = 1.0f;
+            } else if (axis.y != 0.0f) {
+                a.x = 1.0f;
+                a.y = -axis.x / axis.y;
+                a.z = 0.0f;
+            } else {
+                a.x = 1.0f;
+                a.y = 0.0f;
+                a.z = -axis.x / axis.z;
+            }
+
+            a = glm::normalize(a);
+            glm::vec3 b = glm::normalize(glm::cross(a, axis));
+
+            c0_x_[i] = a.x * r;
+            c0_y_[i] = a.y * r;
+            c0_z_[i] = a.z * r;
+            c1_x_[i] = b.x * r;
+            c1_y_[i] = b.y * r;
+            c1_z_[i] = b.z * r;
+            curve_t0_[i] = 0.0f;
+            curve_t1_[i] = std::numeric_limits<float>::infinity();
         }
         break;
     default:
         assert(!"unreachable");
-        curve = nullptr;
         break;
     }
-
-    current_.curve.reset(curve);
 }
 
-Simulation::Simulation(int object_count)
-    : random_dev_()
+void Simulation::generate_random_segment(int i, float t)
 {
-    MeshPicker mesh;
-    ColorPicker color(random_dev_());
+    std::minstd_rand &rng = rngs_[i];
+    std::uniform_real_distribution<float> direction(-0.3f, 0.3f);
+
+    // the new segment starts where the previous one ends
+    float elapsed = curve_t1_[i] - curve_t0_[i];
+    c0_x_[i] += c1_x_[i] * elapsed;
+    c0_y_[i] += c1_y_[i] * elapsed;
+    c0_z_[i] += c1_z_[i] * elapsed;
+
+    float duration = std::uniform_real_distribution<float>(1.0f, 5.0f)(rng);
+    c1_x_[i] = direction(rng) / duration;
+    c1_y_[i] = direction(rng) / duration;
+    c1_z_[i] = direction(rng) / duration;
+    curve_t0_[i] = t;
+    curve_t1_[i] = t + duration;
+}
 
-    objects_.reserve(object_count);
-    for (int i = 0; i < object_count; i++) {
-        Meshes::Type type = mesh.pick();
-        float scale = mesh.scale(type);
+// Advances path time and handles the rare subpath and segment changes, the
+// only places the generators are touched
+void Simulation::update_segments(float time, int begin, int end)
+{
+    for (int i = begin; i < end; i++) {
+        path_now_[i] += time;
+        while (path_now_[i] >= path_end_[i])
+            generate_subpath(i);
 
-        objects_.emplace_back(Object{
-            type,
-            glm::vec3(0.5 + 0.5 * (float) i / object_count),
-            color.pick(),
-            Animation(random_dev_(), scale),
-            Path(random_dev_()),
-        });
+        float t = path_now_[i] - path_start_[i];
+        if (t >= curve_t1_[i])
+            generate_random_segment(i, t);
     }
 }
 
-void Simulation::set_frame_data_size(uint32_t size)
+template <typename Lanes>
+void Simulation::update_lanes(float time, int i)
 {
-    uint32_t offset = 0;
-    for (auto &obj : objects_) {
-        obj.frame_data_offset = offset;
-        offset += size;
-    }
+    const Lanes one = Lanes::set(1.0f);
+
+    // rotation about the object's axis, scaled
+    Lanes angle = wrap_angle(Lanes::load(&angle_[i]) + Lanes::load(&speed_[i]) * Lanes::set(time));
+    angle.store(&angle_[i]);
+
+    Lanes s, c;
+    sin_cos(angle, s, c);
+    Lanes k = one - c;
+
+    Lanes x = Lanes::load(&axis_x_[i]);
+    Lanes y = Lanes::load(&axis_y_[i]);
+    Lanes z = Lanes::load(&axis_z_[i]);
+    Lanes scale = Lanes::load(&scale_[i]);
+
+    // position on the curve
+    Lanes t = Lanes::load(&path_now_[i]) - Lanes::load(&path_start_[i]);
+    Lanes circle = Lanes::greater(Lanes::load(&curve_type_[i]), Lanes::set(0.5f));
+    Lanes ts, tc;
+    sin_cos(wrap_angle(t), ts, tc);
+    Lanes f0 = Lanes::select(circle, tc - one, one);
+    Lanes f1 = Lanes::select(circle, ts, t - Lanes::load(&curve_t0_[i]));
+
+    Lanes m[16] = {
+        scale * (c + k * x * x), scale * (k * x * y + s * z), scale * (k * x * z - s * y), Lanes::set(0.0f),
+        scale * (k * y * x - s * z), scale * (c + k * y * y), scale * (k * y * z + s * x), Lanes::set(0.0f),
+        scale * (k * z * x + s * y), scale * (k * z * y - s * x), scale * (c + k * z * z), Lanes::set(0.0f),
+        Lanes::load(&origin_x_[i]) + Lanes::load(&c0_x_[i]) * f0 + Lanes::load(&c1_x_[i]) * f1,
+        Lanes::load(&origin_y_[i]) + Lanes::load(&c0_y_[i]) * f0 + Lanes::load(&c1_y_[i]) * f1,
+        Lanes::load(&origin_z_[i]) + Lanes::load(&c0_z_[i]) * f0 + Lanes::load(&c1_z_[i]) * f1,
+        one,
+    };
+
+    glm::mat4 *dst[Lanes::width];
+    for (int l = 0; l < Lanes::width; l++)
+        dst[l] = &objects_[i + l].model;
+    Lanes::store_mat4(dst, m);
 }
 
 void Simulation::update(float time, int begin, int end)
 {
-    for (int i = begin; i < end; i++) {
-        auto &obj = objects_[i];
+    for (int block = begin; block < end; block += update_block_size) {
+        int block_end = std::min(block + update_block_size, end);
+
+        update_segments(time, block, block_end);
 
-        glm::vec3 pos = obj.path.position(time);
-        glm::mat4 trans = obj.animation.transformation(time);
-        obj.model = glm::translate(glm::mat4(1.0f), pos) * trans;
+        int i = block;
+        for (; i + SimdLanes::width <= block_end; i += SimdLanes::width)
+            update_lanes<SimdLanes>(time, i);
+        for (; i < block_end; i++)
+            update_lanes<ScalarLanes>(time, i);
     }
 }
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2016 Google, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+
+#include "Helpers.h"
+#include "CommandBufferAllocator.h"
+
+CommandBufferAllocator::CommandBufferAllocator()
+    : dev_(VK_NULL_HANDLE), frame_(0), finished_(nullptr),
+      buffer_count_(0), allocation_count_(0), reset_count_(0)
+{
+}
+
+CommandBufferAllocator::~CommandBufferAllocator()
+{
+    destroy();
+}
+
+void CommandBufferAllocator::init(VkDevice dev, uint32_t queue_family, int thread_count, int frame_count)
+{
+    dev_ = dev;
+
+    // recorded once and reset with the whole pool
+    VkCommandPoolCreateInfo cmd_pool_info = {};
+    cmd_pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    cmd_pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    cmd_pool_info.queueFamilyIndex = queue_family;
+
+    threads_ = std::vector<ThreadPools>(thread_count);
+    for (auto &thread : threads_) {
+        thread.frames.resize(frame_count);
+        for (auto &frame : thread.frames) {
+            vk::assert_success(vk::CreateCommandPool(dev_, &cmd_pool_info, nullptr, &frame.pool));
+            frame.used = 0;
+        }
+    }
+
+    frame_ = 0;
+    finished_.store(nullptr, std::memory_order_relaxed);
+}
+
+void CommandBufferAllocator::destroy()
+{
+    // destroying a pool frees its buffers
+    for (auto &thread : threads_) {
+        for (auto &frame : thread.frames)
+            vk::DestroyCommandPool(dev_, frame.pool, nullptr);
+    }
+    threads_.clear();
+}
+
+void CommandBufferAllocator::begin_frame(int frame)
+{
+    frame_ = frame;
+
+    for (auto &thread : threads_) {
+        FramePool &pool = thread.frames[frame_];
+        if (!pool.used)
+            continue;
+
+        vk::assert_success(vk::ResetCommandPool(dev_, pool.pool, 0));
+        pool.used = 0;
+        reset_count_++;
+    }
+}
+
+CommandBufferAllocator::Buffer *CommandBufferAllocator::allocate(int thread)
+{
+    FramePool &pool = threads_[thread].frames[frame_];
+
+    if (pool.used == pool.buffers.size()) {
+        VkCommandBufferAllocateInfo cmd_info = {};
+        cmd_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        cmd_info.commandPool = pool.pool;
+        cmd_info.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        cmd_info.commandBufferCount = 1;
+
+        Buffer buf = {};
+        vk::assert_success(vk::AllocateCommandBuffers(dev_, &cmd_info, &buf.cmd));
+        pool.buffers.push_back(buf);
+
+        allocation_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return &pool.buffers[pool.used++];
+}
+
+void CommandBufferAllocator::finish(Buffer *buf)
+{
+    // push onto the front; the release makes the recording visible to
+    // whoever takes the list
+    Buffer *head = finished_.load(std::memory_order_relaxed);
+    do {
+        buf->next = head;
+    } while (!finished_.compare_exchange_weak(head, buf,
+                std::memory_order_release, std::memory_order_relaxed));
+
+    buffer_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CommandBufferAllocator::take_finished(std::vector<VkCommandBuffer> &cmds)
+{
+    cmds.clear();
+    for (Buffer *buf = finished_.exchange(nullptr, std::memory_order_acquire); buf; buf = buf->next)
+        cmds.push_back(buf->cmd);
+
+    // the list is last in, first out
+    std::reverse(cmds.begin(), cmds.end());
+}
+
+CommandBufferAllocator::Stats CommandBufferAllocator::reset_stats()
+{
+    Stats stats;
+    stats.buffers = buffer_count_.exchange(0, std::memory_order_relaxed);
+    stats.allocations = allocation_count_.exchange(0, std::memory_order_relaxed);
+    stats.pool_resets = reset_count_;
+    reset_count_ = 0;
+
+    return stats;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2016 Google, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef COMMAND_BUFFER_ALLOCATOR_H
+#define COMMAND_BUFFER_ALLOCATOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// Secondary command buffers for the threads recording a frame.  Every
+// thread has a command pool per frame data index, reset as a whole when
+// that frame data is reused, and keeps the buffers it allocated from the
+// pool for the next time round.  A thread can take as many buffers as it
+// likes in a frame and only allocates when it takes more than ever before.
+// Recorded buffers are handed to the submitting thread through a lock-free
+// list.
+class CommandBufferAllocator {
+public:
+    struct Buffer {
+        VkCommandBuffer cmd;
+        // in the list of finished buffers
+        Buffer *next;
+    };
+
+    CommandBufferAllocator();
+    ~CommandBufferAllocator();
+
+    CommandBufferAllocator(const CommandBufferAllocator &) = delete;
+    CommandBufferAllocator &operator=(const CommandBufferAllocator &) = delete;
+
+    void init(VkDevice dev, uint32_t queue_family, int thread_count, int frame_count);
+    void destroy();
+
+    // Resets the pools of frame, whose buffers the GPU must be done with,
+    // and takes buffers from them until the next call.  Not thread-safe.
+    void begin_frame(int frame);
+
+    // a buffer for thread to begin recording; only thread may call this
+    Buffer *allocate(int thread);
+
+    // Hands a recorded buffer to the submitting thread.  Thread-safe and
+    // lock-free.
+    void finish(Buffer *buf);
+
+    // Replaces cmds with the buffers finished since the last call, in the
+    // order they were finished.  Not thread-safe with itself.
+    void take_finished(std::vector<VkCommandBuffer> &cmds);
+
+    struct Stats {
+        uint64_t buffers;
+        uint64_t allocations;
+        uint64_t pool_resets;
+    };
+    // counters since the last call
+    Stats reset_stats();
+
+private:
+    struct FramePool {
+        VkCommandPool pool;
+        // stable addresses, as finished buffers are linked through them
+        std::deque<Buffer> buffers;
+        size_t used;
+    };
+
+    struct alignas(64) ThreadPools {
+        std::vector<FramePool> frames;
+    };
+
+    VkDevice dev_;
+    std::vector<ThreadPools> threads_;
+    int frame_;
+
+    std::atomic<Buffer *> finished_;
+
+    std::atomic<uint64_t> buffer_count_;
+    std::atomic<uint64_t> allocation_count_;
+    uint64_t reset_count_;
+};
+
+#endif // COMMAND_BUFFER_ALLOCATOR_H
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2016 Google, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstdio>
+
+#ifdef _WIN32
+#include <process.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "FileUtil.h"
+
+bool replace_file(const std::string &filename, const void *data, size_t size)
+{
+    // other processes may be writing the same file, each uses its own
+    // temporary
+    char suffix[32];
+#ifdef _WIN32
+    std::snprintf(suffix, sizeof(suffix), ".%d.tmp", _getpid());
+#else
+    std::snprintf(suffix, sizeof(suffix), ".%d.tmp", static_cast<int>(getpid()));
+#endif
+    const std::string tmp_filename = filename + suffix;
+    std::FILE *fp = std::fopen(tmp_filename.c_str(), "wb");
+    if (!fp)
+        return false;
+
+    bool ok = std::fwrite(data, 1, size, fp) == size;
+    ok = std::fclose(fp) == 0 && ok;
+
+    if (ok) {
+#ifdef _WIN32
+        ok = MoveFileExA(tmp_filename.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        ok = std::rename(tmp_filename.c_str(), filename.c_str()) == 0;
+#endif
+    }
+
+    if (!ok)
+        std::remove(tmp_filename.c_str());
+
+    return ok;
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2016 Google, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmath>
+#include "Frustum.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRUSTUM_SSE2
+#endif
+
+Frustum::Frustum()
+{
+    // accept everything
+    for (int i = 0; i < 6; i++) {
+        planes_[0][i] = 0.0f;
+        planes_[1][i] = 0.0f;
+        planes_[2][i] = 0.0f;
+        planes_[3][i] = 1.0f;
+    }
+}
+
+Frustum::Frustum(const glm::mat4 &view_projection)
+{
+    const glm::mat4 &m = view_projection;
+    const glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    const glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    const glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    // -w <= x <= w, -w <= y <= w, and 0 <= z <= w
+    const glm::vec4 planes[6] = {
+        row3 + row0,
+        row3 - row0,
+        row3 + row1,
+        row3 - row1,
+        row2,
+        row3 - row2,
+    };
+
+    for (int i = 0; i < 6; i++) {
+        const glm::vec4 &p = planes[i];
+        const float len = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+        const float scale = (len > 0.0f) ? 1.0f / len : 0.0f;
+
+        for (int c = 0; c < 4; c++)
+            planes_[c][i] = p[c] * scale;
+    }
+}
+
+int Frustum::cull(const float *x, const float *y, const float *z, const float *radius,
+                  int begin, int end, uint32_t *visible) const
+{
+    int count = 0;
+    int i = begin;
+
+#ifdef FRUSTUM_SSE2
+    for (; i + 4 <= end; i += 4) {
+        const __m128 px = _mm_loadu_ps(&x[i]);
+        const __m128 py = _mm_loadu_ps(&y[i]);
+        const __m128 pz = _mm_loadu_ps(&z[i]);
+        const __m128 neg_r = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&radius[i]));
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int p = 0; p < 6; p++) {
+            __m128 dist = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(planes_[0][p])),
+                               _mm_mul_ps(py, _mm_set1_ps(planes_[1][p]))),
+                    _mm_add_ps(_mm_mul_ps(pz, _mm_set1_ps(planes_[2][p])),
+                               _mm_set1_ps(planes_[3][p])));
+            inside = _mm_and_ps(inside, _mm_cmpgt_ps(dist, neg_r));
+        }
+
+        int mask = _mm_movemask_ps(inside);
+        for (int l = 0; mask; l++, mask >>= 1) {
+            if (mask & 1)
+                visible[count++] = i + l;
+        }
+    }
+#endif
+
+    for (; i < end; i++) {
+        bool inside = true;
+        for (int p = 0; p < 6; p++) {
+            float dist = x[i] * planes_[0][p] + y[i] * planes_[1][p] +
+                         z[i] * planes_[2][p] + planes_[3][p];
+            inside = inside && (dist > -radius[i]);
+        }
+
+        if (inside)
+            visible[count++] = i;
+    }
+
+    return count;
+}
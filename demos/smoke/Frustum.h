@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2016 Google, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+class Frustum {
+public:
+    Frustum();
+
+    // the planes bounding the Vulkan clip volume of view_projection
+    explicit Frustum(const glm::mat4 &view_projection);
+
+    // Writes the indices in [begin, end) of the spheres at least partly
+    // inside the frustum to visible, in order, and returns their count.
+    // Spheres are given as arrays of centers and radii.
+    int cull(const float *x, const float *y, const float *z, const float *radius,
+             int begin, int end, uint32_t *visible) const;
+
+private:
+    // plane i is planes_[0..3][i], with normals pointing inside and of
+    // unit length, so dot(n, p) + d is the distance of p from the plane
+    float planes_[4][6];
+};
+
+#endif // FRUSTUM_H
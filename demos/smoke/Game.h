@@ -50,6 +50,14 @@ public:
         bool no_tick;
         bool no_render;
         bool no_present;
+
+        // render offscreen without a window system and exit after
+        // benchmark_frames frames, reporting timings
+        bool headless;
+        int benchmark_frames;
+
+        // where the pipeline cache is kept between runs, if anywhere
+        std::string pipeline_cache;
     };
     const Settings &settings() const { return settings_; }
 
@@ -74,6 +82,25 @@ public:
 
     virtual void on_frame(float frame_pred) {}
 
+    // CPU time spent in the game's own stages of on_frame, for the shell to
+    // report alongside its own.  Times are totals since the last call.
+    struct StageTiming {
+        const char *name;
+        double ms;
+    };
+    virtual void get_stage_timings(std::vector<StageTiming> &timings) {}
+
+    // per-frame averages of the game's own counts, such as draws, since the
+    // last call
+    struct Counter {
+        const char *name;
+        double value;
+    };
+    virtual void get_counters(std::vector<Counter> &counters) {}
+
+    // objects simulated and drawn per frame, for throughput reports
+    virtual int object_count() const { return 0; }
+
 protected:
     Game(const std::string &name, const std::vector<std::string> &args)
         : settings_(), shell_(nullptr)
@@ -94,6 +121,9 @@ protected:
         settings_.no_render = false;
         settings_.no_present = false;
 
+        settings_.headless = false;
+        settings_.benchmark_frames = 0;
+
         parse_args(args);
     }
 
@@ -125,6 +155,13 @@ private:
                 settings_.no_render = true;
             } else if (*it == "-np") {
                 settings_.no_present = true;
+            } else if (*it == "--benchmark") {
+                ++it;
+                settings_.headless = true;
+                settings_.benchmark_frames = std::stoi(*it);
+            } else if (*it == "--pipeline-cache") {
+                ++it;
+                settings_.pipeline_cache = *it;
             }
         }
     }
@@ -37,12 +37,16 @@ Game *create_game(int argc, char **argv)
 
 #if defined(VK_USE_PLATFORM_XCB_KHR)
 
+#include "ShellHeadless.h"
 #include "ShellXcb.h"
 
 int main(int argc, char **argv)
 {
     Game *game = create_game(argc, argv);
-    {
+    if (game->settings().headless) {
+        ShellHeadless shell(*game);
+        shell.run();
+    } else {
         ShellXcb shell(*game);
         shell.run();
     }
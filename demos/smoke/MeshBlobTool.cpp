@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2016 Google, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// Writes Smoke's mesh blob ahead of time, for passing to smoke with
+// --mesh-cache, and reports how long building and loading it take.
+//
+//   smoke-mesh-blob <file> [thread count]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "MeshBlob.h"
+#include "TaskScheduler.h"
+
+namespace {
+
+double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <file> [thread count]\n", argv[0]);
+        return 1;
+    }
+
+    int thread_count = (argc > 2) ? std::atoi(argv[2]) : 0;
+    if (thread_count <= 0)
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    TaskScheduler scheduler(thread_count);
+
+    MeshBlob blob;
+    auto start = std::chrono::steady_clock::now();
+    blob.build(scheduler);
+    double build_ms = elapsed_ms(start);
+
+    start = std::chrono::steady_clock::now();
+    if (!blob.save(argv[1])) {
+        std::fprintf(stderr, "cannot write %s\n", argv[1]);
+        return 1;
+    }
+    double save_ms = elapsed_ms(start);
+
+    MeshBlob loaded;
+    start = std::chrono::steady_clock::now();
+    if (!loaded.load(argv[1])) {
+        std::fprintf(stderr, "cannot load %s back\n", argv[1]);
+        return 1;
+    }
+    double load_ms = elapsed_ms(start);
+
+    std::printf("%zu bytes, %d thread(s): built in %.3f ms, saved in %.3f ms, loaded in %.3f ms\n",
+            blob.size(), thread_count, build_ms, save_ms, load_ms);
+
+    return 0;
+}
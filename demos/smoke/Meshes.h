@@ -26,9 +26,12 @@
 #include <vulkan/vulkan.h>
 #include <vector>
 
+class MeshBlob;
+
 class Meshes {
 public:
-    Meshes(VkDevice dev, const std::vector<VkMemoryPropertyFlags> &mem_flags);
+    // uploads the meshes of blob, which need not outlive the constructor
+    Meshes(VkDevice dev, const std::vector<VkMemoryPropertyFlags> &mem_flags, const MeshBlob &blob);
     ~Meshes();
 
     const VkPipelineVertexInputStateCreateInfo &vertex_input_state() const { return vertex_input_state_; }
@@ -42,8 +45,12 @@ public:
         MESH_COUNT,
     };
 
+    // bounding sphere radius in model space
+    float radius(Type type) const { return radii_[type]; }
+
     void cmd_bind_buffers(VkCommandBuffer cmd) const;
     void cmd_draw(VkCommandBuffer cmd, Type type) const;
+    void cmd_draw(VkCommandBuffer cmd, Type type, uint32_t instance_count, uint32_t first_instance) const;
 
 private:
     void allocate_resources(VkDeviceSize vb_size, VkDeviceSize ib_size, const std::vector<VkMemoryPropertyFlags> &mem_flags);
@@ -57,6 +64,7 @@ private:
     VkIndexType index_type_;
 
     std::vector<VkDrawIndexedIndirectCommand> draw_commands_;
+    std::vector<float> radii_;
 
     VkBuffer vb_;
     VkBuffer ib_;
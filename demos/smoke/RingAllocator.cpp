@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2016 Google, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cassert>
+
+#include "RingAllocator.h"
+
+RingAllocator::RingAllocator()
+    : base_(nullptr), size_(0), alignment_(1), current_(-1),
+      window_begin_(0), window_end_(0), cursor_(0)
+{
+}
+
+void RingAllocator::init(uint8_t *base, uint64_t size, uint64_t alignment, int frame_count)
+{
+    assert(alignment && !(alignment & (alignment - 1)));
+
+    base_ = base;
+    alignment_ = alignment;
+    // keep the end aligned so that windows starting at 0 or at the end of
+    // another stay aligned
+    size_ = size & ~(alignment - 1);
+
+    frames_.assign(frame_count, FrameWindow());
+    current_ = -1;
+
+    window_begin_ = 0;
+    window_end_ = 0;
+    cursor_.store(0, std::memory_order_relaxed);
+}
+
+void RingAllocator::begin_frame(int frame, uint64_t min_size)
+{
+    // the next window starts where the last one stopped
+    const uint64_t last_end = window_begin_ + frame_bytes();
+    if (current_ >= 0)
+        frames_[current_].end = last_end;
+    const uint64_t head = (last_end == size_) ? 0 : last_end;
+
+    frames_[frame].in_use = false;
+
+    // Windows are taken in ring order, so the used part of the ring runs
+    // from the oldest window still in use up to head and the free part
+    // from head to the first window that begins after it.
+    uint64_t free_size = size_;
+    for (const auto &f : frames_) {
+        if (!f.in_use || f.begin == f.end)
+            continue;
+
+        const uint64_t distance = (f.begin >= head) ? f.begin - head : f.begin + size_ - head;
+        if (distance < free_size)
+            free_size = distance;
+    }
+
+    // The free part may wrap around.  Stay at head unless that leaves less
+    // than min_size before the end of the ring, and then start over from
+    // the beginning if there is more room there.
+    if (head + free_size <= size_) {
+        window_begin_ = head;
+        window_end_ = head + free_size;
+    } else {
+        const uint64_t before_end = size_ - head;
+        const uint64_t after_wrap = free_size - before_end;
+        if (before_end >= min_size || before_end >= after_wrap) {
+            window_begin_ = head;
+            window_end_ = size_;
+        } else {
+            window_begin_ = 0;
+            window_end_ = after_wrap;
+        }
+    }
+
+    frames_[frame].in_use = true;
+    frames_[frame].begin = window_begin_;
+    frames_[frame].end = window_end_;
+    current_ = frame;
+
+    cursor_.store(window_begin_, std::memory_order_relaxed);
+}
+
+bool RingAllocator::allocate(uint64_t size, uint64_t *offset)
+{
+    size = align(size);
+
+    const uint64_t begin = cursor_.fetch_add(size, std::memory_order_relaxed);
+    if (begin + size > window_end_)
+        return false;
+
+    *offset = begin;
+    return true;
+}
+
+uint64_t RingAllocator::frame_bytes() const
+{
+    return std::min(cursor_.load(std::memory_order_relaxed), window_end_) - window_begin_;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2016 Google, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef RING_ALLOCATOR_H
+#define RING_ALLOCATOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// A linear allocator over a persistently mapped buffer for data that lives
+// for one frame.  Frames take consecutive windows of the buffer, wrapping
+// around at its end, and a frame's allocations are released all at once
+// when the frame index is begun again, by which time the caller must have
+// waited for the GPU to be done with them.
+class RingAllocator {
+public:
+    RingAllocator();
+
+    RingAllocator(const RingAllocator &) = delete;
+    RingAllocator &operator=(const RingAllocator &) = delete;
+
+    // Manages size bytes at base.  Allocations are aligned to alignment,
+    // which must be a power of two.
+    void init(uint8_t *base, uint64_t size, uint64_t alignment, int frame_count);
+
+    // Releases what frame allocated the last time it began and starts
+    // allocating for it from the free part of the ring.  The window is kept
+    // contiguous, so min_size, the most the frame is expected to need,
+    // decides whether to skip what is left before the end of the ring.
+    // With every frame needing at most min_size, a ring of
+    // (frame_count + 2) * min_size bytes never runs out.  Not thread-safe
+    // with itself or allocate.
+    void begin_frame(int frame, uint64_t min_size);
+
+    // Thread-safe and lock-free.  Returns false when the frame's window has
+    // no room left.
+    bool allocate(uint64_t size, uint64_t *offset);
+
+    uint8_t *data(uint64_t offset) const { return base_ + offset; }
+
+    // bytes allocated by the current frame, padding included
+    uint64_t frame_bytes() const;
+
+private:
+    uint64_t align(uint64_t size) const { return (size + alignment_ - 1) & ~(alignment_ - 1); }
+
+    uint8_t *base_;
+    uint64_t size_;
+    uint64_t alignment_;
+
+    // what each frame allocated, while the GPU may be using it
+    struct FrameWindow {
+        bool in_use;
+        uint64_t begin;
+        uint64_t end;
+    };
+    std::vector<FrameWindow> frames_;
+    int current_;
+
+    uint64_t window_begin_;
+    uint64_t window_end_;
+    std::atomic<uint64_t> cursor_;
+};
+
+#endif // RING_ALLOCATOR_H
@@ -32,11 +32,15 @@
 
 Shell::Shell(Game &game)
     : game_(game), settings_(game.settings()), ctx_(),
-      game_tick_(1.0f / settings_.ticks_per_second), game_time_(game_tick_)
+      next_offscreen_image_(0), game_tick_(1.0f / settings_.ticks_per_second), game_time_(game_tick_),
+      start_time_(std::chrono::steady_clock::now()), first_frame_ms_(-1.0), first_frame_cache_warm_(false),
+      stage_timings_()
 {
     // require generic WSI extensions
-    instance_extensions_.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
-    device_extensions_.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    if (!settings_.headless) {
+        instance_extensions_.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+        device_extensions_.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
 
     // require "standard" validation layers
     if (settings_.validate) {
@@ -274,6 +278,7 @@ void Shell::create_context()
     vk::GetDeviceQueue(ctx_.dev, ctx_.game_queue_family, 0, &ctx_.game_queue);
     vk::GetDeviceQueue(ctx_.dev, ctx_.present_queue_family, 0, &ctx_.present_queue);
 
+    create_pipeline_cache();
     create_back_buffers();
 
     // initialize ctx_.{surface,format} before attach_shell
@@ -293,6 +298,9 @@ void Shell::destroy_context()
 
     game_.detach_shell();
 
+    // every pipeline is gone; write back what they added to the cache
+    pipeline_cache_.destroy();
+
     destroy_back_buffers();
 
     ctx_.game_queue = VK_NULL_HANDLE;
@@ -339,6 +347,28 @@ void Shell::create_dev()
     vk::assert_success(vk::CreateDevice(ctx_.physical_dev, &dev_info, nullptr, &ctx_.dev));
 }
 
+void Shell::create_pipeline_cache()
+{
+    const std::string &filename = settings_.pipeline_cache;
+
+    std::stringstream ss;
+    switch (pipeline_cache_.create(ctx_.physical_dev, ctx_.dev, filename)) {
+    case PipelineCache::LOAD_OK:
+        ss << "pipeline cache: loaded " << pipeline_cache_.loaded_size() << " bytes from " << filename;
+        break;
+    case PipelineCache::LOAD_MISSING:
+        ss << "pipeline cache: " << filename << " not found, starting empty";
+        break;
+    case PipelineCache::LOAD_MISMATCH:
+        ss << "pipeline cache: " << filename << " is for another device or driver, starting empty";
+        break;
+    case PipelineCache::LOAD_NO_FILE:
+    default:
+        return;
+    }
+    log(LOG_INFO, ss.str().c_str());
+}
+
 void Shell::create_back_buffers()
 {
     VkSemaphoreCreateInfo sem_info = {};
@@ -378,6 +408,19 @@ void Shell::destroy_back_buffers()
 
 void Shell::create_swapchain()
 {
+    if (settings_.headless) {
+        // render to images of our own, in a format every implementation
+        // supports as a color attachment
+        ctx_.surface = VK_NULL_HANDLE;
+        ctx_.format.format = VK_FORMAT_B8G8R8A8_UNORM;
+        ctx_.format.colorSpace = VK_COLORSPACE_SRGB_NONLINEAR_KHR;
+
+        ctx_.swapchain = VK_NULL_HANDLE;
+        ctx_.extent.width = (uint32_t) -1;
+        ctx_.extent.height = (uint32_t) -1;
+        return;
+    }
+
     ctx_.surface = create_surface(ctx_.instance);
 
     VkBool32 supported;
@@ -398,11 +441,20 @@ void Shell::create_swapchain()
 
 void Shell::destroy_swapchain()
 {
+    if (settings_.headless) {
+        if (!ctx_.images.empty()) {
+            game_.detach_swapchain();
+            destroy_offscreen_images();
+        }
+        return;
+    }
+
     if (ctx_.swapchain != VK_NULL_HANDLE) {
         game_.detach_swapchain();
 
         vk::DestroySwapchainKHR(ctx_.dev, ctx_.swapchain, nullptr);
         ctx_.swapchain = VK_NULL_HANDLE;
+        ctx_.images.clear();
     }
 
     vk::DestroySurfaceKHR(ctx_.instance, ctx_.surface, nullptr);
@@ -411,6 +463,25 @@ void Shell::destroy_swapchain()
 
 void Shell::resize_swapchain(uint32_t width_hint, uint32_t height_hint)
 {
+    if (settings_.headless) {
+        VkExtent2D extent = { width_hint, height_hint };
+        if (ctx_.extent.width == extent.width && ctx_.extent.height == extent.height)
+            return;
+
+        if (!ctx_.images.empty()) {
+            game_.detach_swapchain();
+
+            vk::DeviceWaitIdle(ctx_.dev);
+            destroy_offscreen_images();
+        }
+
+        create_offscreen_images(extent);
+        ctx_.extent = extent;
+
+        game_.attach_swapchain();
+        return;
+    }
+
     VkSurfaceCapabilitiesKHR caps;
     vk::assert_success(vk::GetPhysicalDeviceSurfaceCapabilitiesKHR(ctx_.physical_dev,
                 ctx_.surface, &caps));
@@ -491,6 +562,7 @@ void Shell::resize_swapchain(uint32_t width_hint, uint32_t height_hint)
 
     vk::assert_success(vk::CreateSwapchainKHR(ctx_.dev, &swapchain_info, nullptr, &ctx_.swapchain));
     ctx_.extent = extent;
+    vk::get(ctx_.dev, ctx_.swapchain, ctx_.images);
 
     // destroy the old swapchain
     if (swapchain_info.oldSwapchain != VK_NULL_HANDLE) {
@@ -503,6 +575,94 @@ void Shell::resize_swapchain(uint32_t width_hint, uint32_t height_hint)
     game_.attach_swapchain();
 }
 
+void Shell::create_offscreen_images(const VkExtent2D &extent)
+{
+    VkPhysicalDeviceMemoryProperties mem_props;
+    vk::GetPhysicalDeviceMemoryProperties(ctx_.physical_dev, &mem_props);
+
+    VkImageCreateInfo image_info = {};
+    image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.format = ctx_.format.format;
+    image_info.extent.width = extent.width;
+    image_info.extent.height = extent.height;
+    image_info.extent.depth = 1;
+    image_info.mipLevels = 1;
+    image_info.arrayLayers = 1;
+    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    const int count = (settings_.back_buffer_count > 1) ? settings_.back_buffer_count : 1;
+    for (int i = 0; i < count; i++) {
+        VkImage img;
+        vk::assert_success(vk::CreateImage(ctx_.dev, &image_info, nullptr, &img));
+
+        VkMemoryRequirements mem_reqs;
+        vk::GetImageMemoryRequirements(ctx_.dev, img, &mem_reqs);
+
+        // prefer device local memory, but take any type the image allows
+        uint32_t mem_type = UINT32_MAX;
+        for (uint32_t t = 0; t < mem_props.memoryTypeCount; t++) {
+            if (!(mem_reqs.memoryTypeBits & (1u << t)))
+                continue;
+
+            if (mem_type == UINT32_MAX ||
+                (mem_props.memoryTypes[t].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
+                mem_type = t;
+                if (mem_props.memoryTypes[t].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+                    break;
+            }
+        }
+        if (mem_type == UINT32_MAX)
+            throw std::runtime_error("failed to find a memory type for offscreen images");
+
+        VkMemoryAllocateInfo mem_info = {};
+        mem_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        mem_info.allocationSize = mem_reqs.size;
+        mem_info.memoryTypeIndex = mem_type;
+
+        VkDeviceMemory mem;
+        vk::assert_success(vk::AllocateMemory(ctx_.dev, &mem_info, nullptr, &mem));
+        vk::assert_success(vk::BindImageMemory(ctx_.dev, img, mem, 0));
+
+        ctx_.images.push_back(img);
+        offscreen_mems_.push_back(mem);
+    }
+
+    next_offscreen_image_ = 0;
+}
+
+void Shell::destroy_offscreen_images()
+{
+    for (auto img : ctx_.images)
+        vk::DestroyImage(ctx_.dev, img, nullptr);
+    for (auto mem : offscreen_mems_)
+        vk::FreeMemory(ctx_.dev, mem, nullptr);
+
+    ctx_.images.clear();
+    offscreen_mems_.clear();
+}
+
+void Shell::signal_semaphore(VkSemaphore wait, VkSemaphore signal, VkFence fence)
+{
+    VkPipelineStageFlags stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    if (wait != VK_NULL_HANDLE) {
+        submit_info.waitSemaphoreCount = 1;
+        submit_info.pWaitSemaphores = &wait;
+        submit_info.pWaitDstStageMask = &stage;
+    }
+    if (signal != VK_NULL_HANDLE) {
+        submit_info.signalSemaphoreCount = 1;
+        submit_info.pSignalSemaphores = &signal;
+    }
+    vk::assert_success(vk::QueueSubmit(ctx_.game_queue, 1, &submit_info, fence));
+}
+
 void Shell::add_game_time(float time)
 {
     int max_ticks = 3;
@@ -510,10 +670,14 @@ void Shell::add_game_time(float time)
     if (!settings_.no_tick)
         game_time_ += time;
 
+    auto start = std::chrono::steady_clock::now();
+
     while (game_time_ >= game_tick_ && max_ticks--) {
         game_.on_tick();
         game_time_ -= game_tick_;
     }
+
+    stage_timings_.tick += std::chrono::steady_clock::now() - start;
 }
 
 void Shell::acquire_back_buffer()
@@ -523,6 +687,8 @@ void Shell::acquire_back_buffer()
         ctx_.acquired_back_buffer.acquire_semaphore != VK_NULL_HANDLE)
         return;
 
+    auto start = std::chrono::steady_clock::now();
+
     auto &buf = ctx_.back_buffers.front();
 
     // wait until acquire and render semaphores are waited/unsignaled
@@ -531,39 +697,127 @@ void Shell::acquire_back_buffer()
     // reset the fence
     vk::assert_success(vk::ResetFences(ctx_.dev, 1, &buf.present_fence));
 
-    vk::assert_success(vk::AcquireNextImageKHR(ctx_.dev, ctx_.swapchain,
-                UINT64_MAX, buf.acquire_semaphore, VK_NULL_HANDLE,
-                &buf.image_index));
+    if (settings_.headless) {
+        // the images are ours; cycle through them and signal the semaphore
+        // in place of the presentation engine
+        signal_semaphore(VK_NULL_HANDLE, buf.acquire_semaphore, VK_NULL_HANDLE);
+
+        buf.image_index = next_offscreen_image_;
+        next_offscreen_image_ = (next_offscreen_image_ + 1) % static_cast<uint32_t>(ctx_.images.size());
+    } else {
+        vk::assert_success(vk::AcquireNextImageKHR(ctx_.dev, ctx_.swapchain,
+                    UINT64_MAX, buf.acquire_semaphore, VK_NULL_HANDLE,
+                    &buf.image_index));
+    }
 
     ctx_.acquired_back_buffer = buf;
     ctx_.back_buffers.pop();
+
+    stage_timings_.acquire += std::chrono::steady_clock::now() - start;
 }
 
 void Shell::present_back_buffer()
 {
     const auto &buf = ctx_.acquired_back_buffer;
 
+    auto start = std::chrono::steady_clock::now();
+
     if (!settings_.no_render)
         game_.on_frame(game_time_ / game_tick_);
 
+    auto frame_end = std::chrono::steady_clock::now();
+    stage_timings_.frame += frame_end - start;
+    stage_timings_.frames++;
+
     if (settings_.no_present) {
         fake_present();
+        stage_timings_.present += std::chrono::steady_clock::now() - frame_end;
+        if (first_frame_ms_ < 0.0)
+            log_first_frame();
         return;
     }
 
-    VkPresentInfoKHR present_info = {};
-    present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-    present_info.waitSemaphoreCount = 1;
-    present_info.pWaitSemaphores = (settings_.no_render) ?
-        &buf.acquire_semaphore : &buf.render_semaphore;
-    present_info.swapchainCount = 1;
-    present_info.pSwapchains = &ctx_.swapchain;
-    present_info.pImageIndices = &buf.image_index;
+    if (settings_.headless) {
+        // nothing to show the image on; just wait for rendering
+        signal_semaphore((settings_.no_render) ? buf.acquire_semaphore : buf.render_semaphore,
+                VK_NULL_HANDLE, buf.present_fence);
+    } else {
+        VkPresentInfoKHR present_info = {};
+        present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        present_info.waitSemaphoreCount = 1;
+        present_info.pWaitSemaphores = (settings_.no_render) ?
+            &buf.acquire_semaphore : &buf.render_semaphore;
+        present_info.swapchainCount = 1;
+        present_info.pSwapchains = &ctx_.swapchain;
+        present_info.pImageIndices = &buf.image_index;
+
+        vk::assert_success(vk::QueuePresentKHR(ctx_.present_queue, &present_info));
+
+        vk::assert_success(vk::QueueSubmit(ctx_.present_queue, 0, nullptr, buf.present_fence));
+    }
+    ctx_.back_buffers.push(buf);
 
-    vk::assert_success(vk::QueuePresentKHR(ctx_.present_queue, &present_info));
+    stage_timings_.present += std::chrono::steady_clock::now() - frame_end;
 
-    vk::assert_success(vk::QueueSubmit(ctx_.present_queue, 0, nullptr, buf.present_fence));
-    ctx_.back_buffers.push(buf);
+    if (first_frame_ms_ < 0.0)
+        log_first_frame();
+}
+
+void Shell::log_first_frame()
+{
+    first_frame_ms_ = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start_time_).count();
+    first_frame_cache_warm_ = pipeline_cache_.loaded_size() > 0;
+
+    std::stringstream ss;
+    ss << "first frame presented after " << first_frame_ms_ << " ms (pipeline cache "
+       << (first_frame_cache_warm_ ? "warm" : "cold") << ")";
+    log(LOG_INFO, ss.str().c_str());
+}
+
+int Shell::collect_stage_timings(std::vector<Game::StageTiming> &timings)
+{
+    typedef std::chrono::duration<double, std::milli> ms;
+
+    const int frames = stage_timings_.frames;
+
+    timings.push_back({ "acquire", ms(stage_timings_.acquire).count() });
+    timings.push_back({ "tick", ms(stage_timings_.tick).count() });
+    timings.push_back({ "frame", ms(stage_timings_.frame).count() });
+    timings.push_back({ "present", ms(stage_timings_.present).count() });
+    game_.get_stage_timings(timings);
+
+    stage_timings_ = StageTimings();
+
+    return frames;
+}
+
+void Shell::log_stage_timings()
+{
+    if (!stage_timings_.frames)
+        return;
+
+    collected_timings_.clear();
+    const double frames = collect_stage_timings(collected_timings_);
+
+    // the shell's stages come first, the game's are part of its frame
+    const auto &t = collected_timings_;
+    std::stringstream ss;
+    ss.precision(3);
+    ss << "ms/frame: acquire " << t[0].ms / frames <<
+          ", tick " << t[1].ms / frames <<
+          ", frame " << t[2].ms / frames;
+    if (t.size() > 4) {
+        ss << " (";
+        for (size_t i = 4; i < t.size(); i++) {
+            if (i > 4)
+                ss << ", ";
+            ss << t[i].name << " " << t[i].ms / frames;
+        }
+        ss << ")";
+    }
+    ss << ", present " << t[3].ms / frames;
+    log(LOG_INFO, ss.str().c_str());
 }
 
 void Shell::fake_present()
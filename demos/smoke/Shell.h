@@ -23,12 +23,14 @@
 #ifndef SHELL_H
 #define SHELL_H
 
+#include <chrono>
 #include <queue>
 #include <vector>
 #include <stdexcept>
 #include <vulkan/vulkan.h>
 
 #include "Game.h"
+#include "PipelineCache.h"
 
 class Game;
 
@@ -67,11 +69,16 @@ public:
 
         VkSwapchainKHR swapchain;
         VkExtent2D extent;
+        // swapchain images, or the shell's own images when headless
+        std::vector<VkImage> images;
 
         BackBuffer acquired_back_buffer;
     };
     const Context &context() const { return ctx_; }
 
+    // valid while the context is
+    const PipelineCache &pipeline_cache() const { return pipeline_cache_; }
+
     enum LogPriority {
         LOG_DEBUG,
         LOG_INFO,
@@ -99,6 +106,21 @@ protected:
     void acquire_back_buffer();
     void present_back_buffer();
 
+    // logs the average CPU time of each stage of the frames since the last
+    // call, including the game's stages
+    void log_stage_timings();
+
+    // appends the total CPU time of each stage of the frames since the last
+    // call, the shell's stages followed by the game's, and returns the
+    // number of frames
+    int collect_stage_timings(std::vector<Game::StageTiming> &timings);
+
+    // milliseconds from the shell's construction to the first frame being
+    // presented, or negative before then, and whether the pipeline cache
+    // was primed from disk for it
+    double first_frame_ms() const { return first_frame_ms_; }
+    bool first_frame_cache_warm() const { return first_frame_cache_warm_; }
+
     Game &game_;
     const Game::Settings &settings_;
 
@@ -145,18 +167,44 @@ private:
 
     // called by create_context
     void create_dev();
+    void create_pipeline_cache();
     void create_back_buffers();
     void destroy_back_buffers();
     virtual VkSurfaceKHR create_surface(VkInstance instance) = 0;
     void create_swapchain();
     void destroy_swapchain();
 
+    // stand-ins for the swapchain when headless
+    void create_offscreen_images(const VkExtent2D &extent);
+    void destroy_offscreen_images();
+    void signal_semaphore(VkSemaphore wait, VkSemaphore signal, VkFence fence);
+
     void fake_present();
+    void log_first_frame();
 
     Context ctx_;
+    PipelineCache pipeline_cache_;
+
+    std::vector<VkDeviceMemory> offscreen_mems_;
+    uint32_t next_offscreen_image_;
 
     const float game_tick_;
     float game_time_;
+
+    const std::chrono::steady_clock::time_point start_time_;
+    double first_frame_ms_;
+    bool first_frame_cache_warm_;
+
+    // CPU time of the frame loop stages since log_stage_timings
+    struct StageTimings {
+        int frames;
+        std::chrono::steady_clock::duration acquire;
+        std::chrono::steady_clock::duration tick;
+        std::chrono::steady_clock::duration frame;
+        std::chrono::steady_clock::duration present;
+    };
+    StageTimings stage_timings_;
+    std::vector<Game::StageTiming> collected_timings_;
 };
 
 #endif // SHELL_H
@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2016 Google, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <dlfcn.h>
+
+#include "Helpers.h"
+#include "Game.h"
+#include "ShellHeadless.h"
+
+namespace {
+
+// frames run before measuring, to get past first-use costs
+const int warmup_frames = 10;
+
+struct StageSummary {
+    double min;
+    double avg;
+    double p99;
+};
+
+StageSummary summarize(std::vector<double> &samples)
+{
+    StageSummary summary = {};
+    if (samples.empty())
+        return summary;
+
+    std::sort(samples.begin(), samples.end());
+
+    double sum = 0.0;
+    for (auto s : samples)
+        sum += s;
+
+    // nearest rank
+    size_t rank = (samples.size() * 99 + 99) / 100;
+
+    summary.min = samples.front();
+    summary.avg = sum / samples.size();
+    summary.p99 = samples[rank - 1];
+
+    return summary;
+}
+
+} // namespace
+
+ShellHeadless::ShellHeadless(Game &game) : Shell(game), lib_handle_(nullptr), quit_(false)
+{
+    init_vk();
+}
+
+ShellHeadless::~ShellHeadless()
+{
+    cleanup_vk();
+    dlclose(lib_handle_);
+}
+
+void ShellHeadless::log(LogPriority priority, const char *msg)
+{
+    // keep stdout for the report
+    std::cerr << msg << "\n";
+}
+
+PFN_vkGetInstanceProcAddr ShellHeadless::load_vk()
+{
+    const char filename[] = "libvulkan.so";
+    void *handle, *symbol;
+
+#ifdef UNINSTALLED_LOADER
+    handle = dlopen(UNINSTALLED_LOADER, RTLD_LAZY);
+    if (!handle)
+        handle = dlopen(filename, RTLD_LAZY);
+#else
+    handle = dlopen(filename, RTLD_LAZY);
+#endif
+
+    if (handle)
+        symbol = dlsym(handle, "vkGetInstanceProcAddr");
+
+    if (!handle || !symbol) {
+        std::stringstream ss;
+        ss << "failed to load " << dlerror();
+
+        if (handle)
+            dlclose(handle);
+
+        throw std::runtime_error(ss.str());
+    }
+
+    lib_handle_ = handle;
+
+    return reinterpret_cast<PFN_vkGetInstanceProcAddr>(symbol);
+}
+
+void ShellHeadless::run()
+{
+    create_context();
+    resize_swapchain(settings_.initial_width, settings_.initial_height);
+
+    // advance the game by exactly one tick per frame so that every run
+    // simulates the same frames regardless of how fast they are
+    const float frame_time = 1.0f / settings_.ticks_per_second;
+
+    std::vector<Game::StageTiming> timings;
+    std::vector<Game::Counter> counters;
+
+    for (int i = 0; i < warmup_frames && !quit_; i++) {
+        acquire_back_buffer();
+        add_game_time(frame_time);
+        present_back_buffer();
+    }
+    collect_stage_timings(timings);
+    game_.get_counters(counters);
+
+    stage_names_.clear();
+    stage_samples_.clear();
+
+    int frames = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    while (frames < settings_.benchmark_frames && !quit_) {
+        acquire_back_buffer();
+        add_game_time(frame_time);
+        present_back_buffer();
+        frames++;
+
+        timings.clear();
+        collect_stage_timings(timings);
+
+        if (stage_names_.empty()) {
+            for (const auto &t : timings)
+                stage_names_.push_back(t.name);
+            stage_samples_.resize(timings.size());
+        }
+        for (size_t i = 0; i < timings.size() && i < stage_samples_.size(); i++)
+            stage_samples_[i].push_back(timings[i].ms);
+    }
+
+    vk::DeviceWaitIdle(context().dev);
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    counters.clear();
+    game_.get_counters(counters);
+
+    report(frames, elapsed.count(), counters);
+
+    destroy_context();
+}
+
+void ShellHeadless::report(int frames, double seconds, const std::vector<Game::Counter> &counters)
+{
+    const int objects = game_.object_count();
+    const double per_second = (seconds > 0.0) ? frames / seconds : 0.0;
+
+    std::stringstream ss;
+    ss << "{\n";
+    ss << "  \"name\": \"" << settings_.name << "\",\n";
+    ss << "  \"frames\": " << frames << ",\n";
+    ss << "  \"objects\": " << objects << ",\n";
+    ss << "  \"seconds\": " << seconds << ",\n";
+    ss << "  \"frames_per_second\": " << per_second << ",\n";
+    ss << "  \"objects_per_second\": " << per_second * objects << ",\n";
+    ss << "  \"first_frame_ms\": " << first_frame_ms() << ",\n";
+    ss << "  \"pipeline_cache\": \"" << (first_frame_cache_warm() ? "warm" : "cold") << "\",\n";
+    ss << "  \"stages_ms\": {";
+    for (size_t i = 0; i < stage_names_.size(); i++) {
+        const StageSummary summary = summarize(stage_samples_[i]);
+
+        ss << (i ? ",\n" : "\n");
+        ss << "    \"" << stage_names_[i] << "\": { " <<
+              "\"min\": " << summary.min << ", " <<
+              "\"avg\": " << summary.avg << ", " <<
+              "\"p99\": " << summary.p99 << " }";
+    }
+    ss << "\n  },\n";
+    ss << "  \"per_frame\": {";
+    for (size_t i = 0; i < counters.size(); i++) {
+        ss << (i ? ",\n" : "\n");
+        ss << "    \"" << counters[i].name << "\": " << counters[i].value;
+    }
+    ss << "\n  }\n";
+    ss << "}\n";
+
+    std::cout << ss.str();
+    std::cout.flush();
+}
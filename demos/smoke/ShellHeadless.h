@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2016 Google, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef SHELL_HEADLESS_H
+#define SHELL_HEADLESS_H
+
+#include "Shell.h"
+
+// Runs a fixed number of frames without a window system and reports the
+// CPU time of each stage and the game's counters as JSON on stdout.  Rendering goes to offscreen
+// images, so any ICD will do, including one without WSI support.
+class ShellHeadless : public Shell {
+public:
+    ShellHeadless(Game &game);
+    ~ShellHeadless();
+
+    void log(LogPriority priority, const char *msg);
+
+    void run();
+    void quit() { quit_ = true; }
+
+private:
+    PFN_vkGetInstanceProcAddr load_vk();
+    bool can_present(VkPhysicalDevice phy, uint32_t queue_family) { return true; }
+
+    VkSurfaceKHR create_surface(VkInstance instance) { return VK_NULL_HANDLE; }
+
+    void report(int frames, double seconds, const std::vector<Game::Counter> &counters);
+
+    // per-frame samples of each stage, in milliseconds
+    std::vector<std::string> stage_names_;
+    std::vector<std::vector<double>> stage_samples_;
+
+    void *lib_handle_;
+
+    bool quit_;
+};
+
+#endif // SHELL_HEADLESS_H
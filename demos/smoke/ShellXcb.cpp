@@ -315,6 +315,7 @@ void ShellXcb::loop_poll()
                   current_time - profile_start_time << " seconds " <<
                   "(FPS: " << fps << ")";
             log(LOG_INFO, ss.str().c_str());
+            log_stage_timings();
 
             profile_start_time = current_time;
             profile_present_count = 0;
@@ -23,7 +23,6 @@
 #ifndef SIMULATION_H
 #define SIMULATION_H
 
-#include <memory>
 #include <random>
 #include <vector>
 
@@ -31,82 +30,83 @@
 
 #include "Meshes.h"
 
-class Animation {
-public:
-    Animation(unsigned rng_seed, float scale);
-
-    glm::mat4 transformation(float t);
-
-private:
-    struct Data {
-        glm::vec3 axis;
-        float speed;
-        float scale;
-
-        glm::mat4 matrix;
-    };
-
-    std::mt19937 rng_;
-    std::uniform_real_distribution<float> dir_;
-    std::uniform_real_distribution<float> speed_;
-
-    Data current_;
-};
-
-class Curve;
-
-class Path {
-public:
-    Path(unsigned rng_seed);
-
-    glm::vec3 position(float t);
-
-private:
-    struct Subpath {
-        glm::vec3 origin;
-        float start;
-        float end;
-        float now;
-
-        std::shared_ptr<Curve> curve;
-    };
-
-    void generate_subpath();
-
-    std::mt19937 rng_;
-    std::uniform_int_distribution<> type_;
-    std::uniform_real_distribution<float> duration_;
-
-    Subpath current_;
-};
-
 class Simulation {
 public:
     Simulation(int object_count);
+    // seeds every generator from seed, so that runs are repeatable
+    Simulation(int object_count, unsigned int seed);
 
+    // What the renderer needs of an object.  The animation and path state
+    // that produce the model matrix are kept in per-field arrays below.
     struct Object {
         Meshes::Type mesh;
         glm::vec3 light_pos;
         glm::vec3 light_color;
 
-        Animation animation;
-        Path path;
-
-        uint32_t frame_data_offset;
-
         glm::mat4 model;
     };
 
     const std::vector<Object> &objects() const { return objects_; }
 
-    unsigned int rng_seed() { return random_dev_(); }
+    // translations and scales of the model matrices as arrays, for
+    // vectorized culling
+    const float *positions_x() const { return pos_x_.data(); }
+    const float *positions_y() const { return pos_y_.data(); }
+    const float *positions_z() const { return pos_z_.data(); }
+    const float *scales() const { return scale_.data(); }
+
+    unsigned int rng_seed() { return seed_rng_(); }
 
-    void set_frame_data_size(uint32_t size);
     void update(float time, int begin, int end);
 
 private:
-    std::random_device random_dev_;
+    // objects are updated in blocks small enough to stay in cache between
+    // the segment pass and the vectorized pass
+    static const int update_block_size = 256;
+
+    void init_path(int i);
+    void generate_subpath(int i);
+    void generate_random_segment(int i, float t);
+    glm::vec3 evaluate_curve(int i, float t) const;
+
+    void update_segments(float time, int begin, int end);
+    template <typename Lanes> void update_lanes(float time, int i);
+
+    std::mt19937 seed_rng_;
     std::vector<Object> objects_;
+
+    // Each object has its own small generator, only touched when a path
+    // segment ends
+    std::vector<std::minstd_rand> rngs_;
+
+    // rotation about a fixed axis, angle kept in [-pi, pi]
+    std::vector<float> axis_x_, axis_y_, axis_z_;
+    std::vector<float> speed_;
+    std::vector<float> scale_;
+    std::vector<float> angle_;
+
+    // translation written with the model matrix
+    std::vector<float> pos_x_, pos_y_, pos_z_;
+
+    // current subpath: starts at origin at time start and lasts until end
+    std::vector<float> path_now_;
+    std::vector<float> path_start_;
+    std::vector<float> path_end_;
+    std::vector<float> origin_x_, origin_y_, origin_z_;
+
+    // The subpath's curve as a tagged union evaluated at local time t as
+    // c0 * f0(t) + c1 * f1(t):
+    //
+    //   CURVE_RANDOM: c0 = segment start, c1 = velocity, f0 = 1, f1 = t - t0,
+    //                 with a new segment drawn once t reaches t1
+    //   CURVE_CIRCLE: c0 and c1 span the circle, f0 = cos(t) - 1, f1 = sin(t)
+    //
+    // The tag is stored as a float so it can be turned into a lane mask.
+    std::vector<float> curve_type_;
+    std::vector<float> c0_x_, c0_y_, c0_z_;
+    std::vector<float> c1_x_, c1_y_, c1_z_;
+    std::vector<float> curve_t0_;
+    std::vector<float> curve_t1_;
 };
 
 #endif // SIMULATION_H
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2016 Google, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+// CPU-only benchmark of Simulation::update, no Vulkan involved.
+//
+//   smoke-simulation-bench [object count...]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "Simulation.h"
+
+namespace {
+
+const float tick_interval = 1.0f / 30.0f;
+
+double run(int object_count)
+{
+    Simulation sim(object_count);
+
+    // let every object start a path before timing
+    sim.update(tick_interval, 0, object_count);
+
+    // aim for roughly 50M object updates per count
+    int ticks = std::max(10, 50000000 / object_count);
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < ticks; i++)
+        sim.update(tick_interval, 0, object_count);
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+
+    return ns / ticks;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::vector<int> counts;
+    for (int i = 1; i < argc; i++)
+        counts.push_back(std::atoi(argv[i]));
+    if (counts.empty())
+        counts = { 5000, 20000, 100000, 250000, 1000000 };
+
+    std::printf("%10s %14s %14s\n", "objects", "ms/update", "ns/object");
+    for (auto count : counts) {
+        if (count <= 0)
+            continue;
+
+        double ns = run(count);
+        std::printf("%10d %14.3f %14.2f\n", count, ns / 1e6, ns / count);
+    }
+
+    return 0;
+}
@@ -20,13 +20,18 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <algorithm>
 #include <array>
+#include <random>
+#include <sstream>
+#include <thread>
 
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "Helpers.h"
 #include "Smoke.h"
+#include "MeshBlob.h"
 #include "Meshes.h"
 #include "Shell.h"
 
@@ -41,11 +46,43 @@ struct ShaderParamBlock {
     float view_projection[4 * 4];
 };
 
+// ShaderParamBlock split for drawing from buffers: the per-object part is
+// written for each object drawn and the view projection once per frame
+struct ObjectParamBlock {
+    float light_pos[4];
+    float light_color[4];
+    float model[4 * 4];
+};
+
+struct FrameParamBlock {
+    float view_projection[4 * 4];
+};
+
+// objects per parallel_for chunk; small enough for idle threads to steal
+// from a busy one, large enough to amortize the atomics
+const int sim_chunk_size = 256;
+const int frame_chunk_size = 128;
+
+// splits a worker's draws over several secondary command buffers when it
+// records more than a few chunks' worth
+const int default_max_cmd_draws = 512;
+
+const int sim_object_count = 5000;
+// fixed so that benchmark runs simulate and draw the same frames
+const unsigned int benchmark_seed = 20160501;
+
 } // namespace
 
 Smoke::Smoke(const std::vector<std::string> &args)
-    : Game("Smoke", args), multithread_(true), use_push_constants_(false),
-      sim_paused_(false), sim_(5000), camera_(2.5f), frame_data_(),
+    : Game("Smoke", args), multithread_(true), thread_count_(0),
+      use_push_constants_(false), use_instancing_(false), use_culling_(true),
+      max_cmd_draws_(default_max_cmd_draws),
+      sim_paused_(false),
+      sim_(sim_object_count, settings_.benchmark_frames ? benchmark_seed : std::random_device()()),
+      camera_(2.5f),
+      pending_ticks_(0), recorded_chunks_(0),
+      sim_cpu_ns_(0), cull_cpu_ns_(0), uniform_cpu_ns_(0), uniform_bytes_(0),
+      visible_objects_(0), frame_data_(), object_param_stride_(0), frame_param_offset_(0),
       render_pass_clear_value_({{ 0.0f, 0.1f, 0.2f, 1.0f }}),
       render_pass_begin_info_(),
       primary_cmd_begin_info_(), primary_cmd_submit_info_()
@@ -55,39 +92,53 @@ Smoke::Smoke(const std::vector<std::string> &args)
             multithread_ = false;
         else if (*it == "-p")
             use_push_constants_ = true;
+        else if (*it == "-i")
+            use_instancing_ = true;
+        else if (*it == "-nc")
+            use_culling_ = false;
+        else if (*it == "-t")
+            thread_count_ = std::stoi(*++it);
+        else if (*it == "--mesh-cache")
+            mesh_cache_ = *++it;
+        else if (*it == "--draws-per-cmd")
+            max_cmd_draws_ = std::stoi(*++it);
     }
 
-    init_workers();
+    // instanced drawing pushes only the view projection
+    if (use_instancing_)
+        use_push_constants_ = false;
+
+    init_scheduler();
 }
 
 Smoke::~Smoke()
 {
 }
 
-void Smoke::init_workers()
+void Smoke::init_scheduler()
 {
-    int worker_count = std::thread::hardware_concurrency();
+    if (thread_count_ <= 0)
+        thread_count_ = std::thread::hardware_concurrency();
 
     // not enough cores
-    if (!multithread_ || worker_count < 2) {
+    if (!multithread_ || thread_count_ < 2) {
         multithread_ = false;
-        worker_count = 1;
+        thread_count_ = 1;
     }
 
-    const int object_per_worker = sim_.objects().size() / worker_count;
-    int object_begin = 0, object_end = 0;
+    scheduler_ = std::unique_ptr<TaskScheduler>(new TaskScheduler(thread_count_));
 
-    workers_.reserve(worker_count);
-    for (int i = 0; i < worker_count; i++) {
-        object_begin = object_end;
-        if (i < worker_count - 1)
-            object_end += object_per_worker;
-        else
-            object_end = sim_.objects().size();
+    chunk_scratch_.resize(thread_count_);
 
-        Worker *worker = new Worker(*this, i, object_begin, object_end);
-        workers_.emplace_back(std::unique_ptr<Worker>(worker));
+    record_timing_names_.clear();
+    for (int i = 0; i < thread_count_; i++) {
+        std::stringstream ss;
+        ss << "record thread " << i;
+        record_timing_names_.push_back(ss.str());
     }
+    worker_cmds_recorded_.reserve(thread_count_);
+
+    frame_stats_ = FrameStats();
 }
 
 void Smoke::attach_shell(Shell &sh)
@@ -115,7 +166,12 @@ void Smoke::attach_shell(Shell &sh)
     for (uint32_t i = 0; i < mem_props.memoryTypeCount; i++)
         mem_flags_.push_back(mem_props.memoryTypes[i].propertyFlags);
 
-    meshes_ = new Meshes(dev_, mem_flags_);
+    create_meshes();
+
+    const auto &objects = sim_.objects();
+    cull_radii_.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); i++)
+        cull_radii_[i] = sim_.scales()[i] * meshes_->radius(objects[i].mesh);
 
     create_render_pass();
     create_shader_modules();
@@ -123,7 +179,8 @@ void Smoke::attach_shell(Shell &sh)
     create_pipeline_layout();
     create_pipeline();
 
-    create_frame_data(2);
+    // as many frames in flight as the shell has back buffers
+    create_frame_data(settings_.back_buffer_count + 1);
 
     render_pass_begin_info_.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     render_pass_begin_info_.renderPass = render_pass_;
@@ -141,19 +198,11 @@ void Smoke::attach_shell(Shell &sh)
     primary_cmd_submit_info_.pWaitDstStageMask = &primary_cmd_submit_wait_stages_;
     primary_cmd_submit_info_.commandBufferCount = 1;
     primary_cmd_submit_info_.signalSemaphoreCount = 1;
-
-    if (multithread_) {
-        for (auto &worker : workers_)
-            worker->start();
-    }
 }
 
 void Smoke::detach_shell()
 {
-    if (multithread_) {
-        for (auto &worker : workers_)
-            worker->stop();
-    }
+    scheduler_->wait();
 
     destroy_frame_data();
 
@@ -170,6 +219,29 @@ void Smoke::detach_shell()
     Game::detach_shell();
 }
 
+void Smoke::create_meshes()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    // build the meshes only when there is no cached blob to map
+    MeshBlob blob;
+    bool loaded = !mesh_cache_.empty() && blob.load(mesh_cache_);
+    if (!loaded) {
+        blob.build(*scheduler_);
+        if (!mesh_cache_.empty() && !blob.save(mesh_cache_))
+            shell_->log(Shell::LOG_WARN, "cannot write mesh cache");
+    }
+
+    meshes_ = new Meshes(dev_, mem_flags_, blob);
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::stringstream ss;
+    ss << "meshes " << (loaded ? "loaded from " + mesh_cache_ : std::string("built"))
+       << " and uploaded in " << elapsed.count() << " ms (" << blob.size() << " bytes)";
+    shell_->log(Shell::LOG_INFO, ss.str().c_str());
+}
+
 void Smoke::create_render_pass()
 {
     VkAttachmentDescription attachment = {};
@@ -178,7 +250,9 @@ void Smoke::create_render_pass()
     attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
     attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    // headless shells have nothing to present to
+    attachment.finalLayout = settings_.headless ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL :
+                                                  VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
     VkAttachmentReference attachment_ref = {};
     attachment_ref.attachment = 0;
@@ -224,7 +298,11 @@ void Smoke::create_shader_modules()
 {
     VkShaderModuleCreateInfo sh_info = {};
     sh_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    if (use_push_constants_) {
+    if (use_instancing_) {
+#include "Smoke.instanced.vert.h"
+        sh_info.codeSize = sizeof(Smoke_instanced_vert);
+        sh_info.pCode = Smoke_instanced_vert;
+    } else if (use_push_constants_) {
 #include "Smoke.push_constant.vert.h"
         sh_info.codeSize = sizeof(Smoke_push_constant_vert);
         sh_info.pCode = Smoke_push_constant_vert;
@@ -246,16 +324,21 @@ void Smoke::create_descriptor_set_layout()
     if (use_push_constants_)
         return;
 
-    VkDescriptorSetLayoutBinding layout_binding = {};
-    layout_binding.binding = 0;
-    layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
-    layout_binding.descriptorCount = 1;
-    layout_binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    // instanced drawing indexes an array of ObjectParamBlock; otherwise
+    // each draw binds its ObjectParamBlock and the frame's FrameParamBlock
+    std::array<VkDescriptorSetLayoutBinding, 2> layout_bindings = {};
+    for (uint32_t i = 0; i < layout_bindings.size(); i++) {
+        layout_bindings[i].binding = i;
+        layout_bindings[i].descriptorType = use_instancing_ ?
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        layout_bindings[i].descriptorCount = 1;
+        layout_bindings[i].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    }
 
     VkDescriptorSetLayoutCreateInfo layout_info = {};
     layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layout_info.bindingCount = 1;
-    layout_info.pBindings = &layout_binding;
+    layout_info.bindingCount = use_instancing_ ? 1 : 2;
+    layout_info.pBindings = layout_bindings.data();
 
     vk::assert_success(vk::CreateDescriptorSetLayout(dev_, &layout_info,
                 nullptr, &desc_set_layout_));
@@ -268,7 +351,16 @@ void Smoke::create_pipeline_layout()
     VkPipelineLayoutCreateInfo pipeline_layout_info = {};
     pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 
-    if (use_push_constants_) {
+    if (use_instancing_) {
+        push_const_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        push_const_range.offset = 0;
+        push_const_range.size = sizeof(camera_.view_projection);
+
+        pipeline_layout_info.pushConstantRangeCount = 1;
+        pipeline_layout_info.pPushConstantRanges = &push_const_range;
+        pipeline_layout_info.setLayoutCount = 1;
+        pipeline_layout_info.pSetLayouts = &desc_set_layout_;
+    } else if (use_push_constants_) {
         push_const_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
         push_const_range.offset = 0;
         push_const_range.size = sizeof(ShaderParamBlock);
@@ -364,7 +456,14 @@ void Smoke::create_pipeline()
     pipeline_info.layout = pipeline_layout_;
     pipeline_info.renderPass = render_pass_;
     pipeline_info.subpass = 0;
-    vk::assert_success(vk::CreateGraphicsPipelines(dev_, VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &pipeline_));
+
+    // the drawing mode is fixed at startup, so there is one pipeline to
+    // create
+    double ms = shell_->pipeline_cache().create_graphics_pipeline(pipeline_info, pipeline_);
+
+    std::stringstream ss;
+    ss << "pipeline created in " << ms << " ms";
+    shell_->log(Shell::LOG_INFO, ss.str().c_str());
 }
 
 void Smoke::create_frame_data(int count)
@@ -375,9 +474,9 @@ void Smoke::create_frame_data(int count)
     create_command_buffers();
 
     if (!use_push_constants_) {
-        create_buffers();
-        create_buffer_memory();
-        create_descriptor_sets();
+        create_uniform_buffer();
+        create_uniform_memory();
+        create_descriptor_set();
     }
 
     frame_data_index_ = 0;
@@ -385,19 +484,15 @@ void Smoke::create_frame_data(int count)
 
 void Smoke::destroy_frame_data()
 {
+    worker_cmds_.destroy();
+    vk::DestroyCommandPool(dev_, primary_cmd_pool_, nullptr);
+
     if (!use_push_constants_) {
         vk::DestroyDescriptorPool(dev_, desc_pool_, nullptr);
 
-        for (auto cmd_pool : worker_cmd_pools_)
-            vk::DestroyCommandPool(dev_, cmd_pool, nullptr);
-        worker_cmd_pools_.clear();
-        vk::DestroyCommandPool(dev_, primary_cmd_pool_, nullptr);
-
-        vk::UnmapMemory(dev_, frame_data_mem_);
-        vk::FreeMemory(dev_, frame_data_mem_, nullptr);
-
-        for (auto &data : frame_data_)
-            vk::DestroyBuffer(dev_, data.buf, nullptr);
+        vk::UnmapMemory(dev_, uniform_mem_);
+        vk::FreeMemory(dev_, uniform_mem_, nullptr);
+        vk::DestroyBuffer(dev_, uniform_buf_, nullptr);
     }
 
     for (auto &data : frame_data_)
@@ -423,80 +518,65 @@ void Smoke::create_command_buffers()
     cmd_pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
     cmd_pool_info.queueFamilyIndex = queue_family_;
 
+    vk::assert_success(vk::CreateCommandPool(dev_, &cmd_pool_info,
+                nullptr, &primary_cmd_pool_));
+
     VkCommandBufferAllocateInfo cmd_info = {};
     cmd_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmd_info.commandPool = primary_cmd_pool_;
+    cmd_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
     cmd_info.commandBufferCount = static_cast<uint32_t>(frame_data_.size());
 
-    // create command pools and buffers
-    std::vector<VkCommandPool> cmd_pools(workers_.size() + 1, VK_NULL_HANDLE);
-    std::vector<std::vector<VkCommandBuffer>> cmds_vec(workers_.size() + 1,
-            std::vector<VkCommandBuffer>(frame_data_.size(), VK_NULL_HANDLE));
-    for (size_t i = 0; i < cmd_pools.size(); i++) {
-        auto &cmd_pool = cmd_pools[i];
-        auto &cmds = cmds_vec[i];
-
-        vk::assert_success(vk::CreateCommandPool(dev_, &cmd_pool_info,
-                    nullptr, &cmd_pool));
+    std::vector<VkCommandBuffer> cmds(frame_data_.size());
+    vk::assert_success(vk::AllocateCommandBuffers(dev_, &cmd_info, cmds.data()));
+    for (size_t i = 0; i < frame_data_.size(); i++)
+        frame_data_[i].primary_cmd = cmds[i];
 
-        cmd_info.commandPool = cmd_pool;
-        cmd_info.level = (cmd_pool == cmd_pools.back()) ?
-            VK_COMMAND_BUFFER_LEVEL_PRIMARY : VK_COMMAND_BUFFER_LEVEL_SECONDARY;
-
-        vk::assert_success(vk::AllocateCommandBuffers(dev_, &cmd_info, cmds.data()));
-    }
-
-    // update frame_data_
-    for (size_t i = 0; i < frame_data_.size(); i++) {
-        for (const auto &cmds : cmds_vec) {
-            if (cmds == cmds_vec.back()) {
-                frame_data_[i].primary_cmd = cmds[i];
-            } else {
-                frame_data_[i].worker_cmds.push_back(cmds[i]);
-            }
-        }
-    }
-
-    primary_cmd_pool_ = cmd_pools.back();
-    cmd_pools.pop_back();
-    worker_cmd_pools_ = cmd_pools;
+    // secondaries are allocated as the workers need them
+    worker_cmds_.init(dev_, queue_family_, thread_count_, static_cast<int>(frame_data_.size()));
 }
 
-void Smoke::create_buffers()
+void Smoke::create_uniform_buffer()
 {
-    VkDeviceSize object_data_size = sizeof(ShaderParamBlock);
-    // align object data to device limit
-    const VkDeviceSize &alignment =
-        physical_dev_props_.limits.minStorageBufferOffsetAlignment;
-    if (object_data_size % alignment)
-        object_data_size += alignment - (object_data_size % alignment);
-
-    // update simulation
-    sim_.set_frame_data_size(object_data_size);
+    // the limits are powers of two
+    uniform_alignment_ = use_instancing_ ?
+        physical_dev_props_.limits.minStorageBufferOffsetAlignment :
+        physical_dev_props_.limits.minUniformBufferOffsetAlignment;
+    const VkDeviceSize mask = uniform_alignment_ - 1;
+    const VkDeviceSize object_count = sim_.objects().size();
+
+    if (use_instancing_) {
+        init_instances();
+
+        // one array of every object
+        uniform_frame_size_ = (sizeof(ObjectParamBlock) * object_count + mask) & ~mask;
+    } else {
+        // objects are bound one at a time at aligned offsets
+        object_param_stride_ = (sizeof(ObjectParamBlock) + mask) & ~mask;
+        uniform_frame_size_ = ((sizeof(FrameParamBlock) + mask) & ~mask) +
+            object_param_stride_ * object_count;
+    }
 
     VkBufferCreateInfo buf_info = {};
     buf_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    buf_info.size = object_data_size * sim_.objects().size();
-    buf_info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    // what RingAllocator needs to never run out
+    buf_info.size = uniform_frame_size_ * (frame_data_.size() + 2);
+    buf_info.usage = use_instancing_ ?
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT : VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
     buf_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
-    for (auto &data : frame_data_)
-        vk::assert_success(vk::CreateBuffer(dev_, &buf_info, nullptr, &data.buf));
+    vk::assert_success(vk::CreateBuffer(dev_, &buf_info, nullptr, &uniform_buf_));
 }
 
-void Smoke::create_buffer_memory()
+void Smoke::create_uniform_memory()
 {
     VkMemoryRequirements mem_reqs;
-    vk::GetBufferMemoryRequirements(dev_, frame_data_[0].buf, &mem_reqs);
-
-    VkDeviceSize aligned_size = mem_reqs.size;
-    if (aligned_size % mem_reqs.alignment)
-        aligned_size += mem_reqs.alignment - (aligned_size % mem_reqs.alignment);
+    vk::GetBufferMemoryRequirements(dev_, uniform_buf_, &mem_reqs);
 
     // allocate memory
     VkMemoryAllocateInfo mem_info = {};
     mem_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    mem_info.allocationSize = aligned_size * (frame_data_.size() - 1) +
-        mem_reqs.size;
+    mem_info.allocationSize = mem_reqs.size;
 
     for (uint32_t idx = 0; idx < mem_flags_.size(); idx++) {
         if ((mem_reqs.memoryTypeBits & (1 << idx)) &&
@@ -508,28 +588,31 @@ void Smoke::create_buffer_memory()
         }
     }
 
-    vk::AllocateMemory(dev_, &mem_info, nullptr, &frame_data_mem_);
+    vk::AllocateMemory(dev_, &mem_info, nullptr, &uniform_mem_);
+    vk::BindBufferMemory(dev_, uniform_buf_, uniform_mem_, 0);
 
+    // mapped for as long as it exists
     void *ptr;
-    vk::MapMemory(dev_, frame_data_mem_, 0, VK_WHOLE_SIZE, 0, &ptr);
+    vk::MapMemory(dev_, uniform_mem_, 0, VK_WHOLE_SIZE, 0, &ptr);
 
-    VkDeviceSize offset = 0;
-    for (auto &data : frame_data_) {
-        vk::BindBufferMemory(dev_, data.buf, frame_data_mem_, offset);
-        data.base = reinterpret_cast<uint8_t *>(ptr) + offset;
-        offset += aligned_size;
-    }
+    uniform_ring_.init(reinterpret_cast<uint8_t *>(ptr),
+            uniform_frame_size_ * (frame_data_.size() + 2),
+            uniform_alignment_, static_cast<int>(frame_data_.size()));
 }
 
-void Smoke::create_descriptor_sets()
+void Smoke::create_descriptor_set()
 {
+    const VkDescriptorType desc_type = use_instancing_ ?
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    const uint32_t binding_count = use_instancing_ ? 1 : 2;
+
     VkDescriptorPoolSize desc_pool_size = {};
-    desc_pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
-    desc_pool_size.descriptorCount = frame_data_.size();
+    desc_pool_size.type = desc_type;
+    desc_pool_size.descriptorCount = binding_count;
 
     VkDescriptorPoolCreateInfo desc_pool_info = {};
     desc_pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    desc_pool_info.maxSets = frame_data_.size();
+    desc_pool_info.maxSets = 1;
     desc_pool_info.poolSizeCount = 1;
     desc_pool_info.pPoolSizes = &desc_pool_size;
 
@@ -537,45 +620,35 @@ void Smoke::create_descriptor_sets()
     vk::assert_success(vk::CreateDescriptorPool(dev_, &desc_pool_info,
                 nullptr, &desc_pool_));
 
-    std::vector<VkDescriptorSetLayout> set_layouts(frame_data_.size(), desc_set_layout_);
     VkDescriptorSetAllocateInfo set_info = {};
     set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     set_info.descriptorPool = desc_pool_;
-    set_info.descriptorSetCount = static_cast<uint32_t>(set_layouts.size());
-    set_info.pSetLayouts = set_layouts.data();
-
-    // create descriptor sets
-    std::vector<VkDescriptorSet> desc_sets(frame_data_.size(), VK_NULL_HANDLE);
-    vk::assert_success(vk::AllocateDescriptorSets(dev_, &set_info, desc_sets.data()));
-
-    std::vector<VkDescriptorBufferInfo> desc_bufs(frame_data_.size());
-    std::vector<VkWriteDescriptorSet> desc_writes(frame_data_.size());
-
-    for (size_t i = 0; i < frame_data_.size(); i++) {
-        auto &data = frame_data_[i];
-
-        data.desc_set = desc_sets[i];
-
-        VkDescriptorBufferInfo desc_buf = {};
-        desc_buf.buffer = data.buf;
-        desc_buf.offset = 0;
-        desc_buf.range = VK_WHOLE_SIZE;
-        desc_bufs[i] = desc_buf;
-
-        VkWriteDescriptorSet desc_write = {};
-        desc_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        desc_write.dstSet = data.desc_set;
-        desc_write.dstBinding = 0;
-        desc_write.dstArrayElement = 0;
-        desc_write.descriptorCount = 1;
-        desc_write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
-        desc_write.pBufferInfo = &desc_bufs[i];
-        desc_writes[i] = desc_write;
+    set_info.descriptorSetCount = 1;
+    set_info.pSetLayouts = &desc_set_layout_;
+
+    // create the descriptor set; frames differ only in dynamic offsets
+    vk::assert_success(vk::AllocateDescriptorSets(dev_, &set_info, &desc_set_));
+
+    std::array<VkDescriptorBufferInfo, 2> desc_bufs = {};
+    std::array<VkWriteDescriptorSet, 2> desc_writes = {};
+
+    desc_bufs[0].buffer = uniform_buf_;
+    desc_bufs[0].range = use_instancing_ ?
+        sizeof(ObjectParamBlock) * sim_.objects().size() : sizeof(ObjectParamBlock);
+    desc_bufs[1].buffer = uniform_buf_;
+    desc_bufs[1].range = sizeof(FrameParamBlock);
+
+    for (uint32_t i = 0; i < binding_count; i++) {
+        desc_writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        desc_writes[i].dstSet = desc_set_;
+        desc_writes[i].dstBinding = i;
+        desc_writes[i].dstArrayElement = 0;
+        desc_writes[i].descriptorCount = 1;
+        desc_writes[i].descriptorType = desc_type;
+        desc_writes[i].pBufferInfo = &desc_bufs[i];
     }
 
-    vk::UpdateDescriptorSets(dev_,
-            static_cast<uint32_t>(desc_writes.size()),
-            desc_writes.data(), 0, nullptr);
+    vk::UpdateDescriptorSets(dev_, binding_count, desc_writes.data(), 0, nullptr);
 }
 
 void Smoke::attach_swapchain()
@@ -583,7 +656,7 @@ void Smoke::attach_swapchain()
     const Shell::Context &ctx = shell_->context();
 
     prepare_viewport(ctx.extent);
-    prepare_framebuffers(ctx.swapchain);
+    prepare_framebuffers(ctx.images);
 
     update_camera();
 }
@@ -597,7 +670,6 @@ void Smoke::detach_swapchain()
 
     framebuffers_.clear();
     image_views_.clear();
-    images_.clear();
 }
 
 void Smoke::prepare_viewport(const VkExtent2D &extent)
@@ -615,15 +687,12 @@ void Smoke::prepare_viewport(const VkExtent2D &extent)
     scissor_.extent = extent_;
 }
 
-void Smoke::prepare_framebuffers(VkSwapchainKHR swapchain)
+void Smoke::prepare_framebuffers(const std::vector<VkImage> &images)
 {
-    // get swapchain images
-    vk::get(dev_, swapchain, images_);
-
     assert(framebuffers_.empty());
-    image_views_.reserve(images_.size());
-    framebuffers_.reserve(images_.size());
-    for (auto img : images_) {
+    image_views_.reserve(images.size());
+    framebuffers_.reserve(images.size());
+    for (auto img : images) {
         VkImageViewCreateInfo view_info = {};
         view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
         view_info.image = img;
@@ -668,9 +737,10 @@ void Smoke::update_camera()
                          0.0f,  0.0f, 0.5f, 1.0f);
 
     camera_.view_projection = clip * projection * view;
+    camera_.frustum = Frustum(camera_.view_projection);
 }
 
-void Smoke::draw_object(const Simulation::Object &obj, FrameData &data, VkCommandBuffer cmd) const
+void Smoke::draw_object(const Simulation::Object &obj, uint32_t param_offset, VkCommandBuffer cmd) const
 {
     if (use_push_constants_) {
         ShaderParamBlock params;
@@ -682,40 +752,116 @@ void Smoke::draw_object(const Simulation::Object &obj, FrameData &data, VkComman
         vk::CmdPushConstants(cmd, pipeline_layout_, VK_SHADER_STAGE_VERTEX_BIT,
                 0, sizeof(params), &params);
     } else {
-        ShaderParamBlock *params =
-            reinterpret_cast<ShaderParamBlock *>(data.base + obj.frame_data_offset);
-        memcpy(params->light_pos, glm::value_ptr(obj.light_pos), sizeof(obj.light_pos));
-        memcpy(params->light_color, glm::value_ptr(obj.light_color), sizeof(obj.light_color));
-        memcpy(params->model, glm::value_ptr(obj.model), sizeof(obj.model));
-        memcpy(params->view_projection, glm::value_ptr(camera_.view_projection), sizeof(camera_.view_projection));
-
+        const uint32_t offsets[2] = { param_offset, frame_param_offset_ };
         vk::CmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                pipeline_layout_, 0, 1, &data.desc_set, 1, &obj.frame_data_offset);
+                pipeline_layout_, 0, 1, &desc_set_, 2, offsets);
     }
 
     meshes_->cmd_draw(cmd, obj.mesh);
 }
 
-void Smoke::update_simulation(const Worker &worker)
+void Smoke::record_chunk(VkFramebuffer fb, int begin, int end, int thread)
 {
-    sim_.update(worker.tick_interval_, worker.object_begin_, worker.object_end_);
+    auto &scratch = chunk_scratch_[thread];
+    if (scratch.visible.size() < static_cast<size_t>(end - begin)) {
+        scratch.visible.resize(end - begin);
+        scratch.sorted.resize(end - begin);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    int count;
+    if (use_culling_) {
+        count = camera_.frustum.cull(sim_.positions_x(), sim_.positions_y(), sim_.positions_z(),
+                cull_radii_.data(), begin, end, scratch.visible.data());
+    } else {
+        count = end - begin;
+        for (int i = 0; i < count; i++)
+            scratch.visible[i] = begin + i;
+    }
+
+    // group by mesh, keeping the order within a mesh
+    const auto &objects = sim_.objects();
+    std::array<uint32_t, Meshes::MESH_COUNT> mesh_counts = {};
+    for (int i = 0; i < count; i++)
+        mesh_counts[objects[scratch.visible[i]].mesh]++;
+
+    std::array<uint32_t, Meshes::MESH_COUNT> mesh_next;
+    uint32_t next = 0;
+    for (int m = 0; m < Meshes::MESH_COUNT; m++) {
+        mesh_next[m] = next;
+        next += mesh_counts[m];
+    }
+    for (int i = 0; i < count; i++) {
+        const uint32_t obj = scratch.visible[i];
+        scratch.sorted[mesh_next[objects[obj].mesh]++] = obj;
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    cull_cpu_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+            std::memory_order_relaxed);
+
+    if (use_instancing_)
+        write_instances(scratch.sorted.data(), mesh_counts.data());
+    else if (count)
+        draw_objects(fb, scratch.sorted.data(), count, thread);
+
+    visible_objects_.fetch_add(count, std::memory_order_relaxed);
+
+    // read by on_frame's thread only after this chunk is counted as recorded
+    scratch.record_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
 }
 
-void Smoke::draw_objects(Worker &worker)
+void Smoke::draw_objects(VkFramebuffer fb, const uint32_t *objects, int count, int thread)
 {
-    auto &data = frame_data_[frame_data_index_];
-    auto cmd = data.worker_cmds[worker.index_];
+    ChunkScratch &scratch = chunk_scratch_[thread];
+
+    uint32_t param_offset = 0;
+    if (!use_push_constants_)
+        param_offset = write_object_params(objects, count);
+
+    int i = 0;
+    while (i < count) {
+        // a thread begins a command buffer on its first chunk, so threads
+        // that get no chunks contribute nothing
+        if (!scratch.cmd)
+            begin_worker_cmd(fb, thread);
+
+        int batch = count - i;
+        if (max_cmd_draws_ > 0)
+            batch = std::min(batch, max_cmd_draws_ - scratch.cmd_draws);
+
+        for (int end = i + batch; i < end; i++) {
+            auto &obj = sim_.objects()[objects[i]];
+
+            draw_object(obj, param_offset + object_param_stride_ * i, scratch.cmd->cmd);
+        }
+
+        scratch.cmd_draws += batch;
+        if (max_cmd_draws_ > 0 && scratch.cmd_draws >= max_cmd_draws_)
+            end_worker_cmd(thread);
+    }
+}
+
+void Smoke::begin_worker_cmd(VkFramebuffer fb, int thread)
+{
+    ChunkScratch &scratch = chunk_scratch_[thread];
+    scratch.cmd = worker_cmds_.allocate(thread);
+    scratch.cmd_draws = 0;
 
     VkCommandBufferInheritanceInfo inherit_info = {};
     inherit_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
     inherit_info.renderPass = render_pass_;
-    inherit_info.framebuffer = worker.fb_;
+    inherit_info.framebuffer = fb;
 
     VkCommandBufferBeginInfo begin_info = {};
     begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    begin_info.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+                       VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
     begin_info.pInheritanceInfo = &inherit_info;
 
+    VkCommandBuffer cmd = scratch.cmd->cmd;
     vk::BeginCommandBuffer(cmd, &begin_info);
 
     vk::CmdSetViewport(cmd, 0, 1, &viewport_);
@@ -724,14 +870,206 @@ void Smoke::draw_objects(Worker &worker)
     vk::CmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_);
 
     meshes_->cmd_bind_buffers(cmd);
+}
+
+void Smoke::end_worker_cmd(int thread)
+{
+    ChunkScratch &scratch = chunk_scratch_[thread];
+
+    vk::EndCommandBuffer(scratch.cmd->cmd);
+    worker_cmds_.finish(scratch.cmd);
 
-    for (int i = worker.object_begin_; i < worker.object_end_; i++) {
-        auto &obj = sim_.objects()[i];
+    scratch.cmd = nullptr;
+}
+
+uint32_t Smoke::allocate_uniform_data(VkDeviceSize size)
+{
+    uint64_t offset = 0;
+    bool allocated = uniform_ring_.allocate(size, &offset);
+    // the ring is sized for every object in every frame in flight
+    assert(allocated);
+    (void) allocated;
+
+    return static_cast<uint32_t>(offset);
+}
+
+uint32_t Smoke::write_object_params(const uint32_t *objects, int count)
+{
+    auto start = std::chrono::steady_clock::now();
 
-        draw_object(obj, data, cmd);
+    const uint32_t offset = allocate_uniform_data(object_param_stride_ * count);
+    uint8_t *dst = uniform_ring_.data(offset);
+
+    for (int i = 0; i < count; i++) {
+        const auto &obj = sim_.objects()[objects[i]];
+        ObjectParamBlock *params = reinterpret_cast<ObjectParamBlock *>(dst + object_param_stride_ * i);
+
+        memcpy(params->light_pos, glm::value_ptr(obj.light_pos), sizeof(obj.light_pos));
+        memcpy(params->light_color, glm::value_ptr(obj.light_color), sizeof(obj.light_color));
+        memcpy(params->model, glm::value_ptr(obj.model), sizeof(obj.model));
     }
 
-    vk::EndCommandBuffer(cmd);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    uniform_cpu_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+            std::memory_order_relaxed);
+    uniform_bytes_.fetch_add(sizeof(ObjectParamBlock) * count, std::memory_order_relaxed);
+
+    return offset;
+}
+
+void Smoke::init_instances()
+{
+    std::array<uint32_t, Meshes::MESH_COUNT> mesh_objects = {};
+    for (const auto &obj : sim_.objects())
+        mesh_objects[obj.mesh]++;
+
+    // room for every object of a mesh
+    mesh_first_instances_.assign(Meshes::MESH_COUNT, 0);
+    for (int i = 1; i < Meshes::MESH_COUNT; i++)
+        mesh_first_instances_[i] = mesh_first_instances_[i - 1] + mesh_objects[i - 1];
+}
+
+void Smoke::write_instances(const uint32_t *objects, const uint32_t *mesh_counts)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    ObjectParamBlock *instances = reinterpret_cast<ObjectParamBlock *>(
+            uniform_ring_.data(frame_param_offset_));
+    uint32_t written = 0;
+
+    for (int m = 0; m < Meshes::MESH_COUNT; m++) {
+        const uint32_t count = mesh_counts[m];
+        if (!count)
+            continue;
+
+        ObjectParamBlock *params = &instances[mesh_first_instances_[m] +
+            mesh_instance_counts_[m].fetch_add(count, std::memory_order_relaxed)];
+
+        for (uint32_t i = 0; i < count; i++) {
+            const auto &obj = sim_.objects()[objects[i]];
+
+            memcpy(params[i].light_pos, glm::value_ptr(obj.light_pos), sizeof(obj.light_pos));
+            memcpy(params[i].light_color, glm::value_ptr(obj.light_color), sizeof(obj.light_color));
+            memcpy(params[i].model, glm::value_ptr(obj.model), sizeof(obj.model));
+        }
+
+        objects += count;
+        written += count;
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    uniform_cpu_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+            std::memory_order_relaxed);
+    uniform_bytes_.fetch_add(sizeof(ObjectParamBlock) * written, std::memory_order_relaxed);
+}
+
+void Smoke::draw_instances(VkCommandBuffer cmd)
+{
+    vk::CmdSetViewport(cmd, 0, 1, &viewport_);
+    vk::CmdSetScissor(cmd, 0, 1, &scissor_);
+
+    vk::CmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_);
+
+    vk::CmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
+            pipeline_layout_, 0, 1, &desc_set_, 1, &frame_param_offset_);
+    vk::CmdPushConstants(cmd, pipeline_layout_, VK_SHADER_STAGE_VERTEX_BIT,
+            0, sizeof(camera_.view_projection), glm::value_ptr(camera_.view_projection));
+
+    meshes_->cmd_bind_buffers(cmd);
+
+    for (int i = 0; i < Meshes::MESH_COUNT; i++) {
+        const uint32_t count = mesh_instance_counts_[i].load(std::memory_order_relaxed);
+        if (!count)
+            continue;
+
+        meshes_->cmd_draw(cmd, static_cast<Meshes::Type>(i), count, mesh_first_instances_[i]);
+        frame_stats_.draws++;
+    }
+}
+
+void Smoke::update_simulation(int ticks, int begin, int end)
+{
+    const float tick_interval = 1.0f / settings_.ticks_per_second;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < ticks; i++)
+        sim_.update(tick_interval, begin, end);
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    sim_cpu_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+            std::memory_order_relaxed);
+}
+
+void Smoke::log_render_stats()
+{
+    const TaskScheduler::Stats sched = scheduler_->reset_stats();
+
+    const char *mode = use_instancing_ ? "instanced" :
+                       use_push_constants_ ? "push constants" : "dynamic offsets";
+
+    std::vector<Counter> counters;
+    get_counters(counters);
+
+    std::stringstream ss;
+    ss << mode << ", " << thread_count_ << " thread(s), "
+       << frame_data_.size() << " frame(s) in flight: "
+       << static_cast<int>(counters[0].value) << " draws/frame, "
+       << static_cast<int>(counters[1].value) << "/" << sim_.objects().size()
+       << " objects visible" << (use_culling_ ? "" : " (culling off)") << ", "
+       << static_cast<int>(counters[2].value) << " uniform bytes written/frame ("
+       << static_cast<int>(counters[3].value) << " allocated), "
+       << counters[4].value << " secondaries/frame, "
+       << sched.steals << "/" << sched.chunks << " chunks stolen";
+    shell_->log(Shell::LOG_INFO, ss.str().c_str());
+}
+
+void Smoke::get_stage_timings(std::vector<StageTiming> &timings)
+{
+    typedef std::chrono::duration<double, std::milli> ms;
+
+    const double sim_cpu = sim_cpu_ns_.exchange(0, std::memory_order_relaxed) / 1e6;
+
+    timings.push_back({ "sim wait", ms(frame_stats_.sim_wait).count() });
+    timings.push_back({ "fence wait", ms(frame_stats_.fence_wait).count() });
+    timings.push_back({ "record", ms(frame_stats_.record).count() });
+    for (int i = 0; i < thread_count_; i++) {
+        timings.push_back({ record_timing_names_[i].c_str(), chunk_scratch_[i].record_ns / 1e6 });
+        chunk_scratch_[i].record_ns = 0;
+    }
+    timings.push_back({ "submit", ms(frame_stats_.submit).count() });
+    timings.push_back({ "cull (all threads)", cull_cpu_ns_.exchange(0, std::memory_order_relaxed) / 1e6 });
+    timings.push_back({ "uniform update (all threads)", uniform_cpu_ns_.exchange(0, std::memory_order_relaxed) / 1e6 });
+    timings.push_back({ "simulate (all threads)", sim_cpu });
+
+    frame_stats_.sim_wait = std::chrono::steady_clock::duration::zero();
+    frame_stats_.fence_wait = std::chrono::steady_clock::duration::zero();
+    frame_stats_.record = std::chrono::steady_clock::duration::zero();
+    frame_stats_.submit = std::chrono::steady_clock::duration::zero();
+
+    // benchmarks ask for timings every frame and for counters at the end
+    if (!settings_.benchmark_frames)
+        log_render_stats();
+}
+
+void Smoke::get_counters(std::vector<Counter> &counters)
+{
+    const double frames = std::max(frame_stats_.frames, 1);
+
+    counters.push_back({ "draws", frame_stats_.draws / frames });
+    counters.push_back({ "visible objects", frame_stats_.visible / frames });
+    counters.push_back({ "uniform bytes written", frame_stats_.uniform_bytes / frames });
+    counters.push_back({ "uniform bytes allocated", frame_stats_.uniform_ring_bytes / frames });
+
+    const CommandBufferAllocator::Stats cmds = worker_cmds_.reset_stats();
+    counters.push_back({ "secondary command buffers", cmds.buffers / frames });
+    counters.push_back({ "command buffer allocations", cmds.allocations / frames });
+    counters.push_back({ "command pool resets", cmds.pool_resets / frames });
+
+    frame_stats_.frames = 0;
+    frame_stats_.draws = 0;
+    frame_stats_.visible = 0;
+    frame_stats_.uniform_bytes = 0;
+    frame_stats_.uniform_ring_bytes = 0;
 }
 
 void Smoke::on_key(Key key)
@@ -762,50 +1100,138 @@ void Smoke::on_tick()
     if (sim_paused_)
         return;
 
-    for (auto &worker : workers_)
-        worker->update_simulation();
+    // without frames to carry the simulation, step it here
+    if (settings_.no_render) {
+        scheduler_->parallel_for(static_cast<int>(sim_.objects().size()), sim_chunk_size,
+                [this](int begin, int end, int) {
+            update_simulation(1, begin, end);
+        });
+        return;
+    }
+
+    pending_ticks_++;
+}
+
+void Smoke::begin_uniform_data()
+{
+    // what this frame data allocated last time is no longer in use
+    uniform_ring_.begin_frame(frame_data_index_, uniform_frame_size_);
+
+    if (use_instancing_) {
+        // chunks write into the mesh ranges of one array
+        frame_param_offset_ = allocate_uniform_data(sizeof(ObjectParamBlock) * sim_.objects().size());
+    } else {
+        // shared by every object and written once
+        frame_param_offset_ = allocate_uniform_data(sizeof(FrameParamBlock));
+
+        FrameParamBlock *params = reinterpret_cast<FrameParamBlock *>(
+                uniform_ring_.data(frame_param_offset_));
+        memcpy(params->view_projection, glm::value_ptr(camera_.view_projection),
+                sizeof(camera_.view_projection));
+
+        uniform_bytes_.fetch_add(sizeof(FrameParamBlock), std::memory_order_relaxed);
+    }
 }
 
 void Smoke::on_frame(float frame_pred)
 {
     auto &data = frame_data_[frame_data_index_];
 
+    auto start = std::chrono::steady_clock::now();
+
+    // finish simulating the ticks handed to the last frame
+    scheduler_->wait();
+
+    auto sim_end = std::chrono::steady_clock::now();
+
     // wait for the last submission since we reuse frame data
     vk::assert_success(vk::WaitForFences(dev_, 1, &data.fence, true, UINT64_MAX));
     vk::assert_success(vk::ResetFences(dev_, 1, &data.fence));
 
+    // so are the secondaries recorded into this frame data's pools
+    worker_cmds_.begin_frame(frame_data_index_);
+
+    auto fence_end = std::chrono::steady_clock::now();
+
+    if (!use_push_constants_)
+        begin_uniform_data();
+
     const Shell::BackBuffer &back = shell_->context().acquired_back_buffer;
 
     // ignore frame_pred
-    for (auto &worker : workers_)
-        worker->draw_objects(framebuffers_[back.image_index]);
+    const VkFramebuffer fb = framebuffers_[back.image_index];
+    const int object_count = static_cast<int>(sim_.objects().size());
+    const int chunk_count = (object_count + frame_chunk_size - 1) / frame_chunk_size;
+    const int ticks = pending_ticks_;
+    pending_ticks_ = 0;
+
+    // record each chunk and then step it for the next frame
+    for (auto &count : mesh_instance_counts_)
+        count.store(0, std::memory_order_relaxed);
+    recorded_chunks_.store(0, std::memory_order_relaxed);
+    scheduler_->dispatch(object_count, frame_chunk_size,
+            [this, fb, ticks](int begin, int end, int thread) {
+        record_chunk(fb, begin, end, thread);
+        recorded_chunks_.fetch_add(1, std::memory_order_release);
+
+        if (ticks)
+            update_simulation(ticks, begin, end);
+    });
+
+    // help until every chunk is recorded and leave the rest of the
+    // simulation to the workers
+    scheduler_->help();
+    while (recorded_chunks_.load(std::memory_order_acquire) < chunk_count)
+        std::this_thread::yield();
+
+    // the workers are done recording; end what they left open
+    for (int i = 0; i < thread_count_; i++) {
+        if (chunk_scratch_[i].cmd)
+            end_worker_cmd(i);
+    }
+    worker_cmds_.take_finished(worker_cmds_recorded_);
+
+    const int visible = visible_objects_.exchange(0, std::memory_order_relaxed);
+
+    auto record_end = std::chrono::steady_clock::now();
 
     VkResult res = vk::BeginCommandBuffer(data.primary_cmd, &primary_cmd_begin_info_);
 
-    VkBufferMemoryBarrier buf_barrier = {};
-    buf_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-    buf_barrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
-    buf_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-    buf_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    buf_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    buf_barrier.buffer = data.buf;
-    buf_barrier.offset = 0;
-    buf_barrier.size = VK_WHOLE_SIZE;
-    vk::CmdPipelineBarrier(data.primary_cmd,
-            VK_PIPELINE_STAGE_HOST_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
-            0, 0, nullptr, 1, &buf_barrier, 0, nullptr);
+    if (!use_push_constants_) {
+        VkBufferMemoryBarrier buf_barrier = {};
+        buf_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        buf_barrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
+        buf_barrier.dstAccessMask = use_instancing_ ? VK_ACCESS_SHADER_READ_BIT : VK_ACCESS_UNIFORM_READ_BIT;
+        buf_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        buf_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        buf_barrier.buffer = uniform_buf_;
+        buf_barrier.offset = 0;
+        buf_barrier.size = VK_WHOLE_SIZE;
+        vk::CmdPipelineBarrier(data.primary_cmd,
+                VK_PIPELINE_STAGE_HOST_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                0, 0, nullptr, 1, &buf_barrier, 0, nullptr);
+    }
 
     render_pass_begin_info_.framebuffer = framebuffers_[back.image_index];
     render_pass_begin_info_.renderArea.extent = extent_;
-    vk::CmdBeginRenderPass(data.primary_cmd, &render_pass_begin_info_,
-            VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
-
     // record render pass commands
-    for (auto &worker : workers_)
-        worker->wait_idle();
-    vk::CmdExecuteCommands(data.primary_cmd,
-            static_cast<uint32_t>(data.worker_cmds.size()),
-            data.worker_cmds.data());
+    if (use_instancing_) {
+        vk::CmdBeginRenderPass(data.primary_cmd, &render_pass_begin_info_,
+                VK_SUBPASS_CONTENTS_INLINE);
+
+        draw_instances(data.primary_cmd);
+    } else {
+        vk::CmdBeginRenderPass(data.primary_cmd, &render_pass_begin_info_,
+                VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+        if (!worker_cmds_recorded_.empty()) {
+            vk::CmdExecuteCommands(data.primary_cmd,
+                    static_cast<uint32_t>(worker_cmds_recorded_.size()),
+                    worker_cmds_recorded_.data());
+        }
+
+        frame_stats_.draws += visible;
+    }
 
     vk::CmdEndRenderPass(data.primary_cmd);
     vk::EndCommandBuffer(data.primary_cmd);
@@ -819,97 +1245,15 @@ void Smoke::on_frame(float frame_pred)
 
     frame_data_index_ = (frame_data_index_ + 1) % frame_data_.size();
 
-    (void) res;
-}
-
-Smoke::Worker::Worker(Smoke &smoke, int index, int object_begin, int object_end)
-    : smoke_(smoke), index_(index),
-      object_begin_(object_begin), object_end_(object_end),
-      tick_interval_(1.0f / smoke.settings_.ticks_per_second), state_(INIT)
-{
-}
-
-void Smoke::Worker::start()
-{
-    state_ = IDLE;
-    thread_ = std::thread(Smoke::Worker::thread_loop, this);
-}
-
-void Smoke::Worker::stop()
-{
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        state_ = INIT;
-    }
-    state_cv_.notify_one();
-
-    thread_.join();
-}
-
-void Smoke::Worker::update_simulation()
-{
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        bool started = (state_ != INIT);
-
-        state_ = STEP;
-
-        // step directly
-        if (!started) {
-            smoke_.update_simulation(*this);
-            state_ = INIT;
-        }
-    }
-    state_cv_.notify_one();
-}
-
-void Smoke::Worker::draw_objects(VkFramebuffer fb)
-{
-    // wait for step_objects first
-    wait_idle();
-
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        bool started = (state_ != INIT);
-
-        fb_ = fb;
-        state_ = DRAW;
-
-        // render directly
-        if (!started) {
-            smoke_.draw_objects(*this);
-            state_ = INIT;
-        }
-    }
-    state_cv_.notify_one();
-}
-
-void Smoke::Worker::wait_idle()
-{
-    std::unique_lock<std::mutex> lock(mutex_);
-    bool started = (state_ != INIT);
-
-    if (started)
-        state_cv_.wait(lock, [this] { return (state_ == IDLE); });
-}
-
-void Smoke::Worker::update_loop()
-{
-    while (true) {
-        std::unique_lock<std::mutex> lock(mutex_);
-
-        state_cv_.wait(lock, [this] { return (state_ != IDLE); });
-        if (state_ == INIT)
-            break;
-
-        assert(state_ == STEP || state_ == DRAW);
-        if (state_ == STEP)
-            smoke_.update_simulation(*this);
-        else
-            smoke_.draw_objects(*this);
+    frame_stats_.frames++;
+    frame_stats_.visible += visible;
+    frame_stats_.uniform_bytes += uniform_bytes_.exchange(0, std::memory_order_relaxed);
+    if (!use_push_constants_)
+        frame_stats_.uniform_ring_bytes += uniform_ring_.frame_bytes();
+    frame_stats_.sim_wait += sim_end - start;
+    frame_stats_.fence_wait += fence_end - sim_end;
+    frame_stats_.record += record_end - fence_end;
+    frame_stats_.submit += std::chrono::steady_clock::now() - record_end;
 
-        state_ = IDLE;
-        lock.unlock();
-        state_cv_.notify_one();
-    }
+    (void) res;
 }
@@ -23,18 +23,22 @@
 #ifndef SMOKE_H
 #define SMOKE_H
 
-#include <condition_variable>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <memory>
-#include <mutex>
 #include <string>
-#include <thread>
 #include <vector>
 
 #include <vulkan/vulkan.h>
 #include <glm/glm.hpp>
 
+#include "CommandBufferAllocator.h"
+#include "Frustum.h"
+#include "RingAllocator.h"
 #include "Simulation.h"
 #include "Game.h"
+#include "TaskScheduler.h"
 
 class Meshes;
 
@@ -54,48 +58,15 @@ public:
 
     void on_frame(float frame_pred);
 
-private:
-    class Worker {
-    public:
-        Worker(Smoke &smoke, int index, int object_begin, int object_end);
-
-        void start();
-        void stop();
-        void update_simulation();
-        void draw_objects(VkFramebuffer fb);
-        void wait_idle();
-
-        Smoke &smoke_;
-
-        const int index_;
-        const int object_begin_;
-        const int object_end_;
-
-        const float tick_interval_;
-
-        VkFramebuffer fb_;
-
-    private:
-        enum State {
-            INIT,
-            IDLE,
-            STEP,
-            DRAW,
-        };
-
-        void update_loop();
-
-        static void thread_loop(Worker *worker) { worker->update_loop(); }
-
-        std::thread thread_;
-        std::mutex mutex_;
-        std::condition_variable state_cv_;
-        State state_;
-    };
+    void get_stage_timings(std::vector<StageTiming> &timings);
+    void get_counters(std::vector<Counter> &counters);
+    int object_count() const { return static_cast<int>(sim_.objects().size()); }
 
+private:
     struct Camera {
         glm::vec3 eye_pos;
         glm::mat4 view_projection;
+        Frustum frustum;
 
         Camera(float eye) : eye_pos(eye) {}
     };
@@ -105,18 +76,21 @@ private:
         VkFence fence;
 
         VkCommandBuffer primary_cmd;
-        std::vector<VkCommandBuffer> worker_cmds;
-
-        VkBuffer buf;
-        uint8_t *base;
-        VkDescriptorSet desc_set;
     };
 
     // called by the constructor
-    void init_workers();
+    void init_scheduler();
 
     bool multithread_;
+    int thread_count_;
     bool use_push_constants_;
+    bool use_instancing_;
+    bool use_culling_;
+    // draws per secondary command buffer before a worker starts another, or
+    // 0 for one per worker per frame
+    int max_cmd_draws_;
+    // where the mesh blob is cached, if anywhere
+    std::string mesh_cache_;
 
     // called mostly by on_key
     void update_camera();
@@ -125,9 +99,42 @@ private:
     Simulation sim_;
     Camera camera_;
 
-    std::vector<std::unique_ptr<Worker>> workers_;
+    std::unique_ptr<TaskScheduler> scheduler_;
+
+    // Ticks requested by on_tick since the last frame.  They are simulated
+    // by the frame's loop, each chunk right after it is recorded, so the
+    // simulation for the next frame overlaps recording and submission of
+    // this one and runs on while the shell presents.
+    int pending_ticks_;
+    std::atomic<int> recorded_chunks_;
+
+    // CPU time of the stages of on_frame since get_stage_timings, and
+    // counts since get_counters
+    struct FrameStats {
+        int frames;
+        int draws;
+        int visible;
+        std::chrono::steady_clock::duration sim_wait;
+        std::chrono::steady_clock::duration fence_wait;
+        std::chrono::steady_clock::duration record;
+        std::chrono::steady_clock::duration submit;
+        // uniform data written, and allocated with alignment padding
+        uint64_t uniform_bytes;
+        uint64_t uniform_ring_bytes;
+    };
+
+    void log_render_stats();
+
+    FrameStats frame_stats_;
+    // summed over threads
+    std::atomic<uint64_t> sim_cpu_ns_;
+    std::atomic<uint64_t> cull_cpu_ns_;
+    std::atomic<uint64_t> uniform_cpu_ns_;
+    std::atomic<uint64_t> uniform_bytes_;
+    std::atomic<int> visible_objects_;
 
     // called by attach_shell
+    void create_meshes();
     void create_render_pass();
     void create_shader_modules();
     void create_descriptor_set_layout();
@@ -138,9 +145,9 @@ private:
     void destroy_frame_data();
     void create_fences();
     void create_command_buffers();
-    void create_buffers();
-    void create_buffer_memory();
-    void create_descriptor_sets();
+    void create_uniform_buffer();
+    void create_uniform_memory();
+    void create_descriptor_set();
 
     VkPhysicalDevice physical_dev_;
     VkDevice dev_;
@@ -161,12 +168,25 @@ private:
     VkPipeline pipeline_;
 
     VkCommandPool primary_cmd_pool_;
-    std::vector<VkCommandPool> worker_cmd_pools_;
+    CommandBufferAllocator worker_cmds_;
     VkDescriptorPool desc_pool_;
-    VkDeviceMemory frame_data_mem_;
+    VkDescriptorSet desc_set_;
     std::vector<FrameData> frame_data_;
     int frame_data_index_;
 
+    // Uniform data is written afresh each frame into a persistently mapped
+    // ring, each frame data index taking a window of it.  Workers allocate
+    // the parameters of the objects they draw from the frame's window.
+    VkBuffer uniform_buf_;
+    VkDeviceMemory uniform_mem_;
+    VkDeviceSize uniform_alignment_;
+    // the most one frame can need
+    VkDeviceSize uniform_frame_size_;
+    RingAllocator uniform_ring_;
+    uint32_t object_param_stride_;
+    // the frame's FrameParamBlock, or its array of instances
+    uint32_t frame_param_offset_;
+
     VkClearValue render_pass_clear_value_;
     VkRenderPassBeginInfo render_pass_begin_info_;
 
@@ -176,20 +196,59 @@ private:
 
     // called by attach_swapchain
     void prepare_viewport(const VkExtent2D &extent);
-    void prepare_framebuffers(VkSwapchainKHR swapchain);
+    void prepare_framebuffers(const std::vector<VkImage> &images);
 
     VkExtent2D extent_;
     VkViewport viewport_;
     VkRect2D scissor_;
 
-    std::vector<VkImage> images_;
     std::vector<VkImageView> image_views_;
     std::vector<VkFramebuffer> framebuffers_;
 
-    // called by workers
-    void update_simulation(const Worker &worker);
-    void draw_object(const Simulation::Object &obj, FrameData &data, VkCommandBuffer cmd) const;
-    void draw_objects(Worker &worker);
+    // called by on_frame
+    void begin_uniform_data();
+
+    // called by on_frame from scheduler threads
+    void record_chunk(VkFramebuffer fb, int begin, int end, int thread);
+    void draw_object(const Simulation::Object &obj, uint32_t param_offset, VkCommandBuffer cmd) const;
+    void draw_objects(VkFramebuffer fb, const uint32_t *objects, int count, int thread);
+    void begin_worker_cmd(VkFramebuffer fb, int thread);
+    void end_worker_cmd(int thread);
+    uint32_t allocate_uniform_data(VkDeviceSize size);
+    uint32_t write_object_params(const uint32_t *objects, int count);
+    void write_instances(const uint32_t *objects, const uint32_t *mesh_counts);
+    void update_simulation(int ticks, int begin, int end);
+
+    // bounding sphere radius of each object, fixed as meshes and scales are
+    std::vector<float> cull_radii_;
+
+    // the visible objects of the chunk being recorded, before and after
+    // grouping by mesh, the thread's recording time since
+    // get_stage_timings, and the command buffer it is recording into, if
+    // any, with the draws recorded so far
+    struct ChunkScratch {
+        std::vector<uint32_t> visible;
+        std::vector<uint32_t> sorted;
+        uint64_t record_ns;
+        CommandBufferAllocator::Buffer *cmd;
+        int cmd_draws;
+
+        ChunkScratch() : record_ns(0), cmd(nullptr), cmd_draws(0) {}
+    };
+    std::vector<ChunkScratch> chunk_scratch_;
+    std::vector<std::string> record_timing_names_;
+
+    // Instanced drawing writes the objects' parameters grouped by mesh so
+    // that each mesh is drawn by one instanced draw.  Chunks reserve room in
+    // a mesh's range of instances for the objects they found visible.
+    void init_instances();
+    void draw_instances(VkCommandBuffer cmd);
+
+    std::vector<uint32_t> mesh_first_instances_;
+    std::array<std::atomic<uint32_t>, Meshes::MESH_COUNT> mesh_instance_counts_;
+
+    // the secondary command buffers recorded this frame
+    std::vector<VkCommandBuffer> worker_cmds_recorded_;
 };
 
 #endif // HOLOGRAM_H
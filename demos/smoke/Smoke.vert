@@ -3,13 +3,16 @@
 layout(location = 0) in vec3 in_pos;
 layout(location = 1) in vec3 in_normal;
 
-layout(std140, set = 0, binding = 0) readonly buffer param_block {
+layout(std140, set = 0, binding = 0) uniform object_block {
 	vec3 light_pos;
 	vec3 light_color;
 	mat4 model;
-	mat4 view_projection;
 } params;
 
+layout(std140, set = 0, binding = 1) uniform frame_block {
+	mat4 view_projection;
+} frame;
+
 out vec3 color;
 
 void main()
@@ -22,6 +25,6 @@ void main()
 	float brightness = dot(light_dir, world_normal) / length(light_dir) / length(world_normal);
 	brightness = abs(brightness);
 
-	gl_Position = params.view_projection * vec4(world_pos, 1.0);
+	gl_Position = frame.view_projection * vec4(world_pos, 1.0);
 	color = params.light_color * brightness;
 }
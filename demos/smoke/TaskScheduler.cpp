@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2016 Google, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include "TaskScheduler.h"
+
+namespace {
+
+// how long an idle worker polls for the next loop before sleeping; frames
+// run several loops back to back
+const int spin_iterations = 4096;
+
+inline uint64_t pack(uint32_t front, uint32_t back) { return (static_cast<uint64_t>(front) << 32) | back; }
+inline uint32_t front_of(uint64_t range) { return static_cast<uint32_t>(range >> 32); }
+inline uint32_t back_of(uint64_t range) { return static_cast<uint32_t>(range); }
+
+} // namespace
+
+void TaskScheduler::ChunkQueue::reset(uint32_t front, uint32_t back)
+{
+    range.store(pack(front, back), std::memory_order_relaxed);
+}
+
+bool TaskScheduler::ChunkQueue::pop_front(uint32_t &chunk)
+{
+    uint64_t cur = range.load(std::memory_order_relaxed);
+    while (front_of(cur) < back_of(cur)) {
+        if (range.compare_exchange_weak(cur, pack(front_of(cur) + 1, back_of(cur)),
+                    std::memory_order_relaxed)) {
+            chunk = front_of(cur);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool TaskScheduler::ChunkQueue::pop_back(uint32_t &chunk)
+{
+    uint64_t cur = range.load(std::memory_order_relaxed);
+    while (front_of(cur) < back_of(cur)) {
+        if (range.compare_exchange_weak(cur, pack(front_of(cur), back_of(cur) - 1),
+                    std::memory_order_relaxed)) {
+            chunk = back_of(cur) - 1;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+TaskScheduler::TaskScheduler(int thread_count)
+    : queues_(std::max(thread_count, 1)), dispatched_(false), count_(0), chunk_size_(1),
+      generation_(0), quit_(false), busy_workers_(0),
+      chunk_count_(0), steal_count_(0), loop_count_(0)
+{
+    for (auto &queue : queues_)
+        queue.reset(0, 0);
+
+    threads_.reserve(queues_.size() - 1);
+    for (int i = 1; i < this->thread_count(); i++)
+        threads_.emplace_back(&TaskScheduler::worker_loop, this, i);
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    wait();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+    }
+    loop_cv_.notify_all();
+
+    for (auto &thread : threads_)
+        thread.join();
+}
+
+void TaskScheduler::parallel_for(int count, int chunk_size, const LoopBody &body)
+{
+    if (count <= 0)
+        return;
+
+    chunk_size = std::max(chunk_size, 1);
+
+    // not worth waking anyone
+    if (threads_.empty() || count <= chunk_size) {
+        wait();
+
+        body(0, count, 0);
+
+        loop_count_++;
+        chunk_count_.fetch_add((count + chunk_size - 1) / chunk_size, std::memory_order_relaxed);
+        return;
+    }
+
+    dispatch(count, chunk_size, body);
+    wait();
+}
+
+void TaskScheduler::dispatch(int count, int chunk_size, const LoopBody &body)
+{
+    wait();
+
+    if (count <= 0)
+        return;
+
+    chunk_size = std::max(chunk_size, 1);
+    const int chunks = (count + chunk_size - 1) / chunk_size;
+
+    loop_count_++;
+
+    body_ = body;
+    count_ = count;
+    chunk_size_ = chunk_size;
+    dispatched_ = true;
+
+    // deal the chunks out evenly
+    const int threads = thread_count();
+    for (int i = 0; i < threads; i++) {
+        uint32_t front = static_cast<uint32_t>(static_cast<int64_t>(chunks) * i / threads);
+        uint32_t back = static_cast<uint32_t>(static_cast<int64_t>(chunks) * (i + 1) / threads);
+        queues_[i].reset(front, back);
+    }
+
+    if (threads_.empty())
+        return;
+
+    busy_workers_.store(static_cast<int>(threads_.size()), std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+    loop_cv_.notify_all();
+}
+
+void TaskScheduler::help()
+{
+    if (dispatched_)
+        run_chunks(0);
+}
+
+void TaskScheduler::wait()
+{
+    if (!dispatched_)
+        return;
+
+    run_chunks(0);
+
+    // wait for chunks still running elsewhere
+    while (busy_workers_.load(std::memory_order_acquire) > 0)
+        std::this_thread::yield();
+
+    body_ = nullptr;
+    dispatched_ = false;
+}
+
+void TaskScheduler::run_chunks(int thread)
+{
+    const int threads = thread_count();
+    uint64_t chunks = 0, steals = 0;
+
+    while (true) {
+        uint32_t chunk;
+        if (!queues_[thread].pop_front(chunk)) {
+            bool stolen = false;
+            for (int i = 1; i < threads && !stolen; i++)
+                stolen = queues_[(thread + i) % threads].pop_back(chunk);
+            if (!stolen)
+                break;
+
+            steals++;
+        }
+
+        const int begin = static_cast<int>(chunk) * chunk_size_;
+        const int end = std::min(begin + chunk_size_, count_);
+        body_(begin, end, thread);
+
+        chunks++;
+    }
+
+    chunk_count_.fetch_add(chunks, std::memory_order_relaxed);
+    steal_count_.fetch_add(steals, std::memory_order_relaxed);
+}
+
+void TaskScheduler::worker_loop(int thread)
+{
+    uint64_t seen = 0;
+
+    while (true) {
+        // poll briefly since the next loop usually follows soon
+        for (int i = 0; i < spin_iterations && generation_.load(std::memory_order_acquire) == seen; i++)
+            std::this_thread::yield();
+
+        if (generation_.load(std::memory_order_acquire) == seen) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            loop_cv_.wait(lock, [this, seen] {
+                return quit_ || generation_.load(std::memory_order_relaxed) != seen;
+            });
+            if (quit_)
+                break;
+        }
+
+        seen = generation_.load(std::memory_order_acquire);
+
+        run_chunks(thread);
+
+        busy_workers_.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+TaskScheduler::Stats TaskScheduler::reset_stats()
+{
+    Stats stats;
+    stats.loops = loop_count_;
+    stats.chunks = chunk_count_.exchange(0, std::memory_order_relaxed);
+    stats.steals = steal_count_.exchange(0, std::memory_order_relaxed);
+    loop_count_ = 0;
+
+    return stats;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2016 Google, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed pool of threads running chunked parallel-for loops with work
+// stealing.  The calling thread takes part as thread 0; worker threads are
+// 1 through thread_count() - 1, so per-thread resources can be indexed by
+// the thread argument passed to the loop body.
+class TaskScheduler {
+public:
+    explicit TaskScheduler(int thread_count);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler &) = delete;
+    TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+    int thread_count() const { return static_cast<int>(queues_.size()); }
+
+    typedef std::function<void(int begin, int end, int thread)> LoopBody;
+
+    // Calls body over [0, count) in chunks of at most chunk_size and returns
+    // once every chunk has run.  Each thread starts with an even share of
+    // the chunks and, once its share is done, steals from the far end of
+    // the others' shares, so uneven per-item cost does not leave threads
+    // idle.
+    void parallel_for(int count, int chunk_size, const LoopBody &body);
+
+    // Starts a loop like parallel_for but returns at once, leaving the
+    // workers to run it.  The caller may then help() with the loop and
+    // carry on with other work while the remaining chunks finish, and must
+    // wait() before touching what the loop writes.  A loop still running
+    // is waited for first.
+    void dispatch(int count, int chunk_size, const LoopBody &body);
+
+    // runs chunks of the dispatched loop on the calling thread until none
+    // are left to take; chunks other threads took may still be running
+    void help();
+
+    // helps with and then waits for the dispatched loop, if any
+    void wait();
+
+    struct Stats {
+        uint64_t loops;
+        uint64_t chunks;
+        uint64_t steals;
+    };
+    // counters since the last call
+    Stats reset_stats();
+
+private:
+    // A thread's remaining chunks [front, back) packed into one word.  The
+    // owner pops from the front and thieves from the back, both by CAS.
+    struct alignas(64) ChunkQueue {
+        std::atomic<uint64_t> range;
+
+        void reset(uint32_t front, uint32_t back);
+        bool pop_front(uint32_t &chunk);
+        bool pop_back(uint32_t &chunk);
+    };
+
+    void worker_loop(int thread);
+    void run_chunks(int thread);
+
+    std::vector<ChunkQueue> queues_;
+    std::vector<std::thread> threads_;
+
+    // the loop being run
+    LoopBody body_;
+    bool dispatched_;
+    int count_;
+    int chunk_size_;
+
+    std::mutex mutex_;
+    std::condition_variable loop_cv_;
+    std::atomic<uint64_t> generation_;
+    bool quit_;
+
+    // workers still inside the current loop
+    std::atomic<int> busy_workers_;
+
+    std::atomic<uint64_t> chunk_count_;
+    std::atomic<uint64_t> steal_count_;
+    uint64_t loop_count_;
+};
+
+#endif // TASK_SCHEDULER_H
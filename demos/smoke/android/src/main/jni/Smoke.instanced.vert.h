@@ -0,0 +1,389 @@
+#include <stdint.h>
+
+#if 0
+Smoke.instanced.vert
+
+
+Linked vertex stage:
+
+
+// Module Version 10000
+// Generated by (magic number): 80001
+// Id's are bound by 117
+
+                              Capability Shader
+               1:             ExtInstImport  "GLSL.std.450"
+                              MemoryModel Logical GLSL450
+                              EntryPoint Vertex 4  "main" 20 26 27 33 40
+                              Source ESSL 310
+                              Name 4  "main"
+                              Name 9  "world_light"
+                              Name 12  "instance_params"
+                              MemberName 12(instance_params) 0  "light_pos"
+                              MemberName 12(instance_params) 1  "light_color"
+                              MemberName 12(instance_params) 2  "model"
+                              Name 14  "instance_block"
+                              MemberName 14(instance_block) 0  "instances"
+                              Name 16  "params"
+                              Name 20  "gl_InstanceIndex"
+                              Name 26  "in_pos"
+                              Name 27  "in_normal"
+                              Name 31  "gl_PerVertex"
+                              MemberName 31(gl_PerVertex) 0  "gl_Position"
+                              MemberName 31(gl_PerVertex) 1  "gl_PointSize"
+                              Name 33  ""
+                              Name 34  "frame_block"
+                              MemberName 34(frame_block) 0  "view_projection"
+                              Name 36  "frame"
+                              Name 40  "color"
+                              Name 43  "world_pos"
+                              Name 44  "world_normal"
+                              Name 45  "light_dir"
+                              Name 46  "brightness"
+                              MemberDecorate 12(instance_params) 0 Offset 0
+                              MemberDecorate 12(instance_params) 1 Offset 16
+                              MemberDecorate 12(instance_params) 2 ColMajor
+                              MemberDecorate 12(instance_params) 2 Offset 32
+                              MemberDecorate 12(instance_params) 2 MatrixStride 16
+                              Decorate 13 ArrayStride 96
+                              MemberDecorate 14(instance_block) 0 Offset 0
+                              Decorate 14(instance_block) BufferBlock
+                              Decorate 16(params) DescriptorSet 0
+                              Decorate 16(params) Binding 0
+                              Decorate 20(gl_InstanceIndex) BuiltIn InstanceIndex
+                              Decorate 26(in_pos) Location 0
+                              Decorate 27(in_normal) Location 1
+                              MemberDecorate 31(gl_PerVertex) 0 BuiltIn Position
+                              MemberDecorate 31(gl_PerVertex) 1 BuiltIn PointSize
+                              Decorate 31(gl_PerVertex) Block
+                              MemberDecorate 34(frame_block) 0 ColMajor
+                              MemberDecorate 34(frame_block) 0 Offset 0
+                              MemberDecorate 34(frame_block) 0 MatrixStride 16
+                              Decorate 34(frame_block) Block
+               2:             TypeVoid
+               3:             TypeFunction 2
+               6:             TypeFloat 32
+               7:             TypeVector 6(float) 3
+               8:             TypePointer Function 7(fvec3)
+              10:             TypeVector 6(float) 4
+              11:             TypeMatrix 10(fvec4) 4
+12(instance_params):             TypeStruct 7(fvec3) 7(fvec3) 11
+              13:             TypeRuntimeArray 12(instance_params)
+14(instance_block):             TypeStruct 13
+              15:             TypePointer Uniform 14(instance_block)
+      16(params):     15(ptr) Variable Uniform
+              17:             TypeInt 32 1
+              18:     17(int) Constant 0
+              19:             TypePointer Input 17(int)
+20(gl_InstanceIndex):     19(ptr) Variable Input
+              21:     17(int) Constant 2
+              22:             TypePointer Uniform 11
+              23:             TypePointer Uniform 7(fvec3)
+              24:    6(float) Constant 1065353216
+              25:             TypePointer Input 7(fvec3)
+      26(in_pos):     25(ptr) Variable Input
+   27(in_normal):     25(ptr) Variable Input
+              28:             TypeMatrix 7(fvec3) 3
+              30:             TypePointer Function 6(float)
+31(gl_PerVertex):             TypeStruct 10(fvec4) 6(float)
+              32:             TypePointer Output 31(gl_PerVertex)
+              33:     32(ptr) Variable Output
+ 34(frame_block):             TypeStruct 11
+              35:             TypePointer PushConstant 34(frame_block)
+       36(frame):     35(ptr) Variable PushConstant
+              37:             TypePointer PushConstant 11
+              38:             TypePointer Output 10(fvec4)
+              39:             TypePointer Output 7(fvec3)
+       40(color):     39(ptr) Variable Output
+              41:     17(int) Constant 1
+         4(main):           2 Function None 3
+               5:             Label
+  9(world_light):      8(ptr) Variable Function
+   43(world_pos):      8(ptr) Variable Function
+44(world_normal):      8(ptr) Variable Function
+   45(light_dir):      8(ptr) Variable Function
+  46(brightness):     30(ptr) Variable Function
+              47:     17(int) Load 20(gl_InstanceIndex)
+              48:     22(ptr) AccessChain 16(params) 18 47 21
+              49:          11 Load 48
+              50:     23(ptr) AccessChain 16(params) 18 47 18
+              51:    7(fvec3) Load 50
+              52:    6(float) CompositeExtract 51 0
+              53:    6(float) CompositeExtract 51 1
+              54:    6(float) CompositeExtract 51 2
+              55:   10(fvec4) CompositeConstruct 52 53 54 24
+              56:   10(fvec4) MatrixTimesVector 49 55
+              57:    6(float) CompositeExtract 56 0
+              58:    6(float) CompositeExtract 56 1
+              59:    6(float) CompositeExtract 56 2
+              60:    7(fvec3) CompositeConstruct 57 58 59
+                              Store 9(world_light) 60
+              61:     22(ptr) AccessChain 16(params) 18 47 21
+              62:          11 Load 61
+              63:    7(fvec3) Load 26(in_pos)
+              64:    6(float) CompositeExtract 63 0
+              65:    6(float) CompositeExtract 63 1
+              66:    6(float) CompositeExtract 63 2
+              67:   10(fvec4) CompositeConstruct 64 65 66 24
+              68:   10(fvec4) MatrixTimesVector 62 67
+              69:    6(float) CompositeExtract 68 0
+              70:    6(float) CompositeExtract 68 1
+              71:    6(float) CompositeExtract 68 2
+              72:    7(fvec3) CompositeConstruct 69 70 71
+                              Store 43(world_pos) 72
+              73:     22(ptr) AccessChain 16(params) 18 47 21
+              74:          11 Load 73
+              75:    6(float) CompositeExtract 74 0 0
+              76:    6(float) CompositeExtract 74 0 1
+              77:    6(float) CompositeExtract 74 0 2
+              78:    6(float) CompositeExtract 74 1 0
+              79:    6(float) CompositeExtract 74 1 1
+              80:    6(float) CompositeExtract 74 1 2
+              81:    6(float) CompositeExtract 74 2 0
+              82:    6(float) CompositeExtract 74 2 1
+              83:    6(float) CompositeExtract 74 2 2
+              84:    7(fvec3) CompositeConstruct 75 76 77
+              85:    7(fvec3) CompositeConstruct 78 79 80
+              86:    7(fvec3) CompositeConstruct 81 82 83
+              87:          28 CompositeConstruct 84 85 86
+              88:    7(fvec3) Load 27(in_normal)
+              89:    7(fvec3) MatrixTimesVector 87 88
+                              Store 44(world_normal) 89
+              90:    7(fvec3) Load 9(world_light)
+              91:    7(fvec3) Load 43(world_pos)
+              92:    7(fvec3) FSub 90 91
+                              Store 45(light_dir) 92
+              93:    7(fvec3) Load 45(light_dir)
+              94:    7(fvec3) Load 44(world_normal)
+              95:    6(float) Dot 93 94
+              96:    7(fvec3) Load 45(light_dir)
+              97:    6(float) ExtInst 1(GLSL.std.450) 66(Length) 96
+              98:    6(float) FDiv 95 97
+              99:    7(fvec3) Load 44(world_normal)
+             100:    6(float) ExtInst 1(GLSL.std.450) 66(Length) 99
+             101:    6(float) FDiv 98 100
+                              Store 46(brightness) 101
+             102:    6(float) Load 46(brightness)
+             103:    6(float) ExtInst 1(GLSL.std.450) 4(FAbs) 102
+                              Store 46(brightness) 103
+             104:     37(ptr) AccessChain 36(frame) 18
+             105:          11 Load 104
+             106:    7(fvec3) Load 43(world_pos)
+             107:    6(float) CompositeExtract 106 0
+             108:    6(float) CompositeExtract 106 1
+             109:    6(float) CompositeExtract 106 2
+             110:   10(fvec4) CompositeConstruct 107 108 109 24
+             111:   10(fvec4) MatrixTimesVector 105 110
+             112:     38(ptr) AccessChain 33 18
+                              Store 112 111
+             113:     23(ptr) AccessChain 16(params) 18 47 41
+             114:    7(fvec3) Load 113
+             115:    6(float) Load 46(brightness)
+             116:    7(fvec3) VectorTimesScalar 114 115
+                              Store 40(color) 116
+                              Return
+                              FunctionEnd
+#endif
+
+static const uint32_t Smoke_instanced_vert[799] = {
+    0x07230203, 0x00010000, 0x00080001, 0x00000075,
+    0x00000000, 0x00020011, 0x00000001, 0x0006000b,
+    0x00000001, 0x4c534c47, 0x6474732e, 0x3035342e,
+    0x00000000, 0x0003000e, 0x00000000, 0x00000001,
+    0x000a000f, 0x00000000, 0x00000004, 0x6e69616d,
+    0x00000000, 0x00000014, 0x0000001a, 0x0000001b,
+    0x00000021, 0x00000028, 0x00030003, 0x00000001,
+    0x00000136, 0x00040005, 0x00000004, 0x6e69616d,
+    0x00000000, 0x00050005, 0x00000009, 0x6c726f77,
+    0x696c5f64, 0x00746867, 0x00060005, 0x0000000c,
+    0x74736e69, 0x65636e61, 0x7261705f, 0x00736d61,
+    0x00060006, 0x0000000c, 0x00000000, 0x6867696c,
+    0x6f705f74, 0x00000073, 0x00060006, 0x0000000c,
+    0x00000001, 0x6867696c, 0x6f635f74, 0x00726f6c,
+    0x00050006, 0x0000000c, 0x00000002, 0x65646f6d,
+    0x0000006c, 0x00060005, 0x0000000e, 0x74736e69,
+    0x65636e61, 0x6f6c625f, 0x00006b63, 0x00060006,
+    0x0000000e, 0x00000000, 0x74736e69, 0x65636e61,
+    0x00000073, 0x00040005, 0x00000010, 0x61726170,
+    0x0000736d, 0x00070005, 0x00000014, 0x495f6c67,
+    0x6174736e, 0x4965636e, 0x7865646e, 0x00000000,
+    0x00040005, 0x0000001a, 0x705f6e69, 0x0000736f,
+    0x00050005, 0x0000001b, 0x6e5f6e69, 0x616d726f,
+    0x0000006c, 0x00060005, 0x0000001f, 0x505f6c67,
+    0x65567265, 0x78657472, 0x00000000, 0x00060006,
+    0x0000001f, 0x00000000, 0x505f6c67, 0x7469736f,
+    0x006e6f69, 0x00070006, 0x0000001f, 0x00000001,
+    0x505f6c67, 0x746e696f, 0x657a6953, 0x00000000,
+    0x00030005, 0x00000021, 0x00000000, 0x00050005,
+    0x00000022, 0x6d617266, 0x6c625f65, 0x006b636f,
+    0x00070006, 0x00000022, 0x00000000, 0x77656976,
+    0x6f72705f, 0x7463656a, 0x006e6f69, 0x00040005,
+    0x00000024, 0x6d617266, 0x00000065, 0x00040005,
+    0x00000028, 0x6f6c6f63, 0x00000072, 0x00050005,
+    0x0000002b, 0x6c726f77, 0x6f705f64, 0x00000073,
+    0x00060005, 0x0000002c, 0x6c726f77, 0x6f6e5f64,
+    0x6c616d72, 0x00000000, 0x00050005, 0x0000002d,
+    0x6867696c, 0x69645f74, 0x00000072, 0x00050005,
+    0x0000002e, 0x67697262, 0x656e7468, 0x00007373,
+    0x00050048, 0x0000000c, 0x00000000, 0x00000023,
+    0x00000000, 0x00050048, 0x0000000c, 0x00000001,
+    0x00000023, 0x00000010, 0x00040048, 0x0000000c,
+    0x00000002, 0x00000005, 0x00050048, 0x0000000c,
+    0x00000002, 0x00000023, 0x00000020, 0x00050048,
+    0x0000000c, 0x00000002, 0x00000007, 0x00000010,
+    0x00040047, 0x0000000d, 0x00000006, 0x00000060,
+    0x00050048, 0x0000000e, 0x00000000, 0x00000023,
+    0x00000000, 0x00030047, 0x0000000e, 0x00000003,
+    0x00040047, 0x00000010, 0x00000022, 0x00000000,
+    0x00040047, 0x00000010, 0x00000021, 0x00000000,
+    0x00040047, 0x00000014, 0x0000000b, 0x0000002b,
+    0x00040047, 0x0000001a, 0x0000001e, 0x00000000,
+    0x00040047, 0x0000001b, 0x0000001e, 0x00000001,
+    0x00050048, 0x0000001f, 0x00000000, 0x0000000b,
+    0x00000000, 0x00050048, 0x0000001f, 0x00000001,
+    0x0000000b, 0x00000001, 0x00030047, 0x0000001f,
+    0x00000002, 0x00040048, 0x00000022, 0x00000000,
+    0x00000005, 0x00050048, 0x00000022, 0x00000000,
+    0x00000023, 0x00000000, 0x00050048, 0x00000022,
+    0x00000000, 0x00000007, 0x00000010, 0x00030047,
+    0x00000022, 0x00000002, 0x00020013, 0x00000002,
+    0x00030021, 0x00000003, 0x00000002, 0x00030016,
+    0x00000006, 0x00000020, 0x00040017, 0x00000007,
+    0x00000006, 0x00000003, 0x00040020, 0x00000008,
+    0x00000007, 0x00000007, 0x00040017, 0x0000000a,
+    0x00000006, 0x00000004, 0x00040018, 0x0000000b,
+    0x0000000a, 0x00000004, 0x0005001e, 0x0000000c,
+    0x00000007, 0x00000007, 0x0000000b, 0x0003001d,
+    0x0000000d, 0x0000000c, 0x0003001e, 0x0000000e,
+    0x0000000d, 0x00040020, 0x0000000f, 0x00000002,
+    0x0000000e, 0x0004003b, 0x0000000f, 0x00000010,
+    0x00000002, 0x00040015, 0x00000011, 0x00000020,
+    0x00000001, 0x0004002b, 0x00000011, 0x00000012,
+    0x00000000, 0x00040020, 0x00000013, 0x00000001,
+    0x00000011, 0x0004003b, 0x00000013, 0x00000014,
+    0x00000001, 0x0004002b, 0x00000011, 0x00000015,
+    0x00000002, 0x00040020, 0x00000016, 0x00000002,
+    0x0000000b, 0x00040020, 0x00000017, 0x00000002,
+    0x00000007, 0x0004002b, 0x00000006, 0x00000018,
+    0x3f800000, 0x00040020, 0x00000019, 0x00000001,
+    0x00000007, 0x0004003b, 0x00000019, 0x0000001a,
+    0x00000001, 0x0004003b, 0x00000019, 0x0000001b,
+    0x00000001, 0x00040018, 0x0000001c, 0x00000007,
+    0x00000003, 0x00040020, 0x0000001e, 0x00000007,
+    0x00000006, 0x0004001e, 0x0000001f, 0x0000000a,
+    0x00000006, 0x00040020, 0x00000020, 0x00000003,
+    0x0000001f, 0x0004003b, 0x00000020, 0x00000021,
+    0x00000003, 0x0003001e, 0x00000022, 0x0000000b,
+    0x00040020, 0x00000023, 0x00000009, 0x00000022,
+    0x0004003b, 0x00000023, 0x00000024, 0x00000009,
+    0x00040020, 0x00000025, 0x00000009, 0x0000000b,
+    0x00040020, 0x00000026, 0x00000003, 0x0000000a,
+    0x00040020, 0x00000027, 0x00000003, 0x00000007,
+    0x0004003b, 0x00000027, 0x00000028, 0x00000003,
+    0x0004002b, 0x00000011, 0x00000029, 0x00000001,
+    0x00050036, 0x00000002, 0x00000004, 0x00000000,
+    0x00000003, 0x000200f8, 0x00000005, 0x0004003b,
+    0x00000008, 0x00000009, 0x00000007, 0x0004003b,
+    0x00000008, 0x0000002b, 0x00000007, 0x0004003b,
+    0x00000008, 0x0000002c, 0x00000007, 0x0004003b,
+    0x00000008, 0x0000002d, 0x00000007, 0x0004003b,
+    0x0000001e, 0x0000002e, 0x00000007, 0x0004003d,
+    0x00000011, 0x0000002f, 0x00000014, 0x00070041,
+    0x00000016, 0x00000030, 0x00000010, 0x00000012,
+    0x0000002f, 0x00000015, 0x0004003d, 0x0000000b,
+    0x00000031, 0x00000030, 0x00070041, 0x00000017,
+    0x00000032, 0x00000010, 0x00000012, 0x0000002f,
+    0x00000012, 0x0004003d, 0x00000007, 0x00000033,
+    0x00000032, 0x00050051, 0x00000006, 0x00000034,
+    0x00000033, 0x00000000, 0x00050051, 0x00000006,
+    0x00000035, 0x00000033, 0x00000001, 0x00050051,
+    0x00000006, 0x00000036, 0x00000033, 0x00000002,
+    0x00070050, 0x0000000a, 0x00000037, 0x00000034,
+    0x00000035, 0x00000036, 0x00000018, 0x00050091,
+    0x0000000a, 0x00000038, 0x00000031, 0x00000037,
+    0x00050051, 0x00000006, 0x00000039, 0x00000038,
+    0x00000000, 0x00050051, 0x00000006, 0x0000003a,
+    0x00000038, 0x00000001, 0x00050051, 0x00000006,
+    0x0000003b, 0x00000038, 0x00000002, 0x00060050,
+    0x00000007, 0x0000003c, 0x00000039, 0x0000003a,
+    0x0000003b, 0x0003003e, 0x00000009, 0x0000003c,
+    0x00070041, 0x00000016, 0x0000003d, 0x00000010,
+    0x00000012, 0x0000002f, 0x00000015, 0x0004003d,
+    0x0000000b, 0x0000003e, 0x0000003d, 0x0004003d,
+    0x00000007, 0x0000003f, 0x0000001a, 0x00050051,
+    0x00000006, 0x00000040, 0x0000003f, 0x00000000,
+    0x00050051, 0x00000006, 0x00000041, 0x0000003f,
+    0x00000001, 0x00050051, 0x00000006, 0x00000042,
+    0x0000003f, 0x00000002, 0x00070050, 0x0000000a,
+    0x00000043, 0x00000040, 0x00000041, 0x00000042,
+    0x00000018, 0x00050091, 0x0000000a, 0x00000044,
+    0x0000003e, 0x00000043, 0x00050051, 0x00000006,
+    0x00000045, 0x00000044, 0x00000000, 0x00050051,
+    0x00000006, 0x00000046, 0x00000044, 0x00000001,
+    0x00050051, 0x00000006, 0x00000047, 0x00000044,
+    0x00000002, 0x00060050, 0x00000007, 0x00000048,
+    0x00000045, 0x00000046, 0x00000047, 0x0003003e,
+    0x0000002b, 0x00000048, 0x00070041, 0x00000016,
+    0x00000049, 0x00000010, 0x00000012, 0x0000002f,
+    0x00000015, 0x0004003d, 0x0000000b, 0x0000004a,
+    0x00000049, 0x00060051, 0x00000006, 0x0000004b,
+    0x0000004a, 0x00000000, 0x00000000, 0x00060051,
+    0x00000006, 0x0000004c, 0x0000004a, 0x00000000,
+    0x00000001, 0x00060051, 0x00000006, 0x0000004d,
+    0x0000004a, 0x00000000, 0x00000002, 0x00060051,
+    0x00000006, 0x0000004e, 0x0000004a, 0x00000001,
+    0x00000000, 0x00060051, 0x00000006, 0x0000004f,
+    0x0000004a, 0x00000001, 0x00000001, 0x00060051,
+    0x00000006, 0x00000050, 0x0000004a, 0x00000001,
+    0x00000002, 0x00060051, 0x00000006, 0x00000051,
+    0x0000004a, 0x00000002, 0x00000000, 0x00060051,
+    0x00000006, 0x00000052, 0x0000004a, 0x00000002,
+    0x00000001, 0x00060051, 0x00000006, 0x00000053,
+    0x0000004a, 0x00000002, 0x00000002, 0x00060050,
+    0x00000007, 0x00000054, 0x0000004b, 0x0000004c,
+    0x0000004d, 0x00060050, 0x00000007, 0x00000055,
+    0x0000004e, 0x0000004f, 0x00000050, 0x00060050,
+    0x00000007, 0x00000056, 0x00000051, 0x00000052,
+    0x00000053, 0x00060050, 0x0000001c, 0x00000057,
+    0x00000054, 0x00000055, 0x00000056, 0x0004003d,
+    0x00000007, 0x00000058, 0x0000001b, 0x00050091,
+    0x00000007, 0x00000059, 0x00000057, 0x00000058,
+    0x0003003e, 0x0000002c, 0x00000059, 0x0004003d,
+    0x00000007, 0x0000005a, 0x00000009, 0x0004003d,
+    0x00000007, 0x0000005b, 0x0000002b, 0x00050083,
+    0x00000007, 0x0000005c, 0x0000005a, 0x0000005b,
+    0x0003003e, 0x0000002d, 0x0000005c, 0x0004003d,
+    0x00000007, 0x0000005d, 0x0000002d, 0x0004003d,
+    0x00000007, 0x0000005e, 0x0000002c, 0x00050094,
+    0x00000006, 0x0000005f, 0x0000005d, 0x0000005e,
+    0x0004003d, 0x00000007, 0x00000060, 0x0000002d,
+    0x0006000c, 0x00000006, 0x00000061, 0x00000001,
+    0x00000042, 0x00000060, 0x00050088, 0x00000006,
+    0x00000062, 0x0000005f, 0x00000061, 0x0004003d,
+    0x00000007, 0x00000063, 0x0000002c, 0x0006000c,
+    0x00000006, 0x00000064, 0x00000001, 0x00000042,
+    0x00000063, 0x00050088, 0x00000006, 0x00000065,
+    0x00000062, 0x00000064, 0x0003003e, 0x0000002e,
+    0x00000065, 0x0004003d, 0x00000006, 0x00000066,
+    0x0000002e, 0x0006000c, 0x00000006, 0x00000067,
+    0x00000001, 0x00000004, 0x00000066, 0x0003003e,
+    0x0000002e, 0x00000067, 0x00050041, 0x00000025,
+    0x00000068, 0x00000024, 0x00000012, 0x0004003d,
+    0x0000000b, 0x00000069, 0x00000068, 0x0004003d,
+    0x00000007, 0x0000006a, 0x0000002b, 0x00050051,
+    0x00000006, 0x0000006b, 0x0000006a, 0x00000000,
+    0x00050051, 0x00000006, 0x0000006c, 0x0000006a,
+    0x00000001, 0x00050051, 0x00000006, 0x0000006d,
+    0x0000006a, 0x00000002, 0x00070050, 0x0000000a,
+    0x0000006e, 0x0000006b, 0x0000006c, 0x0000006d,
+    0x00000018, 0x00050091, 0x0000000a, 0x0000006f,
+    0x00000069, 0x0000006e, 0x00050041, 0x00000026,
+    0x00000070, 0x00000021, 0x00000012, 0x0003003e,
+    0x00000070, 0x0000006f, 0x00070041, 0x00000017,
+    0x00000071, 0x00000010, 0x00000012, 0x0000002f,
+    0x00000029, 0x0004003d, 0x00000007, 0x00000072,
+    0x00000071, 0x0004003d, 0x00000006, 0x00000073,
+    0x0000002e, 0x0005008e, 0x00000007, 0x00000074,
+    0x00000072, 0x00000073, 0x0003003e, 0x00000028,
+    0x00000074, 0x000100fd, 0x00010038,
+};
@@ -1,8 +1,7 @@
 #include <stdint.h>
 
 #if 0
-/usr/local/google/home/olv/khronos/VulkanSamples/Demos/Hologram/Hologram.vert
-Warning, version 310 is not yet complete; most version-specific features are present, but some are missing.
+Smoke.vert
 
 
 Linked vertex stage:
@@ -10,20 +9,20 @@ Linked vertex stage:
 
 // Module Version 10000
 // Generated by (magic number): 80001
-// Id's are bound by 108
+// Id's are bound by 110
+
 
                               Capability Shader
                1:             ExtInstImport  "GLSL.std.450"
                               MemoryModel Logical GLSL450
-                              EntryPoint Vertex 4  "main" 38 67 89 102
+                              EntryPoint Vertex 4  "main" 38 67 89 104
                               Source ESSL 310
                               Name 4  "main"
                               Name 9  "world_light"
-                              Name 12  "param_block"
-                              MemberName 12(param_block) 0  "light_pos"
-                              MemberName 12(param_block) 1  "light_color"
-                              MemberName 12(param_block) 2  "model"
-                              MemberName 12(param_block) 3  "view_projection"
+                              Name 12  "object_block"
+                              MemberName 12(object_block) 0  "light_pos"
+                              MemberName 12(object_block) 1  "light_color"
+                              MemberName 12(object_block) 2  "model"
                               Name 14  "params"
                               Name 34  "world_pos"
                               Name 38  "in_pos"
@@ -35,16 +34,16 @@ Linked vertex stage:
                               MemberName 87(gl_PerVertex) 0  "gl_Position"
                               MemberName 87(gl_PerVertex) 1  "gl_PointSize"
                               Name 89  ""
-                              Name 102  "color"
-                              MemberDecorate 12(param_block) 0 Offset 0
-                              MemberDecorate 12(param_block) 1 Offset 16
-                              MemberDecorate 12(param_block) 2 ColMajor
-                              MemberDecorate 12(param_block) 2 Offset 32
-                              MemberDecorate 12(param_block) 2 MatrixStride 16
-                              MemberDecorate 12(param_block) 3 ColMajor
-                              MemberDecorate 12(param_block) 3 Offset 96
-                              MemberDecorate 12(param_block) 3 MatrixStride 16
-                              Decorate 12(param_block) BufferBlock
+                              Name 90  "frame_block"
+                              MemberName 90(frame_block) 0  "view_projection"
+                              Name 92  "frame"
+                              Name 104  "color"
+                              MemberDecorate 12(object_block) 0 Offset 0
+                              MemberDecorate 12(object_block) 1 Offset 16
+                              MemberDecorate 12(object_block) 2 ColMajor
+                              MemberDecorate 12(object_block) 2 Offset 32
+                              MemberDecorate 12(object_block) 2 MatrixStride 16
+                              Decorate 12(object_block) Block
                               Decorate 14(params) DescriptorSet 0
                               Decorate 14(params) Binding 0
                               Decorate 38(in_pos) Location 0
@@ -52,6 +51,12 @@ Linked vertex stage:
                               MemberDecorate 87(gl_PerVertex) 0 BuiltIn Position
                               MemberDecorate 87(gl_PerVertex) 1 BuiltIn PointSize
                               Decorate 87(gl_PerVertex) Block
+                              MemberDecorate 90(frame_block) 0 ColMajor
+                              MemberDecorate 90(frame_block) 0 Offset 0
+                              MemberDecorate 90(frame_block) 0 MatrixStride 16
+                              Decorate 90(frame_block) Block
+                              Decorate 92(frame) DescriptorSet 0
+                              Decorate 92(frame) Binding 1
                2:             TypeVoid
                3:             TypeFunction 2
                6:             TypeFloat 32
@@ -59,8 +64,8 @@ Linked vertex stage:
                8:             TypePointer Function 7(fvec3)
               10:             TypeVector 6(float) 4
               11:             TypeMatrix 10(fvec4) 4
- 12(param_block):             TypeStruct 7(fvec3) 7(fvec3) 11 11
-              13:             TypePointer Uniform 12(param_block)
+ 12(object_block):             TypeStruct 7(fvec3) 7(fvec3) 11
+              13:             TypePointer Uniform 12(object_block)
       14(params):     13(ptr) Variable Uniform
               15:             TypeInt 32 1
               16:     15(int) Constant 2
@@ -77,11 +82,13 @@ Linked vertex stage:
 87(gl_PerVertex):             TypeStruct 10(fvec4) 6(float)
               88:             TypePointer Output 87(gl_PerVertex)
               89:     88(ptr) Variable Output
-              90:     15(int) Constant 3
-              99:             TypePointer Output 10(fvec4)
-             101:             TypePointer Output 7(fvec3)
-      102(color):    101(ptr) Variable Output
-             103:     15(int) Constant 1
+ 90(frame_block):             TypeStruct 11
+              91:             TypePointer Uniform 90(frame_block)
+       92(frame):     91(ptr) Variable Uniform
+             101:             TypePointer Output 10(fvec4)
+             103:             TypePointer Output 7(fvec3)
+      104(color):    103(ptr) Variable Output
+             105:     15(int) Constant 1
          4(main):           2 Function None 3
                5:             Label
   9(world_light):      8(ptr) Variable Function
@@ -151,68 +158,67 @@ Linked vertex stage:
               85:    6(float) Load 75(brightness)
               86:    6(float) ExtInst 1(GLSL.std.450) 4(FAbs) 85
                               Store 75(brightness) 86
-              91:     17(ptr) AccessChain 14(params) 90
-              92:          11 Load 91
-              93:    7(fvec3) Load 34(world_pos)
-              94:    6(float) CompositeExtract 93 0
-              95:    6(float) CompositeExtract 93 1
-              96:    6(float) CompositeExtract 93 2
-              97:   10(fvec4) CompositeConstruct 94 95 96 24
-              98:   10(fvec4) MatrixTimesVector 92 97
-             100:     99(ptr) AccessChain 89 20
-                              Store 100 98
-             104:     21(ptr) AccessChain 14(params) 103
-             105:    7(fvec3) Load 104
-             106:    6(float) Load 75(brightness)
-             107:    7(fvec3) VectorTimesScalar 105 106
-                              Store 102(color) 107
+              93:     17(ptr) AccessChain 92(frame) 20
+              94:          11 Load 93
+              95:    7(fvec3) Load 34(world_pos)
+              96:    6(float) CompositeExtract 95 0
+              97:    6(float) CompositeExtract 95 1
+              98:    6(float) CompositeExtract 95 2
+              99:   10(fvec4) CompositeConstruct 96 97 98 24
+             100:   10(fvec4) MatrixTimesVector 94 99
+             102:    101(ptr) AccessChain 89 20
+                              Store 102 100
+             106:     21(ptr) AccessChain 14(params) 105
+             107:    7(fvec3) Load 106
+             108:    6(float) Load 75(brightness)
+             109:    7(fvec3) VectorTimesScalar 107 108
+                              Store 104(color) 109
                               Return
                               FunctionEnd
 #endif
 
-static const uint32_t Smoke_vert[719] = {
-    0x07230203, 0x00010000, 0x00080001, 0x0000006c,
+static const uint32_t Smoke_vert[746] = {
+    0x07230203, 0x00010000, 0x00080001, 0x0000006e,
     0x00000000, 0x00020011, 0x00000001, 0x0006000b,
     0x00000001, 0x4c534c47, 0x6474732e, 0x3035342e,
     0x00000000, 0x0003000e, 0x00000000, 0x00000001,
     0x0009000f, 0x00000000, 0x00000004, 0x6e69616d,
     0x00000000, 0x00000026, 0x00000043, 0x00000059,
-    0x00000066, 0x00030003, 0x00000001, 0x00000136,
+    0x00000068, 0x00030003, 0x00000001, 0x00000136,
     0x00040005, 0x00000004, 0x6e69616d, 0x00000000,
     0x00050005, 0x00000009, 0x6c726f77, 0x696c5f64,
-    0x00746867, 0x00050005, 0x0000000c, 0x61726170,
-    0x6c625f6d, 0x006b636f, 0x00060006, 0x0000000c,
-    0x00000000, 0x6867696c, 0x6f705f74, 0x00000073,
-    0x00060006, 0x0000000c, 0x00000001, 0x6867696c,
-    0x6f635f74, 0x00726f6c, 0x00050006, 0x0000000c,
-    0x00000002, 0x65646f6d, 0x0000006c, 0x00070006,
-    0x0000000c, 0x00000003, 0x77656976, 0x6f72705f,
-    0x7463656a, 0x006e6f69, 0x00040005, 0x0000000e,
-    0x61726170, 0x0000736d, 0x00050005, 0x00000022,
-    0x6c726f77, 0x6f705f64, 0x00000073, 0x00040005,
-    0x00000026, 0x705f6e69, 0x0000736f, 0x00060005,
-    0x00000031, 0x6c726f77, 0x6f6e5f64, 0x6c616d72,
-    0x00000000, 0x00050005, 0x00000043, 0x6e5f6e69,
-    0x616d726f, 0x0000006c, 0x00050005, 0x00000046,
-    0x6867696c, 0x69645f74, 0x00000072, 0x00050005,
-    0x0000004b, 0x67697262, 0x656e7468, 0x00007373,
-    0x00060005, 0x00000057, 0x505f6c67, 0x65567265,
-    0x78657472, 0x00000000, 0x00060006, 0x00000057,
-    0x00000000, 0x505f6c67, 0x7469736f, 0x006e6f69,
-    0x00070006, 0x00000057, 0x00000001, 0x505f6c67,
-    0x746e696f, 0x657a6953, 0x00000000, 0x00030005,
-    0x00000059, 0x00000000, 0x00040005, 0x00000066,
-    0x6f6c6f63, 0x00000072, 0x00050048, 0x0000000c,
-    0x00000000, 0x00000023, 0x00000000, 0x00050048,
-    0x0000000c, 0x00000001, 0x00000023, 0x00000010,
-    0x00040048, 0x0000000c, 0x00000002, 0x00000005,
-    0x00050048, 0x0000000c, 0x00000002, 0x00000023,
-    0x00000020, 0x00050048, 0x0000000c, 0x00000002,
-    0x00000007, 0x00000010, 0x00040048, 0x0000000c,
-    0x00000003, 0x00000005, 0x00050048, 0x0000000c,
-    0x00000003, 0x00000023, 0x00000060, 0x00050048,
-    0x0000000c, 0x00000003, 0x00000007, 0x00000010,
-    0x00030047, 0x0000000c, 0x00000003, 0x00040047,
+    0x00746867, 0x00060005, 0x0000000c, 0x656a626f,
+    0x625f7463, 0x6b636f6c, 0x00000000, 0x00060006,
+    0x0000000c, 0x00000000, 0x6867696c, 0x6f705f74,
+    0x00000073, 0x00060006, 0x0000000c, 0x00000001,
+    0x6867696c, 0x6f635f74, 0x00726f6c, 0x00050006,
+    0x0000000c, 0x00000002, 0x65646f6d, 0x0000006c,
+    0x00040005, 0x0000000e, 0x61726170, 0x0000736d,
+    0x00050005, 0x00000022, 0x6c726f77, 0x6f705f64,
+    0x00000073, 0x00040005, 0x00000026, 0x705f6e69,
+    0x0000736f, 0x00060005, 0x00000031, 0x6c726f77,
+    0x6f6e5f64, 0x6c616d72, 0x00000000, 0x00050005,
+    0x00000043, 0x6e5f6e69, 0x616d726f, 0x0000006c,
+    0x00050005, 0x00000046, 0x6867696c, 0x69645f74,
+    0x00000072, 0x00050005, 0x0000004b, 0x67697262,
+    0x656e7468, 0x00007373, 0x00060005, 0x00000057,
+    0x505f6c67, 0x65567265, 0x78657472, 0x00000000,
+    0x00060006, 0x00000057, 0x00000000, 0x505f6c67,
+    0x7469736f, 0x006e6f69, 0x00070006, 0x00000057,
+    0x00000001, 0x505f6c67, 0x746e696f, 0x657a6953,
+    0x00000000, 0x00030005, 0x00000059, 0x00000000,
+    0x00050005, 0x0000005a, 0x6d617266, 0x6c625f65,
+    0x006b636f, 0x00070006, 0x0000005a, 0x00000000,
+    0x77656976, 0x6f72705f, 0x7463656a, 0x006e6f69,
+    0x00040005, 0x0000005c, 0x6d617266, 0x00000065,
+    0x00040005, 0x00000068, 0x6f6c6f63, 0x00000072,
+    0x00050048, 0x0000000c, 0x00000000, 0x00000023,
+    0x00000000, 0x00050048, 0x0000000c, 0x00000001,
+    0x00000023, 0x00000010, 0x00040048, 0x0000000c,
+    0x00000002, 0x00000005, 0x00050048, 0x0000000c,
+    0x00000002, 0x00000023, 0x00000020, 0x00050048,
+    0x0000000c, 0x00000002, 0x00000007, 0x00000010,
+    0x00030047, 0x0000000c, 0x00000002, 0x00040047,
     0x0000000e, 0x00000022, 0x00000000, 0x00040047,
     0x0000000e, 0x00000021, 0x00000000, 0x00040047,
     0x00000026, 0x0000001e, 0x00000000, 0x00040047,
@@ -220,14 +226,20 @@ static const uint32_t Smoke_vert[719] = {
     0x00000057, 0x00000000, 0x0000000b, 0x00000000,
     0x00050048, 0x00000057, 0x00000001, 0x0000000b,
     0x00000001, 0x00030047, 0x00000057, 0x00000002,
-    0x00020013, 0x00000002, 0x00030021, 0x00000003,
-    0x00000002, 0x00030016, 0x00000006, 0x00000020,
-    0x00040017, 0x00000007, 0x00000006, 0x00000003,
-    0x00040020, 0x00000008, 0x00000007, 0x00000007,
-    0x00040017, 0x0000000a, 0x00000006, 0x00000004,
-    0x00040018, 0x0000000b, 0x0000000a, 0x00000004,
-    0x0006001e, 0x0000000c, 0x00000007, 0x00000007,
-    0x0000000b, 0x0000000b, 0x00040020, 0x0000000d,
+    0x00040048, 0x0000005a, 0x00000000, 0x00000005,
+    0x00050048, 0x0000005a, 0x00000000, 0x00000023,
+    0x00000000, 0x00050048, 0x0000005a, 0x00000000,
+    0x00000007, 0x00000010, 0x00030047, 0x0000005a,
+    0x00000002, 0x00040047, 0x0000005c, 0x00000022,
+    0x00000000, 0x00040047, 0x0000005c, 0x00000021,
+    0x00000001, 0x00020013, 0x00000002, 0x00030021,
+    0x00000003, 0x00000002, 0x00030016, 0x00000006,
+    0x00000020, 0x00040017, 0x00000007, 0x00000006,
+    0x00000003, 0x00040020, 0x00000008, 0x00000007,
+    0x00000007, 0x00040017, 0x0000000a, 0x00000006,
+    0x00000004, 0x00040018, 0x0000000b, 0x0000000a,
+    0x00000004, 0x0005001e, 0x0000000c, 0x00000007,
+    0x00000007, 0x0000000b, 0x00040020, 0x0000000d,
     0x00000002, 0x0000000c, 0x0004003b, 0x0000000d,
     0x0000000e, 0x00000002, 0x00040015, 0x0000000f,
     0x00000020, 0x00000001, 0x0004002b, 0x0000000f,
@@ -244,111 +256,113 @@ static const uint32_t Smoke_vert[719] = {
     0x00000007, 0x00000006, 0x0004001e, 0x00000057,
     0x0000000a, 0x00000006, 0x00040020, 0x00000058,
     0x00000003, 0x00000057, 0x0004003b, 0x00000058,
-    0x00000059, 0x00000003, 0x0004002b, 0x0000000f,
-    0x0000005a, 0x00000003, 0x00040020, 0x00000063,
-    0x00000003, 0x0000000a, 0x00040020, 0x00000065,
-    0x00000003, 0x00000007, 0x0004003b, 0x00000065,
-    0x00000066, 0x00000003, 0x0004002b, 0x0000000f,
-    0x00000067, 0x00000001, 0x00050036, 0x00000002,
-    0x00000004, 0x00000000, 0x00000003, 0x000200f8,
-    0x00000005, 0x0004003b, 0x00000008, 0x00000009,
-    0x00000007, 0x0004003b, 0x00000008, 0x00000022,
-    0x00000007, 0x0004003b, 0x00000008, 0x00000031,
-    0x00000007, 0x0004003b, 0x00000008, 0x00000046,
-    0x00000007, 0x0004003b, 0x0000004a, 0x0000004b,
-    0x00000007, 0x00050041, 0x00000011, 0x00000012,
+    0x00000059, 0x00000003, 0x0003001e, 0x0000005a,
+    0x0000000b, 0x00040020, 0x0000005b, 0x00000002,
+    0x0000005a, 0x0004003b, 0x0000005b, 0x0000005c,
+    0x00000002, 0x00040020, 0x00000065, 0x00000003,
+    0x0000000a, 0x00040020, 0x00000067, 0x00000003,
+    0x00000007, 0x0004003b, 0x00000067, 0x00000068,
+    0x00000003, 0x0004002b, 0x0000000f, 0x00000069,
+    0x00000001, 0x00050036, 0x00000002, 0x00000004,
+    0x00000000, 0x00000003, 0x000200f8, 0x00000005,
+    0x0004003b, 0x00000008, 0x00000009, 0x00000007,
+    0x0004003b, 0x00000008, 0x00000022, 0x00000007,
+    0x0004003b, 0x00000008, 0x00000031, 0x00000007,
+    0x0004003b, 0x00000008, 0x00000046, 0x00000007,
+    0x0004003b, 0x0000004a, 0x0000004b, 0x00000007,
+    0x00050041, 0x00000011, 0x00000012, 0x0000000e,
+    0x00000010, 0x0004003d, 0x0000000b, 0x00000013,
+    0x00000012, 0x00050041, 0x00000015, 0x00000016,
+    0x0000000e, 0x00000014, 0x0004003d, 0x00000007,
+    0x00000017, 0x00000016, 0x00050051, 0x00000006,
+    0x00000019, 0x00000017, 0x00000000, 0x00050051,
+    0x00000006, 0x0000001a, 0x00000017, 0x00000001,
+    0x00050051, 0x00000006, 0x0000001b, 0x00000017,
+    0x00000002, 0x00070050, 0x0000000a, 0x0000001c,
+    0x00000019, 0x0000001a, 0x0000001b, 0x00000018,
+    0x00050091, 0x0000000a, 0x0000001d, 0x00000013,
+    0x0000001c, 0x00050051, 0x00000006, 0x0000001e,
+    0x0000001d, 0x00000000, 0x00050051, 0x00000006,
+    0x0000001f, 0x0000001d, 0x00000001, 0x00050051,
+    0x00000006, 0x00000020, 0x0000001d, 0x00000002,
+    0x00060050, 0x00000007, 0x00000021, 0x0000001e,
+    0x0000001f, 0x00000020, 0x0003003e, 0x00000009,
+    0x00000021, 0x00050041, 0x00000011, 0x00000023,
+    0x0000000e, 0x00000010, 0x0004003d, 0x0000000b,
+    0x00000024, 0x00000023, 0x0004003d, 0x00000007,
+    0x00000027, 0x00000026, 0x00050051, 0x00000006,
+    0x00000028, 0x00000027, 0x00000000, 0x00050051,
+    0x00000006, 0x00000029, 0x00000027, 0x00000001,
+    0x00050051, 0x00000006, 0x0000002a, 0x00000027,
+    0x00000002, 0x00070050, 0x0000000a, 0x0000002b,
+    0x00000028, 0x00000029, 0x0000002a, 0x00000018,
+    0x00050091, 0x0000000a, 0x0000002c, 0x00000024,
+    0x0000002b, 0x00050051, 0x00000006, 0x0000002d,
+    0x0000002c, 0x00000000, 0x00050051, 0x00000006,
+    0x0000002e, 0x0000002c, 0x00000001, 0x00050051,
+    0x00000006, 0x0000002f, 0x0000002c, 0x00000002,
+    0x00060050, 0x00000007, 0x00000030, 0x0000002d,
+    0x0000002e, 0x0000002f, 0x0003003e, 0x00000022,
+    0x00000030, 0x00050041, 0x00000011, 0x00000032,
     0x0000000e, 0x00000010, 0x0004003d, 0x0000000b,
-    0x00000013, 0x00000012, 0x00050041, 0x00000015,
-    0x00000016, 0x0000000e, 0x00000014, 0x0004003d,
-    0x00000007, 0x00000017, 0x00000016, 0x00050051,
-    0x00000006, 0x00000019, 0x00000017, 0x00000000,
-    0x00050051, 0x00000006, 0x0000001a, 0x00000017,
-    0x00000001, 0x00050051, 0x00000006, 0x0000001b,
-    0x00000017, 0x00000002, 0x00070050, 0x0000000a,
-    0x0000001c, 0x00000019, 0x0000001a, 0x0000001b,
-    0x00000018, 0x00050091, 0x0000000a, 0x0000001d,
-    0x00000013, 0x0000001c, 0x00050051, 0x00000006,
-    0x0000001e, 0x0000001d, 0x00000000, 0x00050051,
-    0x00000006, 0x0000001f, 0x0000001d, 0x00000001,
-    0x00050051, 0x00000006, 0x00000020, 0x0000001d,
-    0x00000002, 0x00060050, 0x00000007, 0x00000021,
-    0x0000001e, 0x0000001f, 0x00000020, 0x0003003e,
-    0x00000009, 0x00000021, 0x00050041, 0x00000011,
-    0x00000023, 0x0000000e, 0x00000010, 0x0004003d,
-    0x0000000b, 0x00000024, 0x00000023, 0x0004003d,
-    0x00000007, 0x00000027, 0x00000026, 0x00050051,
-    0x00000006, 0x00000028, 0x00000027, 0x00000000,
-    0x00050051, 0x00000006, 0x00000029, 0x00000027,
-    0x00000001, 0x00050051, 0x00000006, 0x0000002a,
-    0x00000027, 0x00000002, 0x00070050, 0x0000000a,
-    0x0000002b, 0x00000028, 0x00000029, 0x0000002a,
-    0x00000018, 0x00050091, 0x0000000a, 0x0000002c,
-    0x00000024, 0x0000002b, 0x00050051, 0x00000006,
-    0x0000002d, 0x0000002c, 0x00000000, 0x00050051,
-    0x00000006, 0x0000002e, 0x0000002c, 0x00000001,
-    0x00050051, 0x00000006, 0x0000002f, 0x0000002c,
-    0x00000002, 0x00060050, 0x00000007, 0x00000030,
-    0x0000002d, 0x0000002e, 0x0000002f, 0x0003003e,
-    0x00000022, 0x00000030, 0x00050041, 0x00000011,
-    0x00000032, 0x0000000e, 0x00000010, 0x0004003d,
-    0x0000000b, 0x00000033, 0x00000032, 0x00060051,
-    0x00000006, 0x00000036, 0x00000033, 0x00000000,
-    0x00000000, 0x00060051, 0x00000006, 0x00000037,
-    0x00000033, 0x00000000, 0x00000001, 0x00060051,
-    0x00000006, 0x00000038, 0x00000033, 0x00000000,
-    0x00000002, 0x00060051, 0x00000006, 0x00000039,
-    0x00000033, 0x00000001, 0x00000000, 0x00060051,
-    0x00000006, 0x0000003a, 0x00000033, 0x00000001,
-    0x00000001, 0x00060051, 0x00000006, 0x0000003b,
-    0x00000033, 0x00000001, 0x00000002, 0x00060051,
-    0x00000006, 0x0000003c, 0x00000033, 0x00000002,
-    0x00000000, 0x00060051, 0x00000006, 0x0000003d,
-    0x00000033, 0x00000002, 0x00000001, 0x00060051,
-    0x00000006, 0x0000003e, 0x00000033, 0x00000002,
-    0x00000002, 0x00060050, 0x00000007, 0x0000003f,
-    0x00000036, 0x00000037, 0x00000038, 0x00060050,
-    0x00000007, 0x00000040, 0x00000039, 0x0000003a,
-    0x0000003b, 0x00060050, 0x00000007, 0x00000041,
-    0x0000003c, 0x0000003d, 0x0000003e, 0x00060050,
-    0x00000034, 0x00000042, 0x0000003f, 0x00000040,
-    0x00000041, 0x0004003d, 0x00000007, 0x00000044,
-    0x00000043, 0x00050091, 0x00000007, 0x00000045,
-    0x00000042, 0x00000044, 0x0003003e, 0x00000031,
-    0x00000045, 0x0004003d, 0x00000007, 0x00000047,
-    0x00000009, 0x0004003d, 0x00000007, 0x00000048,
-    0x00000022, 0x00050083, 0x00000007, 0x00000049,
-    0x00000047, 0x00000048, 0x0003003e, 0x00000046,
-    0x00000049, 0x0004003d, 0x00000007, 0x0000004c,
-    0x00000046, 0x0004003d, 0x00000007, 0x0000004d,
-    0x00000031, 0x00050094, 0x00000006, 0x0000004e,
-    0x0000004c, 0x0000004d, 0x0004003d, 0x00000007,
-    0x0000004f, 0x00000046, 0x0006000c, 0x00000006,
-    0x00000050, 0x00000001, 0x00000042, 0x0000004f,
-    0x00050088, 0x00000006, 0x00000051, 0x0000004e,
-    0x00000050, 0x0004003d, 0x00000007, 0x00000052,
-    0x00000031, 0x0006000c, 0x00000006, 0x00000053,
-    0x00000001, 0x00000042, 0x00000052, 0x00050088,
-    0x00000006, 0x00000054, 0x00000051, 0x00000053,
-    0x0003003e, 0x0000004b, 0x00000054, 0x0004003d,
-    0x00000006, 0x00000055, 0x0000004b, 0x0006000c,
-    0x00000006, 0x00000056, 0x00000001, 0x00000004,
-    0x00000055, 0x0003003e, 0x0000004b, 0x00000056,
-    0x00050041, 0x00000011, 0x0000005b, 0x0000000e,
-    0x0000005a, 0x0004003d, 0x0000000b, 0x0000005c,
-    0x0000005b, 0x0004003d, 0x00000007, 0x0000005d,
-    0x00000022, 0x00050051, 0x00000006, 0x0000005e,
-    0x0000005d, 0x00000000, 0x00050051, 0x00000006,
-    0x0000005f, 0x0000005d, 0x00000001, 0x00050051,
-    0x00000006, 0x00000060, 0x0000005d, 0x00000002,
-    0x00070050, 0x0000000a, 0x00000061, 0x0000005e,
-    0x0000005f, 0x00000060, 0x00000018, 0x00050091,
-    0x0000000a, 0x00000062, 0x0000005c, 0x00000061,
-    0x00050041, 0x00000063, 0x00000064, 0x00000059,
-    0x00000014, 0x0003003e, 0x00000064, 0x00000062,
-    0x00050041, 0x00000015, 0x00000068, 0x0000000e,
-    0x00000067, 0x0004003d, 0x00000007, 0x00000069,
-    0x00000068, 0x0004003d, 0x00000006, 0x0000006a,
-    0x0000004b, 0x0005008e, 0x00000007, 0x0000006b,
-    0x00000069, 0x0000006a, 0x0003003e, 0x00000066,
-    0x0000006b, 0x000100fd, 0x00010038,
+    0x00000033, 0x00000032, 0x00060051, 0x00000006,
+    0x00000036, 0x00000033, 0x00000000, 0x00000000,
+    0x00060051, 0x00000006, 0x00000037, 0x00000033,
+    0x00000000, 0x00000001, 0x00060051, 0x00000006,
+    0x00000038, 0x00000033, 0x00000000, 0x00000002,
+    0x00060051, 0x00000006, 0x00000039, 0x00000033,
+    0x00000001, 0x00000000, 0x00060051, 0x00000006,
+    0x0000003a, 0x00000033, 0x00000001, 0x00000001,
+    0x00060051, 0x00000006, 0x0000003b, 0x00000033,
+    0x00000001, 0x00000002, 0x00060051, 0x00000006,
+    0x0000003c, 0x00000033, 0x00000002, 0x00000000,
+    0x00060051, 0x00000006, 0x0000003d, 0x00000033,
+    0x00000002, 0x00000001, 0x00060051, 0x00000006,
+    0x0000003e, 0x00000033, 0x00000002, 0x00000002,
+    0x00060050, 0x00000007, 0x0000003f, 0x00000036,
+    0x00000037, 0x00000038, 0x00060050, 0x00000007,
+    0x00000040, 0x00000039, 0x0000003a, 0x0000003b,
+    0x00060050, 0x00000007, 0x00000041, 0x0000003c,
+    0x0000003d, 0x0000003e, 0x00060050, 0x00000034,
+    0x00000042, 0x0000003f, 0x00000040, 0x00000041,
+    0x0004003d, 0x00000007, 0x00000044, 0x00000043,
+    0x00050091, 0x00000007, 0x00000045, 0x00000042,
+    0x00000044, 0x0003003e, 0x00000031, 0x00000045,
+    0x0004003d, 0x00000007, 0x00000047, 0x00000009,
+    0x0004003d, 0x00000007, 0x00000048, 0x00000022,
+    0x00050083, 0x00000007, 0x00000049, 0x00000047,
+    0x00000048, 0x0003003e, 0x00000046, 0x00000049,
+    0x0004003d, 0x00000007, 0x0000004c, 0x00000046,
+    0x0004003d, 0x00000007, 0x0000004d, 0x00000031,
+    0x00050094, 0x00000006, 0x0000004e, 0x0000004c,
+    0x0000004d, 0x0004003d, 0x00000007, 0x0000004f,
+    0x00000046, 0x0006000c, 0x00000006, 0x00000050,
+    0x00000001, 0x00000042, 0x0000004f, 0x00050088,
+    0x00000006, 0x00000051, 0x0000004e, 0x00000050,
+    0x0004003d, 0x00000007, 0x00000052, 0x00000031,
+    0x0006000c, 0x00000006, 0x00000053, 0x00000001,
+    0x00000042, 0x00000052, 0x00050088, 0x00000006,
+    0x00000054, 0x00000051, 0x00000053, 0x0003003e,
+    0x0000004b, 0x00000054, 0x0004003d, 0x00000006,
+    0x00000055, 0x0000004b, 0x0006000c, 0x00000006,
+    0x00000056, 0x00000001, 0x00000004, 0x00000055,
+    0x0003003e, 0x0000004b, 0x00000056, 0x00050041,
+    0x00000011, 0x0000005d, 0x0000005c, 0x00000014,
+    0x0004003d, 0x0000000b, 0x0000005e, 0x0000005d,
+    0x0004003d, 0x00000007, 0x0000005f, 0x00000022,
+    0x00050051, 0x00000006, 0x00000060, 0x0000005f,
+    0x00000000, 0x00050051, 0x00000006, 0x00000061,
+    0x0000005f, 0x00000001, 0x00050051, 0x00000006,
+    0x00000062, 0x0000005f, 0x00000002, 0x00070050,
+    0x0000000a, 0x00000063, 0x00000060, 0x00000061,
+    0x00000062, 0x00000018, 0x00050091, 0x0000000a,
+    0x00000064, 0x0000005e, 0x00000063, 0x00050041,
+    0x00000065, 0x00000066, 0x00000059, 0x00000014,
+    0x0003003e, 0x00000066, 0x00000064, 0x00050041,
+    0x00000015, 0x0000006a, 0x0000000e, 0x00000069,
+    0x0004003d, 0x00000007, 0x0000006b, 0x0000006a,
+    0x0004003d, 0x00000006, 0x0000006c, 0x0000004b,
+    0x0005008e, 0x00000007, 0x0000006d, 0x0000006b,
+    0x0000006c, 0x0003003e, 0x00000068, 0x0000006d,
+    0x000100fd, 0x00010038,
 };
@@ -36,6 +36,12 @@
 #ifdef _WIN32
 #include <fcntl.h>
 #include <io.h>
+#include <direct.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif // _WIN32
 
 #include <vulkan/vulkan.h>
@@ -86,6 +92,23 @@ static int ConsoleIsExclusive(void) {
 #define MAX_QUEUE_TYPES 5
 #define APP_SHORT_NAME "vulkaninfo"
 
+#define FORMAT_CACHE_MAGIC 0x46495656 /* "VVIF" */
+#define FORMAT_CACHE_VERSION 1
+
+struct app_options {
+    /* probe the GPUs at once, one thread each */
+    bool parallel;
+    /* directory format properties are kept in between runs, or NULL */
+    const char *cache_dir;
+};
+
+struct format_cache_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format_count;
+    uint32_t reserved;
+};
+
 struct app_gpu;
 
 struct app_dev {
@@ -399,15 +422,102 @@ static const char *vk_format_string(VkFormat fmt) {
     }
 }
 
-static void app_dev_init_formats(struct app_dev *dev) {
+/*
+ * Format properties only change with the driver, so they can be kept between
+ * runs in a file named after the device, the driver version and the pipeline
+ * cache UUID, which drivers change whenever what they report might.
+ */
+static void app_format_cache_filename(const struct app_gpu *gpu,
+                                      const char *dir, char *name,
+                                      size_t size) {
+    char uuid[2 * VK_UUID_SIZE + 1];
+    uint32_t i;
+
+    for (i = 0; i < VK_UUID_SIZE; i++)
+        snprintf(&uuid[2 * i], 3, "%02x", gpu->props.pipelineCacheUUID[i]);
+    snprintf(name, size, "%s/%04x_%04x_%08x_%s.formats", dir,
+             gpu->props.vendorID, gpu->props.deviceID,
+             gpu->props.driverVersion, uuid);
+}
+
+static bool app_format_cache_read(struct app_dev *dev, const char *dir) {
+    struct format_cache_header header;
+    char filename[1024];
+    FILE *fp;
+    bool ok;
+
+    app_format_cache_filename(dev->gpu, dir, filename, sizeof(filename));
+    fp = fopen(filename, "rb");
+    if (!fp)
+        return false;
+
+    ok = fread(&header, sizeof(header), 1, fp) == 1 &&
+         header.magic == FORMAT_CACHE_MAGIC &&
+         header.version == FORMAT_CACHE_VERSION &&
+         header.format_count == VK_FORMAT_RANGE_SIZE &&
+         fread(dev->format_props, sizeof(dev->format_props), 1, fp) == 1;
+    fclose(fp);
+
+    return ok;
+}
+
+static void app_format_cache_write(const struct app_dev *dev,
+                                   const char *dir) {
+    struct format_cache_header header = {
+        .magic = FORMAT_CACHE_MAGIC,
+        .version = FORMAT_CACHE_VERSION,
+        .format_count = VK_FORMAT_RANGE_SIZE,
+        .reserved = 0,
+    };
+    char filename[1024], tmp_filename[1100];
+    FILE *fp;
+    bool ok;
+
+    /* written to a temporary, named for the process and GPU, and renamed so
+     * that no run sees a partial file */
+    app_format_cache_filename(dev->gpu, dir, filename, sizeof(filename));
+#ifdef _WIN32
+    snprintf(tmp_filename, sizeof(tmp_filename), "%s.%d.%u.tmp", filename,
+             _getpid(), dev->gpu->id);
+#else
+    snprintf(tmp_filename, sizeof(tmp_filename), "%s.%d.%u.tmp", filename,
+             (int)getpid(), dev->gpu->id);
+#endif
+
+    fp = fopen(tmp_filename, "wb");
+    if (!fp)
+        return;
+
+    ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+         fwrite(dev->format_props, sizeof(dev->format_props), 1, fp) == 1;
+    ok = fclose(fp) == 0 && ok;
+
+    if (ok) {
+#ifdef _WIN32
+        ok = MoveFileExA(tmp_filename, filename, MOVEFILE_REPLACE_EXISTING);
+#else
+        ok = rename(tmp_filename, filename) == 0;
+#endif
+    }
+    if (!ok)
+        remove(tmp_filename);
+}
+
+static void app_dev_init_formats(struct app_dev *dev, const char *cache_dir) {
     VkFormat f;
 
+    if (cache_dir && app_format_cache_read(dev, cache_dir))
+        return;
+
     for (f = 0; f < VK_FORMAT_RANGE_SIZE; f++) {
         const VkFormat fmt = f;
 
         vkGetPhysicalDeviceFormatProperties(dev->gpu->obj, fmt,
                                             &dev->format_props[f]);
     }
+
+    if (cache_dir)
+        app_format_cache_write(dev, cache_dir);
 }
 
 static void extract_version(uint32_t version, uint32_t *major, uint32_t *minor,
@@ -706,7 +816,8 @@ static void app_destroy_instance(struct app_instance *inst) {
 }
 
 static void app_gpu_init(struct app_gpu *gpu, uint32_t id,
-                         VkPhysicalDevice obj) {
+                         VkPhysicalDevice obj,
+                         const struct app_options *options) {
     uint32_t i;
 
     memset(gpu, 0, sizeof(*gpu));
@@ -747,7 +858,76 @@ static void app_gpu_init(struct app_gpu *gpu, uint32_t id,
     vkGetPhysicalDeviceFeatures(gpu->obj, &gpu->features);
 
     app_dev_init(&gpu->dev, gpu);
-    app_dev_init_formats(&gpu->dev);
+    app_dev_init_formats(&gpu->dev, options->cache_dir);
+}
+
+struct app_gpu_probe {
+    struct app_gpu *gpu;
+    uint32_t id;
+    VkPhysicalDevice obj;
+    const struct app_options *options;
+#ifdef _WIN32
+    HANDLE thread;
+#else
+    pthread_t thread;
+#endif
+    bool started;
+};
+
+#ifdef _WIN32
+static DWORD WINAPI app_gpu_probe_thread(LPVOID arg) {
+#else
+static void *app_gpu_probe_thread(void *arg) {
+#endif
+    struct app_gpu_probe *probe = arg;
+
+    app_gpu_init(probe->gpu, probe->id, probe->obj, probe->options);
+    return 0;
+}
+
+/*
+ * Fills in every GPU before anything is printed, so that the output is the
+ * same whether or not they are probed in parallel.  A GPU whose thread cannot
+ * be started is probed on this one.
+ */
+static void app_gpu_init_all(struct app_gpu *gpus, VkPhysicalDevice *objs,
+                             uint32_t gpu_count,
+                             const struct app_options *options) {
+    struct app_gpu_probe probes[MAX_GPUS];
+    uint32_t i;
+
+    for (i = 0; i < gpu_count; i++) {
+        probes[i].gpu = &gpus[i];
+        probes[i].id = i;
+        probes[i].obj = objs[i];
+        probes[i].options = options;
+        probes[i].started = false;
+
+        if (!options->parallel || gpu_count < 2)
+            continue;
+#ifdef _WIN32
+        probes[i].thread = CreateThread(NULL, 0, app_gpu_probe_thread,
+                                        &probes[i], 0, NULL);
+        probes[i].started = probes[i].thread != NULL;
+#else
+        probes[i].started = pthread_create(&probes[i].thread, NULL,
+                                           app_gpu_probe_thread,
+                                           &probes[i]) == 0;
+#endif
+    }
+
+    for (i = 0; i < gpu_count; i++) {
+        if (!probes[i].started) {
+            app_gpu_probe_thread(&probes[i]);
+            continue;
+        }
+#ifdef _WIN32
+        WaitForSingleObject(probes[i].thread, INFINITE);
+        CloseHandle(probes[i].thread);
+#else
+        pthread_join(probes[i].thread, NULL);
+#endif
+    }
 }
 
 static void app_gpu_destroy(struct app_gpu *gpu) {
@@ -1165,6 +1345,40 @@ static void ConsoleEnlarge() {
 }
 #endif
 
+static void app_usage(void) {
+    printf("Usage: " APP_SHORT_NAME " [--parallel] [--cache <dir>]\n");
+    printf("\t--parallel     probe all GPUs at once, one thread each\n");
+    printf("\t--cache <dir>  keep format properties in <dir> between runs,\n"
+           "\t               keyed by driver version and pipeline cache UUID\n");
+}
+
+static bool app_parse_options(int argc, char **argv,
+                              struct app_options *options) {
+    int i;
+
+    options->parallel = false;
+    options->cache_dir = NULL;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--parallel")) {
+            options->parallel = true;
+        } else if (!strcmp(argv[i], "--cache") && i + 1 < argc) {
+            options->cache_dir = argv[++i];
+        } else {
+            return false;
+        }
+    }
+
+    if (options->cache_dir) {
+#ifdef _WIN32
+        _mkdir(options->cache_dir);
+#else
+        mkdir(options->cache_dir, 0755);
+#endif
+    }
+    return true;
+}
+
 int main(int argc, char **argv) {
     unsigned int major, minor, patch;
     struct app_gpu gpus[MAX_GPUS];
@@ -1172,6 +1386,12 @@ int main(int argc, char **argv) {
     uint32_t gpu_count, i;
     VkResult err;
     struct app_instance inst;
+    struct app_options options;
+
+    if (!app_parse_options(argc, argv, &options)) {
+        app_usage();
+        return 1;
+    }
 
 #ifdef _WIN32
     if (ConsoleIsExclusive())
@@ -1226,8 +1446,9 @@ int main(int argc, char **argv) {
     if (err)
         ERR_EXIT(err);
 
+    app_gpu_init_all(gpus, objs, gpu_count, &options);
+
     for (i = 0; i < gpu_count; i++) {
-        app_gpu_init(&gpus[i], i, objs[i]);
         app_gpu_dump(&gpus[i]);
         printf("\n\n");
     }
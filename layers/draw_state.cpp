@@ -100,8 +100,8 @@ struct layer_data {
     VkLayerInstanceDispatchTable *instance_dispatch_table;
     devExts device_extensions;
     vector<VkQueue> queues; // all queues under given device
-    // Global set of all cmdBuffers that are inFlight on this device
-    unordered_set<VkCommandBuffer> globalInFlightCmdBuffers;
+    // Secondary cmdBuffers executed by a primary that has not been submitted yet
+    unordered_set<VkCommandBuffer> recordedSecondaryCmdBuffers;
     // Layer specific data
     unordered_map<VkSampler, unique_ptr<SAMPLER_NODE>> sampleMap;
     unordered_map<VkImageView, unique_ptr<VkImageViewCreateInfo>> imageViewMap;
@@ -233,6 +233,15 @@ static loader_platform_thread_mutex globalLock;
 #define MAX_TID 513
 static loader_platform_thread_id g_tidMapping[MAX_TID] = {0};
 static uint32_t g_maxTID = 0;
+// Check categories enabled through lunarg_draw_state.enable_checks, refreshed on settings reload
+static const LayerOptionHandle *g_checkMask = NULL;
+static LayerSampler g_sampler;
+
+// Heavy per-command validation only runs when its category is enabled and the
+// command buffer was picked by the sampler. State tracking must not be gated on this.
+static inline bool cbCheckEnabled(const GLOBAL_CB_NODE *pCB, LayerCheckCategoryFlags category) {
+    return pCB->sampled && layerCheckEnabled(g_checkMask, category);
+}
 
 template layer_data *get_my_data_ptr<layer_data>(void *data_key, std::unordered_map<void *, layer_data *> &data_map);
 
@@ -1923,6 +1932,8 @@ static VkBool32 validate_dynamic_offsets(layer_data *my_data, const GLOBAL_CB_NO
 
 // Validate overall state at the time of a draw call
 static VkBool32 validate_draw_state(layer_data *my_data, GLOBAL_CB_NODE *pCB, VkBool32 indexedDraw) {
+    if (!cbCheckEnabled(pCB, LAYER_CHECK_DRAW_STATE))
+        return VK_FALSE;
     // First check flag states
     VkBool32 result = validate_draw_state_flags(my_data, pCB, indexedDraw);
     PIPELINE_NODE *pPipe = getPipeline(my_data, pCB->lastBoundPipeline);
@@ -2970,7 +2981,7 @@ VkBool32 validateIdleDescriptorSet(const layer_data *my_data, VkDescriptorSet se
                              "Cannot call %s() on descriptor set %" PRIxLEAST64 " that has not been allocated.", func_str.c_str(),
                              (uint64_t)(set));
     } else {
-        if (set_node->second->in_use.load()) {
+        if (set_node->second->inUse()) {
             skip_call |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
                                  VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, (uint64_t)(set), __LINE__, DRAWSTATE_OBJECT_INUSE,
                                  "DS", "Cannot call %s() on descriptor set %" PRIxLEAST64 " that is in use by a command buffer.",
@@ -3459,6 +3470,7 @@ static void resetCB(layer_data *my_data, const VkCommandBuffer cb) {
         pCB->numCmds = 0;
         memset(pCB->drawCount, 0, NUM_DRAW_TYPES * sizeof(uint64_t));
         pCB->state = CB_NEW;
+        pCB->sampled = true;
         pCB->submitCount = 0;
         pCB->status = 0;
         pCB->lastBoundPipeline = 0;
@@ -3732,6 +3744,9 @@ static void init_draw_state(layer_data *my_data, const VkAllocationCallbacks *pA
         loader_platform_thread_create_mutex(&globalLock);
         globalLockInitialized = 1;
     }
+
+    g_checkMask = getLayerCheckMask("lunarg_draw_state");
+    initLayerSampler(&g_sampler);
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
@@ -3940,6 +3955,7 @@ VkBool32 ValidateCmdBufImageLayouts(VkCommandBuffer cmdBuffer) {
     VkBool32 skip_call = VK_FALSE;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(cmdBuffer), layer_data_map);
     GLOBAL_CB_NODE *pCB = getCBNode(dev_data, cmdBuffer);
+    bool checkLayouts = cbCheckEnabled(pCB, LAYER_CHECK_IMAGE_LAYOUTS);
     for (auto cb_image_data : pCB->imageLayoutMap) {
         VkImageLayout imageLayout;
         if (!FindLayout(dev_data, cb_image_data.first, imageLayout)) {
@@ -3950,7 +3966,7 @@ VkBool32 ValidateCmdBufImageLayouts(VkCommandBuffer cmdBuffer) {
         } else {
             if (cb_image_data.second.initialLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
                 // TODO: Set memory invalid which is in mem_tracker currently
-            } else if (imageLayout != cb_image_data.second.initialLayout) {
+            } else if (checkLayouts && imageLayout != cb_image_data.second.initialLayout) {
                 skip_call |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
                                      VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0, __LINE__, DRAWSTATE_INVALID_IMAGE_LAYOUT,
                                      "DS", "Cannot submit cmd buffer using image with layout %s when "
@@ -3962,8 +3978,8 @@ VkBool32 ValidateCmdBufImageLayouts(VkCommandBuffer cmdBuffer) {
     }
     return skip_call;
 }
-// Track which resources are in-flight by atomically incrementing their "in_use" count
-VkBool32 validateAndIncrementResources(layer_data *my_data, GLOBAL_CB_NODE *pCB) {
+// Track which resources are in-flight by stamping them with the sequence number of the submission
+VkBool32 validateAndMarkResources(layer_data *my_data, GLOBAL_CB_NODE *pCB, QUEUE_NODE *pQueue, uint64_t seq) {
     VkBool32 skip_call = VK_FALSE;
     for (auto drawDataElement : pCB->drawData) {
         for (auto buffer : drawDataElement.buffers) {
@@ -3973,7 +3989,7 @@ VkBool32 validateAndIncrementResources(layer_data *my_data, GLOBAL_CB_NODE *pCB)
                                      (uint64_t)(buffer), __LINE__, DRAWSTATE_INVALID_BUFFER, "DS",
                                      "Cannot submit cmd buffer using deleted buffer %" PRIu64 ".", (uint64_t)(buffer));
             } else {
-                buffer_data->second.in_use.fetch_add(1);
+                buffer_data->second.markUsed(pQueue, seq);
             }
         }
     }
@@ -3985,7 +4001,7 @@ VkBool32 validateAndIncrementResources(layer_data *my_data, GLOBAL_CB_NODE *pCB)
                         (uint64_t)(set), __LINE__, DRAWSTATE_INVALID_DESCRIPTOR_SET, "DS",
                         "Cannot submit cmd buffer using deleted descriptor set %" PRIu64 ".", (uint64_t)(set));
         } else {
-            setNode->second->in_use.fetch_add(1);
+            setNode->second->markUsed(pQueue, seq);
         }
     }
     for (auto semaphore : pCB->semaphores) {
@@ -3996,7 +4012,7 @@ VkBool32 validateAndIncrementResources(layer_data *my_data, GLOBAL_CB_NODE *pCB)
                         reinterpret_cast<uint64_t &>(semaphore), __LINE__, DRAWSTATE_INVALID_SEMAPHORE, "DS",
                         "Cannot submit cmd buffer using deleted semaphore %" PRIu64 ".", reinterpret_cast<uint64_t &>(semaphore));
         } else {
-            semaphoreNode->second.in_use.fetch_add(1);
+            semaphoreNode->second.markUsed(pQueue, seq);
         }
     }
     for (auto event : pCB->events) {
@@ -4007,40 +4023,18 @@ VkBool32 validateAndIncrementResources(layer_data *my_data, GLOBAL_CB_NODE *pCB)
                         reinterpret_cast<uint64_t &>(event), __LINE__, DRAWSTATE_INVALID_EVENT, "DS",
                         "Cannot submit cmd buffer using deleted event %" PRIu64 ".", reinterpret_cast<uint64_t &>(event));
         } else {
-            eventNode->second.in_use.fetch_add(1);
+            eventNode->second.markUsed(pQueue, seq);
         }
     }
     return skip_call;
 }
 
-void decrementResources(layer_data *my_data, VkCommandBuffer cmdBuffer) {
-    GLOBAL_CB_NODE *pCB = getCBNode(my_data, cmdBuffer);
-    for (auto drawDataElement : pCB->drawData) {
-        for (auto buffer : drawDataElement.buffers) {
-            auto buffer_data = my_data->bufferMap.find(buffer);
-            if (buffer_data != my_data->bufferMap.end()) {
-                buffer_data->second.in_use.fetch_sub(1);
-            }
-        }
-    }
-    for (auto set : pCB->uniqueBoundSets) {
-        auto setNode = my_data->setMap.find(set);
-        if (setNode != my_data->setMap.end()) {
-            setNode->second->in_use.fetch_sub(1);
-        }
-    }
-    for (auto semaphore : pCB->semaphores) {
-        auto semaphoreNode = my_data->semaphoreMap.find(semaphore);
-        if (semaphoreNode != my_data->semaphoreMap.end()) {
-            semaphoreNode->second.in_use.fetch_sub(1);
-        }
-    }
-    for (auto event : pCB->events) {
-        auto eventNode = my_data->eventMap.find(event);
-        if (eventNode != my_data->eventMap.end()) {
-            eventNode->second.in_use.fetch_sub(1);
-        }
-    }
+// Hand the query and event state recorded in a completed cmd buffer back to the device
+void retireCmdBuffer(layer_data *my_data, VkCommandBuffer cmdBuffer) {
+    auto cb_data = my_data->commandBufferMap.find(cmdBuffer);
+    if (cb_data == my_data->commandBufferMap.end())
+        return;
+    GLOBAL_CB_NODE *pCB = cb_data->second;
     for (auto queryStatePair : pCB->queryToStateMap) {
         my_data->queryToStateMap[queryStatePair.first] = queryStatePair.second;
     }
@@ -4049,95 +4043,58 @@ void decrementResources(layer_data *my_data, VkCommandBuffer cmdBuffer) {
     }
 }
 
-void decrementResources(layer_data *my_data, uint32_t fenceCount, const VkFence *pFences) {
-    for (uint32_t i = 0; i < fenceCount; ++i) {
-        auto fence_data = my_data->fenceMap.find(pFences[i]);
-        if (fence_data == my_data->fenceMap.end() || !fence_data->second.needsSignaled)
-            return;
-        fence_data->second.needsSignaled = false;
-        fence_data->second.in_use.fetch_sub(1);
-        if (fence_data->second.priorFence != VK_NULL_HANDLE) {
-            decrementResources(my_data, 1, &fence_data->second.priorFence);
-        }
-        for (auto cmdBuffer : fence_data->second.cmdBuffers) {
-            decrementResources(my_data, cmdBuffer);
-        }
-    }
-}
-
-void decrementResources(layer_data *my_data, VkQueue queue) {
-    auto queue_data = my_data->queueMap.find(queue);
-    if (queue_data != my_data->queueMap.end()) {
-        for (auto cmdBuffer : queue_data->second.untrackedCmdBuffers) {
-            decrementResources(my_data, cmdBuffer);
-        }
-        queue_data->second.untrackedCmdBuffers.clear();
-        decrementResources(my_data, 1, &queue_data->second.priorFence);
-    }
-}
-
-void trackCommandBuffers(layer_data *my_data, VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits, VkFence fence) {
-    auto queue_data = my_data->queueMap.find(queue);
+// Append a submission to the queue's timeline.  Resources were already stamped
+// with its sequence number while being validated, so only the cmd buffers and
+// fence are recorded here.
+void trackCommandBuffers(layer_data *my_data, VkQueue queue, QUEUE_NODE *pQueue, uint64_t seq, uint32_t submitCount,
+                         const VkSubmitInfo *pSubmits, VkFence fence) {
+    pQueue->submitSeq = seq;
     if (fence != VK_NULL_HANDLE) {
-        VkFence priorFence = VK_NULL_HANDLE;
         auto fence_data = my_data->fenceMap.find(fence);
-        if (fence_data == my_data->fenceMap.end()) {
-            return;
-        }
-        if (queue_data != my_data->queueMap.end()) {
-            priorFence = queue_data->second.priorFence;
-            queue_data->second.priorFence = fence;
-            for (auto cmdBuffer : queue_data->second.untrackedCmdBuffers) {
-                fence_data->second.cmdBuffers.push_back(cmdBuffer);
-            }
-            queue_data->second.untrackedCmdBuffers.clear();
-        }
-        fence_data->second.cmdBuffers.clear();
-        fence_data->second.priorFence = priorFence;
-        fence_data->second.needsSignaled = true;
-        fence_data->second.queue = queue;
-        fence_data->second.in_use.fetch_add(1);
-        for (uint32_t submit_idx = 0; submit_idx < submitCount; submit_idx++) {
-            const VkSubmitInfo *submit = &pSubmits[submit_idx];
-            for (uint32_t i = 0; i < submit->commandBufferCount; ++i) {
-                for (auto secondaryCmdBuffer : my_data->commandBufferMap[submit->pCommandBuffers[i]]->secondaryCommandBuffers) {
-                    fence_data->second.cmdBuffers.push_back(secondaryCmdBuffer);
-                }
-                fence_data->second.cmdBuffers.push_back(submit->pCommandBuffers[i]);
-            }
-        }
-    } else {
-        if (queue_data != my_data->queueMap.end()) {
-            for (uint32_t submit_idx = 0; submit_idx < submitCount; submit_idx++) {
-                const VkSubmitInfo *submit = &pSubmits[submit_idx];
-                for (uint32_t i = 0; i < submit->commandBufferCount; ++i) {
-                    for (auto secondaryCmdBuffer : my_data->commandBufferMap[submit->pCommandBuffers[i]]->secondaryCommandBuffers) {
-                        queue_data->second.untrackedCmdBuffers.push_back(secondaryCmdBuffer);
-                    }
-                    queue_data->second.untrackedCmdBuffers.push_back(submit->pCommandBuffers[i]);
-                }
-            }
+        if (fence_data != my_data->fenceMap.end()) {
+            fence_data->second.queue = queue;
+            fence_data->second.submitSeq = seq;
+            fence_data->second.markUsed(pQueue, seq);
         }
     }
-    if (queue_data != my_data->queueMap.end()) {
-        for (uint32_t submit_idx = 0; submit_idx < submitCount; submit_idx++) {
-            const VkSubmitInfo *submit = &pSubmits[submit_idx];
-            for (uint32_t i = 0; i < submit->commandBufferCount; ++i) {
-                // Add cmdBuffers to both the global set and queue set
-                for (auto secondaryCmdBuffer : my_data->commandBufferMap[submit->pCommandBuffers[i]]->secondaryCommandBuffers) {
-                    my_data->globalInFlightCmdBuffers.insert(secondaryCmdBuffer);
-                    queue_data->second.inFlightCmdBuffers.insert(secondaryCmdBuffer);
+    SUBMISSION_NODE submission;
+    submission.seq = seq;
+    for (uint32_t submit_idx = 0; submit_idx < submitCount; submit_idx++) {
+        const VkSubmitInfo *submit = &pSubmits[submit_idx];
+        for (uint32_t i = 0; i < submit->commandBufferCount; ++i) {
+            GLOBAL_CB_NODE *pCB = getCBNode(my_data, submit->pCommandBuffers[i]);
+            if (!pCB)
+                continue;
+            // Secondaries are tracked through the timeline from here on
+            for (auto secondaryCmdBuffer : pCB->secondaryCommandBuffers) {
+                GLOBAL_CB_NODE *pSubCB = getCBNode(my_data, secondaryCmdBuffer);
+                if (pSubCB) {
+                    my_data->recordedSecondaryCmdBuffers.erase(secondaryCmdBuffer);
+                    pSubCB->markUsed(pQueue, seq);
+                    submission.cmdBuffers.push_back(secondaryCmdBuffer);
                 }
-                my_data->globalInFlightCmdBuffers.insert(submit->pCommandBuffers[i]);
-                queue_data->second.inFlightCmdBuffers.insert(submit->pCommandBuffers[i]);
             }
+            pCB->markUsed(pQueue, seq);
+            submission.cmdBuffers.push_back(submit->pCommandBuffers[i]);
         }
     }
+    if (!submission.cmdBuffers.empty()) {
+        pQueue->submissions.push_back(std::move(submission));
+    }
+}
+
+// A cmd buffer is in flight from submission until its submission retires.
+// Secondaries are also pending from the time they are recorded into a primary.
+static bool isCmdBufferInFlight(const layer_data *my_data, VkCommandBuffer cmdBuffer) {
+    if (my_data->recordedSecondaryCmdBuffers.count(cmdBuffer))
+        return true;
+    auto cb_data = my_data->commandBufferMap.find(cmdBuffer);
+    return cb_data != my_data->commandBufferMap.end() && cb_data->second->inUse();
 }
 
 bool validateCommandBufferSimultaneousUse(layer_data *dev_data, GLOBAL_CB_NODE *pCB) {
     bool skip_call = false;
-    if (dev_data->globalInFlightCmdBuffers.count(pCB->commandBuffer) &&
+    if (isCmdBufferInFlight(dev_data, pCB->commandBuffer) &&
         !(pCB->beginInfo.flags & VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT)) {
         skip_call |=
             log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0,
@@ -4218,12 +4175,12 @@ static bool validateCommandBufferState(layer_data *dev_data, GLOBAL_CB_NODE *pCB
     return skipCall;
 }
 
-static VkBool32 validatePrimaryCommandBufferState(layer_data *dev_data, GLOBAL_CB_NODE *pCB) {
+static VkBool32 validatePrimaryCommandBufferState(layer_data *dev_data, GLOBAL_CB_NODE *pCB, QUEUE_NODE *pQueue, uint64_t seq) {
     // Track in-use for resources off of primary and any secondary CBs
-    VkBool32 skipCall = validateAndIncrementResources(dev_data, pCB);
+    VkBool32 skipCall = validateAndMarkResources(dev_data, pCB, pQueue, seq);
     if (!pCB->secondaryCommandBuffers.empty()) {
         for (auto secondaryCmdBuffer : pCB->secondaryCommandBuffers) {
-            skipCall |= validateAndIncrementResources(dev_data, dev_data->commandBufferMap[secondaryCmdBuffer]);
+            skipCall |= validateAndMarkResources(dev_data, dev_data->commandBufferMap[secondaryCmdBuffer], pQueue, seq);
             GLOBAL_CB_NODE *pSubCB = getCBNode(dev_data, secondaryCmdBuffer);
             if (pSubCB->primaryCommandBuffer != pCB->commandBuffer) {
                 log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, 0,
@@ -4258,9 +4215,13 @@ vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits,
     VkBool32 skipCall = VK_FALSE;
     GLOBAL_CB_NODE *pCB = NULL;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(queue), layer_data_map);
+    pollLayerSettings();
     loader_platform_thread_lock_mutex(&globalLock);
+    // Everything referenced by this submission is stamped with its sequence number on the queue
+    QUEUE_NODE *pQueue = &dev_data->queueMap[queue];
+    uint64_t submitSeq = pQueue->submitSeq + 1;
     // First verify that fence is not in use
-    if ((fence != VK_NULL_HANDLE) && (submitCount != 0) && dev_data->fenceMap[fence].in_use.load()) {
+    if ((fence != VK_NULL_HANDLE) && (submitCount != 0) && dev_data->fenceMap[fence].inUse()) {
         skipCall |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_FENCE_EXT,
                             (uint64_t)(fence), __LINE__, DRAWSTATE_INVALID_FENCE, "DS",
                             "Fence %#" PRIx64 " is already in use by another submission.", (uint64_t)(fence));
@@ -4289,11 +4250,11 @@ vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits,
             pCB = getCBNode(dev_data, submit->pCommandBuffers[i]);
             pCB->semaphores = semaphoreList;
             pCB->submitCount++; // increment submit count
-            skipCall |= validatePrimaryCommandBufferState(dev_data, pCB);
+            skipCall |= validatePrimaryCommandBufferState(dev_data, pCB, pQueue, submitSeq);
         }
     }
     // Update cmdBuffer-related data structs and mark fence in-use
-    trackCommandBuffers(dev_data, queue, submitCount, pSubmits, fence);
+    trackCommandBuffers(dev_data, queue, pQueue, submitSeq, submitCount, pSubmits, fence);
     loader_platform_thread_unlock_mutex(&globalLock);
     if (VK_FALSE == skipCall)
         return dev_data->device_dispatch_table->QueueSubmit(queue, submitCount, pSubmits, fence);
@@ -4320,25 +4281,38 @@ VkBool32 cleanInFlightCmdBuffer(layer_data *my_data, VkCommandBuffer cmdBuffer)
     }
     return skip_call;
 }
-// Remove given cmd_buffer from the global inFlight set.
-//  Also, if given queue is valid, then remove the cmd_buffer from that queues
-//  inFlightCmdBuffer set. Finally, check all other queues and if given cmd_buffer
-//  is still in flight on another queue, add it back into the global set.
+// Advance a queue's retired watermark to seq.  Resources need no per-object
+// update since their in-use state is derived from the watermark; only the cmd
+// buffers of the retired submissions are visited for their query and event state.
 // Note: This function assumes that the global lock is held by the calling
 // thread.
-static inline void removeInFlightCmdBuffer(layer_data *dev_data, VkCommandBuffer cmd_buffer, VkQueue queue) {
-    // Pull it off of global list initially, but if we find it in any other queue list, add it back in
-    dev_data->globalInFlightCmdBuffers.erase(cmd_buffer);
-    if (dev_data->queueMap.find(queue) != dev_data->queueMap.end()) {
-        dev_data->queueMap[queue].inFlightCmdBuffers.erase(cmd_buffer);
-        for (auto q : dev_data->queues) {
-            if ((q != queue) &&
-                (dev_data->queueMap[q].inFlightCmdBuffers.find(cmd_buffer) != dev_data->queueMap[q].inFlightCmdBuffers.end())) {
-                dev_data->globalInFlightCmdBuffers.insert(cmd_buffer);
-                break;
-            }
+static VkBool32 retireQueueSubmissions(layer_data *dev_data, QUEUE_NODE *pQueue, uint64_t seq) {
+    VkBool32 skip_call = VK_FALSE;
+    if (seq <= pQueue->retiredSeq)
+        return skip_call;
+    pQueue->retiredSeq = seq;
+    while (!pQueue->submissions.empty() && pQueue->submissions.front().seq <= seq) {
+        for (auto cmdBuffer : pQueue->submissions.front().cmdBuffers) {
+            skip_call |= cleanInFlightCmdBuffer(dev_data, cmdBuffer);
+            retireCmdBuffer(dev_data, cmdBuffer);
         }
+        pQueue->submissions.pop_front();
     }
+    return skip_call;
+}
+
+// A signaled fence retires its submission and, since a queue completes its
+// submissions in order, every earlier submission on the same queue.
+// Note: This function assumes that the global lock is held by the calling
+// thread.
+static VkBool32 retireFence(layer_data *dev_data, VkFence fence) {
+    auto fence_data = dev_data->fenceMap.find(fence);
+    if (fence_data == dev_data->fenceMap.end() || fence_data->second.queue == VK_NULL_HANDLE)
+        return VK_FALSE;
+    auto queue_data = dev_data->queueMap.find(fence_data->second.queue);
+    if (queue_data == dev_data->queueMap.end())
+        return VK_FALSE;
+    return retireQueueSubmissions(dev_data, &queue_data->second, fence_data->second.submitSeq);
 }
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
@@ -4351,13 +4325,8 @@ vkWaitForFences(VkDevice device, uint32_t fenceCount, const VkFence *pFences, Vk
         // When we know that all fences are complete we can clean/remove their CBs
         if (waitAll || fenceCount == 1) {
             for (uint32_t i = 0; i < fenceCount; ++i) {
-                VkQueue fence_queue = dev_data->fenceMap[pFences[i]].queue;
-                for (auto cmdBuffer : dev_data->fenceMap[pFences[i]].cmdBuffers) {
-                    skip_call |= cleanInFlightCmdBuffer(dev_data, cmdBuffer);
-                    removeInFlightCmdBuffer(dev_data, cmdBuffer, fence_queue);
-                }
+                skip_call |= retireFence(dev_data, pFences[i]);
             }
-            decrementResources(dev_data, fenceCount, pFences);
         }
         // NOTE : Alternate case not handled here is when some fences have completed. In
         //  this case for app to guarantee which fences completed it will have to call
@@ -4375,12 +4344,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkGetFenceStatus(VkDevice device,
     VkBool32 skip_call = VK_FALSE;
     loader_platform_thread_lock_mutex(&globalLock);
     if (result == VK_SUCCESS) {
-        auto fence_queue = dev_data->fenceMap[fence].queue;
-        for (auto cmdBuffer : dev_data->fenceMap[fence].cmdBuffers) {
-            skip_call |= cleanInFlightCmdBuffer(dev_data, cmdBuffer);
-            removeInFlightCmdBuffer(dev_data, cmdBuffer, fence_queue);
-        }
-        decrementResources(dev_data, 1, &fence);
+        skip_call |= retireFence(dev_data, fence);
     }
     loader_platform_thread_unlock_mutex(&globalLock);
     if (VK_FALSE != skip_call)
@@ -4400,16 +4364,12 @@ vkGetDeviceQueue(VkDevice device, uint32_t queueFamilyIndex, uint32_t queueIndex
 
 VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueueWaitIdle(VkQueue queue) {
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(queue), layer_data_map);
-    decrementResources(dev_data, queue);
     VkBool32 skip_call = VK_FALSE;
     loader_platform_thread_lock_mutex(&globalLock);
-    // Iterate over local set since we erase set members as we go in for loop
-    auto local_cb_set = dev_data->queueMap[queue].inFlightCmdBuffers;
-    for (auto cmdBuffer : local_cb_set) {
-        skip_call |= cleanInFlightCmdBuffer(dev_data, cmdBuffer);
-        removeInFlightCmdBuffer(dev_data, cmdBuffer, queue);
+    auto queue_data = dev_data->queueMap.find(queue);
+    if (queue_data != dev_data->queueMap.end()) {
+        skip_call |= retireQueueSubmissions(dev_data, &queue_data->second, queue_data->second.submitSeq);
     }
-    dev_data->queueMap[queue].inFlightCmdBuffers.clear();
     loader_platform_thread_unlock_mutex(&globalLock);
     if (VK_FALSE != skip_call)
         return VK_ERROR_VALIDATION_FAILED_EXT;
@@ -4420,17 +4380,13 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkDeviceWaitIdle(VkDevice device)
     VkBool32 skip_call = VK_FALSE;
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     loader_platform_thread_lock_mutex(&globalLock);
-    for (auto queue : dev_data->queues) {
-        decrementResources(dev_data, queue);
-        if (dev_data->queueMap.find(queue) != dev_data->queueMap.end()) {
-            // Clear all of the queue inFlightCmdBuffers (global set cleared below)
-            dev_data->queueMap[queue].inFlightCmdBuffers.clear();
-        }
+    for (auto &queue_data : dev_data->queueMap) {
+        skip_call |= retireQueueSubmissions(dev_data, &queue_data.second, queue_data.second.submitSeq);
     }
-    for (auto cmdBuffer : dev_data->globalInFlightCmdBuffers) {
+    for (auto cmdBuffer : dev_data->recordedSecondaryCmdBuffers) {
         skip_call |= cleanInFlightCmdBuffer(dev_data, cmdBuffer);
     }
-    dev_data->globalInFlightCmdBuffers.clear();
+    dev_data->recordedSecondaryCmdBuffers.clear();
     loader_platform_thread_unlock_mutex(&globalLock);
     if (VK_FALSE != skip_call)
         return VK_ERROR_VALIDATION_FAILED_EXT;
@@ -4441,7 +4397,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyFence(VkDevice device, VkFen
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     bool skipCall = false;
     loader_platform_thread_lock_mutex(&globalLock);
-    if (dev_data->fenceMap[fence].in_use.load()) {
+    if (dev_data->fenceMap[fence].inUse()) {
         skipCall |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_FENCE_EXT,
                             (uint64_t)(fence), __LINE__, DRAWSTATE_INVALID_FENCE, "DS",
                             "Fence %#" PRIx64 " is in use by a command buffer.", (uint64_t)(fence));
@@ -4457,7 +4413,7 @@ vkDestroySemaphore(VkDevice device, VkSemaphore semaphore, const VkAllocationCal
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
     dev_data->device_dispatch_table->DestroySemaphore(device, semaphore, pAllocator);
     loader_platform_thread_lock_mutex(&globalLock);
-    if (dev_data->semaphoreMap[semaphore].in_use.load()) {
+    if (dev_data->semaphoreMap[semaphore].inUse()) {
         log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_SEMAPHORE_EXT,
                 reinterpret_cast<uint64_t &>(semaphore), __LINE__, DRAWSTATE_INVALID_SEMAPHORE, "DS",
                 "Cannot delete semaphore %" PRIx64 " which is in use.", reinterpret_cast<uint64_t &>(semaphore));
@@ -4473,7 +4429,7 @@ VK_LAYER_EXPORT VKAPI_ATTR void VKAPI_CALL vkDestroyEvent(VkDevice device, VkEve
     loader_platform_thread_lock_mutex(&globalLock);
     auto event_data = dev_data->eventMap.find(event);
     if (event_data != dev_data->eventMap.end()) {
-        if (event_data->second.in_use.load()) {
+        if (event_data->second.inUse()) {
             skip_call |= log_msg(
                 dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
                 reinterpret_cast<uint64_t &>(event), __LINE__, DRAWSTATE_INVALID_EVENT, "DS",
@@ -4501,8 +4457,16 @@ VKAPI_ATTR VkResult VKAPI_CALL vkGetQueryPoolResults(VkDevice device, VkQueryPoo
     unordered_map<QueryObject, vector<VkCommandBuffer>> queriesInFlight;
     GLOBAL_CB_NODE *pCB = nullptr;
     loader_platform_thread_lock_mutex(&globalLock);
-    for (auto cmdBuffer : dev_data->globalInFlightCmdBuffers) {
+    unordered_set<VkCommandBuffer> inFlightCmdBuffers(dev_data->recordedSecondaryCmdBuffers);
+    for (auto &queue_data : dev_data->queueMap) {
+        for (auto &submission : queue_data.second.submissions) {
+            inFlightCmdBuffers.insert(submission.cmdBuffers.begin(), submission.cmdBuffers.end());
+        }
+    }
+    for (auto cmdBuffer : inFlightCmdBuffers) {
         pCB = getCBNode(dev_data, cmdBuffer);
+        if (!pCB)
+            continue;
         for (auto queryStatePair : pCB->queryToStateMap) {
             queriesInFlight[queryStatePair.first].push_back(cmdBuffer);
         }
@@ -4575,7 +4539,7 @@ VkBool32 validateIdleBuffer(const layer_data *my_data, VkBuffer buffer) {
                              (uint64_t)(buffer), __LINE__, DRAWSTATE_DOUBLE_DESTROY, "DS",
                              "Cannot free buffer %" PRIxLEAST64 " that has not been allocated.", (uint64_t)(buffer));
     } else {
-        if (buffer_data->second.in_use.load()) {
+        if (buffer_data->second.inUse()) {
             skip_call |= log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT,
                                  (uint64_t)(buffer), __LINE__, DRAWSTATE_OBJECT_INUSE, "DS",
                                  "Cannot free buffer %" PRIxLEAST64 " that is in use by a command buffer.", (uint64_t)(buffer));
@@ -4668,7 +4632,7 @@ vkFreeCommandBuffers(VkDevice device, VkCommandPool commandPool, uint32_t count,
     bool skip_call = false;
     loader_platform_thread_lock_mutex(&globalLock);
     for (uint32_t i = 0; i < count; i++) {
-        if (dev_data->globalInFlightCmdBuffers.count(pCommandBuffers[i])) {
+        if (isCmdBufferInFlight(dev_data, pCommandBuffers[i])) {
             skip_call |=
                 log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
                         reinterpret_cast<uint64_t>(pCommandBuffers[i]), __LINE__, DRAWSTATE_INVALID_COMMAND_BUFFER_RESET, "DS",
@@ -4727,7 +4691,7 @@ VkBool32 validateCommandBuffersNotInUse(const layer_data *dev_data, VkCommandPoo
     auto pool_data = dev_data->commandPoolMap.find(commandPool);
     if (pool_data != dev_data->commandPoolMap.end()) {
         for (auto cmdBuffer : pool_data->second.commandBuffers) {
-            if (dev_data->globalInFlightCmdBuffers.count(cmdBuffer)) {
+            if (isCmdBufferInFlight(dev_data, cmdBuffer)) {
                 skipCall |=
                     log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_POOL_EXT,
                             (uint64_t)(commandPool), __LINE__, DRAWSTATE_OBJECT_INUSE, "DS",
@@ -4793,7 +4757,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkResetFences(VkDevice device, ui
     bool skipCall = false;
     loader_platform_thread_lock_mutex(&globalLock);
     for (uint32_t i = 0; i < fenceCount; ++i) {
-        if (dev_data->fenceMap[pFences[i]].in_use.load()) {
+        if (dev_data->fenceMap[pFences[i]].inUse()) {
             skipCall |=
                 log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_FENCE_EXT,
                         reinterpret_cast<const uint64_t &>(pFences[i]), __LINE__, DRAWSTATE_INVALID_FENCE, "DS",
@@ -4861,7 +4825,6 @@ vkCreateBuffer(VkDevice device, const VkBufferCreateInfo *pCreateInfo, const VkA
         loader_platform_thread_lock_mutex(&globalLock);
         // TODO : This doesn't create deep copy of pQueueFamilyIndices so need to fix that if/when we want that data to be valid
         dev_data->bufferMap[*pBuffer].create_info = unique_ptr<VkBufferCreateInfo>(new VkBufferCreateInfo(*pCreateInfo));
-        dev_data->bufferMap[*pBuffer].in_use.store(0);
         loader_platform_thread_unlock_mutex(&globalLock);
     }
     return result;
@@ -4961,7 +4924,7 @@ vkCreateFence(VkDevice device, const VkFenceCreateInfo *pCreateInfo, const VkAll
     VkResult result = dev_data->device_dispatch_table->CreateFence(device, pCreateInfo, pAllocator, pFence);
     if (VK_SUCCESS == result) {
         loader_platform_thread_lock_mutex(&globalLock);
-        dev_data->fenceMap[*pFence].in_use.store(0);
+        dev_data->fenceMap[*pFence] = FENCE_NODE();
         loader_platform_thread_unlock_mutex(&globalLock);
     }
     return result;
@@ -5308,7 +5271,6 @@ vkAllocateDescriptorSets(VkDevice device, const VkDescriptorSetAllocateInfo *pAl
                     //  that the count doesn't go below 0. One reset/free need to bump count back up.
                     // Insert set at head of Set LL for this pool
                     pNewNode->pNext = pPoolNode->pSets;
-                    pNewNode->in_use.store(0);
                     pPoolNode->pSets = pNewNode;
                     LAYOUT_NODE *pLayout = getLayoutNode(dev_data, pAllocateInfo->pSetLayouts[i]);
                     if (NULL == pLayout) {
@@ -5408,6 +5370,7 @@ vkAllocateCommandBuffers(VkDevice device, const VkCommandBufferAllocateInfo *pCr
                 dev_data->commandBufferMap[pCommandBuffer[i]] = pCB;
                 resetCB(dev_data, pCommandBuffer[i]);
                 pCB->createInfo = *pCreateInfo;
+                pCB->beginCount = 0;
                 pCB->device = device;
             }
         }
@@ -5521,6 +5484,7 @@ vkBeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginIn
         }
         // Set updated state here in case implicit reset occurs above
         pCB->state = CB_RECORDING;
+        pCB->sampled = layerSamplerBeginCommandBuffer(&g_sampler, (uint64_t)commandBuffer, pCB->beginCount++);
         pCB->beginInfo = *pBeginInfo;
         if (pCB->beginInfo.pInheritanceInfo) {
             pCB->inheritanceInfo = *(pCB->beginInfo.pInheritanceInfo);
@@ -5587,7 +5551,7 @@ vkResetCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferResetFlags fl
                             ") that does NOT have the VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT bit set.",
                             (uint64_t)commandBuffer, (uint64_t)cmdPool);
     }
-    if (dev_data->globalInFlightCmdBuffers.count(commandBuffer)) {
+    if (isCmdBufferInFlight(dev_data, commandBuffer)) {
         skipCall |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
                             (uint64_t)commandBuffer, __LINE__, DRAWSTATE_INVALID_COMMAND_BUFFER_RESET, "DS",
                             "Attempt to reset command buffer (%#" PRIxLEAST64 ") which is in use.",
@@ -7986,7 +7950,7 @@ vkCmdExecuteCommands(VkCommandBuffer commandBuffer, uint32_t commandBuffersCount
             // Secondary cmdBuffers are considered pending execution starting w/
             // being recorded
             if (!(pSubCB->beginInfo.flags & VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT)) {
-                if (dev_data->globalInFlightCmdBuffers.find(pSubCB->commandBuffer) != dev_data->globalInFlightCmdBuffers.end()) {
+                if (isCmdBufferInFlight(dev_data, pSubCB->commandBuffer)) {
                     skipCall |= log_msg(
                         dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
                         (uint64_t)(pCB->commandBuffer), __LINE__, DRAWSTATE_INVALID_CB_SIMULTANEOUS_USE, "DS",
@@ -8019,7 +7983,7 @@ vkCmdExecuteCommands(VkCommandBuffer commandBuffer, uint32_t commandBuffersCount
             }
             pSubCB->primaryCommandBuffer = pCB->commandBuffer;
             pCB->secondaryCommandBuffers.insert(pSubCB->commandBuffer);
-            dev_data->globalInFlightCmdBuffers.insert(pSubCB->commandBuffer);
+            dev_data->recordedSecondaryCmdBuffers.insert(pSubCB->commandBuffer);
         }
         skipCall |= validatePrimaryCommandBuffer(dev_data, pCB, "vkCmdExecuteComands");
         skipCall |= addCmd(dev_data, pCB, CMD_EXECUTECOMMANDS, "vkCmdExecuteComands()");
@@ -8126,7 +8090,6 @@ VKAPI_ATTR VkResult VKAPI_CALL vkCreateSemaphore(VkDevice device, const VkSemaph
     if (result == VK_SUCCESS) {
         loader_platform_thread_lock_mutex(&globalLock);
         dev_data->semaphoreMap[*pSemaphore].signaled = 0;
-        dev_data->semaphoreMap[*pSemaphore].in_use.store(0);
         loader_platform_thread_unlock_mutex(&globalLock);
     }
     return result;
@@ -8139,7 +8102,6 @@ vkCreateEvent(VkDevice device, const VkEventCreateInfo *pCreateInfo, const VkAll
     if (result == VK_SUCCESS) {
         loader_platform_thread_lock_mutex(&globalLock);
         dev_data->eventMap[*pEvent].needsSignaled = false;
-        dev_data->eventMap[*pEvent].in_use.store(0);
         dev_data->eventMap[*pEvent].stageMask = VkPipelineStageFlags(0);
         loader_platform_thread_unlock_mutex(&globalLock);
     }
@@ -8222,6 +8184,9 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueuePresentKHR(VkQueue queue,
     layer_data *dev_data = get_my_data_ptr(get_dispatch_key(queue), layer_data_map);
     VkBool32 skip_call = VK_FALSE;
 
+    pollLayerSettings();
+    layerSamplerEndFrame(&g_sampler);
+
     if (pPresentInfo) {
         loader_platform_thread_lock_mutex(&globalLock);
         for (uint32_t i = 0; i < pPresentInfo->waitSemaphoreCount; ++i) {
@@ -29,7 +29,7 @@
  */
 
 #include "vulkan/vk_layer.h"
-#include <atomic>
+#include <deque>
 #include <vector>
 #include <memory>
 
@@ -279,9 +279,46 @@ typedef struct _PIPELINE_NODE {
           attachmentCount(0), pAttachments(0){};
 } PIPELINE_NODE;
 
+// Submission timeline: each vkQueueSubmit takes the next sequence number on its
+// queue and objects record the latest sequence they were submitted at.  Waiting
+// on a fence or idling a queue only advances that queue's retired watermark, so
+// an object is in use exactly while one of its sequences is above it.
+struct SUBMISSION_NODE {
+    uint64_t seq;
+    vector<VkCommandBuffer> cmdBuffers; // Primaries and the secondaries they execute
+};
+
+class QUEUE_NODE {
+  public:
+    VkDevice device;
+    uint64_t submitSeq;                      // Sequence of the latest submission
+    uint64_t retiredSeq;                     // Every submission up to this one has completed
+    std::deque<SUBMISSION_NODE> submissions; // Submissions not yet retired, oldest first
+
+    QUEUE_NODE() : device(VK_NULL_HANDLE), submitSeq(0), retiredSeq(0){};
+};
+
 class BASE_NODE {
   public:
-    std::atomic_int in_use;
+    // Latest submission referencing this object on each queue it was submitted to
+    vector<std::pair<QUEUE_NODE *, uint64_t>> lastUse;
+
+    void markUsed(QUEUE_NODE *queue, uint64_t seq) {
+        for (auto &use : lastUse) {
+            if (use.first == queue) {
+                use.second = seq;
+                return;
+            }
+        }
+        lastUse.push_back(std::make_pair(queue, seq));
+    }
+    bool inUse() const {
+        for (auto &use : lastUse) {
+            if (use.second > use.first->retiredSeq)
+                return true;
+        }
+        return false;
+    }
 };
 
 typedef struct _SAMPLER_NODE {
@@ -311,7 +348,6 @@ typedef struct _IMAGE_CMD_BUF_LAYOUT_NODE {
 
 class BUFFER_NODE : public BASE_NODE {
   public:
-    using BASE_NODE::in_use;
     unique_ptr<VkBufferCreateInfo> create_info;
 };
 
@@ -359,37 +395,24 @@ class PHYS_DEV_PROPERTIES_NODE {
 
 class FENCE_NODE : public BASE_NODE {
   public:
-    using BASE_NODE::in_use;
-    VkQueue queue;
-    vector<VkCommandBuffer> cmdBuffers;
-    bool needsSignaled;
-    VkFence priorFence;
+    VkQueue queue;      // Queue of the last submission this fence was passed to
+    uint64_t submitSeq; // Sequence of that submission on the queue
 
     // Default constructor
-    FENCE_NODE() : queue(NULL), needsSignaled(VK_FALSE), priorFence(static_cast<VkFence>(NULL)){};
+    FENCE_NODE() : queue(NULL), submitSeq(0){};
 };
 
 class SEMAPHORE_NODE : public BASE_NODE {
   public:
-    using BASE_NODE::in_use;
     uint32_t signaled;
 };
 
 class EVENT_NODE : public BASE_NODE {
   public:
-    using BASE_NODE::in_use;
     bool needsSignaled;
     VkPipelineStageFlags stageMask;
 };
 
-class QUEUE_NODE {
-  public:
-    VkDevice device;
-    VkFence priorFence;
-    vector<VkCommandBuffer> untrackedCmdBuffers;
-    unordered_set<VkCommandBuffer> inFlightCmdBuffers;
-};
-
 class QUERY_POOL_NODE : public BASE_NODE {
   public:
     VkQueryPoolCreateInfo createInfo;
@@ -429,7 +452,6 @@ struct PIPELINE_LAYOUT_NODE {
 
 class SET_NODE : public BASE_NODE {
   public:
-    using BASE_NODE::in_use;
     VkDescriptorSet set;
     VkDescriptorPool pool;
     // Head of LL of all Update structs for this set
@@ -620,7 +642,7 @@ template <> struct hash<QueryObject> {
 }
 
 // Cmd Buffer Wrapper Struct
-typedef struct _GLOBAL_CB_NODE {
+typedef struct _GLOBAL_CB_NODE : public BASE_NODE {
     VkCommandBuffer commandBuffer;
     VkCommandBufferAllocateInfo createInfo;
     VkCommandBufferBeginInfo beginInfo;
@@ -631,6 +653,8 @@ typedef struct _GLOBAL_CB_NODE {
     uint64_t drawCount[NUM_DRAW_TYPES]; // Count of each type of draw in this CB
     CB_STATE state;                     // Track cmd buffer update state
     uint64_t submitCount;               // Number of times CB has been submitted
+    uint64_t beginCount;                // Times recording has begun, kept across resets for the sampler
+    bool sampled;                       // Heavy validation enabled for this recording (see LayerSampler)
     CBStatusFlags status;               // Track status of various bindings on cmd buffer
     vector<CMD_NODE> cmds;              // vector of commands bound to this command buffer
     // Currently storing "lastBound" objects on per-CB basis
@@ -78,10 +78,12 @@ struct layer_data {
     unordered_map<uint64_t, MT_OBJ_BINDING_INFO> imageMap;
     unordered_map<uint64_t, MT_OBJ_BINDING_INFO> bufferMap;
     unordered_map<VkBufferView, VkBufferViewCreateInfo> bufferViewMap;
+    // Cleared while running deferred checks of a command buffer the sampler skipped
+    bool cbChecksActive;
 
     layer_data()
         : report_data(nullptr), device_dispatch_table(nullptr), instance_dispatch_table(nullptr), wsi_enabled(VK_FALSE),
-          currentFenceId(1){};
+          currentFenceId(1), cbChecksActive(true){};
 };
 
 static unordered_map<void *, layer_data *> layer_data_map;
@@ -94,6 +96,10 @@ static VkBool32 clear_cmd_buf_and_mem_references(layer_data *my_data, const VkCo
 static int globalLockInitialized = 0;
 static loader_platform_thread_mutex globalLock;
 
+// Check categories enabled through lunarg_mem_tracker.enable_checks, refreshed on settings reload
+static const LayerOptionHandle *g_checkMask = NULL;
+static LayerSampler g_sampler;
+
 #define MAX_BINDING 0xFFFFFFFF
 
 static MT_OBJ_BINDING_INFO *get_object_binding_info(layer_data *my_data, uint64_t handle, VkDebugReportObjectTypeEXT type) {
@@ -218,6 +224,20 @@ static void add_object_create_info(layer_data *my_data, const uint64_t handle, c
     }
 }
 
+// A submitted fence is signaled once its fenceId falls under its queue's
+// lastRetiredId, so idling a queue or device signals every fence submitted to it
+// without visiting them.
+static bool is_fence_signaled(layer_data *my_data, const MT_FENCE_INFO *pFenceInfo) {
+    if (pFenceInfo->createInfo.flags & VK_FENCE_CREATE_SIGNALED_BIT) {
+        return true;
+    }
+    if (pFenceInfo->queue != VK_NULL_HANDLE) {
+        auto queue_item = my_data->queueMap.find(pFenceInfo->queue);
+        return queue_item != my_data->queueMap.end() && pFenceInfo->fenceId <= queue_item->second.lastRetiredId;
+    }
+    return false;
+}
+
 // Add a fence, creating one if necessary to our list of fences/fenceIds
 static VkBool32 add_fence_info(layer_data *my_data, VkFence fence, VkQueue queue, uint64_t *fenceId) {
     VkBool32 skipCall = VK_FALSE;
@@ -225,11 +245,12 @@ static VkBool32 add_fence_info(layer_data *my_data, VkFence fence, VkQueue queue
 
     // If no fence, create an internal fence to track the submissions
     if (fence != VK_NULL_HANDLE) {
-        my_data->fenceMap[fence].fenceId = *fenceId;
-        my_data->fenceMap[fence].queue = queue;
+        MT_FENCE_INFO *pFenceInfo = &my_data->fenceMap[fence];
         // Validate that fence is in UNSIGNALED state
-        VkFenceCreateInfo *pFenceCI = &(my_data->fenceMap[fence].createInfo);
-        if (pFenceCI->flags & VK_FENCE_CREATE_SIGNALED_BIT) {
+        bool signaled = is_fence_signaled(my_data, pFenceInfo);
+        pFenceInfo->fenceId = *fenceId;
+        pFenceInfo->queue = queue;
+        if (signaled) {
             skipCall = log_msg(my_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_FENCE_EXT,
                                (uint64_t)fence, __LINE__, MEMTRACK_INVALID_FENCE_STATE, "MEM",
                                "Fence %#" PRIxLEAST64 " submitted in SIGNALED state.  Fences must be reset before being submitted",
@@ -364,6 +385,8 @@ static void add_mem_obj_info(layer_data *my_data, void *object, const VkDeviceMe
 
 static VkBool32 validate_memory_is_valid(layer_data *my_data, VkDeviceMemory mem, const char *functionName,
                                          VkImage image = VK_NULL_HANDLE) {
+    if (!my_data->cbChecksActive || !layerCheckEnabled(g_checkMask, LAYER_CHECK_MEMORY))
+        return VK_FALSE;
     if (mem == MEMTRACKER_SWAP_CHAIN_IMAGE_KEY) {
         MT_OBJ_BINDING_INFO *pBindInfo = get_object_binding_info(my_data, (uint64_t)(image), VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT);
         if (pBindInfo && !pBindInfo->valid) {
@@ -922,6 +945,9 @@ static void init_mem_tracker(layer_data *my_data, const VkAllocationCallbacks *p
 
     // Zero out memory property data
     memset(&memProps, 0, sizeof(VkPhysicalDeviceMemoryProperties));
+
+    g_checkMask = getLayerCheckMask("lunarg_mem_tracker");
+    initLayerSampler(&g_sampler);
 }
 
 // hook DestroyInstance to remove tableInstanceMap entry
@@ -1133,6 +1159,7 @@ vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits,
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(queue), layer_data_map);
     VkResult result = VK_ERROR_VALIDATION_FAILED_EXT;
 
+    pollLayerSettings();
     loader_platform_thread_lock_mutex(&globalLock);
     // TODO : Need to track fence and clear mem references when fence clears
     MT_CB_INFO *pCBInfo = NULL;
@@ -1149,9 +1176,13 @@ vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo *pSubmits,
                 pCBInfo->fenceId = fenceId;
                 pCBInfo->lastSubmittedFence = fence;
                 pCBInfo->lastSubmittedQueue = queue;
+                // Deferred functions also update memory validity, so they always run;
+                // only the checks inside them are suppressed for unsampled command buffers
+                my_data->cbChecksActive = pCBInfo->sampled;
                 for (auto &function : pCBInfo->validate_functions) {
                     skipCall |= function();
                 }
+                my_data->cbChecksActive = true;
             }
         }
 
@@ -1725,7 +1756,7 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkResetFences(VkDevice device, ui
         auto fence_item = my_data->fenceMap.find(pFences[i]);
         if (fence_item != my_data->fenceMap.end()) {
             // Validate fences in SIGNALED state
-            if (!(fence_item->second.createInfo.flags & VK_FENCE_CREATE_SIGNALED_BIT)) {
+            if (!is_fence_signaled(my_data, &fence_item->second)) {
                 // TODO: I don't see a Valid Usage section for ResetFences. This behavior should be documented there.
                 skipCall = log_msg(my_data->report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_FENCE_EXT,
                                    (uint64_t)pFences[i], __LINE__, MEMTRACK_INVALID_FENCE_STATE, "MEM",
@@ -1733,6 +1764,8 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkResetFences(VkDevice device, ui
             } else {
                 fence_item->second.createInfo.flags =
                     static_cast<VkFenceCreateFlags>(fence_item->second.createInfo.flags & ~VK_FENCE_CREATE_SIGNALED_BIT);
+                // Detach from the queue so its watermark no longer signals this fence
+                fence_item->second.queue = VK_NULL_HANDLE;
             }
         }
     }
@@ -1749,8 +1782,7 @@ static inline VkBool32 verifyFenceStatus(VkDevice device, VkFence fence, const c
     auto pFenceInfo = my_data->fenceMap.find(fence);
     if (pFenceInfo != my_data->fenceMap.end()) {
         if (pFenceInfo->second.firstTimeFlag != VK_TRUE) {
-            if ((pFenceInfo->second.createInfo.flags & VK_FENCE_CREATE_SIGNALED_BIT) &&
-                pFenceInfo->second.firstTimeFlag != VK_TRUE) {
+            if (is_fence_signaled(my_data, &pFenceInfo->second) && pFenceInfo->second.firstTimeFlag != VK_TRUE) {
                 skipCall |=
                     log_msg(my_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_FENCE_EXT,
                             (uint64_t)fence, __LINE__, MEMTRACK_INVALID_FENCE_STATE, "MEM",
@@ -2046,6 +2078,10 @@ vkBeginCommandBuffer(VkCommandBuffer commandBuffer, const VkCommandBufferBeginIn
     }
     loader_platform_thread_lock_mutex(&globalLock);
     clear_cmd_buf_and_mem_references(my_data, commandBuffer);
+    MT_CB_INFO *pCBInfo = get_cmd_buf_info(my_data, commandBuffer);
+    if (pCBInfo) {
+        pCBInfo->sampled = layerSamplerBeginCommandBuffer(&g_sampler, (uint64_t)commandBuffer, pCBInfo->beginCount++);
+    }
     loader_platform_thread_unlock_mutex(&globalLock);
     return result;
 }
@@ -2811,6 +2847,8 @@ VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL vkQueuePresentKHR(VkQueue queue,
     layer_data *my_data = get_my_data_ptr(get_dispatch_key(queue), layer_data_map);
     VkBool32 skip_call = false;
     VkDeviceMemory mem;
+    pollLayerSettings();
+    layerSamplerEndFrame(&g_sampler);
     loader_platform_thread_lock_mutex(&globalLock);
     for (uint32_t i = 0; i < pPresentInfo->swapchainCount; ++i) {
         MT_SWAP_CHAIN_INFO *pInfo = my_data->swapchainMap[pPresentInfo->pSwapchains[i]];
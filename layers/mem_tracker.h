@@ -138,12 +138,16 @@ typedef struct _MT_CB_INFO {
     VkFence lastSubmittedFence;
     VkQueue lastSubmittedQueue;
     VkRenderPass pass;
+    uint64_t beginCount; // Times recording has begun, for the sampler
+    bool sampled;        // Memory-validity checks enabled for this recording (see LayerSampler)
     vector<VkDescriptorSet> activeDescriptorSets;
     vector<std::function<VkBool32()>> validate_functions;
     // Order dependent, stl containers must be at end of struct
     list<VkDeviceMemory> pMemObjList; // List container of Mem objs referenced by this CB
     // Constructor
-    _MT_CB_INFO() : createInfo{}, pipelines{}, attachmentCount(0), fenceId(0), lastSubmittedFence{}, lastSubmittedQueue{} {};
+    _MT_CB_INFO()
+        : createInfo{}, pipelines{}, attachmentCount(0), fenceId(0), lastSubmittedFence{}, lastSubmittedQueue{}, beginCount(0),
+          sampled(true){};
 } MT_CB_INFO;
 
 // Track command pools and their command buffers
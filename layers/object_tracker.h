@@ -231,6 +231,22 @@ static uint32_t objTypeToIndex(uint32_t objType) {
     return index;
 }
 
+// Extension functions, returned by vkGetDeviceProcAddr.  The counts cover
+// the objects of every instance and device the layer tracks.
+uint64_t objTrackGetObjectCount(VkDevice device) {
+    loader_platform_thread_lock_mutex(&objLock);
+    uint64_t count = numTotalObjs;
+    loader_platform_thread_unlock_mutex(&objLock);
+    return count;
+}
+
+uint64_t objTrackGetObjectsOfTypeCount(VkDevice device, VkDebugReportObjectTypeEXT type) {
+    loader_platform_thread_lock_mutex(&objLock);
+    uint64_t count = numObjs[objTypeToIndex(type)];
+    loader_platform_thread_unlock_mutex(&objLock);
+    return count;
+}
+
 // Add new queue to head of global queue list
 static void addQueueInfo(uint32_t queueNodeIndex, VkQueue queue) {
     OT_QUEUE_INFO *pQueueInfo = new OT_QUEUE_INFO;
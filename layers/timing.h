@@ -0,0 +1,541 @@
+/* Copyright (c) 2015-2016 The Khronos Group Inc.
+ * Copyright (c) 2015-2016 Valve Corporation
+ * Copyright (c) 2015-2016 LunarG, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and/or associated documentation files (the "Materials"), to
+ * deal in the Materials without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Materials, and to permit persons to whom the Materials
+ * are furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice(s) and this permission notice shall be included
+ * in all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE MATERIALS OR THE
+ * USE OR OTHER DEALINGS IN THE MATERIALS
+ */
+
+// Runtime support for the generated timing layer (vk-layer-generate.py timing).
+//
+// Every intercepted entry point samples a monotonic clock around the call down
+// the chain and records the elapsed nanoseconds in a log-linear histogram.
+// Histograms are owned by the calling thread and are only ever written by it,
+// so recording needs no locks or read-modify-write atomics.  A report merges
+// all threads' histograms and is written when a device is destroyed, or after
+// lunarg_timing.dump_signal is received.
+//
+// Before including this file the generated code defines TimingEntryPoint,
+// TIMING_ENTRY_POINT_COUNT and timingEntryPointNames[].
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <signal.h>
+#endif
+
+#include "vulkan/vulkan.h"
+#include "vk_loader_platform.h"
+#include "vulkan/vk_layer.h"
+#include "vk_layer_config.h"
+#include "vk_layer_table.h"
+#include "vk_layer_data.h"
+#include "vk_layer_extension_utils.h"
+
+struct layer_data {
+    bool wsi_enabled;
+
+    layer_data() : wsi_enabled(false){};
+};
+
+struct instExts {
+    bool wsi_enabled;
+};
+
+static std::unordered_map<void *, struct instExts> instanceExtMap;
+static std::unordered_map<void *, layer_data *> layer_data_map;
+static device_table_map timing_device_table_map;
+static instance_table_map timing_instance_table_map;
+
+static LOADER_PLATFORM_THREAD_ONCE_DECLARATION(initOnce);
+
+// Log-linear buckets: values below TIMING_SUB_BUCKETS get a bucket each, above
+// that every power of two is split into TIMING_SUB_BUCKETS linear sub-buckets,
+// which bounds the quantile error to 1/TIMING_SUB_BUCKETS (12.5%).
+#define TIMING_SUB_BUCKET_BITS 3
+#define TIMING_SUB_BUCKETS (1 << TIMING_SUB_BUCKET_BITS)
+#define TIMING_BUCKET_COUNT ((64 - TIMING_SUB_BUCKET_BITS + 1) * TIMING_SUB_BUCKETS)
+
+#ifdef _WIN32
+#define TIMING_THREAD_LOCAL __declspec(thread)
+#else
+#define TIMING_THREAD_LOCAL __thread
+#endif
+
+struct TimingHistogram {
+    std::atomic<uint64_t> buckets[TIMING_BUCKET_COUNT];
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> totalNs;
+    std::atomic<uint64_t> maxNs;
+
+    TimingHistogram() {
+        for (uint32_t i = 0; i < TIMING_BUCKET_COUNT; i++) {
+            buckets[i].store(0, std::memory_order_relaxed);
+        }
+        calls.store(0, std::memory_order_relaxed);
+        totalNs.store(0, std::memory_order_relaxed);
+        maxNs.store(0, std::memory_order_relaxed);
+    }
+};
+
+// One per application thread that has called into the layer.  Histograms are
+// allocated the first time the thread calls a given entry point, and blocks
+// stay on the list after the thread exits so their samples are still reported.
+struct TimingThreadData {
+    loader_platform_thread_id threadId;
+    std::atomic<TimingHistogram *> entries[TIMING_ENTRY_POINT_COUNT];
+    TimingThreadData *next;
+
+    TimingThreadData() : threadId(loader_platform_get_thread_id()), next(NULL) {
+        for (uint32_t i = 0; i < TIMING_ENTRY_POINT_COUNT; i++) {
+            entries[i].store(NULL, std::memory_order_relaxed);
+        }
+    }
+};
+
+static std::atomic<TimingThreadData *> timingThreadList(NULL);
+static TIMING_THREAD_LOCAL TimingThreadData *timingThreadData = NULL;
+
+enum TimingOutputFormat { TIMING_OUTPUT_JSON, TIMING_OUTPUT_CSV };
+
+static std::string timingOutputFile = "vk_timing.json";
+static TimingOutputFormat timingOutputFormat = TIMING_OUTPUT_JSON;
+static std::mutex timingReportLock;
+static std::atomic<bool> timingDumpRequested(false);
+
+static inline uint64_t timing_now() {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    uint64_t seconds = counter.QuadPart / frequency.QuadPart;
+    uint64_t remainder = counter.QuadPart % frequency.QuadPart;
+    return seconds * 1000000000ull + remainder * 1000000000ull / frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static inline uint32_t timing_log2(uint64_t value) {
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(value);
+#else
+    uint32_t result = 0;
+    for (uint32_t shift = 32; shift > 0; shift >>= 1) {
+        if (value >> shift) {
+            value >>= shift;
+            result += shift;
+        }
+    }
+    return result;
+#endif
+}
+
+static inline uint32_t timing_bucket(uint64_t ns) {
+    if (ns < TIMING_SUB_BUCKETS) {
+        return (uint32_t)ns;
+    }
+    uint32_t exponent = timing_log2(ns);
+    uint32_t sub = (uint32_t)(ns >> (exponent - TIMING_SUB_BUCKET_BITS)) & (TIMING_SUB_BUCKETS - 1);
+    return (exponent - TIMING_SUB_BUCKET_BITS + 1) * TIMING_SUB_BUCKETS + sub;
+}
+
+// Largest value that falls into the given bucket
+static uint64_t timing_bucket_upper_bound(uint32_t bucket) {
+    if (bucket < TIMING_SUB_BUCKETS) {
+        return bucket;
+    }
+    uint32_t exponent = bucket / TIMING_SUB_BUCKETS + TIMING_SUB_BUCKET_BITS - 1;
+    uint64_t sub = bucket % TIMING_SUB_BUCKETS;
+    uint64_t width = 1ull << (exponent - TIMING_SUB_BUCKET_BITS);
+    return ((TIMING_SUB_BUCKETS + sub) << (exponent - TIMING_SUB_BUCKET_BITS)) + (width - 1);
+}
+
+static TimingThreadData *timing_register_thread() {
+    TimingThreadData *data = new TimingThreadData();
+    TimingThreadData *head = timingThreadList.load(std::memory_order_relaxed);
+    do {
+        data->next = head;
+    } while (!timingThreadList.compare_exchange_weak(head, data, std::memory_order_release, std::memory_order_relaxed));
+    timingThreadData = data;
+    return data;
+}
+
+// Only the owning thread writes a histogram, so plain load/store pairs are
+// enough; readers may see a slightly stale but never torn value.
+static inline void timing_record(uint32_t entryPoint, uint64_t startNs) {
+    uint64_t ns = timing_now() - startNs;
+    TimingThreadData *data = timingThreadData;
+    if (!data) {
+        data = timing_register_thread();
+    }
+    TimingHistogram *hist = data->entries[entryPoint].load(std::memory_order_relaxed);
+    if (!hist) {
+        hist = new TimingHistogram();
+        data->entries[entryPoint].store(hist, std::memory_order_release);
+    }
+    std::atomic<uint64_t> &bucket = hist->buckets[timing_bucket(ns)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    hist->calls.store(hist->calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    hist->totalNs.store(hist->totalNs.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+    if (ns > hist->maxNs.load(std::memory_order_relaxed)) {
+        hist->maxNs.store(ns, std::memory_order_relaxed);
+    }
+}
+
+// Snapshot of one or more histograms, taken while writing a report
+struct TimingSummary {
+    uint64_t buckets[TIMING_BUCKET_COUNT];
+    uint64_t calls;
+    uint64_t totalNs;
+    uint64_t maxNs;
+
+    TimingSummary() : calls(0), totalNs(0), maxNs(0) { memset(buckets, 0, sizeof(buckets)); }
+
+    void add(const TimingHistogram *hist) {
+        for (uint32_t i = 0; i < TIMING_BUCKET_COUNT; i++) {
+            buckets[i] += hist->buckets[i].load(std::memory_order_relaxed);
+        }
+        calls += hist->calls.load(std::memory_order_relaxed);
+        totalNs += hist->totalNs.load(std::memory_order_relaxed);
+        maxNs = std::max(maxNs, hist->maxNs.load(std::memory_order_relaxed));
+    }
+
+    uint64_t quantile(double q) const {
+        uint64_t sampled = 0;
+        for (uint32_t i = 0; i < TIMING_BUCKET_COUNT; i++) {
+            sampled += buckets[i];
+        }
+        if (sampled == 0) {
+            return 0;
+        }
+        uint64_t rank = (uint64_t)(q * (double)sampled);
+        if (rank >= sampled) {
+            rank = sampled - 1;
+        }
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < TIMING_BUCKET_COUNT; i++) {
+            seen += buckets[i];
+            if (seen > rank) {
+                return std::min(timing_bucket_upper_bound(i), maxNs);
+            }
+        }
+        return maxNs;
+    }
+};
+
+static void timing_write_entry(FILE *out, bool first, const char *thread, uint32_t entryPoint, const TimingSummary &summary) {
+    if (timingOutputFormat == TIMING_OUTPUT_CSV) {
+        fprintf(out, "%s,%s,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n", thread,
+                timingEntryPointNames[entryPoint], summary.calls, summary.totalNs, summary.quantile(0.50), summary.quantile(0.99),
+                summary.maxNs);
+    } else {
+        fprintf(out,
+                "%s        { \"name\": \"%s\", \"calls\": %" PRIu64 ", \"total_ns\": %" PRIu64 ", \"p50_ns\": %" PRIu64
+                ", \"p99_ns\": %" PRIu64 ", \"max_ns\": %" PRIu64 " }",
+                first ? "" : ",\n", timingEntryPointNames[entryPoint], summary.calls, summary.totalNs, summary.quantile(0.50),
+                summary.quantile(0.99), summary.maxNs);
+    }
+}
+
+static bool timing_compare_total(const std::pair<uint32_t, TimingSummary *> &a, const std::pair<uint32_t, TimingSummary *> &b) {
+    return a.second->totalNs > b.second->totalNs;
+}
+
+// Write all entry points that were called, most expensive first.  The "all"
+// rows merge every thread; per-thread rows follow.  Counts are cumulative
+// since the layer was loaded, so each report supersedes the previous one.
+static void timing_write_report() {
+    std::lock_guard<std::mutex> lock(timingReportLock);
+
+    std::vector<TimingThreadData *> threads;
+    for (TimingThreadData *data = timingThreadList.load(std::memory_order_acquire); data; data = data->next) {
+        threads.push_back(data);
+    }
+    std::reverse(threads.begin(), threads.end());
+
+    std::vector<TimingSummary> totals(TIMING_ENTRY_POINT_COUNT);
+    std::vector<std::vector<TimingSummary>> perThread(threads.size());
+    for (size_t t = 0; t < threads.size(); t++) {
+        perThread[t].resize(TIMING_ENTRY_POINT_COUNT);
+        for (uint32_t i = 0; i < TIMING_ENTRY_POINT_COUNT; i++) {
+            TimingHistogram *hist = threads[t]->entries[i].load(std::memory_order_acquire);
+            if (hist) {
+                perThread[t][i].add(hist);
+                totals[i].add(hist);
+            }
+        }
+    }
+
+    FILE *out = fopen(timingOutputFile.c_str(), "w");
+    if (!out) {
+        fprintf(stderr, "lunarg_timing ERROR: Unable to open output file %s\n", timingOutputFile.c_str());
+        return;
+    }
+
+    for (size_t t = 0; t <= threads.size(); t++) {
+        // t == 0 is the merged view, t > 0 is threads[t - 1]
+        std::vector<TimingSummary> &summaries = (t == 0) ? totals : perThread[t - 1];
+        std::vector<std::pair<uint32_t, TimingSummary *>> sorted;
+        for (uint32_t i = 0; i < TIMING_ENTRY_POINT_COUNT; i++) {
+            if (summaries[i].calls) {
+                sorted.push_back(std::make_pair(i, &summaries[i]));
+            }
+        }
+        std::stable_sort(sorted.begin(), sorted.end(), timing_compare_total);
+
+        char thread[32];
+        if (t == 0) {
+            snprintf(thread, sizeof(thread), "all");
+        } else {
+            snprintf(thread, sizeof(thread), "%" PRIu64, (uint64_t)threads[t - 1]->threadId);
+        }
+
+        if (timingOutputFormat == TIMING_OUTPUT_CSV) {
+            if (t == 0) {
+                fprintf(out, "thread,entry_point,calls,total_ns,p50_ns,p99_ns,max_ns\n");
+            }
+        } else {
+            if (t == 0) {
+                fprintf(out, "{\n    \"thread_count\": %u,\n    \"threads\": [\n", (uint32_t)threads.size());
+            }
+            fprintf(out, "%s    { \"thread\": \"%s\", \"entry_points\": [\n", t == 0 ? "" : ",\n", thread);
+        }
+        for (size_t i = 0; i < sorted.size(); i++) {
+            timing_write_entry(out, i == 0, thread, sorted[i].first, *sorted[i].second);
+        }
+        if (timingOutputFormat == TIMING_OUTPUT_JSON) {
+            fprintf(out, "\n    ] }");
+        }
+    }
+    if (timingOutputFormat == TIMING_OUTPUT_JSON) {
+        fprintf(out, "\n    ]\n}\n");
+    }
+    fclose(out);
+}
+
+#ifndef _WIN32
+static void timing_signal_handler(int) { timingDumpRequested.store(true, std::memory_order_relaxed); }
+#endif
+
+// Reports requested by signal are written from the next submit or present,
+// since the handler itself cannot safely do file I/O.
+static inline void timing_poll_report() {
+    if (timingDumpRequested.load(std::memory_order_relaxed) && timingDumpRequested.exchange(false)) {
+        timing_write_report();
+    }
+}
+
+static void init_timing() {
+    const char *option = getLayerOption("lunarg_timing.output_file");
+    if (option) {
+        // copied, since a settings reload can free the option string
+        timingOutputFile = option;
+    }
+    const char *extension = strrchr(timingOutputFile.c_str(), '.');
+    if (extension && !strcmp(extension, ".csv")) {
+        timingOutputFormat = TIMING_OUTPUT_CSV;
+    }
+    option = getLayerOption("lunarg_timing.output_format");
+    if (option) {
+        if (!strcmp(option, "csv")) {
+            timingOutputFormat = TIMING_OUTPUT_CSV;
+        } else if (!strcmp(option, "json")) {
+            timingOutputFormat = TIMING_OUTPUT_JSON;
+        }
+    }
+#ifndef _WIN32
+    option = getLayerOption("lunarg_timing.dump_signal");
+    if (option) {
+        int sig = 0;
+        if (!strcmp(option, "SIGUSR1")) {
+            sig = SIGUSR1;
+        } else if (!strcmp(option, "SIGUSR2")) {
+            sig = SIGUSR2;
+        } else if (!strcmp(option, "SIGHUP")) {
+            sig = SIGHUP;
+        }
+        if (sig) {
+            struct sigaction action;
+            memset(&action, 0, sizeof(action));
+            action.sa_handler = timing_signal_handler;
+            sigemptyset(&action.sa_mask);
+            action.sa_flags = SA_RESTART;
+            sigaction(sig, &action, NULL);
+        }
+    }
+#endif
+}
+
+// Handle CreateInstance
+static void createInstanceRegisterExtensions(const VkInstanceCreateInfo *pCreateInfo, VkInstance instance) {
+    uint32_t i;
+    VkLayerInstanceDispatchTable *pDisp = get_dispatch_table(timing_instance_table_map, instance);
+    PFN_vkGetInstanceProcAddr gpa = pDisp->GetInstanceProcAddr;
+
+    pDisp->DestroySurfaceKHR = (PFN_vkDestroySurfaceKHR)gpa(instance, "vkDestroySurfaceKHR");
+    pDisp->GetPhysicalDeviceSurfaceSupportKHR =
+        (PFN_vkGetPhysicalDeviceSurfaceSupportKHR)gpa(instance, "vkGetPhysicalDeviceSurfaceSupportKHR");
+    pDisp->GetPhysicalDeviceSurfaceCapabilitiesKHR =
+        (PFN_vkGetPhysicalDeviceSurfaceCapabilitiesKHR)gpa(instance, "vkGetPhysicalDeviceSurfaceCapabilitiesKHR");
+    pDisp->GetPhysicalDeviceSurfaceFormatsKHR =
+        (PFN_vkGetPhysicalDeviceSurfaceFormatsKHR)gpa(instance, "vkGetPhysicalDeviceSurfaceFormatsKHR");
+    pDisp->GetPhysicalDeviceSurfacePresentModesKHR =
+        (PFN_vkGetPhysicalDeviceSurfacePresentModesKHR)gpa(instance, "vkGetPhysicalDeviceSurfacePresentModesKHR");
+#ifdef VK_USE_PLATFORM_WIN32_KHR
+    pDisp->CreateWin32SurfaceKHR = (PFN_vkCreateWin32SurfaceKHR)gpa(instance, "vkCreateWin32SurfaceKHR");
+    pDisp->GetPhysicalDeviceWin32PresentationSupportKHR =
+        (PFN_vkGetPhysicalDeviceWin32PresentationSupportKHR)gpa(instance, "vkGetPhysicalDeviceWin32PresentationSupportKHR");
+#endif // VK_USE_PLATFORM_WIN32_KHR
+#ifdef VK_USE_PLATFORM_XCB_KHR
+    pDisp->CreateXcbSurfaceKHR = (PFN_vkCreateXcbSurfaceKHR)gpa(instance, "vkCreateXcbSurfaceKHR");
+    pDisp->GetPhysicalDeviceXcbPresentationSupportKHR =
+        (PFN_vkGetPhysicalDeviceXcbPresentationSupportKHR)gpa(instance, "vkGetPhysicalDeviceXcbPresentationSupportKHR");
+#endif // VK_USE_PLATFORM_XCB_KHR
+#ifdef VK_USE_PLATFORM_XLIB_KHR
+    pDisp->CreateXlibSurfaceKHR = (PFN_vkCreateXlibSurfaceKHR)gpa(instance, "vkCreateXlibSurfaceKHR");
+    pDisp->GetPhysicalDeviceXlibPresentationSupportKHR =
+        (PFN_vkGetPhysicalDeviceXlibPresentationSupportKHR)gpa(instance, "vkGetPhysicalDeviceXlibPresentationSupportKHR");
+#endif // VK_USE_PLATFORM_XLIB_KHR
+#ifdef VK_USE_PLATFORM_MIR_KHR
+    pDisp->CreateMirSurfaceKHR = (PFN_vkCreateMirSurfaceKHR)gpa(instance, "vkCreateMirSurfaceKHR");
+    pDisp->GetPhysicalDeviceMirPresentationSupportKHR =
+        (PFN_vkGetPhysicalDeviceMirPresentationSupportKHR)gpa(instance, "vkGetPhysicalDeviceMirPresentationSupportKHR");
+#endif // VK_USE_PLATFORM_MIR_KHR
+#ifdef VK_USE_PLATFORM_WAYLAND_KHR
+    pDisp->CreateWaylandSurfaceKHR = (PFN_vkCreateWaylandSurfaceKHR)gpa(instance, "vkCreateWaylandSurfaceKHR");
+    pDisp->GetPhysicalDeviceWaylandPresentationSupportKHR =
+        (PFN_vkGetPhysicalDeviceWaylandPresentationSupportKHR)gpa(instance, "vkGetPhysicalDeviceWaylandPresentationSupportKHR");
+#endif //  VK_USE_PLATFORM_WAYLAND_KHR
+#ifdef VK_USE_PLATFORM_ANDROID_KHR
+    pDisp->CreateAndroidSurfaceKHR = (PFN_vkCreateAndroidSurfaceKHR)gpa(instance, "vkCreateAndroidSurfaceKHR");
+#endif // VK_USE_PLATFORM_ANDROID_KHR
+
+    instanceExtMap[pDisp] = {};
+    for (i = 0; i < pCreateInfo->enabledExtensionCount; i++) {
+        if (strcmp(pCreateInfo->ppEnabledExtensionNames[i], VK_KHR_SURFACE_EXTENSION_NAME) == 0)
+            instanceExtMap[pDisp].wsi_enabled = true;
+    }
+}
+
+VkResult explicit_CreateInstance(const VkInstanceCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator,
+                                 VkInstance *pInstance) {
+    VkLayerInstanceCreateInfo *chain_info = get_chain_info(pCreateInfo, VK_LAYER_LINK_INFO);
+
+    assert(chain_info->u.pLayerInfo);
+    PFN_vkGetInstanceProcAddr fpGetInstanceProcAddr = chain_info->u.pLayerInfo->pfnNextGetInstanceProcAddr;
+    PFN_vkCreateInstance fpCreateInstance = (PFN_vkCreateInstance)fpGetInstanceProcAddr(NULL, "vkCreateInstance");
+    if (fpCreateInstance == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    // Advance the link info for the next element on the chain
+    chain_info->u.pLayerInfo = chain_info->u.pLayerInfo->pNext;
+
+    VkResult result = fpCreateInstance(pCreateInfo, pAllocator, pInstance);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    loader_platform_thread_once(&initOnce, init_timing);
+
+    initInstanceTable(*pInstance, fpGetInstanceProcAddr, timing_instance_table_map);
+
+    createInstanceRegisterExtensions(pCreateInfo, *pInstance);
+
+    return result;
+}
+
+void explicit_DestroyInstance(VkInstance instance, const VkAllocationCallbacks *pAllocator) {
+    dispatch_key key = get_dispatch_key(instance);
+    VkLayerInstanceDispatchTable *pDisp = get_dispatch_table(timing_instance_table_map, instance);
+    pDisp->DestroyInstance(instance, pAllocator);
+    instanceExtMap.erase(pDisp);
+    destroy_dispatch_table(timing_instance_table_map, key);
+}
+
+// Handle CreateDevice
+static void createDeviceRegisterExtensions(const VkDeviceCreateInfo *pCreateInfo, VkDevice device) {
+    layer_data *my_device_data = get_my_data_ptr(get_dispatch_key(device), layer_data_map);
+    VkLayerDispatchTable *pDisp = get_dispatch_table(timing_device_table_map, device);
+    PFN_vkGetDeviceProcAddr gpa = pDisp->GetDeviceProcAddr;
+    pDisp->CreateSwapchainKHR = (PFN_vkCreateSwapchainKHR)gpa(device, "vkCreateSwapchainKHR");
+    pDisp->DestroySwapchainKHR = (PFN_vkDestroySwapchainKHR)gpa(device, "vkDestroySwapchainKHR");
+    pDisp->GetSwapchainImagesKHR = (PFN_vkGetSwapchainImagesKHR)gpa(device, "vkGetSwapchainImagesKHR");
+    pDisp->AcquireNextImageKHR = (PFN_vkAcquireNextImageKHR)gpa(device, "vkAcquireNextImageKHR");
+    pDisp->QueuePresentKHR = (PFN_vkQueuePresentKHR)gpa(device, "vkQueuePresentKHR");
+    my_device_data->wsi_enabled = false;
+    for (uint32_t i = 0; i < pCreateInfo->enabledExtensionCount; i++) {
+        if (strcmp(pCreateInfo->ppEnabledExtensionNames[i], VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0)
+            my_device_data->wsi_enabled = true;
+    }
+}
+
+VkResult explicit_CreateDevice(VkPhysicalDevice gpu, const VkDeviceCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator,
+                               VkDevice *pDevice) {
+    VkLayerDeviceCreateInfo *chain_info = get_chain_info(pCreateInfo, VK_LAYER_LINK_INFO);
+
+    assert(chain_info->u.pLayerInfo);
+    PFN_vkGetInstanceProcAddr fpGetInstanceProcAddr = chain_info->u.pLayerInfo->pfnNextGetInstanceProcAddr;
+    PFN_vkGetDeviceProcAddr fpGetDeviceProcAddr = chain_info->u.pLayerInfo->pfnNextGetDeviceProcAddr;
+    PFN_vkCreateDevice fpCreateDevice = (PFN_vkCreateDevice)fpGetInstanceProcAddr(NULL, "vkCreateDevice");
+    if (fpCreateDevice == NULL) {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    // Advance the link info for the next element on the chain
+    chain_info->u.pLayerInfo = chain_info->u.pLayerInfo->pNext;
+
+    VkResult result = fpCreateDevice(gpu, pCreateInfo, pAllocator, pDevice);
+    if (result != VK_SUCCESS) {
+        return result;
+    }
+
+    // Setup layer's device dispatch table
+    initDeviceTable(*pDevice, fpGetDeviceProcAddr, timing_device_table_map);
+
+    createDeviceRegisterExtensions(pCreateInfo, *pDevice);
+
+    return result;
+}
+
+void explicit_DestroyDevice(VkDevice device, const VkAllocationCallbacks *pAllocator) {
+    dispatch_key key = get_dispatch_key(device);
+    get_dispatch_table(timing_device_table_map, device)->DestroyDevice(device, pAllocator);
+    destroy_dispatch_table(timing_device_table_map, key);
+    layer_data *my_device_data = get_my_data_ptr(key, layer_data_map);
+    delete my_device_data;
+    layer_data_map.erase(key);
+}
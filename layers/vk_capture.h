@@ -0,0 +1,249 @@
+/* Copyright (c) 2015-2016 The Khronos Group Inc.
+ * Copyright (c) 2015-2016 Valve Corporation
+ * Copyright (c) 2015-2016 LunarG, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and/or associated documentation files (the "Materials"), to
+ * deal in the Materials without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Materials, and to permit persons to whom the Materials
+ * are furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice(s) and this permission notice shall be included
+ * in all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE MATERIALS OR THE
+ * USE OR OTHER DEALINGS IN THE MATERIALS
+ */
+
+// Trace format shared by the capture layer and vkreplay.
+//
+// A trace is a VkCaptureFileHeader, the names of the captured entry points
+// (so traces survive entry points being added or reordered), and then one
+// record per call.  Each record is a VkCaptureRecordHeader followed by the
+// call's parameters in declaration order, then its return value.
+//
+// Values are stored at their natural alignment and every array or struct blob
+// is 8-byte aligned, so a trace can be memory-mapped and read in place: arrays
+// of plain data are passed to the driver straight out of the mapping, and only
+// structs containing pointers or handles are copied so they can be patched.
+// Struct bytes are stored raw, so a trace can only be replayed by a process
+// with the same pointer size as the one that captured it.
+
+#ifndef VK_CAPTURE_H
+#define VK_CAPTURE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <unordered_map>
+
+#include "vulkan/vulkan.h"
+
+#define VK_CAPTURE_MAGIC "VKCAPTR"
+#define VK_CAPTURE_VERSION 1
+
+struct VkCaptureFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t pointerSize;
+    uint32_t entryPointCount;
+    uint32_t entryPointNamesSize; // bytes of NUL-terminated names that follow, padded to 8
+};
+
+struct VkCaptureRecordHeader {
+    uint32_t size; // including this header, always a multiple of 8
+    uint16_t entryPoint;
+    uint16_t thread;
+};
+
+static inline size_t vk_capture_align(size_t offset, size_t alignment) { return (offset + alignment - 1) & ~(alignment - 1); }
+
+// Serializes one record into a growable buffer.  The capture layer keeps one
+// writer per thread and appends finished records to the trace under a lock.
+class VkCaptureWriter {
+  public:
+    VkCaptureWriter() { m_data.reserve(4096); }
+
+    void begin(uint16_t entryPoint, uint16_t thread) {
+        m_data.resize(sizeof(VkCaptureRecordHeader));
+        VkCaptureRecordHeader *header = (VkCaptureRecordHeader *)m_data.data();
+        header->entryPoint = entryPoint;
+        header->thread = thread;
+    }
+
+    // Pads the record to 8 bytes and returns it
+    const std::vector<uint8_t> &end() {
+        m_data.resize(vk_capture_align(m_data.size(), 8), 0);
+        ((VkCaptureRecordHeader *)m_data.data())->size = (uint32_t)m_data.size();
+        return m_data;
+    }
+
+    void writeBytes(const void *data, size_t size, size_t alignment) {
+        size_t offset = vk_capture_align(m_data.size(), alignment);
+        m_data.resize(offset + size, 0);
+        if (size) {
+            memcpy(&m_data[offset], data, size);
+        }
+    }
+
+    template <typename T> void writeValue(const T &value) { writeBytes(&value, sizeof(T), sizeof(T) < 8 ? sizeof(T) : 8); }
+
+    template <typename T> void writeHandle(T handle) { writeValue((uint64_t)handle); }
+
+    bool writePresence(const void *pointer) {
+        writeValue((uint32_t)(pointer != NULL));
+        return pointer != NULL;
+    }
+
+    void writeString(const char *string) {
+        uint32_t size = string ? (uint32_t)strlen(string) + 1 : 0;
+        writeValue(size);
+        writeBytes(string, size, 1);
+    }
+
+    void writeStringArray(const char *const *strings, uint32_t count) {
+        if (writePresence(strings)) {
+            for (uint32_t i = 0; i < count; i++) {
+                writeString(strings[i]);
+            }
+        }
+    }
+
+    // Arrays of plain data and of handles are stored as raw bytes
+    template <typename T> void writeArray(const T *array, uint64_t count) {
+        if (writePresence(array)) {
+            writeBytes(array, (size_t)(sizeof(T) * count), 8);
+        }
+    }
+
+    void writeBlob(const void *data, uint64_t size) {
+        if (writePresence(data)) {
+            writeBytes(data, (size_t)size, 8);
+        }
+    }
+
+    // Defined with the generated struct serializers
+    template <typename T> void writeStructArray(const T *array, uint64_t count);
+    void writeNextChain(const void *pNext);
+
+  private:
+    std::vector<uint8_t> m_data;
+};
+
+// Reads the parameters of one record.  Plain data is returned in place;
+// anything that needs patching is copied into scratch memory that stays valid
+// until the next record is started.
+class VkCaptureReader {
+  public:
+    VkCaptureReader() : m_cursor(NULL), m_end(NULL), m_scratchUsed(0) {}
+
+    void begin(const uint8_t *payload, const uint8_t *end) {
+        m_cursor = payload;
+        m_end = end;
+        m_scratchUsed = 0;
+        m_overflow.clear();
+    }
+
+    bool overrun() const { return m_cursor > m_end; }
+
+    const void *readBytes(size_t size, size_t alignment) {
+        const uint8_t *data = (const uint8_t *)vk_capture_align((size_t)m_cursor, alignment);
+        m_cursor = data + size;
+        return data;
+    }
+
+    template <typename T> T readValue() {
+        T value;
+        memcpy(&value, readBytes(sizeof(T), sizeof(T) < 8 ? sizeof(T) : 8), sizeof(T));
+        return value;
+    }
+
+    template <typename T> T readHandle() { return remap((T)readValue<uint64_t>()); }
+
+    // Captured handle as recorded, for handles the replay creates itself
+    template <typename T> T readCapturedHandle() { return (T)readValue<uint64_t>(); }
+
+    bool readPresence() { return readValue<uint32_t>() != 0; }
+
+    const char *readString() {
+        uint32_t size = readValue<uint32_t>();
+        return size ? (const char *)readBytes(size, 1) : NULL;
+    }
+
+    const char *const *readStringArray(uint32_t count) {
+        if (!readPresence()) {
+            return NULL;
+        }
+        const char **strings = allocate<const char *>(count);
+        for (uint32_t i = 0; i < count; i++) {
+            strings[i] = readString();
+        }
+        return strings;
+    }
+
+    template <typename T> const T *readArray(uint64_t count) {
+        return readPresence() ? (const T *)readBytes((size_t)(sizeof(T) * count), 8) : NULL;
+    }
+
+    template <typename T> const T *readHandleArray(uint64_t count) {
+        const T *captured = readArray<T>(count);
+        if (!captured) {
+            return NULL;
+        }
+        T *handles = allocate<T>(count);
+        for (uint64_t i = 0; i < count; i++) {
+            handles[i] = remap(captured[i]);
+        }
+        return handles;
+    }
+
+    const void *readBlob(uint64_t size) { return readPresence() ? readBytes((size_t)size, 8) : NULL; }
+
+    // Defined with the generated struct serializers
+    template <typename T> const T *readStructArray(uint64_t count);
+    const void *readNextChain();
+
+    template <typename T> T *allocate(uint64_t count) {
+        size_t size = vk_capture_align((size_t)(sizeof(T) * count), 8);
+        if (m_scratchUsed + size > m_scratch.size()) {
+            if (m_scratchUsed == 0) {
+                m_scratch.resize(size * 2);
+            } else {
+                // Earlier allocations in this record are still referenced, so
+                // fall back to separate buffers until the next record
+                m_overflow.push_back(std::vector<uint64_t>((size + 7) / 8));
+                return (T *)m_overflow.back().data();
+            }
+        }
+        T *result = (T *)&m_scratch[m_scratchUsed];
+        m_scratchUsed += size;
+        return result;
+    }
+
+    void registerHandle(uint64_t captured, uint64_t replayed) { m_handleMap[captured] = replayed; }
+
+    template <typename T> T remap(T handle) const {
+        if ((uint64_t)handle == 0) {
+            return handle;
+        }
+        std::unordered_map<uint64_t, uint64_t>::const_iterator it = m_handleMap.find((uint64_t)handle);
+        return it == m_handleMap.end() ? handle : (T)it->second;
+    }
+
+  private:
+    const uint8_t *m_cursor;
+    const uint8_t *m_end;
+    std::vector<uint8_t> m_scratch;
+    size_t m_scratchUsed;
+    std::vector<std::vector<uint64_t>> m_overflow;
+    std::unordered_map<uint64_t, uint64_t> m_handleMap;
+};
+
+#endif // VK_CAPTURE_H
@@ -29,13 +29,37 @@
 #include <fstream>
 #include <string>
 #include <map>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <signal.h>
+#endif
 #include <vulkan/vk_layer.h>
 #include <iostream>
 #include "vk_layer_config.h"
 #include "vulkan/vk_sdk_platform.h"
 
 #define MAX_CHARS_PER_LINE 4096
+#define LAYER_SETTINGS_FILENAME "vk_layer_settings.txt"
+#define DEFAULT_WATCH_INTERVAL_MS 1000
+// A map replaced by a reload is freed once this many newer reloads have
+// happened and it has been retired for at least this long
+#define RETIRED_MAP_GRACE_RELOADS 2
+#define RETIRED_MAP_GRACE_MS 5000
+
+enum OptionHandleType {
+    OPTION_HANDLE_UINT,
+    OPTION_HANDLE_FLAGS,
+    OPTION_HANDLE_CHECK_MASK,
+    OPTION_HANDLE_SAMPLE_MODE,
+};
 
 class ConfigFile {
   public:
@@ -45,10 +69,46 @@ class ConfigFile {
     const char *getOption(const std::string &_option);
     void setOption(const std::string &_option, const std::string &_val);
 
+    const LayerOptionHandle *getHandle(const std::string &_option, OptionHandleType type, uint32_t optionDefault);
+    void reload();
+    void poll();
+    uint32_t generation() const { return m_generation.load(); }
+
   private:
+    struct OptionHandleEntry {
+        OptionHandleType type;
+        uint32_t optionDefault;
+        std::unique_ptr<LayerOptionHandle> handle;
+    };
+
     bool m_fileIsParsed;
+    std::mutex m_lock;
     std::map<std::string, std::string> m_valueMap;
-
+    // Values set through setLayerOption survive a reload of the file
+    std::map<std::string, std::string> m_overrideMap;
+    // getOption hands out c_str() pointers, so a map replaced by a reload is
+    // kept for a grace period in case a caller is still reading one of them.
+    // Callers only parse or copy the value right away, and older maps are
+    // freed, so a watched file that keeps changing does not grow this list.
+    struct RetiredMap {
+        uint32_t generation;
+        int64_t retiredNs;
+        std::map<std::string, std::string> values;
+    };
+    std::list<RetiredMap> m_retiredMaps;
+    std::map<std::string, OptionHandleEntry> m_handleMap;
+
+    std::atomic<uint32_t> m_generation;
+    std::atomic<bool> m_watchFile;
+    std::atomic<int64_t> m_watchIntervalNs;
+    std::atomic<int64_t> m_nextWatchCheckNs;
+    std::atomic<int64_t> m_fileModTime;
+    bool m_signalInstalled;
+
+    const char *findOption(const std::string &_option);
+    uint32_t resolveHandleValue(const std::string &_option, const OptionHandleEntry &entry);
+    void refreshHandles();
+    void applyReloadSettings();
     void parseFile(const char *filename);
 };
 
@@ -116,9 +176,8 @@ FILE *getLayerLogOutput(const char *_option, const char *layerName) {
     return log_output;
 }
 
-VkDebugReportFlagsEXT getLayerOptionFlags(const char *_option, uint32_t optionDefault) {
+static VkDebugReportFlagsEXT parseOptionFlags(const char *option, uint32_t optionDefault) {
     VkDebugReportFlagsEXT flags = optionDefault;
-    const char *option = (g_configFileObj.getOption(_option));
 
     /* parse comma-separated options */
     while (option) {
@@ -152,6 +211,145 @@ VkDebugReportFlagsEXT getLayerOptionFlags(const char *_option, uint32_t optionDe
     return flags;
 }
 
+VkDebugReportFlagsEXT getLayerOptionFlags(const char *_option, uint32_t optionDefault) {
+    return parseOptionFlags(g_configFileObj.getOption(_option), optionDefault);
+}
+
+// Accepts decimal or hex numbers, TRUE/FALSE, or a single enum name understood
+// by convertStringEnumVal.
+static uint32_t parseOptionUint(const char *option, uint32_t optionDefault) {
+    if (!option)
+        return optionDefault;
+    char *end = NULL;
+    unsigned long val = strtoul(option, &end, 0);
+    if (end != option && *end == '\0')
+        return (uint32_t)val;
+    if (!strcmp(option, "TRUE") || !strcmp(option, "true"))
+        return 1;
+    if (!strcmp(option, "FALSE") || !strcmp(option, "false"))
+        return 0;
+    unsigned int enumVal = convertStringEnumVal(option);
+    return enumVal ? enumVal : optionDefault;
+}
+
+static const struct {
+    const char *name;
+    LayerCheckCategoryFlags flags;
+} checkCategoryNames[] = {
+    {"object_lifetime", LAYER_CHECK_OBJECT_LIFETIME},
+    {"parameters", LAYER_CHECK_PARAMETERS},
+    {"draw_state", LAYER_CHECK_DRAW_STATE},
+    {"shaders", LAYER_CHECK_SHADERS},
+    {"memory", LAYER_CHECK_MEMORY},
+    {"image_layouts", LAYER_CHECK_IMAGE_LAYOUTS},
+    {"synchronization", LAYER_CHECK_SYNCHRONIZATION},
+    {"all", LAYER_CHECK_ALL},
+};
+
+// Parse a comma-separated list of check categories. "none" clears the mask;
+// an absent option leaves every category enabled. A name that is not a
+// category, such as a misspelled one, is reported and the default used, so
+// that a typo cannot silently turn checks off.
+static LayerCheckCategoryFlags parseCheckMask(const char *option, uint32_t optionDefault) {
+    LayerCheckCategoryFlags mask = 0;
+
+    if (!option)
+        return optionDefault;
+
+    while (option) {
+        const char *p = strchr(option, ',');
+        size_t len = p ? (size_t)(p - option) : strlen(option);
+
+        bool known = (len == strlen("none") && !strncmp(option, "none", len));
+        for (uint32_t i = 0; !known && i < sizeof(checkCategoryNames) / sizeof(checkCategoryNames[0]); i++) {
+            if (strlen(checkCategoryNames[i].name) == len && !strncmp(option, checkCategoryNames[i].name, len)) {
+                mask |= checkCategoryNames[i].flags;
+                known = true;
+            }
+        }
+        if (!known) {
+            fprintf(stderr, "vk_layer_settings: unknown check category \"%.*s\" in enable_checks, using the default\n",
+                    (int)len, option);
+            return optionDefault;
+        }
+
+        if (!p)
+            break;
+        option = p + 1;
+    }
+    return mask;
+}
+
+static uint32_t parseSampleMode(const char *option, uint32_t optionDefault) {
+    if (!option)
+        return optionDefault;
+    if (!strcmp(option, "frames"))
+        return LAYER_SAMPLE_FRAMES;
+    else if (!strcmp(option, "command_buffers"))
+        return LAYER_SAMPLE_COMMAND_BUFFERS;
+    else if (!strcmp(option, "off"))
+        return LAYER_SAMPLE_OFF;
+    return optionDefault;
+}
+
+const LayerOptionHandle *getLayerOptionUintHandle(const char *_option, uint32_t optionDefault) {
+    return g_configFileObj.getHandle(_option, OPTION_HANDLE_UINT, optionDefault);
+}
+
+const LayerOptionHandle *getLayerOptionFlagsHandle(const char *_option, uint32_t optionDefault) {
+    return g_configFileObj.getHandle(_option, OPTION_HANDLE_FLAGS, optionDefault);
+}
+
+const LayerOptionHandle *getLayerCheckMask(const char *layerIdentifier) {
+    std::string option(layerIdentifier);
+    option += ".enable_checks";
+    return g_configFileObj.getHandle(option, OPTION_HANDLE_CHECK_MASK, LAYER_CHECK_ALL);
+}
+
+void initLayerSampler(LayerSampler *sampler) {
+    sampler->mode = g_configFileObj.getHandle("layer_settings.sample_mode", OPTION_HANDLE_SAMPLE_MODE, LAYER_SAMPLE_OFF);
+    sampler->period = g_configFileObj.getHandle("layer_settings.sample_period", OPTION_HANDLE_UINT, 1);
+    sampler->frameIndex = 0;
+}
+
+void layerSamplerEndFrame(LayerSampler *sampler) { sampler->frameIndex.fetch_add(1, std::memory_order_relaxed); }
+
+// splitmix64 finalizer, so neighbouring handles and recordings land in uncorrelated buckets
+static inline uint64_t mixSampleIndex(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+bool layerSamplePicksCommandBuffer(uint64_t commandBuffer, uint64_t beginIndex, uint32_t period) {
+    if (period <= 1)
+        return true;
+    return (mixSampleIndex(commandBuffer ^ mixSampleIndex(beginIndex)) % period) == 0;
+}
+
+bool layerSamplerBeginCommandBuffer(LayerSampler *sampler, uint64_t commandBuffer, uint64_t beginIndex) {
+    uint32_t period = readLayerOption(sampler->period);
+    if (period <= 1)
+        return true;
+
+    switch (readLayerOption(sampler->mode)) {
+    case LAYER_SAMPLE_FRAMES:
+        return (sampler->frameIndex.load(std::memory_order_relaxed) % period) == 0;
+    case LAYER_SAMPLE_COMMAND_BUFFERS:
+        return layerSamplePicksCommandBuffer(commandBuffer, beginIndex, period);
+    case LAYER_SAMPLE_OFF:
+    default:
+        return true;
+    }
+}
+
+void reloadLayerSettings() { g_configFileObj.reload(); }
+
+void pollLayerSettings() { g_configFileObj.poll(); }
+
+uint32_t getLayerSettingsGeneration() { return g_configFileObj.generation(); }
+
 bool getLayerOptionEnum(const char *_option, uint32_t *optionDefault) {
     bool res;
     const char *option = (g_configFileObj.getOption(_option));
@@ -173,14 +371,50 @@ void setLayerOptionEnum(const char *_option, const char *_valEnum) {
 
 void setLayerOption(const char *_option, const char *_val) { g_configFileObj.setOption(_option, _val); }
 
-ConfigFile::ConfigFile() : m_fileIsParsed(false) {}
+#ifndef WIN32
+static volatile sig_atomic_t g_reloadRequested = 0;
+static struct sigaction g_prevReloadAction;
+
+static void reloadSignalHandler(int sig) {
+    g_reloadRequested = 1;
+    if (!(g_prevReloadAction.sa_flags & SA_SIGINFO) && g_prevReloadAction.sa_handler != SIG_DFL &&
+        g_prevReloadAction.sa_handler != SIG_IGN)
+        g_prevReloadAction.sa_handler(sig);
+}
+
+static int stringToSignal(const char *_name) {
+    if (!strcmp(_name, "SIGHUP"))
+        return SIGHUP;
+    else if (!strcmp(_name, "SIGUSR1"))
+        return SIGUSR1;
+    else if (!strcmp(_name, "SIGUSR2"))
+        return SIGUSR2;
+    return 0;
+}
+#endif
+
+static int64_t steadyClockNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int64_t getFileModTime(const char *filename) {
+    struct stat st;
+    if (stat(filename, &st) != 0)
+        return 0;
+    return (int64_t)st.st_mtime;
+}
+
+ConfigFile::ConfigFile()
+    : m_fileIsParsed(false), m_generation(0), m_watchFile(false), m_watchIntervalNs(0), m_nextWatchCheckNs(0),
+      m_fileModTime(0), m_signalInstalled(false) {}
 
 ConfigFile::~ConfigFile() {}
 
-const char *ConfigFile::getOption(const std::string &_option) {
+// Caller must hold m_lock
+const char *ConfigFile::findOption(const std::string &_option) {
     std::map<std::string, std::string>::const_iterator it;
     if (!m_fileIsParsed) {
-        parseFile("vk_layer_settings.txt");
+        parseFile(LAYER_SETTINGS_FILENAME);
     }
 
     if ((it = m_valueMap.find(_option)) == m_valueMap.end())
@@ -189,12 +423,134 @@ const char *ConfigFile::getOption(const std::string &_option) {
         return it->second.c_str();
 }
 
+const char *ConfigFile::getOption(const std::string &_option) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    return findOption(_option);
+}
+
 void ConfigFile::setOption(const std::string &_option, const std::string &_val) {
+    std::lock_guard<std::mutex> lock(m_lock);
     if (!m_fileIsParsed) {
-        parseFile("vk_layer_settings.txt");
+        parseFile(LAYER_SETTINGS_FILENAME);
     }
 
     m_valueMap[_option] = _val;
+    m_overrideMap[_option] = _val;
+
+    auto it = m_handleMap.find(_option);
+    if (it != m_handleMap.end())
+        it->second.handle->store(resolveHandleValue(_option, it->second));
+}
+
+// Caller must hold m_lock
+uint32_t ConfigFile::resolveHandleValue(const std::string &_option, const OptionHandleEntry &entry) {
+    const char *option = findOption(_option);
+    switch (entry.type) {
+    case OPTION_HANDLE_FLAGS:
+        return parseOptionFlags(option, entry.optionDefault);
+    case OPTION_HANDLE_CHECK_MASK:
+        return parseCheckMask(option, entry.optionDefault);
+    case OPTION_HANDLE_SAMPLE_MODE:
+        return parseSampleMode(option, entry.optionDefault);
+    case OPTION_HANDLE_UINT:
+    default:
+        return parseOptionUint(option, entry.optionDefault);
+    }
+}
+
+const LayerOptionHandle *ConfigFile::getHandle(const std::string &_option, OptionHandleType type, uint32_t optionDefault) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    auto it = m_handleMap.find(_option);
+    if (it == m_handleMap.end()) {
+        OptionHandleEntry &entry = m_handleMap[_option];
+        entry.type = type;
+        entry.optionDefault = optionDefault;
+        entry.handle.reset(new LayerOptionHandle(0));
+        entry.handle->store(resolveHandleValue(_option, entry));
+        return entry.handle.get();
+    }
+    return it->second.handle.get();
+}
+
+// Caller must hold m_lock
+void ConfigFile::refreshHandles() {
+    for (auto &it : m_handleMap) {
+        it.second.handle->store(resolveHandleValue(it.first, it.second));
+    }
+}
+
+void ConfigFile::reload() {
+    std::lock_guard<std::mutex> lock(m_lock);
+    int64_t now = steadyClockNs();
+    while (!m_retiredMaps.empty()) {
+        const RetiredMap &oldest = m_retiredMaps.front();
+        if (m_generation.load() - oldest.generation < RETIRED_MAP_GRACE_RELOADS ||
+            now - oldest.retiredNs < (int64_t)RETIRED_MAP_GRACE_MS * 1000000)
+            break;
+        m_retiredMaps.pop_front();
+    }
+    m_retiredMaps.push_back(RetiredMap());
+    m_retiredMaps.back().generation = m_generation.load();
+    m_retiredMaps.back().retiredNs = now;
+    m_retiredMaps.back().values.swap(m_valueMap);
+    parseFile(LAYER_SETTINGS_FILENAME);
+    for (auto &it : m_overrideMap) {
+        m_valueMap[it.first] = it.second;
+    }
+    refreshHandles();
+    m_generation++;
+}
+
+void ConfigFile::poll() {
+#ifndef WIN32
+    if (g_reloadRequested) {
+        g_reloadRequested = 0;
+        reload();
+        return;
+    }
+#endif
+    if (!m_watchFile.load(std::memory_order_relaxed))
+        return;
+
+    // Only one thread per interval gets to stat the file
+    int64_t now = steadyClockNs();
+    int64_t nextCheck = m_nextWatchCheckNs.load(std::memory_order_relaxed);
+    if (now < nextCheck ||
+        !m_nextWatchCheckNs.compare_exchange_strong(nextCheck, now + m_watchIntervalNs.load(std::memory_order_relaxed)))
+        return;
+
+    if (getFileModTime(LAYER_SETTINGS_FILENAME) != m_fileModTime.load())
+        reload();
+}
+
+// Read the global "layer_settings.*" options that control reloading.
+// Caller must hold m_lock
+void ConfigFile::applyReloadSettings() {
+    std::map<std::string, std::string>::const_iterator it;
+
+    it = m_valueMap.find("layer_settings.watch_file");
+    m_watchFile = (it != m_valueMap.end()) && parseOptionUint(it->second.c_str(), 0);
+
+    it = m_valueMap.find("layer_settings.watch_interval_ms");
+    uint32_t intervalMs = (it != m_valueMap.end()) ? parseOptionUint(it->second.c_str(), DEFAULT_WATCH_INTERVAL_MS)
+                                                   : DEFAULT_WATCH_INTERVAL_MS;
+    m_watchIntervalNs = (int64_t)intervalMs * 1000000;
+
+#ifndef WIN32
+    it = m_valueMap.find("layer_settings.reload_signal");
+    if (!m_signalInstalled && it != m_valueMap.end()) {
+        int sig = stringToSignal(it->second.c_str());
+        if (sig) {
+            struct sigaction action;
+            memset(&action, 0, sizeof(action));
+            action.sa_handler = reloadSignalHandler;
+            sigemptyset(&action.sa_mask);
+            action.sa_flags = SA_RESTART;
+            sigaction(sig, &action, &g_prevReloadAction);
+            m_signalInstalled = true;
+        }
+    }
+#endif
 }
 
 void ConfigFile::parseFile(const char *filename) {
@@ -203,6 +559,7 @@ void ConfigFile::parseFile(const char *filename) {
 
     m_fileIsParsed = true;
     m_valueMap.clear();
+    m_fileModTime = getFileModTime(filename);
 
     file.open(filename);
     if (!file.good())
@@ -228,6 +585,8 @@ void ConfigFile::parseFile(const char *filename) {
         }
         file.getline(buf, MAX_CHARS_PER_LINE);
     }
+
+    applyReloadSettings();
 }
 
 void print_msg_flags(VkFlags msgFlags, char *msg_flags) {
@@ -30,6 +30,8 @@
 extern "C" {
 #endif
 
+// The returned string can be freed by a later settings reload; parse or copy it
+// right away rather than keeping the pointer.
 const char *getLayerOption(const char *_option);
 FILE *getLayerLogOutput(const char *_option, const char *layerName);
 VkDebugReportFlagsEXT getLayerOptionFlags(const char *_option, uint32_t optionDefault);
@@ -41,3 +43,73 @@ void print_msg_flags(VkFlags msgFlags, char *msg_flags);
 #ifdef __cplusplus
 }
 #endif
+
+#ifdef __cplusplus
+#include <atomic>
+
+// Categories of validation that a layer can turn on and off at runtime through
+// "<LayerIdentifier>.enable_checks" in vk_layer_settings.txt. Only checks that do
+// not feed layer state may be gated, so tracking stays consistent while disabled.
+enum LayerCheckCategoryBits {
+    LAYER_CHECK_OBJECT_LIFETIME = 0x00000001,
+    LAYER_CHECK_PARAMETERS = 0x00000002,
+    LAYER_CHECK_DRAW_STATE = 0x00000004,
+    LAYER_CHECK_SHADERS = 0x00000008,
+    LAYER_CHECK_MEMORY = 0x00000010,
+    LAYER_CHECK_IMAGE_LAYOUTS = 0x00000020,
+    LAYER_CHECK_SYNCHRONIZATION = 0x00000040,
+    LAYER_CHECK_ALL = 0x7FFFFFFF,
+};
+typedef uint32_t LayerCheckCategoryFlags;
+
+// Pre-resolved handle to a numeric option. Handles are looked up by name once and
+// stay valid for the lifetime of the process; a settings reload rewrites the value
+// in place, so hot paths only pay for a relaxed atomic load.
+typedef std::atomic<uint32_t> LayerOptionHandle;
+
+const LayerOptionHandle *getLayerOptionUintHandle(const char *_option, uint32_t optionDefault);
+const LayerOptionHandle *getLayerOptionFlagsHandle(const char *_option, uint32_t optionDefault);
+const LayerOptionHandle *getLayerCheckMask(const char *layerIdentifier);
+
+static inline uint32_t readLayerOption(const LayerOptionHandle *handle) { return handle->load(std::memory_order_relaxed); }
+
+static inline bool layerCheckEnabled(const LayerOptionHandle *checkMask, LayerCheckCategoryFlags category) {
+    return (checkMask->load(std::memory_order_relaxed) & category) != 0;
+}
+
+// Sampling validation: heavy per-command checks run only for a subset of the
+// work, selected by "layer_settings.sample_mode" and "layer_settings.sample_period".
+//   frames          - one frame in every sample_period (frames end at vkQueuePresentKHR)
+//   command_buffers - a pseudo-random 1/sample_period of command buffers
+// The decision is made when a command buffer begins recording and applies to
+// everything recorded into it. Object tracking is never sampled.
+// Sampling is honored by draw_state (draw-time state and image layout checks)
+// and mem_tracker (memory validity checks); other layers validate everything.
+// The decision is a function of the command buffer handle and how many times it
+// has begun recording, so every layer samples the same recordings.
+enum LayerSampleMode {
+    LAYER_SAMPLE_OFF = 0,
+    LAYER_SAMPLE_FRAMES = 1,
+    LAYER_SAMPLE_COMMAND_BUFFERS = 2,
+};
+
+struct LayerSampler {
+    const LayerOptionHandle *mode;
+    const LayerOptionHandle *period;
+    std::atomic<uint64_t> frameIndex;
+};
+
+void initLayerSampler(LayerSampler *sampler);
+void layerSamplerEndFrame(LayerSampler *sampler);
+// beginIndex counts the earlier vkBeginCommandBuffer calls on commandBuffer
+bool layerSamplerBeginCommandBuffer(LayerSampler *sampler, uint64_t commandBuffer, uint64_t beginIndex);
+// Whether command_buffers mode picks this recording, whatever the current mode
+bool layerSamplePicksCommandBuffer(uint64_t commandBuffer, uint64_t beginIndex, uint32_t period);
+
+// Re-read vk_layer_settings.txt and refresh every handle. Layers call
+// pollLayerSettings() from low-frequency entry points (submit/present); it is
+// a no-op unless a reload signal arrived or the watched file changed on disk.
+void reloadLayerSettings();
+void pollLayerSettings();
+uint32_t getLayerSettingsGeneration();
+#endif
@@ -0,0 +1,408 @@
+/* Copyright (c) 2015-2016 The Khronos Group Inc.
+ * Copyright (c) 2015-2016 Valve Corporation
+ * Copyright (c) 2015-2016 LunarG, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and/or associated documentation files (the "Materials"), to
+ * deal in the Materials without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Materials, and to permit persons to whom the Materials
+ * are furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice(s) and this permission notice shall be included
+ * in all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE MATERIALS OR THE
+ * USE OR OTHER DEALINGS IN THE MATERIALS
+ */
+
+// vkreplay: re-issues a trace written by VK_LAYER_LUNARG_capture through the
+// loader as fast as possible and reports where the CPU time went.
+//
+// Usage: vkreplay <trace file>
+//
+// Calls are replayed on one thread in the order they returned during capture.
+// Buffer contents written through mapped memory are not part of a trace, so
+// replay measures API and driver overhead rather than reproducing the image.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "vkreplay.h"
+
+struct ReplayEntryStats {
+    uint64_t calls;
+    uint64_t totalNs;
+};
+
+static std::vector<ReplayEntryStats> replayStats;
+static uint64_t replayDivergent = 0;
+static uint64_t replaySkipped = 0;
+
+void replay_record(uint32_t entryPoint, uint64_t startNs, bool matchedCapture) {
+    uint64_t ns = replay_now() - startNs;
+    replayStats[entryPoint].calls++;
+    replayStats[entryPoint].totalNs += ns;
+    if (!matchedCapture) {
+        replayDivergent++;
+    }
+}
+
+void replay_skip(uint32_t) { replaySkipped++; }
+
+// Entry points with special handling
+
+struct ReplaySwapchain {
+    VkDevice device;
+    VkSwapchainCreateInfoKHR createInfo;
+    std::vector<VkImage> images;
+    std::vector<VkDeviceMemory> memory;
+};
+
+static std::unordered_map<VkDevice, VkPhysicalDevice> replayPhysicalDevices;
+static std::unordered_map<VkDevice, VkQueue> replayQueues;
+
+static std::vector<const char *> replay_filter_names(uint32_t count, const char *const *names, bool (*keep)(const char *)) {
+    std::vector<const char *> kept;
+    for (uint32_t i = 0; i < count; i++) {
+        if (keep(names[i])) {
+            kept.push_back(names[i]);
+        }
+    }
+    return kept;
+}
+
+static bool replay_keep_layer(const char *name) { return strcmp(name, "VK_LAYER_LUNARG_capture") != 0; }
+
+static bool replay_keep_instance_extension(const char *name) { return strstr(name, "_surface") == NULL; }
+
+static bool replay_keep_device_extension(const char *name) { return strcmp(name, VK_KHR_SWAPCHAIN_EXTENSION_NAME) != 0; }
+
+VkResult replay_vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator,
+                                 VkInstance *pInstance) {
+    VkInstanceCreateInfo createInfo = *pCreateInfo;
+    std::vector<const char *> layers =
+        replay_filter_names(createInfo.enabledLayerCount, createInfo.ppEnabledLayerNames, replay_keep_layer);
+    std::vector<const char *> extensions =
+        replay_filter_names(createInfo.enabledExtensionCount, createInfo.ppEnabledExtensionNames, replay_keep_instance_extension);
+    createInfo.enabledLayerCount = (uint32_t)layers.size();
+    createInfo.ppEnabledLayerNames = layers.data();
+    createInfo.enabledExtensionCount = (uint32_t)extensions.size();
+    createInfo.ppEnabledExtensionNames = extensions.data();
+    return vkCreateInstance(&createInfo, pAllocator, pInstance);
+}
+
+VkResult replay_vkCreateDevice(VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo *pCreateInfo,
+                               const VkAllocationCallbacks *pAllocator, VkDevice *pDevice) {
+    VkDeviceCreateInfo createInfo = *pCreateInfo;
+    std::vector<const char *> layers =
+        replay_filter_names(createInfo.enabledLayerCount, createInfo.ppEnabledLayerNames, replay_keep_layer);
+    std::vector<const char *> extensions =
+        replay_filter_names(createInfo.enabledExtensionCount, createInfo.ppEnabledExtensionNames, replay_keep_device_extension);
+    createInfo.enabledLayerCount = (uint32_t)layers.size();
+    createInfo.ppEnabledLayerNames = layers.data();
+    createInfo.enabledExtensionCount = (uint32_t)extensions.size();
+    createInfo.ppEnabledExtensionNames = extensions.data();
+    VkResult result = vkCreateDevice(physicalDevice, &createInfo, pAllocator, pDevice);
+    if (result == VK_SUCCESS) {
+        replayPhysicalDevices[*pDevice] = physicalDevice;
+    }
+    return result;
+}
+
+void replay_vkGetDeviceQueue(VkDevice device, uint32_t queueFamilyIndex, uint32_t queueIndex, VkQueue *pQueue) {
+    vkGetDeviceQueue(device, queueFamilyIndex, queueIndex, pQueue);
+    if (replayQueues.find(device) == replayQueues.end()) {
+        replayQueues[device] = *pQueue;
+    }
+}
+
+VkResult replay_vkCreateSwapchainKHR(VkDevice device, const VkSwapchainCreateInfoKHR *pCreateInfo, const VkAllocationCallbacks *,
+                                     VkSwapchainKHR *pSwapchain) {
+    ReplaySwapchain *swapchain = new ReplaySwapchain();
+    swapchain->device = device;
+    swapchain->createInfo = *pCreateInfo;
+    swapchain->createInfo.pNext = NULL;
+    swapchain->createInfo.pQueueFamilyIndices = NULL;
+    *pSwapchain = (VkSwapchainKHR)(uintptr_t)swapchain;
+    return VK_SUCCESS;
+}
+
+void replay_vkDestroySwapchainKHR(VkDevice device, VkSwapchainKHR swapchain, const VkAllocationCallbacks *) {
+    ReplaySwapchain *replaySwapchain = (ReplaySwapchain *)(uintptr_t)swapchain;
+    if (!replaySwapchain) {
+        return;
+    }
+    for (size_t i = 0; i < replaySwapchain->images.size(); i++) {
+        vkDestroyImage(device, replaySwapchain->images[i], NULL);
+        vkFreeMemory(device, replaySwapchain->memory[i], NULL);
+    }
+    delete replaySwapchain;
+}
+
+static bool replay_create_swapchain_image(ReplaySwapchain *swapchain) {
+    VkImageCreateInfo imageInfo = {};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = swapchain->createInfo.imageFormat;
+    imageInfo.extent.width = swapchain->createInfo.imageExtent.width;
+    imageInfo.extent.height = swapchain->createInfo.imageExtent.height;
+    imageInfo.extent.depth = 1;
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = swapchain->createInfo.imageArrayLayers;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = swapchain->createInfo.imageUsage;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    VkImage image;
+    if (vkCreateImage(swapchain->device, &imageInfo, NULL, &image) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(swapchain->device, image, &requirements);
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(replayPhysicalDevices[swapchain->device], &memoryProperties);
+    uint32_t memoryType = UINT32_MAX;
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+        if (!(requirements.memoryTypeBits & (1u << i))) {
+            continue;
+        }
+        if (memoryType == UINT32_MAX ||
+            (memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
+            memoryType = i;
+            if (memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) {
+                break;
+            }
+        }
+    }
+
+    VkMemoryAllocateInfo allocateInfo = {};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.allocationSize = requirements.size;
+    allocateInfo.memoryTypeIndex = memoryType;
+    VkDeviceMemory memory;
+    if (memoryType == UINT32_MAX || vkAllocateMemory(swapchain->device, &allocateInfo, NULL, &memory) != VK_SUCCESS) {
+        vkDestroyImage(swapchain->device, image, NULL);
+        return false;
+    }
+    vkBindImageMemory(swapchain->device, image, memory, 0);
+
+    swapchain->images.push_back(image);
+    swapchain->memory.push_back(memory);
+    return true;
+}
+
+VkResult replay_vkGetSwapchainImagesKHR(VkDevice, VkSwapchainKHR swapchain, uint32_t *pSwapchainImageCount,
+                                        VkImage *pSwapchainImages) {
+    ReplaySwapchain *replaySwapchain = (ReplaySwapchain *)(uintptr_t)swapchain;
+    // The count already holds what the application was told during capture
+    if (!replaySwapchain || !pSwapchainImages) {
+        return VK_SUCCESS;
+    }
+    while (replaySwapchain->images.size() < *pSwapchainImageCount) {
+        if (!replay_create_swapchain_image(replaySwapchain)) {
+            return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        }
+    }
+    memcpy(pSwapchainImages, replaySwapchain->images.data(), *pSwapchainImageCount * sizeof(VkImage));
+    return VK_SUCCESS;
+}
+
+VkResult replay_vkAcquireNextImageKHR(VkDevice device, VkSwapchainKHR, uint64_t, VkSemaphore semaphore, VkFence fence,
+                                      uint32_t *) {
+    // The image index already holds the one acquired during capture; all
+    // that's left is to signal the semaphore and fence like the driver would
+    std::unordered_map<VkDevice, VkQueue>::const_iterator queue = replayQueues.find(device);
+    if ((semaphore == VK_NULL_HANDLE && fence == VK_NULL_HANDLE) || queue == replayQueues.end()) {
+        return VK_SUCCESS;
+    }
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.signalSemaphoreCount = semaphore != VK_NULL_HANDLE ? 1 : 0;
+    submitInfo.pSignalSemaphores = &semaphore;
+    return vkQueueSubmit(queue->second, semaphore != VK_NULL_HANDLE ? 1 : 0, &submitInfo, fence);
+}
+
+VkResult replay_vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR *pPresentInfo) {
+    if (pPresentInfo->waitSemaphoreCount == 0) {
+        return VK_SUCCESS;
+    }
+    std::vector<VkPipelineStageFlags> stages(pPresentInfo->waitSemaphoreCount, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.waitSemaphoreCount = pPresentInfo->waitSemaphoreCount;
+    submitInfo.pWaitSemaphores = pPresentInfo->pWaitSemaphores;
+    submitInfo.pWaitDstStageMask = stages.data();
+    return vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+}
+
+// Trace file access
+
+struct ReplayTrace {
+    const uint8_t *data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int file;
+#endif
+};
+
+static bool replay_map_trace(const char *path, ReplayTrace *trace) {
+#ifdef _WIN32
+    trace->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (trace->file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(trace->file, &size);
+    trace->size = (size_t)size.QuadPart;
+    trace->mapping = CreateFileMapping(trace->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!trace->mapping) {
+        CloseHandle(trace->file);
+        return false;
+    }
+    trace->data = (const uint8_t *)MapViewOfFile(trace->mapping, FILE_MAP_READ, 0, 0, 0);
+    return trace->data != NULL;
+#else
+    trace->file = open(path, O_RDONLY);
+    if (trace->file < 0) {
+        return false;
+    }
+    struct stat info;
+    fstat(trace->file, &info);
+    trace->size = (size_t)info.st_size;
+    void *data = mmap(NULL, trace->size, PROT_READ, MAP_PRIVATE, trace->file, 0);
+    if (data == MAP_FAILED) {
+        close(trace->file);
+        return false;
+    }
+    madvise(data, trace->size, MADV_SEQUENTIAL);
+    trace->data = (const uint8_t *)data;
+    return true;
+#endif
+}
+
+static void replay_unmap_trace(ReplayTrace *trace) {
+#ifdef _WIN32
+    UnmapViewOfFile(trace->data);
+    CloseHandle(trace->mapping);
+    CloseHandle(trace->file);
+#else
+    munmap((void *)trace->data, trace->size);
+    close(trace->file);
+#endif
+}
+
+static bool replay_compare_total(uint32_t a, uint32_t b) { return replayStats[a].totalNs > replayStats[b].totalNs; }
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <trace file>\n", argv[0]);
+        return 1;
+    }
+
+    ReplayTrace trace;
+    if (!replay_map_trace(argv[1], &trace)) {
+        fprintf(stderr, "vkreplay: could not open %s\n", argv[1]);
+        return 1;
+    }
+
+    const VkCaptureFileHeader *header = (const VkCaptureFileHeader *)trace.data;
+    if (trace.size < sizeof(VkCaptureFileHeader) || memcmp(header->magic, VK_CAPTURE_MAGIC, sizeof(header->magic)) ||
+        header->version != VK_CAPTURE_VERSION || trace.size < sizeof(VkCaptureFileHeader) + header->entryPointNamesSize) {
+        fprintf(stderr, "vkreplay: %s is not a capture trace\n", argv[1]);
+        return 1;
+    }
+    if (header->pointerSize != sizeof(void *)) {
+        fprintf(stderr, "vkreplay: %s was captured by a %u-bit process\n", argv[1], header->pointerSize * 8);
+        return 1;
+    }
+
+    // Map the trace's entry point numbering onto ours by name
+    std::unordered_map<std::string, uint32_t> entryPointIds;
+    for (uint32_t i = 0; i < replayEntryPointCount; i++) {
+        entryPointIds[replayEntryPointNames[i]] = i;
+    }
+    std::vector<uint32_t> traceEntryPoints(header->entryPointCount, UINT32_MAX);
+    const char *name = (const char *)(header + 1);
+    const char *namesEnd = name + header->entryPointNamesSize;
+    for (uint32_t i = 0; i < header->entryPointCount && name < namesEnd; i++) {
+        std::unordered_map<std::string, uint32_t>::const_iterator it = entryPointIds.find(name);
+        if (it != entryPointIds.end()) {
+            traceEntryPoints[i] = it->second;
+        }
+        name += strlen(name) + 1;
+    }
+
+    replayStats.resize(replayEntryPointCount);
+    VkCaptureReader reader;
+    const uint8_t *cursor = (const uint8_t *)namesEnd;
+    const uint8_t *end = trace.data + trace.size;
+    uint64_t records = 0;
+    uint64_t start = replay_now();
+    while (cursor + sizeof(VkCaptureRecordHeader) <= end) {
+        const VkCaptureRecordHeader *record = (const VkCaptureRecordHeader *)cursor;
+        if (record->size < sizeof(VkCaptureRecordHeader) || record->size > (size_t)(end - cursor)) {
+            fprintf(stderr, "vkreplay: trace is truncated after %" PRIu64 " calls\n", records);
+            break;
+        }
+        uint32_t entryPoint = record->entryPoint < traceEntryPoints.size() ? traceEntryPoints[record->entryPoint] : UINT32_MAX;
+        reader.begin(cursor + sizeof(VkCaptureRecordHeader), cursor + record->size);
+        if (!replay_dispatch(entryPoint, reader)) {
+            fprintf(stderr, "vkreplay: malformed record after %" PRIu64 " calls\n", records);
+            break;
+        }
+        records++;
+        cursor += record->size;
+    }
+    uint64_t elapsedNs = replay_now() - start;
+
+    uint64_t callNs = 0;
+    std::vector<uint32_t> order;
+    for (uint32_t i = 0; i < replayEntryPointCount; i++) {
+        callNs += replayStats[i].totalNs;
+        if (replayStats[i].calls) {
+            order.push_back(i);
+        }
+    }
+    std::sort(order.begin(), order.end(), replay_compare_total);
+
+    double seconds = elapsedNs / 1e9;
+    printf("Replayed %" PRIu64 " calls in %.3f s (%.0f calls/s), %.3f s inside Vulkan\n", records, seconds,
+           seconds > 0 ? records / seconds : 0.0, callNs / 1e9);
+    printf("Skipped %" PRIu64 " window system or unrecognized calls, %" PRIu64 " results differed from the capture\n\n", replaySkipped,
+           replayDivergent);
+    printf("%-40s %12s %14s %12s\n", "Entry point", "Calls", "Total (ms)", "Avg (ns)");
+    for (size_t i = 0; i < order.size(); i++) {
+        const ReplayEntryStats &stats = replayStats[order[i]];
+        printf("%-40s %12" PRIu64 " %14.3f %12" PRIu64 "\n", replayEntryPointNames[order[i]], stats.calls, stats.totalNs / 1e6,
+               stats.totalNs / stats.calls);
+    }
+
+    replay_unmap_trace(&trace);
+    return 0;
+}
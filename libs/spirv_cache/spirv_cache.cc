@@ -0,0 +1,273 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2016 The Khronos Group Inc.
+// Copyright (c) 2016 Valve Corporation
+// Copyright (c) 2016 LunarG, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and/or associated documentation files (the "Materials"), to
+// deal in the Materials without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Materials, and to permit persons to whom the Materials are
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice(s) and this permission notice shall be included in
+// all copies or substantial portions of the Materials.
+//
+// THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE MATERIALS OR THE
+// USE OR OTHER DEALINGS IN THE MATERIALS.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "spirv_cache.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <mutex>
+#include <unordered_map>
+
+#ifndef GLSLANG_REVISION
+#define GLSLANG_REVISION "unknown"
+#endif
+
+namespace spirv_cache {
+
+namespace {
+
+// Bumped whenever the file layout or what goes into the key changes.
+const uint32_t kFormatVersion = 1;
+const uint32_t kFileMagic = 0x43565053;  // "SPVC"
+const uint32_t kSpirvMagic = 0x07230203;
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t key;
+  uint32_t word_count;
+  uint32_t reserved;
+};
+
+// 64-bit FNV-1a
+class Hasher {
+ public:
+  Hasher() : hash_(0xcbf29ce484222325ULL) {}
+
+  void Add(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+      hash_ ^= bytes[i];
+      hash_ *= 0x100000001b3ULL;
+    }
+  }
+
+  // lengths go in first so that adjacent strings cannot run together
+  void Add(const char* str, size_t length) {
+    uint64_t length64 = length;
+    Add(&length64, sizeof(length64));
+    Add(static_cast<const void*>(str), length);
+  }
+
+  void Add(uint32_t value) { Add(&value, sizeof(value)); }
+
+  uint64_t hash() const { return hash_; }
+
+ private:
+  uint64_t hash_;
+};
+
+class Cache {
+ public:
+  Cache()
+      : memory_hits_(0), disk_hits_(0), misses_(0), writes_(0),
+        write_failures_(0) {
+    const char* dir = getenv("VK_SPIRV_CACHE_DIR");
+    if (dir && dir[0] != '\0') {
+      dir_ = dir;
+#ifdef _WIN32
+      _mkdir(dir);
+#else
+      mkdir(dir, 0755);
+#endif
+    }
+  }
+
+  ~Cache() {
+    if (!memory_hits_ && !disk_hits_ && !misses_)
+      return;
+
+    if (dir_.empty()) {
+      printf("SPIR-V cache: %u hits, %u misses (VK_SPIRV_CACHE_DIR unset)\n",
+             memory_hits_, misses_);
+    } else {
+      printf("SPIR-V cache: %u hits (%u from %s), %u misses, %u written",
+             memory_hits_ + disk_hits_, disk_hits_, dir_.c_str(), misses_,
+             writes_);
+      if (write_failures_)
+        printf(", %u failed to write", write_failures_);
+      printf("\n");
+    }
+    fflush(stdout);
+  }
+
+  bool Lookup(uint64_t key, std::vector<unsigned int>& spirv) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = memo_.find(key);
+    if (it != memo_.end()) {
+      spirv = it->second;
+      memory_hits_++;
+      return true;
+    }
+
+    if (!dir_.empty() && ReadFile(key, spirv)) {
+      memo_[key] = spirv;
+      disk_hits_++;
+      return true;
+    }
+
+    misses_++;
+    return false;
+  }
+
+  void Store(uint64_t key, const std::vector<unsigned int>& spirv) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    memo_[key] = spirv;
+
+    if (!dir_.empty()) {
+      if (WriteFile(key, spirv))
+        writes_++;
+      else
+        write_failures_++;
+    }
+  }
+
+ private:
+  std::string Filename(uint64_t key) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016" PRIx64 ".spv", key);
+    return dir_ + "/" + name;
+  }
+
+  bool ReadFile(uint64_t key, std::vector<unsigned int>& spirv) const {
+    FILE* fp = fopen(Filename(key).c_str(), "rb");
+    if (!fp)
+      return false;
+
+    FileHeader header;
+    bool ok = fread(&header, sizeof(header), 1, fp) == 1 &&
+              header.magic == kFileMagic && header.version == kFormatVersion &&
+              header.key == key && header.word_count > 0;
+    if (ok) {
+      spirv.resize(header.word_count);
+      ok = fread(spirv.data(), sizeof(unsigned int), spirv.size(), fp) ==
+               spirv.size() &&
+           spirv[0] == kSpirvMagic;
+    }
+
+    fclose(fp);
+
+    return ok;
+  }
+
+  bool WriteFile(uint64_t key, const std::vector<unsigned int>& spirv) const {
+    FileHeader header = {};
+    header.magic = kFileMagic;
+    header.version = kFormatVersion;
+    header.key = key;
+    header.word_count = static_cast<uint32_t>(spirv.size());
+
+    // other processes may be writing the same file, each uses its own
+    // temporary
+    const std::string filename = Filename(key);
+    char suffix[32];
+#ifdef _WIN32
+    snprintf(suffix, sizeof(suffix), ".%d.tmp", _getpid());
+#else
+    snprintf(suffix, sizeof(suffix), ".%d.tmp", static_cast<int>(getpid()));
+#endif
+    const std::string tmp_filename = filename + suffix;
+
+    FILE* fp = fopen(tmp_filename.c_str(), "wb");
+    if (!fp)
+      return false;
+
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              fwrite(spirv.data(), sizeof(unsigned int), spirv.size(), fp) ==
+                  spirv.size();
+    ok = fclose(fp) == 0 && ok;
+
+    // losing a race to another process is harmless as it wrote the same
+    // words
+    if (ok) {
+#ifdef _WIN32
+      ok = MoveFileExA(tmp_filename.c_str(), filename.c_str(),
+                       MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+      ok = rename(tmp_filename.c_str(), filename.c_str()) == 0;
+#endif
+    }
+
+    if (!ok)
+      remove(tmp_filename.c_str());
+
+    return ok;
+  }
+
+  std::mutex mutex_;
+  std::string dir_;
+  std::unordered_map<uint64_t, std::vector<unsigned int>> memo_;
+
+  unsigned int memory_hits_;
+  unsigned int disk_hits_;
+  unsigned int misses_;
+  unsigned int writes_;
+  unsigned int write_failures_;
+};
+
+// constructed on first use and destroyed, printing its statistics, at exit
+Cache& GetCache() {
+  static Cache cache;
+  return cache;
+}
+
+}  // namespace
+
+uint64_t Key(int stage, int messages, const char* source,
+             const std::string& options) {
+  Hasher hasher;
+  hasher.Add(kFormatVersion);
+  hasher.Add(GLSLANG_REVISION, strlen(GLSLANG_REVISION));
+  hasher.Add(static_cast<uint32_t>(stage));
+  hasher.Add(static_cast<uint32_t>(messages));
+  hasher.Add(options.c_str(), options.size());
+  hasher.Add(source, strlen(source));
+  return hasher.hash();
+}
+
+bool Lookup(uint64_t key, std::vector<unsigned int>& spirv) {
+  return GetCache().Lookup(key, spirv);
+}
+
+void Store(uint64_t key, const std::vector<unsigned int>& spirv) {
+  GetCache().Store(key, spirv);
+}
+
+}  // namespace spirv_cache
@@ -0,0 +1,59 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2016 The Khronos Group Inc.
+// Copyright (c) 2016 Valve Corporation
+// Copyright (c) 2016 LunarG, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and/or associated documentation files (the "Materials"), to
+// deal in the Materials without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Materials, and to permit persons to whom the Materials are
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice(s) and this permission notice shall be included in
+// all copies or substantial portions of the Materials.
+//
+// THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE MATERIALS OR THE
+// USE OR OTHER DEALINGS IN THE MATERIALS.
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef SPIRV_CACHE_H_
+#define SPIRV_CACHE_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+// Cache of GLSL compiled to SPIR-V, shared by the API samples and the test
+// framework.  Compiles are remembered for the life of the process and, when
+// VK_SPIRV_CACHE_DIR names a directory, in one file per compile there, so
+// that later runs skip glslang altogether.  Files are written to a temporary
+// name and renamed into place, so processes sharing the directory never see
+// a partial one.  Hits and misses are printed when the process exits.
+namespace spirv_cache {
+
+// Returns the key of a compile.  It covers everything the SPIR-V depends on:
+// the stage and EShMessages flags as passed to glslang, the source text, the
+// glslang revision built against, and any caller options, such as the GLSL
+// version or remapping done after the compile.
+uint64_t Key(int stage, int messages, const char* source,
+             const std::string& options = std::string());
+
+// Fills spirv with what was stored for key, from memory or from disk, and
+// returns true, or returns false if nothing was.
+bool Lookup(uint64_t key, std::vector<unsigned int>& spirv);
+
+// Stores the SPIR-V compiled for key.
+void Store(uint64_t key, const std::vector<unsigned int>& spirv);
+
+}  // namespace spirv_cache
+
+#endif  // SPIRV_CACHE_H_
@@ -30,16 +30,16 @@
 #include <assert.h>
 #include <string.h>
 
+#include <cfloat>
+#include <climits>
 #include <cmath>
 #include <cinttypes>
 #include <cstdio>
+#include <cstdlib>
 #include <limits>
-#include <memory>
-#include <sstream>
 #include <type_traits>
 #include <utility>
 
-#include "cJSON.h"
 #include "vk_sdk_platform.h"
 
 namespace {
@@ -358,97 +358,192 @@ template <typename T>
 using EnableForEnum =
     typename std::enable_if<std::is_enum<T>::value, void>::type;
 
+// JSON is written straight into a string as Iterate visits each field.  The
+// layout, down to the tabs and the formatting of numbers, is the one
+// cJSON_Print gives, so that profiles stay comparable with older ones.
+
+inline void WriteJsonIndent(std::string* out, int depth) {
+  if (depth > 0)
+    out->append(depth, '\t');
+}
+
+inline void WriteJsonNumber(std::string* out, double d) {
+  char string[64];
+  if (d == 0) {
+    out->push_back('0');
+    return;
+  }
+  if (d <= INT_MAX && d >= INT_MIN &&
+      std::fabs(static_cast<double>(static_cast<int>(d)) - d) <= DBL_EPSILON) {
+    // most fields are integers, which are worth formatting by hand
+    int value = static_cast<int>(d);
+    uint32_t magnitude = value < 0 ? 0u - static_cast<uint32_t>(value)
+                                   : static_cast<uint32_t>(value);
+    char* end = string + sizeof(string);
+    char* digits = end;
+    do {
+      *--digits = static_cast<char>('0' + magnitude % 10);
+      magnitude /= 10;
+    } while (magnitude);
+    if (value < 0)
+      *--digits = '-';
+    out->append(digits, end - digits);
+    return;
+  }
+  if (std::fabs(std::floor(d) - d) <= DBL_EPSILON && std::fabs(d) < 1.0e60)
+    snprintf(string, sizeof(string), "%.0f", d);
+  else if (std::fabs(d) < 1.0e-6 || std::fabs(d) > 1.0e9)
+    snprintf(string, sizeof(string), "%e", d);
+  else
+    snprintf(string, sizeof(string), "%f", d);
+  out->append(string);
+}
+
+inline void WriteJsonString(std::string* out, const char* value) {
+  out->push_back('"');
+  for (const char* c = value; *c; ++c) {
+    const char* run = c;
+    while (static_cast<unsigned char>(*c) > 31 && *c != '"' && *c != '\\')
+      ++c;
+    out->append(run, c - run);
+    if (!*c)
+      break;
+    unsigned char ch = static_cast<unsigned char>(*c);
+    out->push_back('\\');
+    switch (ch) {
+      case '\\': out->push_back('\\'); break;
+      case '"': out->push_back('"'); break;
+      case '\b': out->push_back('b'); break;
+      case '\f': out->push_back('f'); break;
+      case '\n': out->push_back('n'); break;
+      case '\r': out->push_back('r'); break;
+      case '\t': out->push_back('t'); break;
+      default: {
+        char escape[8];
+        snprintf(escape, sizeof(escape), "u%04x", ch);
+        out->append(escape);
+      }
+    }
+  }
+  out->push_back('"');
+}
+
 template <typename T, typename = EnableForStruct<T>, typename = void>
-cJSON* ToJsonValue(const T& value);
+void WriteJsonValue(std::string* out, int depth, const T& value);
 
 template <typename T, typename = EnableForArithmetic<T>>
-inline cJSON* ToJsonValue(const T& value) {
-  return cJSON_CreateNumber(static_cast<double>(value));
+inline void WriteJsonValue(std::string* out, int depth, const T& value) {
+  WriteJsonNumber(out, static_cast<double>(value));
 }
 
-inline cJSON* ToJsonValue(const uint64_t& value) {
+inline void WriteJsonValue(std::string* out, int depth, const uint64_t& value) {
   char string[19] = {0};  // "0x" + 16 digits + terminal \0
   snprintf(string, sizeof(string), "0x%016" PRIx64, value);
-  return cJSON_CreateString(string);
+  WriteJsonString(out, string);
 }
 
 template <typename T, typename = EnableForEnum<T>, typename = void,
           typename = void>
-inline cJSON* ToJsonValue(const T& value) {
-  return cJSON_CreateNumber(static_cast<double>(value));
+inline void WriteJsonValue(std::string* out, int depth, const T& value) {
+  WriteJsonNumber(out, static_cast<double>(value));
 }
 
 template <typename T>
-inline cJSON* ArrayToJsonValue(uint32_t count, const T* values) {
-  cJSON* array = cJSON_CreateArray();
-  for (unsigned int i = 0; i < count; ++i)
-    cJSON_AddItemToArray(array, ToJsonValue(values[i]));
-  return array;
+inline void WriteJsonArray(std::string* out, int depth, uint32_t count,
+                           const T* values) {
+  out->push_back('[');
+  for (uint32_t i = 0; i < count; ++i) {
+    if (i)
+      out->append(", ");
+    WriteJsonValue(out, depth + 1, values[i]);
+  }
+  out->push_back(']');
 }
 
 template <typename T, unsigned int N>
-inline cJSON* ToJsonValue(const T (&value)[N]) {
-  return ArrayToJsonValue(N, value);
+inline void WriteJsonValue(std::string* out, int depth, const T (&value)[N]) {
+  WriteJsonArray(out, depth, N, value);
 }
 
 template <size_t N>
-inline cJSON* ToJsonValue(const char (&value)[N]) {
+inline void WriteJsonValue(std::string* out, int depth,
+                           const char (&value)[N]) {
   assert(strlen(value) < N);
-  return cJSON_CreateString(value);
+  WriteJsonString(out, value);
 }
 
 template <typename T>
-inline cJSON* ToJsonValue(const std::vector<T>& value) {
+inline void WriteJsonValue(std::string* out, int depth,
+                           const std::vector<T>& value) {
   assert(value.size() <= std::numeric_limits<uint32_t>::max());
-  return ArrayToJsonValue(static_cast<uint32_t>(value.size()), value.data());
+  WriteJsonArray(out, depth, static_cast<uint32_t>(value.size()),
+                 value.data());
 }
 
 template <typename F, typename S>
-inline cJSON* ToJsonValue(const std::pair<F, S>& value) {
-  cJSON* array = cJSON_CreateArray();
-  cJSON_AddItemToArray(array, ToJsonValue(value.first));
-  cJSON_AddItemToArray(array, ToJsonValue(value.second));
-  return array;
+inline void WriteJsonValue(std::string* out, int depth,
+                           const std::pair<F, S>& value) {
+  out->push_back('[');
+  WriteJsonValue(out, depth + 1, value.first);
+  out->append(", ");
+  WriteJsonValue(out, depth + 1, value.second);
+  out->push_back(']');
 }
 
 template <typename F, typename S>
-inline cJSON* ToJsonValue(const std::map<F, S>& value) {
-  cJSON* array = cJSON_CreateArray();
-  for (auto& kv : value)
-    cJSON_AddItemToArray(array, ToJsonValue(kv));
-  return array;
+inline void WriteJsonValue(std::string* out, int depth,
+                           const std::map<F, S>& value) {
+  out->push_back('[');
+  bool first = true;
+  for (auto& kv : value) {
+    if (!first)
+      out->append(", ");
+    first = false;
+    WriteJsonValue(out, depth + 1, kv);
+  }
+  out->push_back(']');
 }
 
 class JsonWriterVisitor {
  public:
-  JsonWriterVisitor() : object_(cJSON_CreateObject()) {}
-
-  ~JsonWriterVisitor() {
-    if (object_)
-      cJSON_Delete(object_);
+  JsonWriterVisitor(std::string* out, int depth)
+      : out_(out), depth_(depth), count_(0) {
+    out_->push_back('{');
   }
 
   template <typename T> bool Visit(const char* key, const T* value) {
-    cJSON_AddItemToObjectCS(object_, key, ToJsonValue(*value));
+    BeginMember(key);
+    WriteJsonValue(out_, depth_ + 1, *value);
     return true;
   }
 
   template <typename T, uint32_t N>
   bool VisitArray(const char* key, uint32_t count, const T (*value)[N]) {
     assert(count <= N);
-    cJSON_AddItemToObjectCS(object_, key, ArrayToJsonValue(count, *value));
+    BeginMember(key);
+    WriteJsonArray(out_, depth_ + 1, count, *value);
     return true;
   }
 
-  cJSON* get_object() const { return object_; }
-  cJSON* take_object() {
-    cJSON* object = object_;
-    object_ = nullptr;
-    return object;
+  void Finish() {
+    out_->push_back('\n');
+    WriteJsonIndent(out_, count_ ? depth_ : depth_ - 1);
+    out_->push_back('}');
   }
 
  private:
-  cJSON* object_;
+  void BeginMember(const char* key) {
+    if (count_++)
+      out_->push_back(',');
+    out_->push_back('\n');
+    WriteJsonIndent(out_, depth_ + 1);
+    WriteJsonString(out_, key);
+    out_->append(":\t");
+  }
+
+  std::string* out_;
+  int depth_;
+  uint32_t count_;
 };
 
 template <typename Visitor, typename T>
@@ -456,19 +551,244 @@ inline void VisitForWrite(Visitor* visitor, const T& t) {
   Iterate(visitor, const_cast<T*>(&t));
 }
 
-template <typename T, typename = EnableForStruct<T>, typename = void>
-cJSON* ToJsonValue(const T& value) {
-  JsonWriterVisitor visitor;
+template <typename T, typename, typename>
+void WriteJsonValue(std::string* out, int depth, const T& value) {
+  JsonWriterVisitor visitor(out, depth);
   VisitForWrite(&visitor, value);
-  return visitor.take_object();
+  visitor.Finish();
 }
 
+// Pulls JSON values out of the text as the readers ask for them.  A value of
+// the wrong type makes a read return false and leaves the parser where it
+// was; malformed JSON also marks the parser failed, at the offending
+// character.
+class JsonParser {
+ public:
+  explicit JsonParser(const char* text) : pos_(text), error_(nullptr) {}
+
+  bool failed() const { return error_ != nullptr; }
+  const char* error() const { return error_; }
+
+  const char* position() const { return pos_; }
+  void set_position(const char* position) { pos_ = position; }
+
+  char Peek() {
+    while (*pos_ && static_cast<unsigned char>(*pos_) <= 32)
+      ++pos_;
+    return *pos_;
+  }
+
+  bool Consume(char c) {
+    if (Peek() != c)
+      return false;
+    ++pos_;
+    return true;
+  }
+
+  bool Expect(char c) {
+    return Consume(c) || Fail();
+  }
+
+  bool ParseNumber(double* value) {
+    const char* start = pos_;
+    const char* p = pos_;
+    bool negative = *p == '-';
+    if (negative)
+      ++p;
+    uint64_t integer = 0;
+    const char* digits = p;
+    if (*p == '0') {
+      ++p;
+    } else if (*p >= '1' && *p <= '9') {
+      while (*p >= '0' && *p <= '9')
+        integer = integer * 10 + (*p++ - '0');
+    } else {
+      return Fail();
+    }
+    // integers that a double holds exactly need no strtod
+    if (*p != '.' && *p != 'e' && *p != 'E' && p - digits <= 15) {
+      *value = negative ? -static_cast<double>(integer)
+                        : static_cast<double>(integer);
+      pos_ = p;
+      return true;
+    }
+    if (*p == '.') {
+      ++p;
+      if (*p < '0' || *p > '9')
+        return FailAt(p);
+      while (*p >= '0' && *p <= '9')
+        ++p;
+    }
+    if (*p == 'e' || *p == 'E') {
+      ++p;
+      if (*p == '+' || *p == '-')
+        ++p;
+      if (*p < '0' || *p > '9')
+        return FailAt(p);
+      while (*p >= '0' && *p <= '9')
+        ++p;
+    }
+    *value = strtod(start, nullptr);
+    pos_ = p;
+    return true;
+  }
+
+  bool ParseString(std::string* value) {
+    if (!Expect('"'))
+      return false;
+    value->clear();
+    for (;;) {
+      const char* run = pos_;
+      while (*pos_ && *pos_ != '"' && *pos_ != '\\')
+        ++pos_;
+      value->append(run, pos_ - run);
+      if (*pos_ == '"') {
+        ++pos_;
+        return true;
+      }
+      if (!*pos_)
+        return Fail();
+      ++pos_;
+      switch (*pos_++) {
+        case '"': value->push_back('"'); break;
+        case '\\': value->push_back('\\'); break;
+        case '/': value->push_back('/'); break;
+        case 'b': value->push_back('\b'); break;
+        case 'f': value->push_back('\f'); break;
+        case 'n': value->push_back('\n'); break;
+        case 'r': value->push_back('\r'); break;
+        case 't': value->push_back('\t'); break;
+        case 'u': {
+          uint32_t code = 0;
+          if (!ParseHex4(&code))
+            return false;
+          if (code >= 0xd800 && code <= 0xdbff) {
+            uint32_t low = 0;
+            if (pos_[0] != '\\' || pos_[1] != 'u')
+              return Fail();
+            pos_ += 2;
+            if (!ParseHex4(&low))
+              return false;
+            if (low < 0xdc00 || low > 0xdfff)
+              return Fail();
+            code = 0x10000 + (((code & 0x3ff) << 10) | (low & 0x3ff));
+          }
+          AppendUtf8(value, code);
+          break;
+        }
+        default:
+          --pos_;
+          return Fail();
+      }
+    }
+  }
+
+  // Steps over a value of any type, checking that it is well formed.
+  bool SkipValue() {
+    switch (Peek()) {
+      case '"':
+        return ParseString(&scratch_);
+      case '{':
+        ++pos_;
+        if (Consume('}'))
+          return true;
+        do {
+          if (!ParseString(&scratch_) || !Expect(':') || !SkipValue())
+            return false;
+        } while (Consume(','));
+        return Expect('}');
+      case '[':
+        ++pos_;
+        if (Consume(']'))
+          return true;
+        do {
+          if (!SkipValue())
+            return false;
+        } while (Consume(','));
+        return Expect(']');
+      case 't':
+        return SkipLiteral("true");
+      case 'f':
+        return SkipLiteral("false");
+      case 'n':
+        return SkipLiteral("null");
+      default: {
+        double value;
+        return ParseNumber(&value);
+      }
+    }
+  }
+
+ private:
+  bool Fail() { return FailAt(pos_); }
+
+  bool FailAt(const char* position) {
+    if (!error_)
+      error_ = position;
+    return false;
+  }
+
+  bool ParseHex4(uint32_t* code) {
+    for (int i = 0; i < 4; ++i, ++pos_) {
+      char c = *pos_;
+      uint32_t digit;
+      if (c >= '0' && c <= '9')
+        digit = c - '0';
+      else if (c >= 'a' && c <= 'f')
+        digit = c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F')
+        digit = c - 'A' + 10;
+      else
+        return Fail();
+      *code = (*code << 4) | digit;
+    }
+    return true;
+  }
+
+  static void AppendUtf8(std::string* value, uint32_t code) {
+    if (code < 0x80) {
+      value->push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+      value->push_back(static_cast<char>(0xc0 | (code >> 6)));
+      value->push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    } else if (code < 0x10000) {
+      value->push_back(static_cast<char>(0xe0 | (code >> 12)));
+      value->push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+      value->push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    } else {
+      value->push_back(static_cast<char>(0xf0 | (code >> 18)));
+      value->push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+      value->push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+      value->push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    }
+  }
+
+  bool SkipLiteral(const char* literal) {
+    size_t length = strlen(literal);
+    if (strncmp(pos_, literal, length))
+      return Fail();
+    pos_ += length;
+    return true;
+  }
+
+  const char* pos_;
+  const char* error_;
+  std::string scratch_;
+};
+
 template <typename T, typename = EnableForStruct<T>>
-bool AsValue(cJSON* json_value, T* t);
+bool ReadJsonValue(JsonParser* parser, T* t);
 
-inline bool AsValue(cJSON* json_value, int32_t* value) {
-  double d = json_value->valuedouble;
-  if (json_value->type != cJSON_Number || !IsIntegral(d) ||
+inline bool ReadJsonNumber(JsonParser* parser, double* value) {
+  char c = parser->Peek();
+  if (c != '-' && (c < '0' || c > '9'))
+    return false;
+  return parser->ParseNumber(value);
+}
+
+inline bool ReadJsonValue(JsonParser* parser, int32_t* value) {
+  double d = 0.0;
+  if (!ReadJsonNumber(parser, &d) || !IsIntegral(d) ||
       d < static_cast<double>(std::numeric_limits<int32_t>::min()) ||
       d > static_cast<double>(std::numeric_limits<int32_t>::max()))
     return false;
@@ -476,72 +796,74 @@ inline bool AsValue(cJSON* json_value, int32_t* value) {
   return true;
 }
 
-inline bool AsValue(cJSON* json_value, uint64_t* value) {
-  if (json_value->type != cJSON_String)
+inline bool ReadJsonValue(JsonParser* parser, uint64_t* value) {
+  std::string string;
+  if (parser->Peek() != '"' || !parser->ParseString(&string))
     return false;
-  int result = std::sscanf(json_value->valuestring, "0x%016" PRIx64, value);
+  int result = std::sscanf(string.c_str(), "0x%016" PRIx64, value);
   return result == 1;
 }
 
-inline bool AsValue(cJSON* json_value, uint32_t* value) {
-  double d = json_value->valuedouble;
-  if (json_value->type != cJSON_Number || !IsIntegral(d) ||
+inline bool ReadJsonValue(JsonParser* parser, uint32_t* value) {
+  double d = 0.0;
+  if (!ReadJsonNumber(parser, &d) || !IsIntegral(d) ||
       d < 0.0 || d > static_cast<double>(std::numeric_limits<uint32_t>::max()))
     return false;
   *value = static_cast<uint32_t>(d);
   return true;
 }
 
-inline bool AsValue(cJSON* json_value, uint8_t* value) {
+inline bool ReadJsonValue(JsonParser* parser, uint8_t* value) {
   uint32_t value32 = 0;
-  AsValue(json_value, &value32);
-  if (value32 > std::numeric_limits<uint8_t>::max())
+  if (!ReadJsonValue(parser, &value32) ||
+      value32 > std::numeric_limits<uint8_t>::max())
     return false;
   *value = static_cast<uint8_t>(value32);
   return true;
 }
 
-inline bool AsValue(cJSON* json_value, float* value) {
-  if (json_value->type != cJSON_Number)
+inline bool ReadJsonValue(JsonParser* parser, float* value) {
+  double d = 0.0;
+  if (!ReadJsonNumber(parser, &d))
     return false;
-  *value = static_cast<float>(json_value->valuedouble);
+  *value = static_cast<float>(d);
   return true;
 }
 
 template <typename T>
-inline bool AsArray(cJSON* json_value, uint32_t count, T* values) {
-  if (json_value->type != cJSON_Array ||
-      cJSON_GetArraySize(json_value) != count)
+inline bool ReadJsonArray(JsonParser* parser, uint32_t count, T* values) {
+  if (!parser->Consume('['))
     return false;
   for (uint32_t i = 0; i < count; ++i) {
-    if (!AsValue(cJSON_GetArrayItem(json_value, i), values + i))
+    if ((i && !parser->Consume(',')) || !ReadJsonValue(parser, values + i))
       return false;
   }
-  return true;
+  return parser->Consume(']');
 }
 
 template <typename T, unsigned int N>
-inline bool AsValue(cJSON* json_value, T (*value)[N]) {
-  return AsArray(json_value, N, *value);
+inline bool ReadJsonValue(JsonParser* parser, T (*value)[N]) {
+  return ReadJsonArray(parser, N, *value);
 }
 
 template <size_t N>
-inline bool AsValue(cJSON* json_value, char (*value)[N]) {
-  if (json_value->type != cJSON_String)
+inline bool ReadJsonValue(JsonParser* parser, char (*value)[N]) {
+  std::string string;
+  if (parser->Peek() != '"' || !parser->ParseString(&string))
     return false;
-  size_t len = strlen(json_value->valuestring);
+  size_t len = strlen(string.c_str());
   if (len >= N)
     return false;
-  memcpy(*value, json_value->valuestring, len);
+  memcpy(*value, string.data(), len);
   memset(*value + len, 0, N-len);
   return true;
 }
 
 template <typename T, typename = EnableForEnum<T>, typename = void>
-inline bool AsValue(cJSON* json_value, T* t) {
+inline bool ReadJsonValue(JsonParser* parser, T* t) {
   // TODO(piman): to/from strings instead?
   uint32_t value = 0;
-  if (!AsValue(json_value, &value))
+  if (!ReadJsonValue(parser, &value))
       return false;
   if (value < EnumTraits<T>::min() || value > EnumTraits<T>::max())
     return false;
@@ -550,51 +872,44 @@ inline bool AsValue(cJSON* json_value, T* t) {
 }
 
 template <typename T>
-inline bool AsValue(cJSON* json_value, std::vector<T>* value) {
-  if (json_value->type != cJSON_Array)
+inline bool ReadJsonValue(JsonParser* parser, std::vector<T>* value) {
+  if (!parser->Consume('['))
     return false;
-  int size = cJSON_GetArraySize(json_value);
-  value->resize(size);
-  return AsArray(json_value, size, value->data());
+  value->clear();
+  if (parser->Consume(']'))
+    return true;
+  do {
+    value->emplace_back();
+    if (!ReadJsonValue(parser, &value->back()))
+      return false;
+  } while (parser->Consume(','));
+  return parser->Expect(']');
 }
 
 template <typename F, typename S>
-inline bool AsValue(cJSON* json_value, std::pair<F, S>* value) {
-  if (json_value->type != cJSON_Array || cJSON_GetArraySize(json_value) != 2)
-    return false;
-  return AsValue(cJSON_GetArrayItem(json_value, 0), &value->first) &&
-         AsValue(cJSON_GetArrayItem(json_value, 1), &value->second);
+inline bool ReadJsonValue(JsonParser* parser, std::pair<F, S>* value) {
+  return parser->Consume('[') && ReadJsonValue(parser, &value->first) &&
+         parser->Consume(',') && ReadJsonValue(parser, &value->second) &&
+         parser->Consume(']');
 }
 
 template <typename F, typename S>
-inline bool AsValue(cJSON* json_value, std::map<F, S>* value) {
-  if (json_value->type != cJSON_Array)
+inline bool ReadJsonValue(JsonParser* parser, std::map<F, S>* value) {
+  if (!parser->Consume('['))
     return false;
-  int size = cJSON_GetArraySize(json_value);
-  for (int i = 0; i < size; ++i) {
+  if (parser->Consume(']'))
+    return true;
+  do {
     std::pair<F, S> elem;
-    if (!AsValue(cJSON_GetArrayItem(json_value, i), &elem))
+    if (!ReadJsonValue(parser, &elem))
       return false;
-    if (!value->insert(elem).second)
+    // written in key order, so each insert goes at the end
+    size_t size = value->size();
+    value->insert(value->end(), elem);
+    if (value->size() == size)
       return false;
-  }
-  return true;
-}
-
-template <typename T>
-bool ReadValue(cJSON* object, const char* key, T* value,
-               std::string* errors) {
-  cJSON* json_value = cJSON_GetObjectItem(object, key);
-  if (!json_value) {
-    if (errors)
-      *errors = std::string(key) + " missing.";
-    return false;
-  }
-  if (AsValue(json_value, value))
-    return true;
-  if (errors)
-    *errors = std::string("Wrong type for ") + std::string(key) + ".";
-  return false;
+  } while (parser->Consume(','));
+  return parser->Expect(']');
 }
 
 template <typename Visitor, typename T>
@@ -602,54 +917,96 @@ inline bool VisitForRead(Visitor* visitor, T* t) {
   return Iterate(visitor, t);
 }
 
+// Reads the members of an object, which has had its '{' consumed, in the
+// order they are visited.  That is the order they were written in, so each
+// lookup normally finds its key next; keys in any other order are found by
+// going back over the object from its start.
 class JsonReaderVisitor {
  public:
-  JsonReaderVisitor(cJSON* object, std::string* errors)
-      : object_(object), errors_(errors) {}
+  JsonReaderVisitor(JsonParser* parser, std::string* errors)
+      : parser_(parser), errors_(errors), members_(parser->position()) {}
 
-  template <typename T> bool Visit(const char* key, T* value) const {
-    return ReadValue(object_, key, value, errors_);
+  template <typename T> bool Visit(const char* key, T* value) {
+    if (!FindMember(key))
+      return false;
+    if (ReadJsonValue(parser_, value))
+      return true;
+    return WrongType(key);
   }
 
   template <typename T, uint32_t N>
   bool VisitArray(const char* key, uint32_t count, T (*value)[N]) {
     if (count > N)
       return false;
-    cJSON* json_value = cJSON_GetObjectItem(object_, key);
-    if (!json_value) {
-      if (errors_)
-        *errors_ = std::string(key) + " missing.";
+    if (!FindMember(key))
       return false;
+    if (ReadJsonArray(parser_, count, *value))
+      return true;
+    return WrongType(key);
+  }
+
+  // Steps over the members left unvisited, up to the closing '}'.
+  bool Finish() {
+    while (NextMember()) {
+      if (!parser_->SkipValue())
+        return false;
     }
-    if (AsArray(json_value, count, *value))
+    return !parser_->failed() && parser_->Expect('}');
+  }
+
+ private:
+  // Reads the key of the next member, if there is one, and its ':'.
+  bool NextMember() {
+    if (parser_->position() != members_ && parser_->Peek() != '}' &&
+        !parser_->Expect(','))
+      return false;
+    if (parser_->Peek() == '}')
+      return false;
+    return parser_->ParseString(&name_) && parser_->Expect(':');
+  }
+
+  bool FindMember(const char* key) {
+    if (NextMember() && name_ == key)
       return true;
-    if (errors_)
-      *errors_ = std::string("Wrong type for ") + std::string(key) + ".";
+    if (parser_->failed())
+      return false;
+    parser_->set_position(members_);
+    while (NextMember()) {
+      if (name_ == key)
+        return true;
+      if (!parser_->SkipValue())
+        return false;
+    }
+    if (!parser_->failed() && errors_)
+      *errors_ = std::string(key) + " missing.";
     return false;
   }
 
+  bool WrongType(const char* key) {
+    if (!parser_->failed() && errors_)
+      *errors_ = std::string("Wrong type for ") + std::string(key) + ".";
+    return false;
+  }
 
- private:
-  cJSON* object_;
+  JsonParser* parser_;
   std::string* errors_;
+  const char* members_;
+  std::string name_;
 };
 
-template <typename T, typename = EnableForStruct<T>>
-bool AsValue(cJSON* json_value, T* t) {
-  if (json_value->type != cJSON_Object)
+template <typename T, typename>
+bool ReadJsonValue(JsonParser* parser, T* t) {
+  if (!parser->Consume('{'))
     return false;
-  JsonReaderVisitor visitor(json_value, nullptr);
-  return VisitForRead(&visitor, t);
+  JsonReaderVisitor visitor(parser, nullptr);
+  return VisitForRead(&visitor, t) && visitor.Finish();
 }
 
 
 template <typename T> std::string VkTypeToJson(const T& t) {
-  JsonWriterVisitor visitor;
-  VisitForWrite(&visitor, t);
-
-  char* output = cJSON_Print(visitor.get_object());
-  std::string result(output);
-  free(output);
+  std::string result;
+  result.reserve(32768);
+  WriteJsonValue(&result, 0, t);
   return result;
 }
 
@@ -657,17 +1014,349 @@ template <typename T> bool VkTypeFromJson(const std::string& json,
                                           T* t,
                                           std::string* errors) {
   *t = T();
-  cJSON* object = cJSON_Parse(json.c_str());
-  if (!object) {
+  JsonParser parser(json.c_str());
+  bool result = false;
+  if (parser.Consume('{')) {
+    JsonReaderVisitor visitor(&parser, errors);
+    result = VisitForRead(&visitor, t) && visitor.Finish();
+  } else if (!parser.failed() && errors) {
+    *errors = "Not a JSON object.";
+  }
+  if (parser.failed()) {
     if (errors)
-      errors->assign(cJSON_GetErrorPtr());
+      errors->assign(parser.error());
     return false;
   }
-  bool result = AsValue(object, t);
-  cJSON_Delete(object);
   return result;
 }
 
+// Binary profiles hold a header and then every field, in the order Iterate
+// visits them, little-endian.  Strings are written up to their terminator
+// with a one byte length, vectors with a 32-bit count, and the format table
+// as one entry for each core format whether the device supports it or not.
+// kBinaryVersion is bumped whenever any of that changes.
+
+const uint32_t kBinaryMagic = 0x424a4b56;  // "VKJB"
+const uint32_t kBinaryVersion = 1;
+
+template <typename T, typename = EnableForStruct<T>>
+void WriteBinary(std::vector<uint8_t>* out, const T& value);
+
+inline void WriteBinary(std::vector<uint8_t>* out, uint32_t value) {
+  uint8_t bytes[4] = {static_cast<uint8_t>(value),
+                      static_cast<uint8_t>(value >> 8),
+                      static_cast<uint8_t>(value >> 16),
+                      static_cast<uint8_t>(value >> 24)};
+  out->insert(out->end(), bytes, bytes + sizeof(bytes));
+}
+
+inline void WriteBinary(std::vector<uint8_t>* out, int32_t value) {
+  WriteBinary(out, static_cast<uint32_t>(value));
+}
+
+inline void WriteBinary(std::vector<uint8_t>* out, uint64_t value) {
+  WriteBinary(out, static_cast<uint32_t>(value));
+  WriteBinary(out, static_cast<uint32_t>(value >> 32));
+}
+
+inline void WriteBinary(std::vector<uint8_t>* out, uint8_t value) {
+  out->push_back(value);
+}
+
+inline void WriteBinary(std::vector<uint8_t>* out, float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  WriteBinary(out, bits);
+}
+
+template <typename T, typename = EnableForEnum<T>, typename = void>
+inline void WriteBinary(std::vector<uint8_t>* out, T value) {
+  WriteBinary(out, static_cast<uint32_t>(value));
+}
+
+template <typename T, unsigned int N>
+inline void WriteBinary(std::vector<uint8_t>* out, const T (&value)[N]) {
+  for (unsigned int i = 0; i < N; ++i)
+    WriteBinary(out, value[i]);
+}
+
+template <size_t N>
+inline void WriteBinary(std::vector<uint8_t>* out, const char (&value)[N]) {
+  static_assert(N <= 256, "string lengths are written as one byte");
+  const char* end = static_cast<const char*>(memchr(value, 0, N));
+  assert(end);
+  size_t len = end ? end - value : N - 1;
+  out->push_back(static_cast<uint8_t>(len));
+  out->insert(out->end(), value, value + len);
+}
+
+template <typename T>
+inline void WriteBinary(std::vector<uint8_t>* out,
+                        const std::vector<T>& value) {
+  assert(value.size() <= std::numeric_limits<uint32_t>::max());
+  WriteBinary(out, static_cast<uint32_t>(value.size()));
+  for (const T& elem : value)
+    WriteBinary(out, elem);
+}
+
+inline void WriteBinary(std::vector<uint8_t>* out,
+                        const std::map<VkFormat, VkFormatProperties>& value) {
+  VkFormatProperties table[VK_FORMAT_RANGE_SIZE] = {};
+  for (auto& kv : value) {
+    assert(kv.first >= VK_FORMAT_BEGIN_RANGE &&
+           kv.first <= VK_FORMAT_END_RANGE);
+    if (kv.first >= VK_FORMAT_BEGIN_RANGE && kv.first <= VK_FORMAT_END_RANGE)
+      table[kv.first - VK_FORMAT_BEGIN_RANGE] = kv.second;
+  }
+  WriteBinary(out, static_cast<uint32_t>(VK_FORMAT_RANGE_SIZE));
+  for (const VkFormatProperties& properties : table)
+    WriteBinary(out, properties);
+}
+
+class BinaryWriterVisitor {
+ public:
+  explicit BinaryWriterVisitor(std::vector<uint8_t>* out) : out_(out) {}
+
+  template <typename T> bool Visit(const char* key, const T* value) {
+    WriteBinary(out_, *value);
+    return true;
+  }
+
+  template <typename T, uint32_t N>
+  bool VisitArray(const char* key, uint32_t count, const T (*value)[N]) {
+    assert(count <= N);
+    for (uint32_t i = 0; i < count; ++i)
+      WriteBinary(out_, (*value)[i]);
+    return true;
+  }
+
+ private:
+  std::vector<uint8_t>* out_;
+};
+
+template <typename T, typename>
+void WriteBinary(std::vector<uint8_t>* out, const T& value) {
+  BinaryWriterVisitor visitor(out);
+  VisitForWrite(&visitor, value);
+}
+
+class BinaryReader {
+ public:
+  BinaryReader(const uint8_t* data, size_t size)
+      : pos_(data), end_(data + size), truncated_(false) {}
+
+  bool truncated() const { return truncated_; }
+  bool done() const { return pos_ == end_; }
+
+  // Returns the next size bytes, or nullptr if there are not that many.
+  const uint8_t* Take(size_t size) {
+    if (static_cast<size_t>(end_ - pos_) < size) {
+      truncated_ = true;
+      return nullptr;
+    }
+    const uint8_t* bytes = pos_;
+    pos_ += size;
+    return bytes;
+  }
+
+ private:
+  const uint8_t* pos_;
+  const uint8_t* end_;
+  bool truncated_;
+};
+
+template <typename T, typename = EnableForStruct<T>>
+bool ReadBinary(BinaryReader* reader, T* t);
+
+inline bool ReadBinary(BinaryReader* reader, uint32_t* value) {
+  const uint8_t* bytes = reader->Take(4);
+  if (!bytes)
+    return false;
+  *value = static_cast<uint32_t>(bytes[0]) |
+           static_cast<uint32_t>(bytes[1]) << 8 |
+           static_cast<uint32_t>(bytes[2]) << 16 |
+           static_cast<uint32_t>(bytes[3]) << 24;
+  return true;
+}
+
+inline bool ReadBinary(BinaryReader* reader, int32_t* value) {
+  uint32_t value32 = 0;
+  if (!ReadBinary(reader, &value32))
+    return false;
+  *value = static_cast<int32_t>(value32);
+  return true;
+}
+
+inline bool ReadBinary(BinaryReader* reader, uint64_t* value) {
+  uint32_t low = 0, high = 0;
+  if (!ReadBinary(reader, &low) || !ReadBinary(reader, &high))
+    return false;
+  *value = static_cast<uint64_t>(high) << 32 | low;
+  return true;
+}
+
+inline bool ReadBinary(BinaryReader* reader, uint8_t* value) {
+  const uint8_t* bytes = reader->Take(1);
+  if (!bytes)
+    return false;
+  *value = *bytes;
+  return true;
+}
+
+inline bool ReadBinary(BinaryReader* reader, float* value) {
+  uint32_t bits = 0;
+  if (!ReadBinary(reader, &bits))
+    return false;
+  memcpy(value, &bits, sizeof(bits));
+  return true;
+}
+
+template <typename T, typename = EnableForEnum<T>, typename = void>
+inline bool ReadBinary(BinaryReader* reader, T* t) {
+  uint32_t value = 0;
+  if (!ReadBinary(reader, &value))
+    return false;
+  if (value < EnumTraits<T>::min() || value > EnumTraits<T>::max())
+    return false;
+  *t = static_cast<T>(value);
+  return true;
+}
+
+template <typename T, unsigned int N>
+inline bool ReadBinary(BinaryReader* reader, T (*value)[N]) {
+  for (unsigned int i = 0; i < N; ++i) {
+    if (!ReadBinary(reader, *value + i))
+      return false;
+  }
+  return true;
+}
+
+template <size_t N>
+inline bool ReadBinary(BinaryReader* reader, char (*value)[N]) {
+  uint8_t len = 0;
+  if (!ReadBinary(reader, &len))
+    return false;
+  const uint8_t* bytes = reader->Take(len);
+  if (!bytes || len >= N || memchr(bytes, 0, len))
+    return false;
+  memcpy(*value, bytes, len);
+  memset(*value + len, 0, N-len);
+  return true;
+}
+
+template <typename T>
+inline bool ReadBinary(BinaryReader* reader, std::vector<T>* value) {
+  uint32_t count = 0;
+  if (!ReadBinary(reader, &count))
+    return false;
+  value->clear();
+  for (uint32_t i = 0; i < count; ++i) {
+    value->emplace_back();
+    if (!ReadBinary(reader, &value->back()))
+      return false;
+  }
+  return true;
+}
+
+inline bool ReadBinary(BinaryReader* reader,
+                       std::map<VkFormat, VkFormatProperties>* value) {
+  uint32_t count = 0;
+  if (!ReadBinary(reader, &count) || count > VK_FORMAT_RANGE_SIZE)
+    return false;
+  value->clear();
+  for (uint32_t i = 0; i < count; ++i) {
+    VkFormatProperties properties = {};
+    if (!ReadBinary(reader, &properties))
+      return false;
+    if (properties.linearTilingFeatures || properties.optimalTilingFeatures ||
+        properties.bufferFeatures)
+      value->insert(value->end(),
+                    std::make_pair(
+                        static_cast<VkFormat>(VK_FORMAT_BEGIN_RANGE + i),
+                        properties));
+  }
+  return true;
+}
+
+class BinaryReaderVisitor {
+ public:
+  BinaryReaderVisitor(BinaryReader* reader, std::string* errors)
+      : reader_(reader), errors_(errors) {}
+
+  template <typename T> bool Visit(const char* key, T* value) {
+    if (ReadBinary(reader_, value))
+      return true;
+    return Error(key);
+  }
+
+  template <typename T, uint32_t N>
+  bool VisitArray(const char* key, uint32_t count, T (*value)[N]) {
+    if (count > N)
+      return Error(key);
+    for (uint32_t i = 0; i < count; ++i) {
+      if (!ReadBinary(reader_, *value + i))
+        return Error(key);
+    }
+    return true;
+  }
+
+ private:
+  bool Error(const char* key) {
+    if (errors_) {
+      if (reader_->truncated())
+        *errors_ = std::string(key) + " truncated.";
+      else
+        *errors_ = std::string("Bad value for ") + std::string(key) + ".";
+    }
+    return false;
+  }
+
+  BinaryReader* reader_;
+  std::string* errors_;
+};
+
+template <typename T, typename>
+bool ReadBinary(BinaryReader* reader, T* t) {
+  BinaryReaderVisitor visitor(reader, nullptr);
+  return VisitForRead(&visitor, t);
+}
+
+template <typename T> std::vector<uint8_t> VkTypeToBinary(const T& t) {
+  std::vector<uint8_t> result;
+  result.reserve(4096);
+  WriteBinary(&result, kBinaryMagic);
+  WriteBinary(&result, kBinaryVersion);
+  WriteBinary(&result, t);
+  return result;
+}
+
+template <typename T> bool VkTypeFromBinary(const void* data, size_t size,
+                                            T* t, std::string* errors) {
+  *t = T();
+  BinaryReader reader(static_cast<const uint8_t*>(data), size);
+  uint32_t magic = 0, version = 0;
+  if (!ReadBinary(&reader, &magic) || magic != kBinaryMagic) {
+    if (errors)
+      *errors = "Not a binary profile.";
+    return false;
+  }
+  if (!ReadBinary(&reader, &version) || version != kBinaryVersion) {
+    if (errors)
+      *errors = "Unsupported binary profile version " +
+                std::to_string(version) + ".";
+    return false;
+  }
+  BinaryReaderVisitor visitor(&reader, errors);
+  if (!VisitForRead(&visitor, t))
+    return false;
+  if (!reader.done()) {
+    if (errors)
+      *errors = "Trailing data after profile.";
+    return false;
+  }
+  return true;
+}
+
 }  // anonymous namespace
 
 std::string VkJsonAllPropertiesToJson(
@@ -681,6 +1370,17 @@ bool VkJsonAllPropertiesFromJson(
   return VkTypeFromJson(json, properties, errors);
 };
 
+std::vector<uint8_t> VkJsonAllPropertiesToBinary(
+    const VkJsonAllProperties& properties) {
+  return VkTypeToBinary(properties);
+}
+
+bool VkJsonAllPropertiesFromBinary(const void* data, size_t size,
+                                   VkJsonAllProperties* properties,
+                                   std::string* errors) {
+  return VkTypeFromBinary(data, size, properties, errors);
+}
+
 std::string VkJsonImageFormatPropertiesToJson(
     const VkImageFormatProperties& properties) {
   return VkTypeToJson(properties);
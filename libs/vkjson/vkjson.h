@@ -63,6 +63,15 @@ bool VkJsonAllPropertiesFromJson(
     const std::string& json, VkJsonAllProperties* properties,
     std::string* errors);
 
+// Binary profiles hold the same fields as JSON ones in a compact, versioned
+// encoding that loads without parsing text.  The format table is stored
+// densely, so formats the device reports no features for are not kept.
+std::vector<uint8_t> VkJsonAllPropertiesToBinary(
+    const VkJsonAllProperties& properties);
+bool VkJsonAllPropertiesFromBinary(const void* data, size_t size,
+                                   VkJsonAllProperties* properties,
+                                   std::string* errors);
+
 std::string VkJsonImageFormatPropertiesToJson(
     const VkImageFormatProperties& properties);
 bool VkJsonImageFormatPropertiesFromJson(const std::string& json,
@@ -0,0 +1,226 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2016 The Khronos Group Inc.
+// Copyright (c) 2016 Valve Corporation
+// Copyright (c) 2016 LunarG, Inc.
+// Copyright (c) 2016 Google, Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and/or associated documentation files (the "Materials"), to
+// deal in the Materials without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Materials, and to permit persons to whom the Materials are
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice(s) and this permission notice shall be included in
+// all copies or substantial portions of the Materials.
+//
+// THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE MATERIALS OR THE
+// USE OR OTHER DEALINGS IN THE MATERIALS.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "vkjson.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <fstream>
+
+// Times writing and reading a device profile as JSON and in the binary
+// encoding.  The profile is a made up one resembling a desktop GPU, or the
+// one in the JSON file given after the iteration count.
+//
+//   vkjson_bench [iterations] [profile.json]
+
+namespace {
+
+VkJsonAllProperties MakeProfile() {
+  VkJsonAllProperties props;
+  const char name[] = "Benchmark device";
+  memcpy(props.properties.deviceName, name, sizeof(name));
+  props.properties.apiVersion = VK_API_VERSION;
+  props.properties.deviceType = VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
+
+  // every limit gets a distinct value, with the floats not all integral
+  VkPhysicalDeviceLimits& limits = props.properties.limits;
+  uint32_t* words = reinterpret_cast<uint32_t*>(&limits);
+  for (size_t i = 0; i < sizeof(limits) / sizeof(uint32_t); ++i)
+    words[i] = static_cast<uint32_t>(i * 1021);
+  limits.maxSamplerLodBias = 15.5f;
+  limits.maxSamplerAnisotropy = 16.0f;
+  limits.viewportBoundsRange[0] = -32768.0f;
+  limits.viewportBoundsRange[1] = 32767.0f;
+  limits.minInterpolationOffset = -0.5f;
+  limits.maxInterpolationOffset = 0.4375f;
+  limits.timestampPeriod = 1.25f;
+  limits.pointSizeRange[0] = 1.0f;
+  limits.pointSizeRange[1] = 189.875f;
+  limits.lineWidthRange[0] = 0.5f;
+  limits.lineWidthRange[1] = 10.0f;
+  limits.pointSizeGranularity = 0.125f;
+  limits.lineWidthGranularity = 0.125f;
+  limits.minTexelOffset = -8;
+  limits.minTexelGatherOffset = -32;
+  limits.bufferImageGranularity = 0x400;
+  limits.sparseAddressSpaceSize = 0xffffffffffull;
+  limits.minMemoryMapAlignment = 64;
+  limits.minTexelBufferOffsetAlignment = 16;
+  limits.minUniformBufferOffsetAlignment = 256;
+  limits.minStorageBufferOffsetAlignment = 32;
+  limits.optimalBufferCopyOffsetAlignment = 1;
+  limits.optimalBufferCopyRowPitchAlignment = 1;
+  limits.nonCoherentAtomSize = 64;
+
+  VkBool32* features = reinterpret_cast<VkBool32*>(&props.features);
+  for (size_t i = 0; i < sizeof(props.features) / sizeof(VkBool32); ++i)
+    features[i] = (i % 5) != 0;
+
+  props.memory.memoryTypeCount = 8;
+  for (uint32_t i = 0; i < props.memory.memoryTypeCount; ++i) {
+    props.memory.memoryTypes[i].propertyFlags = i & 7;
+    props.memory.memoryTypes[i].heapIndex = i & 1;
+  }
+  props.memory.memoryHeapCount = 2;
+  props.memory.memoryHeaps[0].size = 0x100000000ull;
+  props.memory.memoryHeaps[0].flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+  props.memory.memoryHeaps[1].size = 0x200000000ull;
+
+  for (uint32_t i = 0; i < 3; ++i) {
+    VkQueueFamilyProperties queue = {};
+    queue.queueFlags = VK_QUEUE_TRANSFER_BIT | (i ? 0 : VK_QUEUE_GRAPHICS_BIT);
+    queue.queueCount = i ? 1 : 16;
+    queue.timestampValidBits = 64;
+    queue.minImageTransferGranularity.width = 1;
+    queue.minImageTransferGranularity.height = 1;
+    queue.minImageTransferGranularity.depth = 1;
+    props.queues.push_back(queue);
+  }
+
+  for (uint32_t i = 0; i < 40; ++i) {
+    VkExtensionProperties extension = {};
+    snprintf(extension.extensionName, sizeof(extension.extensionName),
+             "VK_VENDOR_benchmark_extension_%u", i);
+    extension.specVersion = i + 1;
+    props.extensions.push_back(extension);
+  }
+
+  for (uint32_t i = 0; i < 4; ++i) {
+    VkLayerProperties layer = {};
+    snprintf(layer.layerName, sizeof(layer.layerName),
+             "VK_LAYER_VENDOR_benchmark_%u", i);
+    layer.specVersion = VK_API_VERSION;
+    layer.implementationVersion = i;
+    snprintf(layer.description, sizeof(layer.description),
+             "Benchmark layer %u, with \"quotes\" and a\ttab", i);
+    props.layers.push_back(layer);
+  }
+
+  for (uint32_t format = VK_FORMAT_R4G4_UNORM_PACK8;
+       format <= VK_FORMAT_END_RANGE; ++format) {
+    if (format % 7 == 3)
+      continue;
+    VkFormatProperties format_props = {format * 3u, format * 5u, format};
+    props.formats.insert(
+        std::make_pair(static_cast<VkFormat>(format), format_props));
+  }
+  return props;
+}
+
+// Compares every field, leaving out the padding a memcmp would see.
+bool SameProfile(const VkJsonAllProperties& a, const VkJsonAllProperties& b) {
+  return VkJsonAllPropertiesToBinary(a) == VkJsonAllPropertiesToBinary(b);
+}
+
+typedef std::chrono::steady_clock Clock;
+
+void Report(const char* what, int iterations, size_t bytes,
+            Clock::duration elapsed) {
+  double seconds = std::chrono::duration<double>(elapsed).count();
+  if (seconds <= 0.0)
+    seconds = 1e-9;
+  printf("  %-14s %9.2f us/profile %9.1f MB/s\n", what,
+         seconds * 1e6 / iterations,
+         static_cast<double>(bytes) * iterations / (1024.0 * 1024.0) /
+             seconds);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int iterations = 2000;
+  if (argc > 1)
+    iterations = atoi(argv[1]);
+  if (iterations <= 0) {
+    std::cerr << "Usage: " << argv[0] << " [iterations] [profile.json]"
+              << std::endl;
+    return 1;
+  }
+
+  VkJsonAllProperties props;
+  std::string errors;
+  if (argc > 2) {
+    std::ifstream file(argv[2], std::ios::binary);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    if (!file ||
+        !VkJsonAllPropertiesFromJson(contents.str(), &props, &errors)) {
+      std::cerr << "Unable to read profile " << argv[2] << ": " << errors
+                << std::endl;
+      return 1;
+    }
+  } else {
+    props = MakeProfile();
+  }
+
+  std::string json;
+  std::vector<uint8_t> binary;
+  VkJsonAllProperties loaded;
+  bool ok = true;
+
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < iterations; ++i)
+    json = VkJsonAllPropertiesToJson(props);
+  Clock::duration json_write = Clock::now() - start;
+
+  start = Clock::now();
+  for (int i = 0; i < iterations; ++i)
+    ok = VkJsonAllPropertiesFromJson(json, &loaded, &errors) && ok;
+  Clock::duration json_read = Clock::now() - start;
+  ok = ok && SameProfile(props, loaded);
+
+  start = Clock::now();
+  for (int i = 0; i < iterations; ++i)
+    binary = VkJsonAllPropertiesToBinary(props);
+  Clock::duration binary_write = Clock::now() - start;
+
+  start = Clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    ok = VkJsonAllPropertiesFromBinary(binary.data(), binary.size(), &loaded,
+                                       &errors) && ok;
+  }
+  Clock::duration binary_read = Clock::now() - start;
+  ok = ok && SameProfile(props, loaded);
+
+  printf("%d round trips of %s: %zu bytes as JSON, %zu as binary\n",
+         iterations, props.properties.deviceName, json.size(), binary.size());
+  Report("JSON write", iterations, json.size(), json_write);
+  Report("JSON read", iterations, json.size(), json_read);
+  Report("binary write", iterations, binary.size(), binary_write);
+  Report("binary read", iterations, binary.size(), binary_read);
+
+  if (!ok) {
+    std::cerr << "Round trip failed: " << errors << std::endl;
+    return 1;
+  }
+  return 0;
+}
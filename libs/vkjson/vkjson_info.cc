@@ -27,11 +27,22 @@
 
 #define VK_PROTOTYPES
 #include "vkjson.h"
+#include "vk_sdk_platform.h"
 
 #include <stdio.h>
 #include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
 
 #include <iostream>
+#include <thread>
 #include <vector>
 
 const uint32_t unsignedNegOne = (uint32_t)(-1);
@@ -40,6 +51,8 @@ struct Options {
   uint32_t device_index = unsignedNegOne;
   std::string device_name;
   std::string output_file;
+  bool parallel = false;
+  std::string cache_dir;
 };
 
 bool ParseOptions(int argc, char* argv[], Options* options) {
@@ -47,6 +60,8 @@ bool ParseOptions(int argc, char* argv[], Options* options) {
     std::string arg(argv[i]);
     if (arg == "--first" || arg == "-f") {
       options->device_index = 0;
+    } else if (arg == "--parallel" || arg == "-p") {
+      options->parallel = true;
     } else {
       ++i;
       if (i >= argc) {
@@ -65,6 +80,8 @@ bool ParseOptions(int argc, char* argv[], Options* options) {
         options->device_name = arg2;
       } else if (arg == "--output" || arg == "-o") {
         options->output_file = arg2;
+      } else if (arg == "--cache" || arg == "-c") {
+        options->cache_dir = arg2;
       } else {
         std::cerr << "Unknown argument: " << arg << std::endl;
         return false;
@@ -86,6 +103,134 @@ bool ParseOptions(int argc, char* argv[], Options* options) {
   return true;
 }
 
+// Profiles are kept between runs in files named after the device, the driver
+// version and the pipeline cache UUID, which drivers change whenever what
+// they report might.  Extensions and layers also depend on the layers
+// installed, so those are always queried afresh.
+std::string CacheFilename(const Options& options,
+                          const VkPhysicalDeviceProperties& props) {
+  char name[128];
+  int len = snprintf(name, sizeof(name), "/%04x_%04x_%08x_", props.vendorID,
+                     props.deviceID, props.driverVersion);
+  for (uint32_t i = 0; i < VK_UUID_SIZE; ++i)
+    len += snprintf(name + len, sizeof(name) - len, "%02x",
+                    props.pipelineCacheUUID[i]);
+  snprintf(name + len, sizeof(name) - len, ".vkjsonb");
+  return options.cache_dir + name;
+}
+
+bool ReadCachedProperties(const std::string& filename,
+                          VkJsonAllProperties* props) {
+  FILE* file = fopen(filename.c_str(), "rb");
+  if (!file)
+    return false;
+  std::vector<uint8_t> data;
+  uint8_t buffer[4096];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    data.insert(data.end(), buffer, buffer + size);
+  fclose(file);
+  return VkJsonAllPropertiesFromBinary(data.data(), data.size(), props,
+                                       nullptr);
+}
+
+void WriteCachedProperties(const std::string& filename, uint32_t index,
+                           const VkJsonAllProperties& props) {
+  // written to a temporary, named for the process and device, and renamed so
+  // that no run sees a partial file
+  char suffix[64];
+#ifdef _WIN32
+  snprintf(suffix, sizeof(suffix), ".%d.%u.tmp", _getpid(), index);
+#else
+  snprintf(suffix, sizeof(suffix), ".%d.%u.tmp", static_cast<int>(getpid()),
+           index);
+#endif
+  std::string tmp_filename = filename + suffix;
+  std::vector<uint8_t> data = VkJsonAllPropertiesToBinary(props);
+  FILE* file = fopen(tmp_filename.c_str(), "wb");
+  if (!file)
+    return;
+  bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+  ok = fclose(file) == 0 && ok;
+  if (ok) {
+#ifdef _WIN32
+    ok = MoveFileExA(tmp_filename.c_str(), filename.c_str(),
+                     MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    ok = rename(tmp_filename.c_str(), filename.c_str()) == 0;
+#endif
+  }
+  if (!ok)
+    remove(tmp_filename.c_str());
+}
+
+VkJsonAllProperties ProbeDevice(VkPhysicalDevice physical_device,
+                                uint32_t index, const Options& options) {
+  if (options.cache_dir.empty())
+    return VkJsonGetAllProperties(physical_device);
+
+  VkPhysicalDeviceProperties props;
+  vkGetPhysicalDeviceProperties(physical_device, &props);
+  std::string filename = CacheFilename(options, props);
+
+  VkJsonAllProperties cached;
+  if (!ReadCachedProperties(filename, &cached) ||
+      cached.properties.vendorID != props.vendorID ||
+      cached.properties.deviceID != props.deviceID ||
+      cached.properties.driverVersion != props.driverVersion ||
+      memcmp(cached.properties.pipelineCacheUUID, props.pipelineCacheUUID,
+             VK_UUID_SIZE)) {
+    cached = VkJsonGetAllProperties(physical_device);
+    WriteCachedProperties(filename, index, cached);
+    return cached;
+  }
+  cached.properties = props;
+
+  uint32_t extension_count = 0;
+  vkEnumerateDeviceExtensionProperties(physical_device, nullptr,
+                                       &extension_count, nullptr);
+  cached.extensions.resize(extension_count);
+  if (extension_count > 0) {
+    vkEnumerateDeviceExtensionProperties(physical_device, nullptr,
+                                         &extension_count,
+                                         cached.extensions.data());
+  }
+
+  uint32_t layer_count = 0;
+  vkEnumerateDeviceLayerProperties(physical_device, &layer_count, nullptr);
+  cached.layers.resize(layer_count);
+  if (layer_count > 0) {
+    vkEnumerateDeviceLayerProperties(physical_device, &layer_count,
+                                     cached.layers.data());
+  }
+  return cached;
+}
+
+// Probes every device, each on its own thread with --parallel, before
+// anything is written, so the output is the same either way.
+std::vector<VkJsonAllProperties> ProbeDevices(
+    const std::vector<VkPhysicalDevice>& physical_devices,
+    const Options& options) {
+  std::vector<VkJsonAllProperties> props(physical_devices.size());
+  if (!options.parallel || physical_devices.size() < 2) {
+    for (size_t i = 0; i < physical_devices.size(); ++i)
+      props[i] = ProbeDevice(physical_devices[i], static_cast<uint32_t>(i),
+                             options);
+    return props;
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < physical_devices.size(); ++i) {
+    threads.emplace_back([&props, &physical_devices, &options, i]() {
+      props[i] = ProbeDevice(physical_devices[i], static_cast<uint32_t>(i),
+                             options);
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  return props;
+}
+
 bool DumpProperties(const VkJsonAllProperties& props, const Options& options) {
   std::string device_name(props.properties.deviceName);
   std::string output_file = options.output_file;
@@ -141,6 +286,14 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
+  if (!options.cache_dir.empty()) {
+#ifdef _WIN32
+    _mkdir(options.cache_dir.c_str());
+#else
+    mkdir(options.cache_dir.c_str(), 0755);
+#endif
+  }
+
   uint32_t device_count = 0;
   result = vkEnumeratePhysicalDevices(instance, &device_count, nullptr);
   if (result != VK_SUCCESS) {
@@ -170,15 +323,15 @@ int main(int argc, char* argv[]) {
                 << std::endl;
       return 1;
     }
-    auto props = VkJsonGetAllProperties(physical_devices[options.device_index]);
+    auto props = ProbeDevice(physical_devices[options.device_index],
+                             options.device_index, options);
     if (!DumpProperties(props, options))
       return 1;
     return 0;
   }
 
   bool found = false;
-  for (auto physical_device : physical_devices) {
-    auto props = VkJsonGetAllProperties(physical_device);
+  for (auto& props : ProbeDevices(physical_devices, options)) {
     if (!options.device_name.empty() &&
         options.device_name != props.properties.deviceName)
       continue;
@@ -96,6 +96,76 @@ int main(int argc, char* argv[]) {
 
   EXPECT(!memcmp(&props, &props2, sizeof(props)));
 
+  // Members may come in any order, and unknown ones are skipped.
+  json = "{ \"maxResourceSize\": \"0x0000000000001000\", \"unknown\": "
+         "[{\"a\": [true, null, \"\\u00e9\"]}], \"sampleCounts\": 4, "
+         "\"maxArrayLayers\": 6, \"maxMipLevels\": 5, \"maxExtent\": "
+         "{\"depth\": 3, \"height\": 2, \"width\": 1}}";
+  result = VkJsonImageFormatPropertiesFromJson(json, &props2, &errors);
+  EXPECT(result);
+  EXPECT(props2.maxExtent.width == 1 && props2.maxExtent.height == 2 &&
+         props2.maxExtent.depth == 3);
+  EXPECT(props2.maxMipLevels == 5 && props2.maxArrayLayers == 6);
+  EXPECT(props2.sampleCounts == 4 && props2.maxResourceSize == 0x1000);
+
+  json = "{\"maxExtent\": {\"width\": 1, \"height\": 2, \"depth\": 3}}";
+  EXPECT(!VkJsonImageFormatPropertiesFromJson(json, &props2, &errors));
+  EXPECT(errors == "maxMipLevels missing.");
+  json = "{\"maxExtent\": {\"width\": 1, \"height\": 2}}";
+  EXPECT(!VkJsonImageFormatPropertiesFromJson(json, &props2, &errors));
+  EXPECT(errors == "Wrong type for maxExtent.");
+  json = "{\"maxExtent\": {\"width\": 1, \"height\" 2}}";
+  EXPECT(!VkJsonImageFormatPropertiesFromJson(json, &props2, &errors));
+  EXPECT(errors == "2}}");
+
+  // Binary profiles round trip, and are refused when damaged.
+  const char description[] = "Layer with \"quotes\",\ttabs and \xc3\xa9";
+  VkLayerProperties layer = {};
+  memcpy(layer.layerName, name, sizeof(name));
+  memcpy(layer.description, description, sizeof(description));
+  device_props.layers.push_back(layer);
+  device_props.properties.limits.minTexelOffset = -8;
+  device_props.properties.limits.maxInterpolationOffset = 0.4375f;
+
+  json = VkJsonAllPropertiesToJson(device_props);
+  result = VkJsonAllPropertiesFromJson(json, &device_props2, &errors);
+  EXPECT(result);
+  EXPECT(device_props2.layers.size() == 1 &&
+         !strcmp(device_props2.layers[0].description, description));
+
+  std::vector<uint8_t> binary = VkJsonAllPropertiesToBinary(device_props);
+  VkJsonAllProperties device_props3;
+  result = VkJsonAllPropertiesFromBinary(binary.data(), binary.size(),
+                                         &device_props3, &errors);
+  EXPECT(result);
+  if (!result)
+    std::cout << "Error: " << errors << std::endl;
+  EXPECT(!memcmp(&device_props.properties, &device_props3.properties,
+                 sizeof(device_props.properties)));
+  EXPECT(!memcmp(&device_props.memory, &device_props3.memory,
+                 sizeof(device_props.memory)));
+  EXPECT(device_props3.formats.size() == device_props.formats.size());
+  for (auto& kv : device_props.formats) {
+    auto it = device_props3.formats.find(kv.first);
+    EXPECT(it != device_props3.formats.end());
+    EXPECT(!memcmp(&kv.second, &it->second, sizeof(kv.second)));
+  }
+  EXPECT(device_props3.layers.size() == 1 &&
+         !strcmp(device_props3.layers[0].description, description));
+  EXPECT(VkJsonAllPropertiesToJson(device_props3) == json);
+
+  EXPECT(!VkJsonAllPropertiesFromBinary(binary.data(), binary.size() - 1,
+                                        &device_props3, &errors));
+  EXPECT(errors == "formats truncated.");
+  binary.push_back(0);
+  EXPECT(!VkJsonAllPropertiesFromBinary(binary.data(), binary.size(),
+                                        &device_props3, &errors));
+  EXPECT(errors == "Trailing data after profile.");
+  binary[4] = 99;
+  EXPECT(!VkJsonAllPropertiesFromBinary(binary.data(), binary.size(),
+                                        &device_props3, &errors));
+  EXPECT(errors == "Unsupported binary profile version 99.");
+
   if (g_failures) {
     std::cout << g_failures << " failures." << std::endl;
     return 1;
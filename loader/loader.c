@@ -65,12 +65,6 @@ THREAD_LOCAL_DECL struct loader_instance *tls_instance;
 
 static size_t loader_platform_combine_path(char *dest, size_t len, ...);
 
-struct loader_phys_dev_per_icd {
-    uint32_t count;
-    VkPhysicalDevice *phys_devs;
-    struct loader_icd *this_icd;
-};
-
 enum loader_debug {
     LOADER_INFO_BIT = 0x01,
     LOADER_WARN_BIT = 0x02,
@@ -87,6 +81,8 @@ uint32_t g_loader_log_msgs = 0;
 // additionally CreateDevice and DestroyDevice needs to be locked
 loader_platform_thread_mutex loader_lock;
 loader_platform_thread_mutex loader_json_lock;
+// protects loader.resident_libs, which ICD scans and layer activation share
+loader_platform_thread_mutex loader_lib_lock;
 
 const char *std_validation_str = "VK_LAYER_LUNARG_standard_validation";
 
@@ -170,8 +166,136 @@ const VkLayerInstanceDispatchTable instance_disp = {
 
 LOADER_PLATFORM_THREAD_ONCE_DECLARATION(once_init);
 
+/* Arena allocations are aligned for any loader structure */
+#define LOADER_ARENA_ALIGNMENT 16
+#define LOADER_ARENA_ALIGN(size)                                               \
+    (((size) + LOADER_ARENA_ALIGNMENT - 1) & ~(size_t)(LOADER_ARENA_ALIGNMENT - 1))
+#define LOADER_ARENA_HEADER_SIZE                                               \
+    LOADER_ARENA_ALIGN(sizeof(struct loader_arena_block))
+// big enough for the bookkeeping of an instance with a few layers and ICDs
+#define LOADER_ARENA_BLOCK_SIZE (256 * 1024)
+
+static inline uint8_t *loader_arena_data(struct loader_arena_block *block) {
+    return (uint8_t *)block + LOADER_ARENA_HEADER_SIZE;
+}
+
+static struct loader_arena_block *
+loader_arena_owner(const struct loader_instance *inst, const void *pMemory) {
+    struct loader_arena_block *block;
+
+    for (block = inst->arena.blocks; block; block = block->next) {
+        const uint8_t *data = loader_arena_data(block);
+        if ((const uint8_t *)pMemory >= data &&
+            (const uint8_t *)pMemory < data + block->size)
+            return block;
+    }
+    return NULL;
+}
+
+static void *loader_arena_alloc(struct loader_instance *inst, size_t size) {
+    struct loader_instance_arena *arena = &inst->arena;
+    struct loader_arena_block *block = arena->blocks;
+    size_t offset;
+    void *pMemory;
+
+    size = LOADER_ARENA_ALIGN(size ? size : 1);
+    if (!block || block->size - block->used < size) {
+        // large allocations get a block of their own, so that the current
+        // block keeps serving the small ones
+        bool dedicated = size > LOADER_ARENA_BLOCK_SIZE / 4;
+        size_t block_size = dedicated ? size : LOADER_ARENA_BLOCK_SIZE;
+
+        if (arena->alloc_callbacks.pfnAllocation)
+            block = arena->alloc_callbacks.pfnAllocation(
+                arena->alloc_callbacks.pUserData,
+                LOADER_ARENA_HEADER_SIZE + block_size, LOADER_ARENA_ALIGNMENT,
+                VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+        else
+            block = malloc(LOADER_ARENA_HEADER_SIZE + block_size);
+        if (!block)
+            return NULL;
+
+        block->size = block_size;
+        block->used = 0;
+        block->last = 0;
+        if (dedicated && arena->blocks) {
+            block->next = arena->blocks->next;
+            arena->blocks->next = block;
+        } else {
+            block->next = arena->blocks;
+            arena->blocks = block;
+        }
+        arena->block_count++;
+    }
+
+    offset = block->used;
+    block->last = offset;
+    block->used += size;
+    arena->alloc_count++;
+    arena->alloc_bytes += size;
+
+    pMemory = loader_arena_data(block) + offset;
+    return pMemory;
+}
+
+/**
+ * Start serving the instance-scope allocations made for inst from its
+ * arena.  Called before anything is allocated for a new instance.
+ */
+void loader_arena_open(struct loader_instance *inst,
+                       const VkAllocationCallbacks *pAllocator) {
+    memset(&inst->arena, 0, sizeof(inst->arena));
+    if (pAllocator)
+        inst->arena.alloc_callbacks = *pAllocator;
+    inst->arena.open = true;
+}
+
+/**
+ * Stop adding to the arena once the instance is created.  What the loader
+ * allocates for it later, per device or per call, goes to the heap again
+ * so that the arena does not grow for the life of the instance.
+ */
+void loader_arena_close(struct loader_instance *inst) {
+    struct loader_instance_arena *arena = &inst->arena;
+    size_t used = 0;
+
+    for (struct loader_arena_block *block = arena->blocks; block;
+         block = block->next)
+        used += block->used;
+
+    arena->open = false;
+    loader_log(inst, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, 0,
+               "Instance bookkeeping: %u allocations, %lu bytes allocated, "
+               "%lu bytes in use, %u arena blocks",
+               arena->alloc_count, (unsigned long)arena->alloc_bytes,
+               (unsigned long)used, arena->block_count);
+}
+
+/**
+ * Free every block of the arena at once, when the instance is destroyed.
+ */
+void loader_arena_release(struct loader_instance *inst) {
+    struct loader_instance_arena *arena = &inst->arena;
+    struct loader_arena_block *block, *next;
+
+    for (block = arena->blocks; block; block = next) {
+        next = block->next;
+        if (arena->alloc_callbacks.pfnFree)
+            arena->alloc_callbacks.pfnFree(arena->alloc_callbacks.pUserData,
+                                           block);
+        else
+            free(block);
+    }
+    arena->blocks = NULL;
+    arena->open = false;
+}
+
 void *loader_heap_alloc(const struct loader_instance *instance, size_t size,
                         VkSystemAllocationScope alloc_scope) {
+    if (instance && instance->arena.open &&
+        alloc_scope == VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE) {
+        return loader_arena_alloc((struct loader_instance *)instance, size);
+    }
     if (instance && instance->alloc_callbacks.pfnAllocation) {
         /* TODO: What should default alignment be? 1, 4, 8, other? */
         return instance->alloc_callbacks.pfnAllocation(
@@ -182,8 +306,18 @@ void *loader_heap_alloc(const struct loader_instance *instance, size_t size,
 }
 
 void loader_heap_free(const struct loader_instance *instance, void *pMemory) {
+    struct loader_arena_block *block;
+
     if (pMemory == NULL)
         return;
+    if (instance && instance->arena.blocks &&
+        (block = loader_arena_owner(instance, pMemory))) {
+        // only the most recent allocation can be given back
+        if ((uint8_t *)pMemory == loader_arena_data(block) + block->last) {
+            block->used = block->last;
+        }
+        return;
+    }
     if (instance && instance->alloc_callbacks.pfnFree) {
         instance->alloc_callbacks.pfnFree(instance->alloc_callbacks.pUserData,
                                           pMemory);
@@ -195,12 +329,33 @@ void loader_heap_free(const struct loader_instance *instance, void *pMemory) {
 void *loader_heap_realloc(const struct loader_instance *instance, void *pMemory,
                           size_t orig_size, size_t size,
                           VkSystemAllocationScope alloc_scope) {
+    struct loader_arena_block *block;
+
     if (pMemory == NULL || orig_size == 0)
         return loader_heap_alloc(instance, size, alloc_scope);
     if (size == 0) {
         loader_heap_free(instance, pMemory);
         return NULL;
     }
+    if (instance && instance->arena.blocks &&
+        (block = loader_arena_owner(instance, pMemory))) {
+        size_t offset = (uint8_t *)pMemory - loader_arena_data(block);
+        if (size <= orig_size) {
+            memset(((uint8_t *)pMemory) + size, 0, orig_size - size);
+            return pMemory;
+        }
+        // the most recent allocation grows in place if the block has room
+        if (instance->arena.open && offset == block->last &&
+            LOADER_ARENA_ALIGN(size) <= block->size - offset) {
+            block->used = offset + LOADER_ARENA_ALIGN(size);
+            return pMemory;
+        }
+        void *new_ptr = loader_heap_alloc(instance, size, alloc_scope);
+        if (!new_ptr)
+            return NULL;
+        memcpy(new_ptr, pMemory, orig_size);
+        return new_ptr;
+    }
     // TODO use the callback realloc function
     if (instance && instance->alloc_callbacks.pfnAllocation) {
         if (size <= orig_size) {
@@ -523,6 +678,9 @@ void loader_delete_layer_properties(const struct loader_instance *inst,
     if (!layer_list)
         return;
 
+    /* Entries filled while the instance was created live in its arena, where
+     * freeing is a no-op, but lists grown after loader_arena_close came from
+     * the heap, so every entry is walked */
     for (i = 0; i < layer_list->count; i++) {
         loader_destroy_generic_list(
             inst, (struct loader_generic_list *)&layer_list->list[i]
@@ -1220,12 +1378,111 @@ loader_icd_add(struct loader_instance *ptr_inst,
     return icd;
 }
 
+/**
+ * Take a reference on the named library, opening it unless an earlier
+ * instance already did.  Entries are allocated without the instance's
+ * allocator since they outlive it.  A library that fails to open is
+ * logged with open_error_flag.
+ */
+static struct loader_resident_lib *
+loader_lib_acquire(const struct loader_instance *inst, const char *lib_name,
+                   VkFlags open_error_flag) {
+    struct loader_resident_lib *lib;
+
+    loader_platform_thread_lock_mutex(&loader_lib_lock);
+    for (lib = loader.resident_libs; lib; lib = lib->next) {
+        if (strcmp(lib->lib_name, lib_name) == 0) {
+            lib->ref_count++;
+            loader_platform_thread_unlock_mutex(&loader_lib_lock);
+            loader_log(inst, VK_DEBUG_REPORT_DEBUG_BIT_EXT, 0,
+                       "Reusing resident library %s (reference count %d)",
+                       lib_name, lib->ref_count);
+            return lib;
+        }
+    }
+
+    lib = loader_heap_alloc(NULL, sizeof(struct loader_resident_lib),
+                            VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+    if (!lib) {
+        loader_platform_thread_unlock_mutex(&loader_lib_lock);
+        loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
+                   "Out of memory can't add library %s", lib_name);
+        return NULL;
+    }
+    memset(lib, 0, sizeof(*lib));
+    strncpy(lib->lib_name, lib_name, sizeof(lib->lib_name));
+    lib->lib_name[sizeof(lib->lib_name) - 1] = '\0';
+
+    // Used to call: dlopen(filename, RTLD_LAZY);
+    lib->lib_handle = loader_platform_open_library(lib->lib_name);
+    if (!lib->lib_handle) {
+        loader_platform_thread_unlock_mutex(&loader_lib_lock);
+        loader_log(inst, open_error_flag, 0,
+                   loader_platform_open_library_error(lib_name));
+        loader_heap_free(NULL, lib);
+        return NULL;
+    }
+    lib->ref_count = 1;
+    lib->next = loader.resident_libs;
+    loader.resident_libs = lib;
+    loader_platform_thread_unlock_mutex(&loader_lib_lock);
+
+    loader_log(inst, VK_DEBUG_REPORT_DEBUG_BIT_EXT, 0, "Loaded library %s",
+               lib_name);
+    return lib;
+}
+
+/**
+ * Drop a reference taken by loader_lib_acquire.  The library stays open
+ * until loader_lib_sweep finds it unused.
+ */
+static void loader_lib_release(const struct loader_instance *inst,
+                               struct loader_resident_lib *lib) {
+    loader_platform_thread_lock_mutex(&loader_lib_lock);
+    if (lib->ref_count == 0) {
+        loader_platform_thread_unlock_mutex(&loader_lib_lock);
+        loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
+                   "Unable to unref library %s", lib->lib_name);
+        return;
+    }
+    lib->ref_count--;
+    loader_platform_thread_unlock_mutex(&loader_lib_lock);
+}
+
+/**
+ * Close the libraries nothing references any more.  Called once an instance
+ * has been created, so a library is unloaded only when a newer instance
+ * did not need it, unless VK_LOADER_KEEP_LIBRARIES keeps every library
+ * resident for the life of the process.
+ */
+void loader_lib_sweep(const struct loader_instance *inst) {
+    struct loader_resident_lib **link, *lib;
+
+    if (loader.keep_libs)
+        return;
+
+    loader_platform_thread_lock_mutex(&loader_lib_lock);
+    link = &loader.resident_libs;
+    while ((lib = *link) != NULL) {
+        if (lib->ref_count > 0) {
+            link = &lib->next;
+            continue;
+        }
+        *link = lib->next;
+        loader_log(inst, VK_DEBUG_REPORT_DEBUG_BIT_EXT, 0,
+                   "Unloading library %s", lib->lib_name);
+        loader_platform_close_library(lib->lib_handle);
+        loader_heap_free(NULL, lib);
+    }
+    loader_platform_thread_unlock_mutex(&loader_lib_lock);
+}
+
 void loader_scanned_icd_clear(const struct loader_instance *inst,
                               struct loader_icd_libs *icd_libs) {
     if (icd_libs->capacity == 0)
         return;
     for (uint32_t i = 0; i < icd_libs->count; i++) {
-        loader_platform_close_library(icd_libs->list[i].handle);
+        loader_lib_release(inst, icd_libs->list[i].lib);
         loader_heap_free(inst, icd_libs->list[i].lib_name);
     }
     loader_heap_free(inst, icd_libs->list);
@@ -1242,57 +1499,48 @@ static void loader_scanned_icd_init(const struct loader_instance *inst,
                                        VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
 }
 
-static void loader_scanned_icd_add(const struct loader_instance *inst,
-                                   struct loader_icd_libs *icd_libs,
-                                   const char *filename, uint32_t api_version) {
-    loader_platform_dl_handle handle;
+/**
+ * Look up the entry points the loader calls on an ICD before any instance
+ * exists, and keep them with the resident library for later scans.
+ */
+static bool loader_scanned_icd_resolve(const struct loader_instance *inst,
+                                       struct loader_resident_lib *lib) {
     PFN_vkCreateInstance fp_create_inst;
     PFN_vkEnumerateInstanceExtensionProperties fp_get_inst_ext_props;
     PFN_vkGetInstanceProcAddr fp_get_proc_addr;
-    struct loader_scanned_icds *new_node;
-
-    /* TODO implement ref counting of libraries, for now this function leaves
-       libraries open and the scanned_icd_clear closes them */
-    // Used to call: dlopen(filename, RTLD_LAZY);
-    handle = loader_platform_open_library(filename);
-    if (!handle) {
-        loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
-                   loader_platform_open_library_error(filename));
-        return;
-    }
 
-    fp_get_proc_addr =
-        loader_platform_get_proc_address(handle, "vk_icdGetInstanceProcAddr");
+    fp_get_proc_addr = loader_platform_get_proc_address(
+        lib->lib_handle, "vk_icdGetInstanceProcAddr");
     if (!fp_get_proc_addr) {
         // Use deprecated interface
-        fp_get_proc_addr =
-            loader_platform_get_proc_address(handle, "vkGetInstanceProcAddr");
+        fp_get_proc_addr = loader_platform_get_proc_address(
+            lib->lib_handle, "vkGetInstanceProcAddr");
         if (!fp_get_proc_addr) {
             loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
                        loader_platform_get_proc_address_error(
                            "vk_icdGetInstanceProcAddr"));
-            return;
+            return false;
         } else {
             loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
                        "Using deprecated ICD interface of "
                        "vkGetInstanceProcAddr instead of "
                        "vk_icdGetInstanceProcAddr");
         }
-        fp_create_inst =
-            loader_platform_get_proc_address(handle, "vkCreateInstance");
+        fp_create_inst = loader_platform_get_proc_address(lib->lib_handle,
+                                                          "vkCreateInstance");
         if (!fp_create_inst) {
             loader_log(
                 inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
                 "Couldn't get vkCreateInstance via dlsym/loadlibrary from ICD");
-            return;
+            return false;
         }
         fp_get_inst_ext_props = loader_platform_get_proc_address(
-            handle, "vkEnumerateInstanceExtensionProperties");
+            lib->lib_handle, "vkEnumerateInstanceExtensionProperties");
         if (!fp_get_inst_ext_props) {
             loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
                        "Couldn't get vkEnumerateInstanceExtensionProperties "
                        "via dlsym/loadlibrary from ICD");
-            return;
+            return false;
         }
     } else {
         // Use newer interface
@@ -1302,7 +1550,7 @@ static void loader_scanned_icd_add(const struct loader_instance *inst,
             loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
                        "Couldn't get vkCreateInstance via "
                        "vk_icdGetInstanceProcAddr from ICD");
-            return;
+            return false;
         }
         fp_get_inst_ext_props =
             (PFN_vkEnumerateInstanceExtensionProperties)fp_get_proc_addr(
@@ -1311,10 +1559,35 @@ static void loader_scanned_icd_add(const struct loader_instance *inst,
             loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
                        "Couldn't get vkEnumerateInstanceExtensionProperties "
                        "via vk_icdGetInstanceProcAddr from ICD");
-            return;
+            return false;
         }
     }
 
+    lib->GetInstanceProcAddr = fp_get_proc_addr;
+    lib->CreateInstance = fp_create_inst;
+    lib->EnumerateInstanceExtensionProperties = fp_get_inst_ext_props;
+    lib->icd_resolved = true;
+    return true;
+}
+
+static void loader_scanned_icd_add(const struct loader_instance *inst,
+                                   struct loader_icd_libs *icd_libs,
+                                   const char *filename, uint32_t api_version) {
+    struct loader_resident_lib *lib;
+    struct loader_scanned_icds *new_node;
+
+    lib = loader_lib_acquire(inst, filename,
+                             VK_DEBUG_REPORT_WARNING_BIT_EXT);
+    if (!lib)
+        return;
+
+    /* scans are serialized by loader_json_lock, so only one thread ever
+       resolves a library's entry points */
+    if (!lib->icd_resolved && !loader_scanned_icd_resolve(inst, lib)) {
+        loader_lib_release(inst, lib);
+        return;
+    }
+
     // check for enough capacity
     if ((icd_libs->count * sizeof(struct loader_scanned_icds)) >=
         icd_libs->capacity) {
@@ -1327,17 +1600,20 @@ static void loader_scanned_icd_add(const struct loader_instance *inst,
     }
     new_node = &(icd_libs->list[icd_libs->count]);
 
-    new_node->handle = handle;
+    new_node->lib = lib;
+    new_node->handle = lib->lib_handle;
     new_node->api_version = api_version;
-    new_node->GetInstanceProcAddr = fp_get_proc_addr;
-    new_node->EnumerateInstanceExtensionProperties = fp_get_inst_ext_props;
-    new_node->CreateInstance = fp_create_inst;
+    new_node->GetInstanceProcAddr = lib->GetInstanceProcAddr;
+    new_node->EnumerateInstanceExtensionProperties =
+        lib->EnumerateInstanceExtensionProperties;
+    new_node->CreateInstance = lib->CreateInstance;
 
     new_node->lib_name = (char *)loader_heap_alloc(
         inst, strlen(filename) + 1, VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
     if (!new_node->lib_name) {
         loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
                    "Out of memory can't add icd");
+        loader_lib_release(inst, lib);
         return;
     }
     strcpy(new_node->lib_name, filename);
@@ -1447,13 +1723,20 @@ static void loader_debug_init(void) {
 }
 
 void loader_initialize(void) {
+    char *keep_libs;
+
     // initialize mutexs
     loader_platform_thread_create_mutex(&loader_lock);
     loader_platform_thread_create_mutex(&loader_json_lock);
+    loader_platform_thread_create_mutex(&loader_lib_lock);
 
     // initialize logging
     loader_debug_init();
 
+    keep_libs = loader_getenv("VK_LOADER_KEEP_LIBRARIES");
+    loader.keep_libs = keep_libs && strcmp(keep_libs, "0") != 0;
+    loader_free_getenv(keep_libs);
+
     // initial cJSON to use alloc callbacks
     cJSON_Hooks alloc_fns = {
         .malloc_fn = loader_tls_heap_alloc, .free_fn = loader_tls_heap_free,
@@ -2902,130 +3185,38 @@ struct loader_instance *loader_get_instance(const VkInstance instance) {
 static loader_platform_dl_handle
 loader_add_layer_lib(const struct loader_instance *inst, const char *chain_type,
                      struct loader_layer_properties *layer_prop) {
-    struct loader_lib_info *new_layer_lib_list, *my_lib;
-    size_t new_alloc_size;
-    /*
-     * TODO: We can now track this information in the
-     * scanned_layer_libraries list.
-     */
-    for (uint32_t i = 0; i < loader.loaded_layer_lib_count; i++) {
-        if (strcmp(loader.loaded_layer_lib_list[i].lib_name,
-                   layer_prop->lib_name) == 0) {
-            /* Have already loaded this library, just increment ref count */
-            loader.loaded_layer_lib_list[i].ref_count++;
-            loader_log(inst, VK_DEBUG_REPORT_DEBUG_BIT_EXT, 0,
-                       "%s Chain: Increment layer reference count for layer "
-                       "library %s",
-                       chain_type, layer_prop->lib_name);
-            return loader.loaded_layer_lib_list[i].lib_handle;
-        }
-    }
-
-    /* Haven't seen this library so load it */
-    new_alloc_size = 0;
-    if (loader.loaded_layer_lib_capacity == 0)
-        new_alloc_size = 8 * sizeof(struct loader_lib_info);
-    else if (loader.loaded_layer_lib_capacity <=
-             loader.loaded_layer_lib_count * sizeof(struct loader_lib_info))
-        new_alloc_size = loader.loaded_layer_lib_capacity * 2;
+    struct loader_resident_lib *lib;
 
-    if (new_alloc_size) {
-        new_layer_lib_list = loader_heap_realloc(
-            inst, loader.loaded_layer_lib_list,
-            loader.loaded_layer_lib_capacity, new_alloc_size,
-            VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
-        if (!new_layer_lib_list) {
-            loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
-                       "loader: realloc failed in loader_add_layer_lib");
-            return NULL;
-        }
-        loader.loaded_layer_lib_capacity = new_alloc_size;
-        loader.loaded_layer_lib_list = new_layer_lib_list;
-    } else
-        new_layer_lib_list = loader.loaded_layer_lib_list;
-    my_lib = &new_layer_lib_list[loader.loaded_layer_lib_count];
-
-    strncpy(my_lib->lib_name, layer_prop->lib_name, sizeof(my_lib->lib_name));
-    my_lib->lib_name[sizeof(my_lib->lib_name) - 1] = '\0';
-    my_lib->ref_count = 0;
-    my_lib->lib_handle = NULL;
-
-    if ((my_lib->lib_handle = loader_platform_open_library(my_lib->lib_name)) ==
-        NULL) {
-        loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
-                   loader_platform_open_library_error(my_lib->lib_name));
+    // the application or environment asked for this layer
+    lib = loader_lib_acquire(inst, layer_prop->lib_name,
+                             VK_DEBUG_REPORT_ERROR_BIT_EXT);
+    if (!lib)
         return NULL;
-    } else {
-        loader_log(inst, VK_DEBUG_REPORT_DEBUG_BIT_EXT, 0,
-                   "Chain: %s: Loading layer library %s", chain_type,
-                   layer_prop->lib_name);
-    }
-    loader.loaded_layer_lib_count++;
-    my_lib->ref_count++;
 
-    return my_lib->lib_handle;
+    loader_log(inst, VK_DEBUG_REPORT_DEBUG_BIT_EXT, 0,
+               "Chain: %s: Using layer library %s", chain_type,
+               layer_prop->lib_name);
+    return lib->lib_handle;
 }
 
 static void
 loader_remove_layer_lib(struct loader_instance *inst,
                         struct loader_layer_properties *layer_prop) {
-    uint32_t idx = loader.loaded_layer_lib_count;
-    struct loader_lib_info *new_layer_lib_list, *my_lib = NULL;
-
-    for (uint32_t i = 0; i < loader.loaded_layer_lib_count; i++) {
-        if (strcmp(loader.loaded_layer_lib_list[i].lib_name,
-                   layer_prop->lib_name) == 0) {
-            /* found matching library */
-            idx = i;
-            my_lib = &loader.loaded_layer_lib_list[i];
+    struct loader_resident_lib *lib;
+
+    loader_platform_thread_lock_mutex(&loader_lib_lock);
+    for (lib = loader.resident_libs; lib; lib = lib->next) {
+        if (strcmp(lib->lib_name, layer_prop->lib_name) == 0)
             break;
-        }
     }
+    loader_platform_thread_unlock_mutex(&loader_lib_lock);
 
-    if (idx == loader.loaded_layer_lib_count) {
+    if (!lib) {
         loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
                    "Unable to unref library %s", layer_prop->lib_name);
         return;
     }
-
-    if (my_lib) {
-        my_lib->ref_count--;
-        if (my_lib->ref_count > 0) {
-            loader_log(inst, VK_DEBUG_REPORT_DEBUG_BIT_EXT, 0,
-                       "Decrement reference count for layer library %s",
-                       layer_prop->lib_name);
-            return;
-        }
-    }
-    loader_platform_close_library(my_lib->lib_handle);
-    loader_log(inst, VK_DEBUG_REPORT_DEBUG_BIT_EXT, 0,
-               "Unloading layer library %s", layer_prop->lib_name);
-
-    /* Need to remove unused library from list */
-    new_layer_lib_list =
-        loader_heap_alloc(inst, loader.loaded_layer_lib_capacity,
-                          VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
-    if (!new_layer_lib_list) {
-        loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
-                   "loader: heap alloc failed loader_remove_layer_library");
-        return;
-    }
-
-    if (idx > 0) {
-        /* Copy records before idx */
-        memcpy(new_layer_lib_list, &loader.loaded_layer_lib_list[0],
-               sizeof(struct loader_lib_info) * idx);
-    }
-    if (idx < (loader.loaded_layer_lib_count - 1)) {
-        /* Copy records after idx */
-        memcpy(&new_layer_lib_list[idx], &loader.loaded_layer_lib_list[idx + 1],
-               sizeof(struct loader_lib_info) *
-                   (loader.loaded_layer_lib_count - idx - 1));
-    }
-
-    loader_heap_free(inst, loader.loaded_layer_lib_list);
-    loader.loaded_layer_lib_count--;
-    loader.loaded_layer_lib_list = new_layer_lib_list;
+    loader_lib_release(inst, lib);
 }
 
 /**
@@ -3865,102 +4056,124 @@ terminator_CreateDevice(VkPhysicalDevice physicalDevice,
     return res;
 }
 
-VKAPI_ATTR VkResult VKAPI_CALL
-terminator_EnumeratePhysicalDevices(VkInstance instance,
-                                    uint32_t *pPhysicalDeviceCount,
-                                    VkPhysicalDevice *pPhysicalDevices) {
-    uint32_t i;
-    struct loader_instance *inst = (struct loader_instance *)instance;
-    VkResult res = VK_SUCCESS;
-
+/**
+ * Make sure inst->phys_devs_term holds the physical devices of every ICD.
+ * Only their counts are queried when the list already exists; it is rebuilt
+ * if any of them changed.
+ */
+static VkResult loader_update_phys_devs_term(struct loader_instance *inst) {
     struct loader_icd *icd;
-    struct loader_phys_dev_per_icd *phys_devs;
+    struct loader_physical_device *new_phys_devs_term;
+    VkPhysicalDevice **icd_phys_devs;
+    uint32_t *icd_counts;
+    uint32_t i, j, idx, total = 0;
+    bool changed = (inst->phys_devs_term == NULL);
+    VkResult res;
 
-    inst->total_gpu_count = 0;
-    phys_devs = (struct loader_phys_dev_per_icd *)loader_stack_alloc(
-        sizeof(struct loader_phys_dev_per_icd) * inst->total_icd_count);
-    if (!phys_devs)
+    icd_counts = loader_stack_alloc(sizeof(uint32_t) * inst->total_icd_count);
+    icd_phys_devs = loader_stack_alloc(sizeof(VkPhysicalDevice *) *
+                                       inst->total_icd_count);
+    if (!icd_counts || !icd_phys_devs)
         return VK_ERROR_OUT_OF_HOST_MEMORY;
 
     icd = inst->icds;
     for (i = 0; i < inst->total_icd_count; i++) {
         assert(icd);
-        res = icd->EnumeratePhysicalDevices(icd->instance, &phys_devs[i].count,
+        res = icd->EnumeratePhysicalDevices(icd->instance, &icd_counts[i],
                                             NULL);
         if (res != VK_SUCCESS)
             return res;
+        if (icd_counts[i] != icd->phys_dev_count)
+            changed = true;
+        total += icd_counts[i];
         icd = icd->next;
     }
 
+    if (!changed)
+        return VK_SUCCESS;
+
+    memset(icd_phys_devs, 0, sizeof(VkPhysicalDevice *) * inst->total_icd_count);
+    new_phys_devs_term = loader_heap_alloc(
+        inst, sizeof(struct loader_physical_device) * (total ? total : 1),
+        VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+    if (!new_phys_devs_term)
+        return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+    res = VK_SUCCESS;
     icd = inst->icds;
-    for (i = 0; i < inst->total_icd_count; i++) {
-        assert(icd);
-        phys_devs[i].phys_devs = (VkPhysicalDevice *)loader_stack_alloc(
-            phys_devs[i].count * sizeof(VkPhysicalDevice));
-        if (!phys_devs[i].phys_devs) {
-            return VK_ERROR_OUT_OF_HOST_MEMORY;
-        }
-        res = icd->EnumeratePhysicalDevices(
-            icd->instance, &(phys_devs[i].count), phys_devs[i].phys_devs);
-        if ((res == VK_SUCCESS)) {
-            inst->total_gpu_count += phys_devs[i].count;
-        } else {
-            return res;
-        }
-        phys_devs[i].this_icd = icd;
+    for (i = 0; i < inst->total_icd_count && res == VK_SUCCESS; i++) {
+        icd_phys_devs[i] = loader_heap_alloc(
+            inst, sizeof(VkPhysicalDevice) * (icd_counts[i] ? icd_counts[i] : 1),
+            VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+        if (!icd_phys_devs[i])
+            res = VK_ERROR_OUT_OF_HOST_MEMORY;
+        else
+            res = icd->EnumeratePhysicalDevices(icd->instance, &icd_counts[i],
+                                                icd_phys_devs[i]);
         icd = icd->next;
     }
-
-    *pPhysicalDeviceCount = inst->total_gpu_count;
-    if (!pPhysicalDevices) {
+    if (res != VK_SUCCESS) {
+        for (i = 0; i < inst->total_icd_count; i++)
+            loader_heap_free(inst, icd_phys_devs[i]);
+        loader_heap_free(inst, new_phys_devs_term);
         return res;
     }
 
-    /* Initialize the output pPhysicalDevices  with wrapped loader terminator
-     * physicalDevice objects; save this list of wrapped objects in instance
-     * struct for later cleanup and use by trampoline code */
-    uint32_t j, idx = 0;
-    uint32_t copy_count = 0;
-
-    copy_count = (inst->total_gpu_count < *pPhysicalDeviceCount)
-                     ? inst->total_gpu_count
-                     : *pPhysicalDeviceCount;
+    /* Nothing can fail from here on; swap in the new lists.  Handles from
+     * before the change are no longer valid. */
+    idx = 0;
+    icd = inst->icds;
+    for (i = 0; i < inst->total_icd_count; i++) {
+        for (j = 0; j < icd_counts[i]; j++) {
+            loader_set_dispatch((void *)&new_phys_devs_term[idx], inst->disp);
+            new_phys_devs_term[idx].this_icd = icd;
+            new_phys_devs_term[idx].phys_dev = icd_phys_devs[i][j];
+            idx++;
+        }
+        if (icd->phys_devs != NULL)
+            loader_heap_free(inst, icd->phys_devs);
+        icd->phys_devs = icd_phys_devs[i];
+        icd->phys_dev_count = icd_counts[i];
+        icd = icd->next;
+    }
 
-    // phys_devs_term is used to pass the "this_icd" info to trampoline code
     if (inst->phys_devs_term)
         loader_heap_free(inst, inst->phys_devs_term);
-    inst->phys_devs_term = loader_heap_alloc(
-        inst, sizeof(struct loader_physical_device) * copy_count,
-        VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
-    if (!inst->phys_devs_term)
-        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    inst->phys_devs_term = new_phys_devs_term;
+    inst->total_gpu_count = idx;
 
-    for (i = 0; idx < copy_count && i < inst->total_icd_count; i++) {
-        icd = phys_devs[i].this_icd;
-        if (icd->phys_devs != NULL) {
-            loader_heap_free(inst, icd->phys_devs);
-        }
-        icd->phys_devs = loader_heap_alloc(inst,
-                              sizeof(VkPhysicalDevice) * phys_devs[i].count,
-                              VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+    return VK_SUCCESS;
+}
 
-        for (j = 0; j < phys_devs[i].count && idx < copy_count; j++) {
-            loader_set_dispatch((void *)&inst->phys_devs_term[idx], inst->disp);
-            inst->phys_devs_term[idx].this_icd = phys_devs[i].this_icd;
-            inst->phys_devs_term[idx].phys_dev = phys_devs[i].phys_devs[j];
-            icd->phys_devs[j] = phys_devs[i].phys_devs[j];
-            pPhysicalDevices[idx] =
-                (VkPhysicalDevice)&inst->phys_devs_term[idx];
-            idx++;
-        }
+VKAPI_ATTR VkResult VKAPI_CALL
+terminator_EnumeratePhysicalDevices(VkInstance instance,
+                                    uint32_t *pPhysicalDeviceCount,
+                                    VkPhysicalDevice *pPhysicalDevices) {
+    uint32_t i, copy_count;
+    struct loader_instance *inst = (struct loader_instance *)instance;
+    VkResult res;
+
+    res = loader_update_phys_devs_term(inst);
+    if (res != VK_SUCCESS)
+        return res;
+
+    if (!pPhysicalDevices) {
+        *pPhysicalDeviceCount = inst->total_gpu_count;
+        return VK_SUCCESS;
     }
+
+    /* Return the wrapped loader terminator physicalDevice objects;
+     * phys_devs_term passes the "this_icd" info to trampoline code */
+    copy_count = (inst->total_gpu_count < *pPhysicalDeviceCount)
+                     ? inst->total_gpu_count
+                     : *pPhysicalDeviceCount;
+    for (i = 0; i < copy_count; i++)
+        pPhysicalDevices[i] = (VkPhysicalDevice)&inst->phys_devs_term[i];
     *pPhysicalDeviceCount = copy_count;
 
-    if (copy_count < inst->total_gpu_count) {
-        inst->total_gpu_count = copy_count;
+    if (copy_count < inst->total_gpu_count)
         return VK_INCOMPLETE;
-    }
-    return res;
+    return VK_SUCCESS;
 }
 
 VKAPI_ATTR void VKAPI_CALL terminator_GetPhysicalDeviceProperties(
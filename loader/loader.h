@@ -126,6 +126,23 @@ struct loader_lib_info {
     loader_platform_dl_handle lib_handle;
 };
 
+/* An ICD or layer library opened by the loader.  Libraries stay resident
+   after their last instance or device lets go of them, so that the next
+   instance reuses the handle and the ICD entry points already resolved
+   from it, and are only closed by loader_lib_sweep. */
+struct loader_resident_lib {
+    struct loader_resident_lib *next;
+    char lib_name[MAX_STRING_SIZE];
+    uint32_t ref_count;
+    loader_platform_dl_handle lib_handle;
+    // set once the ICD entry points below have been looked up
+    bool icd_resolved;
+    PFN_vkGetInstanceProcAddr GetInstanceProcAddr;
+    PFN_vkCreateInstance CreateInstance;
+    PFN_vkEnumerateInstanceExtensionProperties
+        EnumerateInstanceExtensionProperties;
+};
+
 struct loader_layer_functions {
     char str_gipa[MAX_STRING_SIZE];
     char str_gdpa[MAX_STRING_SIZE];
@@ -201,6 +218,7 @@ struct loader_icd {
     const struct loader_scanned_icds *this_icd_lib;
     const struct loader_instance *this_instance;
     VkPhysicalDevice *phys_devs;  // physicalDevice object from icd
+    uint32_t phys_dev_count;      // count of phys_devs
     struct loader_device *logical_device_list;
     VkInstance instance; // instance object from the icd
     PFN_vkGetDeviceProcAddr GetDeviceProcAddr;
@@ -271,12 +289,40 @@ struct loader_icd_libs {
     struct loader_scanned_icds *list;
 };
 
+/* A bump allocator for the loader's own bookkeeping of an instance.  While
+ * the instance is being created, its instance-scope allocations are carved
+ * out of a few large blocks instead of being allocated one by one; freeing
+ * them is a no-op, except that the most recent allocation is given back.
+ * The blocks come from the pAllocator of vkCreateInstance, if any, and are
+ * all released at once when the instance is destroyed. */
+struct loader_arena_block {
+    struct loader_arena_block *next;
+    size_t size; // bytes available after the header
+    size_t used;
+    size_t last; // offset of the most recent allocation
+};
+
+struct loader_instance_arena {
+    struct loader_arena_block *blocks; // most recent first
+    bool open; // serving instance-scope allocations
+    VkAllocationCallbacks alloc_callbacks;
+
+    // statistics, logged when the instance is created
+    uint32_t alloc_count;
+    uint32_t block_count;
+    size_t alloc_bytes;
+};
+
 /* per instance structure */
 struct loader_instance {
     VkLayerInstanceDispatchTable *disp; // must be first entry in structure
 
-    uint32_t total_gpu_count; // count of the next two arrays
+    // Physical devices are enumerated from the ICDs once and kept until an
+    // ICD reports a different count, so the wrapped objects below, and the
+    // handles given to the application, stay valid across enumerations.
+    uint32_t total_gpu_count; // count of phys_devs_term
     struct loader_physical_device *phys_devs_term;
+    uint32_t phys_dev_count_tramp; // count of phys_devs
     struct loader_physical_device *phys_devs; // tramp wrapped physDev obj list
     uint32_t total_icd_count;
     struct loader_icd *icds;
@@ -297,6 +343,7 @@ struct loader_instance {
     VkLayerDbgFunctionNode *DbgFunctionHead;
 
     VkAllocationCallbacks alloc_callbacks;
+    struct loader_instance_arena arena;
 
     bool wsi_surface_enabled;
 #ifdef VK_USE_PLATFORM_WIN32_KHR
@@ -345,16 +392,17 @@ struct loader_physical_device {
 struct loader_struct {
     struct loader_instance *instances;
 
-    unsigned int loaded_layer_lib_count;
-    size_t loaded_layer_lib_capacity;
-    struct loader_lib_info *loaded_layer_lib_list;
-    // TODO add ref counting of ICD libraries
+    // ICD and layer libraries, shared by all instances and protected by
+    // loader_lib_lock
+    struct loader_resident_lib *resident_libs;
+    // VK_LOADER_KEEP_LIBRARIES: never close a library once opened
+    bool keep_libs;
     // TODO use this struct loader_layer_library_list scanned_layer_libraries;
-    // TODO add list of icd libraries for ref counting them for closure
 };
 
 struct loader_scanned_icds {
     char *lib_name;
+    struct loader_resident_lib *lib;
     loader_platform_dl_handle handle;
     uint32_t api_version;
     PFN_vkGetInstanceProcAddr GetInstanceProcAddr;
@@ -408,6 +456,7 @@ extern THREAD_LOCAL_DECL struct loader_instance *tls_instance;
 extern LOADER_PLATFORM_THREAD_ONCE_DEFINITION(once_init);
 extern loader_platform_thread_mutex loader_lock;
 extern loader_platform_thread_mutex loader_json_lock;
+extern loader_platform_thread_mutex loader_lib_lock;
 extern const VkLayerInstanceDispatchTable instance_disp;
 extern const char *std_validation_str;
 
@@ -422,6 +471,11 @@ void *loader_heap_alloc(const struct loader_instance *instance, size_t size,
 
 void loader_heap_free(const struct loader_instance *instance, void *pMemory);
 
+void loader_arena_open(struct loader_instance *inst,
+                       const VkAllocationCallbacks *pAllocator);
+void loader_arena_close(struct loader_instance *inst);
+void loader_arena_release(struct loader_instance *inst);
+
 void *loader_tls_heap_alloc(size_t size);
 
 void loader_tls_heap_free(void *pMemory);
@@ -485,6 +539,7 @@ void loader_add_to_layer_list(const struct loader_instance *inst,
                               struct loader_layer_list *list,
                               uint32_t prop_list_count,
                               const struct loader_layer_properties *props);
+void loader_lib_sweep(const struct loader_instance *inst);
 void loader_scanned_icd_clear(const struct loader_instance *inst,
                               struct loader_icd_libs *icd_libs);
 void loader_icd_scan(const struct loader_instance *inst,
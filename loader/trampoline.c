@@ -272,6 +272,10 @@ vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo,
     }
 #endif
 
+    /* What the loader keeps for the life of the instance is allocated from
+     * its arena while the instance is being created */
+    loader_arena_open(ptr_instance, pAllocator);
+
     /*
      * Look for a debug report create info structure
      * and setup a callback if found.
@@ -282,6 +286,7 @@ vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo,
             instance_callback = (VkDebugReportCallbackEXT)ptr_instance;
             if (util_CreateDebugReportCallback(ptr_instance, pNext, NULL,
                                                instance_callback)) {
+                loader_arena_release(ptr_instance);
                 loader_heap_free(ptr_instance, ptr_instance);
                 loader_platform_thread_unlock_mutex(&loader_lock);
                 return VK_ERROR_OUT_OF_HOST_MEMORY;
@@ -309,6 +314,7 @@ vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo,
         if (res != VK_SUCCESS) {
             util_DestroyDebugReportCallback(ptr_instance, instance_callback,
                                             NULL);
+            loader_arena_release(ptr_instance);
             loader_heap_free(ptr_instance, ptr_instance);
             loader_platform_thread_unlock_mutex(&loader_lock);
             return res;
@@ -356,6 +362,7 @@ vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo,
             (struct loader_generic_list *)&ptr_instance->ext_list);
         util_DestroyDebugReportCallback(ptr_instance, instance_callback, NULL);
         loader_platform_thread_unlock_mutex(&loader_lock);
+        loader_arena_release(ptr_instance);
         loader_heap_free(ptr_instance, ptr_instance);
         return res;
     }
@@ -377,6 +384,7 @@ vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo,
             (struct loader_generic_list *)&ptr_instance->ext_list);
         util_DestroyDebugReportCallback(ptr_instance, instance_callback, NULL);
         loader_platform_thread_unlock_mutex(&loader_lock);
+        loader_arena_release(ptr_instance);
         loader_heap_free(ptr_instance, ptr_instance);
         return VK_ERROR_OUT_OF_HOST_MEMORY;
     }
@@ -403,6 +411,7 @@ vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo,
         util_DestroyDebugReportCallback(ptr_instance, instance_callback, NULL);
         loader_platform_thread_unlock_mutex(&loader_lock);
         loader_heap_free(ptr_instance, ptr_instance->disp);
+        loader_arena_release(ptr_instance);
         loader_heap_free(ptr_instance, ptr_instance);
         return res;
     }
@@ -424,6 +433,10 @@ vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo,
          * if enabled.
          */
         loader_activate_instance_layer_extensions(ptr_instance, *pInstance);
+
+        /* Unload the libraries earlier instances left resident that this
+           one did not use */
+        loader_lib_sweep(ptr_instance);
     } else {
         // TODO: cleanup here.
     }
@@ -433,6 +446,7 @@ vkCreateInstance(const VkInstanceCreateInfo *pCreateInfo,
     loader_unexpand_inst_layer_names(ptr_instance, saved_layer_count,
                                      saved_layer_names, saved_layer_ptr,
                                      pCreateInfo);
+    loader_arena_close(ptr_instance);
     loader_platform_thread_unlock_mutex(&loader_lock);
     return res;
 }
@@ -455,6 +469,7 @@ vkDestroyInstance(VkInstance instance,
     if (ptr_instance->phys_devs)
         loader_heap_free(ptr_instance, ptr_instance->phys_devs);
     loader_heap_free(ptr_instance, ptr_instance->disp);
+    loader_arena_release(ptr_instance);
     loader_heap_free(ptr_instance, ptr_instance);
     loader_platform_thread_unlock_mutex(&loader_lock);
 }
@@ -488,23 +503,41 @@ vkEnumeratePhysicalDevices(VkInstance instance, uint32_t *pPhysicalDeviceCount,
         loader_platform_thread_unlock_mutex(&loader_lock);
         return VK_ERROR_INITIALIZATION_FAILED;
     }
-    if (inst->phys_devs)
-        loader_heap_free(inst, inst->phys_devs);
-    count = inst->total_gpu_count;
-    inst->phys_devs = (struct loader_physical_device *)loader_heap_alloc(
-        inst, count * sizeof(struct loader_physical_device),
-        VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
-    if (!inst->phys_devs) {
-        loader_platform_thread_unlock_mutex(&loader_lock);
-        return VK_ERROR_OUT_OF_HOST_MEMORY;
+    /* Reallocate the wrapped objects only when the number of physical
+     * devices changed; otherwise the objects from earlier calls are reused
+     * so that handles the application already has stay valid */
+    if (inst->phys_dev_count_tramp != inst->total_gpu_count ||
+        !inst->phys_devs) {
+        struct loader_physical_device *new_phys_devs;
+
+        new_phys_devs = (struct loader_physical_device *)loader_heap_alloc(
+            inst,
+            (inst->total_gpu_count ? inst->total_gpu_count : 1) *
+                sizeof(struct loader_physical_device),
+            VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+        if (!new_phys_devs) {
+            loader_platform_thread_unlock_mutex(&loader_lock);
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
+        memset(new_phys_devs, 0, inst->total_gpu_count *
+                                     sizeof(struct loader_physical_device));
+        if (inst->phys_devs)
+            loader_heap_free(inst, inst->phys_devs);
+        inst->phys_devs = new_phys_devs;
+        inst->phys_dev_count_tramp = inst->total_gpu_count;
     }
 
+    count = *pPhysicalDeviceCount;
     for (i = 0; i < count; i++) {
 
-        // initialize the loader's physicalDevice object
-        loader_set_dispatch((void *)&inst->phys_devs[i], inst->disp);
-        inst->phys_devs[i].this_icd = inst->phys_devs_term[i].this_icd;
-        inst->phys_devs[i].phys_dev = pPhysicalDevices[i];
+        // initialize the loader's physicalDevice object unless an earlier
+        // call already wrapped the same object
+        if (inst->phys_devs[i].phys_dev != pPhysicalDevices[i] ||
+            inst->phys_devs[i].this_icd != inst->phys_devs_term[i].this_icd) {
+            loader_set_dispatch((void *)&inst->phys_devs[i], inst->disp);
+            inst->phys_devs[i].this_icd = inst->phys_devs_term[i].this_icd;
+            inst->phys_devs[i].phys_dev = pPhysicalDevices[i];
+        }
 
         // copy wrapped object into Application provided array
         pPhysicalDevices[i] = (VkPhysicalDevice)&inst->phys_devs[i];
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and/or associated documentation files (the "Materials"), to
+ * deal in the Materials without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Materials, and to permit persons to whom the Materials are
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice(s) and this permission notice shall be included in
+ * all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE MATERIALS OR THE
+ * USE OR OTHER DEALINGS IN THE MATERIALS.
+ */
+
+// Times vkCreateInstance/vkDestroyInstance loops through the loader, to
+// measure what reusing resident ICD and layer libraries saves.  The first
+// iteration loads the libraries; later ones find them resident unless the
+// loader unloads them in between.
+//
+//   vk_instance_bench [-a] [iterations] [layer name...]
+//
+// Run once as is and once with VK_LOADER_KEEP_LIBRARIES=1 to compare the
+// default policy with keeping every library loaded.  With -a, the instances
+// are given a counting pAllocator and the calls made to it are reported.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double ms_since(Clock::time_point begin) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+}
+
+struct Timings {
+    std::vector<double> create_ms;
+    std::vector<double> destroy_ms;
+};
+
+// what was asked of the pAllocator
+struct AllocatorStats {
+    uint64_t allocations;
+    uint64_t reallocations;
+    uint64_t frees;
+    uint64_t bytes;
+};
+
+VKAPI_ATTR void *VKAPI_CALL count_allocation(void *user_data, size_t size, size_t alignment,
+                                             VkSystemAllocationScope) {
+    AllocatorStats *stats = static_cast<AllocatorStats *>(user_data);
+    stats->allocations++;
+    stats->bytes += size;
+
+    // keep the size and alignment in front of the allocation for frees
+    // and reallocations
+    if (alignment < 2 * sizeof(size_t))
+        alignment = 2 * sizeof(size_t);
+    char *mem = static_cast<char *>(std::malloc(size + alignment));
+    if (!mem)
+        return NULL;
+    char *ptr = mem + alignment;
+    const size_t header[2] = {size, alignment};
+    std::memcpy(ptr - sizeof(header), header, sizeof(header));
+    return ptr;
+}
+
+VKAPI_ATTR void VKAPI_CALL count_free(void *user_data, void *ptr) {
+    if (!ptr)
+        return;
+    AllocatorStats *stats = static_cast<AllocatorStats *>(user_data);
+    stats->frees++;
+
+    size_t alignment;
+    std::memcpy(&alignment, static_cast<char *>(ptr) - sizeof(size_t), sizeof(size_t));
+    std::free(static_cast<char *>(ptr) - alignment);
+}
+
+VKAPI_ATTR void *VKAPI_CALL count_reallocation(void *user_data, void *ptr, size_t size, size_t alignment,
+                                               VkSystemAllocationScope scope) {
+    AllocatorStats *stats = static_cast<AllocatorStats *>(user_data);
+    stats->reallocations++;
+
+    void *new_ptr = count_allocation(user_data, size, alignment, scope);
+    stats->allocations--;
+    if (!new_ptr)
+        return NULL;
+
+    if (ptr) {
+        size_t old_size;
+        std::memcpy(&old_size, static_cast<char *>(ptr) - 2 * sizeof(size_t), sizeof(size_t));
+        std::memcpy(new_ptr, ptr, old_size < size ? old_size : size);
+        count_free(user_data, ptr);
+        stats->frees--;
+    }
+    return new_ptr;
+}
+
+bool run(int iterations, const std::vector<const char *> &layers, const VkAllocationCallbacks *allocator,
+         Timings &timings) {
+    VkApplicationInfo app_info = {};
+    app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    app_info.pApplicationName = "vk_instance_bench";
+    app_info.apiVersion = VK_API_VERSION;
+
+    VkInstanceCreateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    info.pApplicationInfo = &app_info;
+    info.enabledLayerCount = static_cast<uint32_t>(layers.size());
+    info.ppEnabledLayerNames = layers.data();
+
+    for (int i = 0; i < iterations; i++) {
+        VkInstance instance;
+
+        Clock::time_point begin = Clock::now();
+        VkResult res = vkCreateInstance(&info, allocator, &instance);
+        timings.create_ms.push_back(ms_since(begin));
+        if (res != VK_SUCCESS) {
+            std::fprintf(stderr, "vkCreateInstance failed: %d\n", res);
+            return false;
+        }
+
+        begin = Clock::now();
+        vkDestroyInstance(instance, allocator);
+        timings.destroy_ms.push_back(ms_since(begin));
+    }
+
+    return true;
+}
+
+void print(const char *name, const std::vector<double> &ms) {
+    // the first iteration is the cold one, report the rest separately
+    std::vector<double> warm;
+    for (size_t i = 1; i < ms.size(); i++)
+        warm.push_back(ms[i]);
+    std::sort(warm.begin(), warm.end());
+
+    double sum = 0.0;
+    for (auto t : warm)
+        sum += t;
+
+    if (warm.empty()) {
+        std::printf("%-8s %10.3f\n", name, ms[0]);
+        return;
+    }
+    std::printf("%-8s %10.3f %10.3f %10.3f %10.3f\n", name, ms[0], sum / warm.size(),
+                warm[warm.size() / 2], warm.back());
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int arg = 1;
+    bool count_allocations = false;
+    if (arg < argc && std::strcmp(argv[arg], "-a") == 0) {
+        count_allocations = true;
+        arg++;
+    }
+
+    int iterations = 100;
+    if (arg < argc)
+        iterations = std::max(1, std::atoi(argv[arg++]));
+
+    std::vector<const char *> layers;
+    for (; arg < argc; arg++)
+        layers.push_back(argv[arg]);
+
+    AllocatorStats stats = {};
+    VkAllocationCallbacks allocator = {};
+    allocator.pUserData = &stats;
+    allocator.pfnAllocation = count_allocation;
+    allocator.pfnReallocation = count_reallocation;
+    allocator.pfnFree = count_free;
+
+    Timings timings;
+    if (!run(iterations, layers, count_allocations ? &allocator : NULL, timings))
+        return 1;
+
+    const char *keep = std::getenv("VK_LOADER_KEEP_LIBRARIES");
+    std::printf("%d iterations, %zu layers, VK_LOADER_KEEP_LIBRARIES=%s\n", iterations, layers.size(),
+                keep ? keep : "(unset)");
+    std::printf("%-8s %10s %10s %10s %10s\n", "ms", "first", "mean", "median", "max");
+    print("create", timings.create_ms);
+    print("destroy", timings.destroy_ms);
+    if (count_allocations) {
+        std::printf("pAllocator per instance: %.1f allocations, %.1f reallocations, %.1f frees, %.0f bytes\n",
+                    double(stats.allocations) / iterations, double(stats.reallocations) / iterations,
+                    double(stats.frees) / iterations, double(stats.bytes) / iterations);
+    }
+
+    return 0;
+}
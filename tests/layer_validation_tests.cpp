@@ -812,6 +812,115 @@ TEST_F(VkLayerTest, RebindMemory) {
     vkFreeMemory(m_device->device(), mem2, NULL);
 }
 
+TEST_F(VkLayerTest, SuballocatedMemoryNotAliased) {
+    // Buffers and images created with memory share the blocks of the
+    // device's MemoryPool.  Their ranges must not overlap, and binding them at
+    // their offsets must not be reported as aliasing.
+    const uint32_t buffer_count = 16;
+    const uint32_t image_count = 4;
+
+    ASSERT_NO_FATAL_FAILURE(InitState());
+
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT |
+                                             VK_DEBUG_REPORT_WARNING_BIT_EXT,
+                                         "");
+
+    // the pool outlives the test when the device is shared
+    const vk_testing::MemoryPool &pool = m_device->memory_pool();
+    const vk_testing::MemoryPool::Stats before = pool.stats();
+
+    const VkBufferCreateInfo buffer_info = vk_testing::Buffer::create_info(
+        1000, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+    vk_testing::Buffer buffers[buffer_count];
+    for (uint32_t i = 0; i < buffer_count; i++) {
+        buffers[i].init(*m_device, buffer_info,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+    }
+
+    // the small buffers share at most one new block, unless --dedicated-memory
+    // gives each its own
+    if (!vk_testing::get_dedicated_memory()) {
+        const vk_testing::MemoryPool::Stats after_buffers = pool.stats();
+        EXPECT_GE(1u, after_buffers.vk_allocation_count -
+                          before.vk_allocation_count);
+        EXPECT_EQ(before.suballocation_count + buffer_count,
+                  after_buffers.suballocation_count);
+        for (uint32_t i = 0; i < buffer_count; i++) {
+            EXPECT_TRUE(buffers[i].memory().suballocated());
+            EXPECT_EQ(buffers[0].memory().handle(),
+                      buffers[i].memory().handle());
+        }
+    }
+
+    // linear and optimal images may share a block too
+    VkImageCreateInfo image_info = vk_testing::Image::create_info();
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.format = VK_FORMAT_B8G8R8A8_UNORM;
+    image_info.extent.width = 32;
+    image_info.extent.height = 32;
+    image_info.usage = VK_IMAGE_USAGE_SAMPLED_BIT;
+    vk_testing::Image images[image_count];
+    for (uint32_t i = 0; i < image_count; i++) {
+        image_info.tiling =
+            i % 2 ? VK_IMAGE_TILING_OPTIMAL : VK_IMAGE_TILING_LINEAR;
+        images[i].init(*m_device, image_info, 0);
+    }
+
+    // images start on granules of their own, so linear and optimal ones
+    // never share one
+    const VkDeviceSize granularity =
+        m_device->phy().properties().limits.bufferImageGranularity;
+    for (uint32_t i = 0; i < image_count; i++) {
+        const vk_testing::DeviceMemory &mem = images[i].memory();
+        const VkMemoryRequirements reqs = images[i].memory_requirements();
+        EXPECT_EQ(0u, mem.offset() % reqs.alignment);
+        EXPECT_EQ(0u, mem.offset() % granularity);
+        for (uint32_t j = 0; j < i; j++) {
+            const vk_testing::DeviceMemory &other = images[j].memory();
+            if (other.handle() != mem.handle())
+                continue;
+            const VkDeviceSize other_size =
+                images[j].memory_requirements().size;
+            EXPECT_TRUE(mem.offset() >= other.offset() + other_size ||
+                        other.offset() >= mem.offset() + reqs.size);
+        }
+    }
+
+    for (uint32_t i = 0; i < buffer_count; i++) {
+        const vk_testing::DeviceMemory &mem = buffers[i].memory();
+        const VkDeviceSize size = buffers[i].memory_requirements().size;
+        for (uint32_t j = 0; j < i; j++) {
+            const vk_testing::DeviceMemory &other = buffers[j].memory();
+            if (other.handle() != mem.handle())
+                continue;
+            EXPECT_TRUE(mem.offset() >= other.offset() + size ||
+                        other.offset() >= mem.offset() + size);
+        }
+    }
+
+    // each buffer keeps what was written to it
+    for (uint32_t i = 0; i < buffer_count; i++) {
+        uint32_t *data = static_cast<uint32_t *>(buffers[i].memory().map());
+        ASSERT_TRUE(data != NULL);
+        for (uint32_t k = 0; k < 1000 / sizeof(uint32_t); k++)
+            data[k] = i;
+        buffers[i].memory().unmap();
+    }
+    for (uint32_t i = 0; i < buffer_count; i++) {
+        const uint32_t *data =
+            static_cast<const uint32_t *>(buffers[i].memory().map());
+        ASSERT_TRUE(data != NULL);
+        EXPECT_EQ(i, data[0]);
+        EXPECT_EQ(i, data[1000 / sizeof(uint32_t) - 1]);
+        buffers[i].memory().unmap();
+    }
+
+    if (m_errorMonitor->DesiredMsgFound()) {
+        FAIL() << "Suballocated memory reported: "
+               << m_errorMonitor->GetFailureMsg();
+    }
+}
+
 TEST_F(VkLayerTest, SubmitSignaledFence) {
     vk_testing::Fence testFence;
 
@@ -1158,6 +1267,51 @@ TEST_F(VkLayerTest, BindMemoryToDestroyedObject) {
     vkFreeMemory(m_device->device(), mem, NULL);
 }
 
+TEST_F(VkLayerTest, EnumeratePhysicalDevicesStableHandles) {
+    // The loader keeps the physical devices of an instance between calls, so
+    // every enumeration, complete or not, must hand out the same handles
+    VkResult err;
+    uint32_t count = 0;
+
+    ASSERT_NO_FATAL_FAILURE(InitState());
+
+    err = vkEnumeratePhysicalDevices(inst, &count, NULL);
+    ASSERT_VK_SUCCESS(err);
+    ASSERT_GT(count, 0u);
+
+    std::vector<VkPhysicalDevice> first(count), second(count);
+    err = vkEnumeratePhysicalDevices(inst, &count, first.data());
+    ASSERT_VK_SUCCESS(err);
+    ASSERT_EQ(first.size(), count);
+    err = vkEnumeratePhysicalDevices(inst, &count, second.data());
+    ASSERT_VK_SUCCESS(err);
+    ASSERT_EQ(first.size(), count);
+    for (uint32_t i = 0; i < count; i++) {
+        EXPECT_EQ(first[i], second[i]);
+    }
+
+    // the framework enumerated before this test did
+    EXPECT_EQ(gpu(), first[0]);
+
+    if (count > 1) {
+        uint32_t partial = count - 1;
+        std::vector<VkPhysicalDevice> some(partial);
+        err = vkEnumeratePhysicalDevices(inst, &partial, some.data());
+        EXPECT_EQ(VK_INCOMPLETE, err);
+        ASSERT_EQ(count - 1, partial);
+        for (uint32_t i = 0; i < partial; i++) {
+            EXPECT_EQ(first[i], some[i]);
+        }
+    }
+
+    // and the handles handed out first are still usable
+    VkPhysicalDeviceProperties props, gpu_props;
+    vkGetPhysicalDeviceProperties(first[0], &props);
+    vkGetPhysicalDeviceProperties(gpu(), &gpu_props);
+    EXPECT_EQ(gpu_props.deviceID, props.deviceID);
+    EXPECT_EQ(gpu_props.vendorID, props.vendorID);
+}
+
 #endif // OBJ_TRACKER_TESTS
 
 #if DRAW_STATE_TESTS
@@ -4853,6 +5007,282 @@ TEST_F(VkLayerTest, VtxBufferBadIndex) {
     vkDestroyDescriptorSetLayout(m_device->device(), ds_layout, NULL);
     vkDestroyDescriptorPool(m_device->device(), ds_pool, NULL);
 }
+
+// Puts layer_settings.sample_mode and sample_period back to their defaults when
+// a test leaves, however it leaves, as they apply to every later test too
+struct SampleSettingsGuard {
+    ~SampleSettingsGuard() {
+        setLayerOption("layer_settings.sample_mode", "off");
+        setLayerOption("layer_settings.sample_period", "1");
+    }
+};
+
+TEST_F(VkLayerTest, SampledValidationPicksCommandBuffers) {
+    // Reading memory that was never written is reported when a command buffer
+    // is submitted, by a check that is sampled.  With sampling off every
+    // command buffer reports it; with a sample period, exactly the command
+    // buffers the sampler picks do.
+    static const uint32_t commandBufferCount = 32;
+    static const uint32_t samplePeriod = 4;
+
+    SampleSettingsGuard sampleSettings;
+    ASSERT_NO_FATAL_FAILURE(InitState());
+
+    // Memory of their own, so nothing else writes to the source's memory
+    VkBufferCreateInfo buffer_info = vk_testing::Buffer::create_info(
+        256, VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                 VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    vk_testing::Buffer src, dst;
+    src.init_dedicated(*m_device, buffer_info, 0);
+    dst.init_dedicated(*m_device, buffer_info, 0);
+
+    VkBufferCopy region = {};
+    region.size = 256;
+
+    for (uint32_t pass = 0; pass < 2; pass++) {
+        bool sampling = pass == 1;
+        setLayerOption("layer_settings.sample_mode",
+                       sampling ? "command_buffers" : "off");
+        setLayerOption("layer_settings.sample_period",
+                       sampling ? std::to_string(samplePeriod).c_str() : "1");
+
+        uint32_t reported = 0;
+        for (uint32_t i = 0; i < commandBufferCount; i++) {
+            VkCommandBufferObj commandBuffer(m_device, m_commandPool);
+            commandBuffer.BeginCommandBuffer();
+            vkCmdCopyBuffer(commandBuffer.handle(), src.handle(),
+                            dst.handle(), 1, &region);
+            commandBuffer.EndCommandBuffer();
+
+            // The sampler decides from the handle and how many times it
+            // has begun recording, once here
+            bool picked =
+                !sampling ||
+                layerSamplePicksCommandBuffer(
+                    (uint64_t)commandBuffer.handle(), 0, samplePeriod);
+
+            m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                                 "Cannot read invalid memory");
+            VkSubmitInfo submit_info = {};
+            submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submit_info.commandBufferCount = 1;
+            submit_info.pCommandBuffers = &commandBuffer.handle();
+            vkQueueSubmit(m_device->m_queue, 1, &submit_info, VK_NULL_HANDLE);
+            vkQueueWaitIdle(m_device->m_queue);
+
+            EXPECT_EQ(picked, (bool)m_errorMonitor->DesiredMsgFound())
+                << "command buffer " << i << (sampling ? " with" : " without")
+                << " sampling";
+            if (m_errorMonitor->DesiredMsgFound())
+                reported++;
+        }
+
+        if (sampling) {
+            EXPECT_LT(reported, commandBufferCount);
+        } else {
+            EXPECT_EQ(commandBufferCount, reported);
+        }
+    }
+}
+
+static const char vertexBufferVertShaderText[] =
+    "#version 400\n"
+    "#extension GL_ARB_separate_shader_objects: require\n"
+    "#extension GL_ARB_shading_language_420pack: require\n"
+    "\n"
+    "layout(location=0) in float x;\n"
+    "out gl_PerVertex {\n"
+    "    vec4 gl_Position;\n"
+    "};\n"
+    "void main(){\n"
+    "   gl_Position = vec4(x);\n"
+    "}\n";
+
+TEST_F(VkLayerTest, DestroyBufferInUseBySubmission) {
+    // A vertex buffer read by a draw is in use from the submit until the
+    // submission retires, so destroying it in between is an error
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                         "that is in use by a command buffer");
+
+    ASSERT_NO_FATAL_FAILURE(InitState());
+    ASSERT_NO_FATAL_FAILURE(InitViewport());
+    ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
+
+    VkVertexInputBindingDescription input_binding = {};
+    input_binding.stride = sizeof(float);
+    VkVertexInputAttributeDescription input_attrib = {};
+    input_attrib.format = VK_FORMAT_R32_SFLOAT;
+
+    VkShaderObj vs(m_device, vertexBufferVertShaderText,
+                   VK_SHADER_STAGE_VERTEX_BIT, this);
+    VkShaderObj fs(m_device, bindStateFragShaderText,
+                   VK_SHADER_STAGE_FRAGMENT_BIT, this);
+
+    VkPipelineObj pipe(m_device);
+    pipe.AddColorAttachment();
+    pipe.AddShader(&vs);
+    pipe.AddShader(&fs);
+    pipe.AddVertexInputBindings(&input_binding, 1);
+    pipe.AddVertexInputAttribs(&input_attrib, 1);
+    pipe.SetViewport(m_viewports);
+    pipe.SetScissor(m_scissors);
+
+    VkDescriptorSetObj descriptorSet(m_device);
+    descriptorSet.AppendDummy();
+    descriptorSet.CreateVKDescriptorSet(m_commandBuffer);
+
+    ASSERT_VK_SUCCESS(
+        pipe.CreateVKPipeline(descriptorSet.GetPipelineLayout(), renderPass()));
+
+    vk_testing::Buffer vbo;
+    vbo.init_dedicated(*m_device, vk_testing::Buffer::create_info(
+                                      3 * sizeof(float),
+                                      VK_BUFFER_USAGE_VERTEX_BUFFER_BIT),
+                       0);
+    VkDeviceSize offset = 0;
+
+    BeginCommandBuffer();
+    m_commandBuffer->BindPipeline(pipe);
+    m_commandBuffer->BindDescriptorSet(descriptorSet);
+    vkCmdBindVertexBuffers(m_commandBuffer->handle(), 0, 1, &vbo.handle(),
+                           &offset);
+    Draw(3, 1, 0, 0);
+    EndCommandBuffer();
+
+    vk_testing::Fence fence;
+    fence.init(*m_device, vk_testing::Fence::create_info());
+
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &m_commandBuffer->handle();
+    vkQueueSubmit(m_device->m_queue, 1, &submit_info, fence.handle());
+
+    // The error makes the layer skip the destroy; vbo destroys the buffer
+    // again once the submission has finished with it
+    vkDestroyBuffer(m_device->device(), vbo.handle(), NULL);
+
+    if (!m_errorMonitor->DesiredMsgFound()) {
+        FAIL() << "Did not receive Error 'Cannot free buffer that is in use "
+                  "by a command buffer.'";
+        m_errorMonitor->DumpFailureMsgs();
+    }
+
+    vkWaitForFences(m_device->device(), 1, &fence.handle(), VK_TRUE,
+                    UINT64_MAX);
+}
+
+TEST_F(VkLayerTest, DestroyBufferAfterFenceWait) {
+    // Waiting on the fence of the submission that read a vertex buffer
+    // retires it, after which the buffer can be destroyed
+    ASSERT_NO_FATAL_FAILURE(InitState());
+    ASSERT_NO_FATAL_FAILURE(InitViewport());
+    ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
+
+    VkVertexInputBindingDescription input_binding = {};
+    input_binding.stride = sizeof(float);
+    VkVertexInputAttributeDescription input_attrib = {};
+    input_attrib.format = VK_FORMAT_R32_SFLOAT;
+
+    VkShaderObj vs(m_device, vertexBufferVertShaderText,
+                   VK_SHADER_STAGE_VERTEX_BIT, this);
+    VkShaderObj fs(m_device, bindStateFragShaderText,
+                   VK_SHADER_STAGE_FRAGMENT_BIT, this);
+
+    VkPipelineObj pipe(m_device);
+    pipe.AddColorAttachment();
+    pipe.AddShader(&vs);
+    pipe.AddShader(&fs);
+    pipe.AddVertexInputBindings(&input_binding, 1);
+    pipe.AddVertexInputAttribs(&input_attrib, 1);
+    pipe.SetViewport(m_viewports);
+    pipe.SetScissor(m_scissors);
+
+    VkDescriptorSetObj descriptorSet(m_device);
+    descriptorSet.AppendDummy();
+    descriptorSet.CreateVKDescriptorSet(m_commandBuffer);
+
+    ASSERT_VK_SUCCESS(
+        pipe.CreateVKPipeline(descriptorSet.GetPipelineLayout(), renderPass()));
+
+    vk_testing::Fence fence;
+    fence.init(*m_device, vk_testing::Fence::create_info());
+
+    {
+        vk_testing::Buffer vbo;
+        vbo.init_dedicated(*m_device, vk_testing::Buffer::create_info(
+                                          3 * sizeof(float),
+                                          VK_BUFFER_USAGE_VERTEX_BUFFER_BIT),
+                           0);
+        VkDeviceSize offset = 0;
+
+        BeginCommandBuffer();
+        m_commandBuffer->BindPipeline(pipe);
+        m_commandBuffer->BindDescriptorSet(descriptorSet);
+        vkCmdBindVertexBuffers(m_commandBuffer->handle(), 0, 1, &vbo.handle(),
+                               &offset);
+        Draw(3, 1, 0, 0);
+        EndCommandBuffer();
+
+        VkSubmitInfo submit_info = {};
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &m_commandBuffer->handle();
+        vkQueueSubmit(m_device->m_queue, 1, &submit_info, fence.handle());
+        vkWaitForFences(m_device->device(), 1, &fence.handle(), VK_TRUE,
+                        UINT64_MAX);
+
+        // vbo is destroyed here
+        m_errorMonitor->SetDesiredFailureMsg(
+            VK_DEBUG_REPORT_ERROR_BIT_EXT, "that is in use by a command buffer");
+    }
+
+    if (m_errorMonitor->DesiredMsgFound()) {
+        FAIL() << "Destroying a retired buffer reported: "
+               << m_errorMonitor->GetFailureMsg();
+    }
+}
+
+TEST_F(VkLayerTest, ResubmitCommandBufferInFlight) {
+    // A command buffer begun without SIMULTANEOUS_USE may be submitted again
+    // only after its earlier submission retires
+    ASSERT_NO_FATAL_FAILURE(InitState());
+
+    VkCommandBufferBeginInfo begin_info = {};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    m_commandBuffer->BeginCommandBuffer(&begin_info);
+    m_commandBuffer->EndCommandBuffer();
+
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &m_commandBuffer->handle();
+
+    m_errorMonitor->SetDesiredFailureMsg(
+        VK_DEBUG_REPORT_ERROR_BIT_EXT,
+        "is already in use and is not marked for simultaneous use");
+    vkQueueSubmit(m_device->m_queue, 1, &submit_info, VK_NULL_HANDLE);
+    EXPECT_FALSE(m_errorMonitor->DesiredMsgFound())
+        << "First submit reported: " << m_errorMonitor->GetFailureMsg();
+
+    vkQueueSubmit(m_device->m_queue, 1, &submit_info, VK_NULL_HANDLE);
+    if (!m_errorMonitor->DesiredMsgFound()) {
+        ADD_FAILURE() << "Did not receive Error 'Command Buffer is already in "
+                         "use and is not marked for simultaneous use.'";
+        m_errorMonitor->DumpFailureMsgs();
+    }
+
+    // Once the queue is idle the submission has retired
+    vkQueueWaitIdle(m_device->m_queue);
+    m_errorMonitor->SetDesiredFailureMsg(
+        VK_DEBUG_REPORT_ERROR_BIT_EXT,
+        "is already in use and is not marked for simultaneous use");
+    vkQueueSubmit(m_device->m_queue, 1, &submit_info, VK_NULL_HANDLE);
+    EXPECT_FALSE(m_errorMonitor->DesiredMsgFound())
+        << "Submit after the queue went idle reported: "
+        << m_errorMonitor->GetFailureMsg();
+    vkQueueWaitIdle(m_device->m_queue);
+}
 #endif // DRAW_STATE_TESTS
 
 #if THREADING_TESTS
@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+# Copyright (c) 2016 The Khronos Group Inc.
+# Copyright (c) 2016 Valve Corporation
+# Copyright (c) 2016 LunarG, Inc.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and/or associated documentation files (the "Materials"), to
+# deal in the Materials without restriction, including without limitation the
+# rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+# sell copies of the Materials, and to permit persons to whom the Materials
+# are furnished to do so, subject to the following conditions:
+#
+# The above copyright notice(s) and this permission notice shall be included
+# in all copies or substantial portions of the Materials.
+#
+# THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+#
+# IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+# DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+# OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE MATERIALS OR THE
+# USE OR OTHER DEALINGS IN THE MATERIALS
+
+import argparse
+import multiprocessing
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+import xml.etree.ElementTree as ElementTree
+
+# run_sharded_tests.py overview
+# Runs a gtest binary, vk_layer_validation_tests by default, as several
+#  processes each running a shard of the tests, using gtest's own
+#  GTEST_TOTAL_SHARDS and GTEST_SHARD_INDEX.  Each process shares one
+#  instance and device between its tests unless --fresh-device is passed.
+# When all are done, it prints the tests that failed with the output of their
+#  shards, and the time each shard and each of the slowest tests took.  The
+#  time of every test can also be written to a file.
+# Shards share compiled shaders through VK_SPIRV_CACHE_DIR, which defaults
+#  to a spirv_cache directory next to the binary.  Point VK_ICD_FILENAMES at
+#  a null driver to run without a GPU.
+
+def parse_args():
+    default_binary = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                  'vk_layer_validation_tests')
+    parser = argparse.ArgumentParser(
+        description='Run a gtest binary as parallel shards and report test times.',
+        epilog='Arguments after -- are passed to every shard.')
+    parser.add_argument('-j', '--jobs', type=int, default=multiprocessing.cpu_count(),
+                        help='number of shards run at once (default: %(default)s)')
+    parser.add_argument('--binary', default=default_binary,
+                        help='test binary (default: %(default)s)')
+    parser.add_argument('--icd', help='ICD manifest to set VK_ICD_FILENAMES to')
+    parser.add_argument('--timing-report', metavar='FILE',
+                        help='write the time of every test to FILE, slowest first')
+    parser.add_argument('--slowest', type=int, default=20,
+                        help='number of slowest tests to print (default: %(default)s)')
+    parser.add_argument('--keep-logs', action='store_true',
+                        help='keep the output and XML results of each shard')
+    parser.add_argument('test_args', nargs='*', help=argparse.SUPPRESS)
+    return parser.parse_args()
+
+class Shard:
+    def __init__(self, index, count, work_dir):
+        self.index = index
+        self.count = count
+        self.log_path = os.path.join(work_dir, 'shard_%d.log' % index)
+        self.xml_path = os.path.join(work_dir, 'shard_%d.xml' % index)
+        self.process = None
+        self.log = None
+        self.start = 0.0
+        self.seconds = 0.0
+        self.returncode = None
+
+    def launch(self, binary, test_args, env):
+        shard_env = dict(env)
+        shard_env['GTEST_TOTAL_SHARDS'] = str(self.count)
+        shard_env['GTEST_SHARD_INDEX'] = str(self.index)
+        cmd = [binary, '--gtest_output=xml:' + self.xml_path] + test_args
+        self.log = open(self.log_path, 'w')
+        self.start = time.time()
+        self.process = subprocess.Popen(cmd, env=shard_env, stdout=self.log,
+                                        stderr=subprocess.STDOUT)
+
+    def wait(self):
+        self.returncode = self.process.wait()
+        self.seconds = time.time() - self.start
+        self.log.close()
+
+    # returns (name, milliseconds, failed) for each test the shard ran
+    def results(self):
+        if not os.path.exists(self.xml_path):
+            return []
+        tests = []
+        for case in ElementTree.parse(self.xml_path).getroot().iter('testcase'):
+            if case.get('status') != 'run':
+                continue
+            name = '%s.%s' % (case.get('classname'), case.get('name'))
+            milliseconds = float(case.get('time', '0')) * 1000.0
+            tests.append((name, milliseconds, case.find('failure') is not None))
+        return tests
+
+    def output(self):
+        with open(self.log_path, errors='replace') as log:
+            return log.read()
+
+def main():
+    args = parse_args()
+    args.jobs = max(1, args.jobs)
+    if not os.path.exists(args.binary):
+        print('No test binary at %s' % args.binary)
+        return 1
+
+    env = dict(os.environ)
+    if args.icd:
+        env['VK_ICD_FILENAMES'] = os.path.abspath(args.icd)
+    if 'VK_SPIRV_CACHE_DIR' not in env:
+        env['VK_SPIRV_CACHE_DIR'] = os.path.join(os.path.dirname(os.path.abspath(args.binary)),
+                                                 'spirv_cache')
+
+    work_dir = tempfile.mkdtemp(prefix='vk_test_shards_')
+    shards = [Shard(i, args.jobs, work_dir) for i in range(args.jobs)]
+
+    start = time.time()
+    for shard in shards:
+        shard.launch(args.binary, args.test_args, env)
+    for shard in shards:
+        shard.wait()
+    wall_seconds = time.time() - start
+
+    tests = []
+    failed_shards = []
+    for shard in shards:
+        shard_tests = shard.results()
+        tests.extend((name, ms, failed, shard.index) for name, ms, failed in shard_tests)
+        # a shard can exit early, crashing or failing outside of a test
+        if shard.returncode != 0 or any(failed for _, _, failed in shard_tests):
+            failed_shards.append(shard)
+
+    for shard in failed_shards:
+        print('==== shard %d of %d exited with %d ====' % (shard.index, shard.count,
+                                                          shard.returncode))
+        print(shard.output())
+
+    print('%-10s %10s %8s' % ('shard', 'seconds', 'tests'))
+    for shard in shards:
+        count = sum(1 for test in tests if test[3] == shard.index)
+        print('%-10d %10.2f %8d' % (shard.index, shard.seconds, count))
+
+    tests.sort(key=lambda test: test[1], reverse=True)
+    if args.slowest > 0 and tests:
+        print('\nslowest tests (ms):')
+        for name, ms, failed, index in tests[:args.slowest]:
+            print('%10.0f  %s%s' % (ms, name, '  FAILED' if failed else ''))
+
+    if args.timing_report:
+        with open(args.timing_report, 'w') as report:
+            for name, ms, failed, index in tests:
+                report.write('%.0f\t%d\t%s\t%s\n' % (ms, index,
+                                                     'FAILED' if failed else 'OK', name))
+
+    failures = [test[0] for test in tests if test[2]]
+    print('\n%d tests in %d shards, %.2f s of tests in %.2f s wall time' %
+          (len(tests), args.jobs, sum(test[1] for test in tests) / 1000.0, wall_seconds))
+    if failures:
+        print('%d FAILED:' % len(failures))
+        for name in sorted(failures):
+            print('    ' + name)
+
+    if args.keep_logs:
+        print('shard logs and results kept in %s' % work_dir)
+    else:
+        shutil.rmtree(work_dir, ignore_errors=True)
+
+    return 1 if failed_shards else 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) 2016 The Khronos Group Inc.
+ * Copyright (c) 2016 Valve Corporation
+ * Copyright (c) 2016 LunarG, Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and/or associated documentation files (the "Materials"), to
+ * deal in the Materials without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Materials, and to permit persons to whom the Materials are
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice(s) and this permission notice shall be included in
+ * all copies or substantial portions of the Materials.
+ *
+ * THE MATERIALS ARE PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE MATERIALS OR THE
+ * USE OR OTHER DEALINGS IN THE MATERIALS.
+ */
+
+// Times recording and submitting work through the validation layers, to track
+// the CPU cost of the checks they make on it.
+//
+//   vk_validation_bench [-v] sampling|retire [command buffers]
+//
+// sampling: records command buffers of buffer copies and submits them with
+//   layer_settings.sample_mode set to command_buffers, for growing values of
+//   layer_settings.sample_period, and reports the time per copy.
+// retire: submits prerecorded command buffers in a frame loop that keeps
+//   several frames in flight and waits on the oldest frame's fence, and
+//   reports the time per submitted command buffer, which includes retiring
+//   the submissions the fence covers.
+//
+// The DrawState and MemTracker layers are enabled; they honor sampling and
+// track what each submission keeps in use.  Point VK_ICD_FILENAMES at a null driver to measure only the
+// layers.  With -v, messages from the layers are printed.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+#include <vulkan/vk_layer.h>
+#include "vk_layer_config.h"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// not const, the loader writes to ppEnabledLayerNames while expanding meta layers
+const char *bench_layers[] = {
+    "VK_LAYER_LUNARG_draw_state", "VK_LAYER_LUNARG_mem_tracker",
+};
+const uint32_t bench_layer_count = sizeof(bench_layers) / sizeof(bench_layers[0]);
+
+const VkDeviceSize buffer_size = 64 * 1024;
+
+double ns_since(Clock::time_point begin) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+}
+
+VKAPI_ATTR VkBool32 VKAPI_CALL print_message(VkDebugReportFlagsEXT, VkDebugReportObjectTypeEXT, uint64_t, size_t,
+                                             int32_t, const char *layer_prefix, const char *message, void *) {
+    std::printf("%s: %s\n", layer_prefix, message);
+    return VK_FALSE;
+}
+
+// an instance and device with the layers, and the buffers the work copies between
+struct Context {
+    VkInstance instance;
+    VkDebugReportCallbackEXT callback;
+    VkPhysicalDevice gpu;
+    VkDevice device;
+    VkQueue queue;
+    uint32_t queue_family;
+    VkCommandPool command_pool;
+    VkBuffer buffers[2];
+    VkDeviceMemory memory[2];
+};
+
+bool check(VkResult res, const char *what) {
+    if (res != VK_SUCCESS)
+        std::fprintf(stderr, "%s failed: %d\n", what, res);
+    return res == VK_SUCCESS;
+}
+
+bool init_buffer(Context &ctx, int index) {
+    VkBufferCreateInfo buffer_info = {};
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = buffer_size;
+    buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (!check(vkCreateBuffer(ctx.device, &buffer_info, NULL, &ctx.buffers[index]), "vkCreateBuffer"))
+        return false;
+
+    VkMemoryRequirements reqs;
+    vkGetBufferMemoryRequirements(ctx.device, ctx.buffers[index], &reqs);
+    VkPhysicalDeviceMemoryProperties props;
+    vkGetPhysicalDeviceMemoryProperties(ctx.gpu, &props);
+
+    VkMemoryAllocateInfo alloc_info = {};
+    alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    alloc_info.allocationSize = reqs.size;
+    alloc_info.memoryTypeIndex = props.memoryTypeCount;
+    for (uint32_t i = 0; i < props.memoryTypeCount; i++) {
+        if ((reqs.memoryTypeBits & (1u << i)) &&
+            (props.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) {
+            alloc_info.memoryTypeIndex = i;
+            break;
+        }
+    }
+    if (alloc_info.memoryTypeIndex == props.memoryTypeCount) {
+        std::fprintf(stderr, "no host visible memory type\n");
+        return false;
+    }
+    if (!check(vkAllocateMemory(ctx.device, &alloc_info, NULL, &ctx.memory[index]), "vkAllocateMemory") ||
+        !check(vkBindBufferMemory(ctx.device, ctx.buffers[index], ctx.memory[index], 0), "vkBindBufferMemory"))
+        return false;
+
+    // written memory, so the copies are valid and only the checks are timed
+    void *data;
+    if (!check(vkMapMemory(ctx.device, ctx.memory[index], 0, buffer_size, 0, &data), "vkMapMemory"))
+        return false;
+    std::memset(data, index, buffer_size);
+    vkUnmapMemory(ctx.device, ctx.memory[index]);
+    return true;
+}
+
+bool init(Context &ctx, bool verbose) {
+    VkApplicationInfo app_info = {};
+    app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    app_info.pApplicationName = "vk_validation_bench";
+    app_info.apiVersion = VK_API_VERSION;
+
+    const char *extension = VK_EXT_DEBUG_REPORT_EXTENSION_NAME;
+    VkInstanceCreateInfo instance_info = {};
+    instance_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_info.pApplicationInfo = &app_info;
+    instance_info.enabledLayerCount = bench_layer_count;
+    instance_info.ppEnabledLayerNames = bench_layers;
+    instance_info.enabledExtensionCount = 1;
+    instance_info.ppEnabledExtensionNames = &extension;
+    if (!check(vkCreateInstance(&instance_info, NULL, &ctx.instance), "vkCreateInstance"))
+        return false;
+
+    // the layers only report to their log output unless -v adds a callback
+    PFN_vkCreateDebugReportCallbackEXT create_callback = reinterpret_cast<PFN_vkCreateDebugReportCallbackEXT>(
+        vkGetInstanceProcAddr(ctx.instance, "vkCreateDebugReportCallbackEXT"));
+    VkDebugReportCallbackCreateInfoEXT callback_info = {};
+    callback_info.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
+    callback_info.flags = VK_DEBUG_REPORT_ERROR_BIT_EXT | VK_DEBUG_REPORT_WARNING_BIT_EXT;
+    callback_info.pfnCallback = print_message;
+    ctx.callback = VK_NULL_HANDLE;
+    if (verbose && create_callback)
+        create_callback(ctx.instance, &callback_info, NULL, &ctx.callback);
+
+    uint32_t gpu_count = 1;
+    VkResult res = vkEnumeratePhysicalDevices(ctx.instance, &gpu_count, &ctx.gpu);
+    if ((res != VK_SUCCESS && res != VK_INCOMPLETE) || gpu_count == 0) {
+        std::fprintf(stderr, "no physical device\n");
+        return false;
+    }
+
+    uint32_t family_count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(ctx.gpu, &family_count, NULL);
+    std::vector<VkQueueFamilyProperties> families(family_count);
+    vkGetPhysicalDeviceQueueFamilyProperties(ctx.gpu, &family_count, families.data());
+    ctx.queue_family = 0;
+    for (uint32_t i = 0; i < family_count; i++) {
+        if (families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+            ctx.queue_family = i;
+            break;
+        }
+    }
+
+    float priority = 1.0f;
+    VkDeviceQueueCreateInfo queue_info = {};
+    queue_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queue_info.queueFamilyIndex = ctx.queue_family;
+    queue_info.queueCount = 1;
+    queue_info.pQueuePriorities = &priority;
+
+    VkDeviceCreateInfo device_info = {};
+    device_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    device_info.queueCreateInfoCount = 1;
+    device_info.pQueueCreateInfos = &queue_info;
+    device_info.enabledLayerCount = bench_layer_count;
+    device_info.ppEnabledLayerNames = bench_layers;
+    if (!check(vkCreateDevice(ctx.gpu, &device_info, NULL, &ctx.device), "vkCreateDevice"))
+        return false;
+    vkGetDeviceQueue(ctx.device, ctx.queue_family, 0, &ctx.queue);
+
+    VkCommandPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pool_info.queueFamilyIndex = ctx.queue_family;
+    if (!check(vkCreateCommandPool(ctx.device, &pool_info, NULL, &ctx.command_pool), "vkCreateCommandPool"))
+        return false;
+
+    return init_buffer(ctx, 0) && init_buffer(ctx, 1);
+}
+
+void destroy(Context &ctx) {
+    for (int i = 0; i < 2; i++) {
+        vkDestroyBuffer(ctx.device, ctx.buffers[i], NULL);
+        vkFreeMemory(ctx.device, ctx.memory[i], NULL);
+    }
+    vkDestroyCommandPool(ctx.device, ctx.command_pool, NULL);
+    vkDestroyDevice(ctx.device, NULL);
+    if (ctx.callback) {
+        PFN_vkDestroyDebugReportCallbackEXT destroy_callback = reinterpret_cast<PFN_vkDestroyDebugReportCallbackEXT>(
+            vkGetInstanceProcAddr(ctx.instance, "vkDestroyDebugReportCallbackEXT"));
+        destroy_callback(ctx.instance, ctx.callback, NULL);
+    }
+    vkDestroyInstance(ctx.instance, NULL);
+}
+
+std::vector<VkCommandBuffer> allocate_command_buffers(Context &ctx, uint32_t count) {
+    std::vector<VkCommandBuffer> command_buffers(count);
+    VkCommandBufferAllocateInfo info = {};
+    info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    info.commandPool = ctx.command_pool;
+    info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    info.commandBufferCount = count;
+    if (!check(vkAllocateCommandBuffers(ctx.device, &info, command_buffers.data()), "vkAllocateCommandBuffers"))
+        command_buffers.clear();
+    return command_buffers;
+}
+
+void record_copies(Context &ctx, VkCommandBuffer command_buffer, uint32_t copies) {
+    VkCommandBufferBeginInfo begin_info = {};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    vkBeginCommandBuffer(command_buffer, &begin_info);
+
+    VkBufferCopy region = {};
+    region.size = 256;
+    for (uint32_t i = 0; i < copies; i++) {
+        region.srcOffset = region.dstOffset = (i * region.size) % buffer_size;
+        vkCmdCopyBuffer(command_buffer, ctx.buffers[i & 1], ctx.buffers[~i & 1], 1, &region);
+    }
+
+    vkEndCommandBuffer(command_buffer);
+}
+
+int bench_sampling(Context &ctx, uint32_t command_buffer_count) {
+    static const uint32_t periods[] = {1, 2, 4, 8, 16, 64};
+    static const uint32_t copies_per_command_buffer = 256;
+    static const int rounds = 8;
+
+    std::vector<VkCommandBuffer> command_buffers = allocate_command_buffers(ctx, command_buffer_count);
+    if (command_buffers.empty())
+        return 1;
+
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = command_buffer_count;
+    submit_info.pCommandBuffers = command_buffers.data();
+
+    // each recording is sampled on its own, so many short command buffers
+    // give a smooth curve
+    setLayerOption("layer_settings.sample_mode", "command_buffers");
+    std::printf("%u command buffers of %u copies\n", command_buffer_count, copies_per_command_buffer);
+    std::printf("%-14s %14s\n", "sample_period", "ns per copy");
+    for (size_t p = 0; p < sizeof(periods) / sizeof(periods[0]); p++) {
+        char period[16];
+        std::snprintf(period, sizeof(period), "%u", periods[p]);
+        setLayerOption("layer_settings.sample_period", period);
+
+        Clock::time_point begin = Clock::now();
+        for (int r = 0; r < rounds; r++) {
+            for (auto command_buffer : command_buffers)
+                record_copies(ctx, command_buffer, copies_per_command_buffer);
+            vkQueueSubmit(ctx.queue, 1, &submit_info, VK_NULL_HANDLE);
+            vkQueueWaitIdle(ctx.queue);
+        }
+        double ns = ns_since(begin);
+        std::printf("%-14u %14.1f\n", periods[p],
+                    ns / (double(rounds) * command_buffer_count * copies_per_command_buffer));
+    }
+    setLayerOption("layer_settings.sample_mode", "off");
+    setLayerOption("layer_settings.sample_period", "1");
+
+    vkFreeCommandBuffers(ctx.device, ctx.command_pool, command_buffer_count, command_buffers.data());
+    return 0;
+}
+
+int bench_retire(Context &ctx, uint32_t command_buffers_per_frame) {
+    static const uint32_t frames_in_flight[] = {1, 2, 3, 4};
+    static const uint32_t max_frames_in_flight = 4;
+    static const uint32_t frames = 512;
+
+    std::vector<VkCommandBuffer> command_buffers =
+        allocate_command_buffers(ctx, max_frames_in_flight * command_buffers_per_frame);
+    if (command_buffers.empty())
+        return 1;
+    // recorded once and resubmitted, so only submission and retirement are timed
+    for (auto command_buffer : command_buffers)
+        record_copies(ctx, command_buffer, 1);
+
+    VkFence fences[max_frames_in_flight];
+    VkFenceCreateInfo fence_info = {};
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    for (uint32_t i = 0; i < max_frames_in_flight; i++) {
+        if (!check(vkCreateFence(ctx.device, &fence_info, NULL, &fences[i]), "vkCreateFence"))
+            return 1;
+    }
+
+    VkSubmitInfo submit_info = {};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.commandBufferCount = command_buffers_per_frame;
+
+    std::printf("%u command buffers per frame, %u frames\n", command_buffers_per_frame, frames);
+    std::printf("%-16s %24s\n", "frames_in_flight", "ns per command buffer");
+    for (size_t n = 0; n < sizeof(frames_in_flight) / sizeof(frames_in_flight[0]); n++) {
+        uint32_t in_flight = frames_in_flight[n];
+
+        Clock::time_point begin = Clock::now();
+        for (uint32_t f = 0; f < frames; f++) {
+            uint32_t slot = f % in_flight;
+            if (f >= in_flight) {
+                vkWaitForFences(ctx.device, 1, &fences[slot], VK_TRUE, UINT64_MAX);
+                vkResetFences(ctx.device, 1, &fences[slot]);
+            }
+            submit_info.pCommandBuffers = &command_buffers[slot * command_buffers_per_frame];
+            vkQueueSubmit(ctx.queue, 1, &submit_info, fences[slot]);
+        }
+        vkQueueWaitIdle(ctx.queue);
+        double ns = ns_since(begin);
+        std::printf("%-16u %24.1f\n", in_flight, ns / (double(frames) * command_buffers_per_frame));
+
+        // the next row starts with every fence unsignaled
+        for (uint32_t i = 0; i < in_flight; i++) {
+            vkWaitForFences(ctx.device, 1, &fences[i], VK_TRUE, UINT64_MAX);
+            vkResetFences(ctx.device, 1, &fences[i]);
+        }
+    }
+
+    for (uint32_t i = 0; i < max_frames_in_flight; i++)
+        vkDestroyFence(ctx.device, fences[i], NULL);
+    vkFreeCommandBuffers(ctx.device, ctx.command_pool, static_cast<uint32_t>(command_buffers.size()),
+                         command_buffers.data());
+    return 0;
+}
+
+void usage() { std::fprintf(stderr, "usage: vk_validation_bench [-v] sampling|retire [command buffers]\n"); }
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int arg = 1;
+    bool verbose = false;
+    if (arg < argc && std::strcmp(argv[arg], "-v") == 0) {
+        verbose = true;
+        arg++;
+    }
+    if (arg >= argc) {
+        usage();
+        return 1;
+    }
+    const char *bench = argv[arg++];
+
+    bool sampling = std::strcmp(bench, "sampling") == 0;
+    if (!sampling && std::strcmp(bench, "retire") != 0) {
+        usage();
+        return 1;
+    }
+
+    uint32_t count = sampling ? 64 : 16;
+    if (arg < argc && std::atoi(argv[arg]) > 0)
+        count = static_cast<uint32_t>(std::atoi(argv[arg++]));
+
+    Context ctx = {};
+    if (!init(ctx, verbose))
+        return 1;
+    int result = sampling ? bench_sampling(ctx, count) : bench_retire(ctx, count);
+    destroy(ctx);
+    return result;
+}
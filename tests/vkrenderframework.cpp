@@ -37,8 +37,46 @@
         assert(fp##entrypoint != NULL);                                        \
     }
 
+// The instance and device shared by the tests of this process, with the
+// layers and extensions they were created with
+struct SharedDevice {
+    std::vector<std::string> instance_layer_names;
+    std::vector<std::string> device_layer_names;
+    std::vector<std::string> instance_extension_names;
+    std::vector<std::string> device_extension_names;
+
+    VkInstance inst;
+    VkPhysicalDevice objs[16];
+    uint32_t gpu_count;
+    VkDeviceObj *device;
+};
+
+static SharedDevice shared_device;
+
+static bool names_match(const std::vector<std::string> &shared_names,
+                        const std::vector<const char *> &names) {
+    if (shared_names.size() != names.size())
+        return false;
+    for (size_t i = 0; i < names.size(); i++) {
+        if (shared_names[i] != names[i])
+            return false;
+    }
+    return true;
+}
+
+bool VkRenderFramework::m_fresh_device = false;
+
+void VkRenderFramework::ReleaseSharedDevice() {
+    delete shared_device.device;
+    if (shared_device.inst)
+        vkDestroyInstance(shared_device.inst, NULL);
+
+    shared_device = SharedDevice();
+}
+
 VkRenderFramework::VkRenderFramework()
-    : m_commandPool(), m_commandBuffer(), m_renderPass(VK_NULL_HANDLE),
+    : inst(VK_NULL_HANDLE), m_device(NULL), m_commandPool(),
+      m_commandBuffer(), m_renderPass(VK_NULL_HANDLE),
       m_framebuffer(VK_NULL_HANDLE), m_width(256.0), // default window width
       m_height(256.0),                               // default window height
       m_render_target_fmt(VK_FORMAT_R8G8B8A8_UNORM),
@@ -46,7 +84,8 @@ VkRenderFramework::VkRenderFramework()
       m_depth_clear_color(1.0), m_stencil_clear_color(0), m_depthStencil(NULL),
       m_CreateDebugReportCallback(VK_NULL_HANDLE),
       m_DestroyDebugReportCallback(VK_NULL_HANDLE),
-      m_globalMsgCallback(VK_NULL_HANDLE), m_devMsgCallback(VK_NULL_HANDLE) {
+      m_globalMsgCallback(VK_NULL_HANDLE), m_devMsgCallback(VK_NULL_HANDLE),
+      m_GetObjectCount(NULL), m_initObjectCount(0) {
 
     memset(&m_renderPassBeginInfo, 0, sizeof(m_renderPassBeginInfo));
     m_renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -82,24 +121,42 @@ void VkRenderFramework::InitFramework(
     std::vector<VkExtensionProperties> device_extensions;
     VkResult U_ASSERT_ONLY err;
 
-    /* TODO: Verify requested extensions are available */
-
-    instInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
-    instInfo.pNext = NULL;
-    instInfo.pApplicationInfo = &app_info;
-    instInfo.enabledLayerCount = instance_layer_names.size();
-    instInfo.ppEnabledLayerNames = instance_layer_names.data();
-    instInfo.enabledExtensionCount = instance_extension_names.size();
-    instInfo.ppEnabledExtensionNames = instance_extension_names.data();
-    err = vkCreateInstance(&instInfo, NULL, &this->inst);
-    ASSERT_VK_SUCCESS(err);
+    const bool reuse =
+        !m_fresh_device && shared_device.device &&
+        names_match(shared_device.instance_layer_names, instance_layer_names) &&
+        names_match(shared_device.device_layer_names, device_layer_names) &&
+        names_match(shared_device.instance_extension_names,
+                    instance_extension_names) &&
+        names_match(shared_device.device_extension_names,
+                    device_extension_names);
+    if (!reuse)
+        ReleaseSharedDevice();
+
+    if (reuse) {
+        this->inst = shared_device.inst;
+        this->gpu_count = shared_device.gpu_count;
+        memcpy(objs, shared_device.objs, sizeof(objs));
+    } else {
+        /* TODO: Verify requested extensions are available */
+
+        instInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        instInfo.pNext = NULL;
+        instInfo.pApplicationInfo = &app_info;
+        instInfo.enabledLayerCount = instance_layer_names.size();
+        instInfo.ppEnabledLayerNames = instance_layer_names.data();
+        instInfo.enabledExtensionCount = instance_extension_names.size();
+        instInfo.ppEnabledExtensionNames = instance_extension_names.data();
+        err = vkCreateInstance(&instInfo, NULL, &this->inst);
+        ASSERT_VK_SUCCESS(err);
+
+        err = vkEnumeratePhysicalDevices(inst, &this->gpu_count, NULL);
+        ASSERT_LE(this->gpu_count, ARRAY_SIZE(objs)) << "Too many gpus";
+        ASSERT_VK_SUCCESS(err);
+        err = vkEnumeratePhysicalDevices(inst, &this->gpu_count, objs);
+        ASSERT_VK_SUCCESS(err);
+        ASSERT_GE(this->gpu_count, (uint32_t)1) << "No GPU available";
+    }
 
-    err = vkEnumeratePhysicalDevices(inst, &this->gpu_count, NULL);
-    ASSERT_LE(this->gpu_count, ARRAY_SIZE(objs)) << "Too many gpus";
-    ASSERT_VK_SUCCESS(err);
-    err = vkEnumeratePhysicalDevices(inst, &this->gpu_count, objs);
-    ASSERT_VK_SUCCESS(err);
-    ASSERT_GE(this->gpu_count, (uint32_t)1) << "No GPU available";
     if (dbgFunction) {
         m_CreateDebugReportCallback =
             (PFN_vkCreateDebugReportCallbackEXT)vkGetInstanceProcAddr(
@@ -137,9 +194,29 @@ void VkRenderFramework::InitFramework(
         }
     }
 
-    /* TODO: Verify requested physical device extensions are available */
-    m_device =
-        new VkDeviceObj(0, objs[0], device_layer_names, device_extension_names);
+    if (reuse) {
+        m_device = shared_device.device;
+    } else {
+        /* TODO: Verify requested physical device extensions are available */
+        m_device = new VkDeviceObj(0, objs[0], device_layer_names,
+                                   device_extension_names);
+
+        if (!m_fresh_device) {
+            shared_device.instance_layer_names.assign(
+                instance_layer_names.begin(), instance_layer_names.end());
+            shared_device.device_layer_names.assign(device_layer_names.begin(),
+                                                    device_layer_names.end());
+            shared_device.instance_extension_names.assign(
+                instance_extension_names.begin(),
+                instance_extension_names.end());
+            shared_device.device_extension_names.assign(
+                device_extension_names.begin(), device_extension_names.end());
+            shared_device.inst = this->inst;
+            memcpy(shared_device.objs, objs, sizeof(objs));
+            shared_device.gpu_count = this->gpu_count;
+            shared_device.device = m_device;
+        }
+    }
 
     /* Now register callback on device */
     if (0) {
@@ -158,10 +235,30 @@ void VkRenderFramework::InitFramework(
     }
     m_device->get_device_queue();
 
+    // objTrackGetObjectCount is there only with the object tracker loaded
+    m_GetObjectCount = (uint64_t(*)(VkDevice))vkGetDeviceProcAddr(
+        device(), "objTrackGetObjectCount");
+    if (m_GetObjectCount)
+        m_initObjectCount = ObjectCount();
+
     m_depthStencil = new VkDepthStencilObj();
 }
 
+// Objects the object tracker counts, less the empty memory blocks the pool
+// keeps for the next test
+uint64_t VkRenderFramework::ObjectCount() {
+    return m_GetObjectCount(device()) -
+           m_device->memory_pool().stats().block_count;
+}
+
 void VkRenderFramework::ShutdownFramework() {
+    const bool shared = m_device && m_device == shared_device.device;
+
+    // nothing this test submitted may still be running when its objects
+    // are destroyed and the device is handed to the next test
+    if (shared)
+        vkDeviceWaitIdle(device());
+
     delete m_commandBuffer;
     if (m_commandPool)
         vkDestroyCommandPool(device(), m_commandPool, NULL);
@@ -176,20 +273,23 @@ void VkRenderFramework::ShutdownFramework() {
         m_DestroyDebugReportCallback(this->inst, m_devMsgCallback, NULL);
 
     while (!m_renderTargets.empty()) {
-        vkDestroyImageView(
-            device(), m_renderTargets.back()->targetView(m_render_target_fmt),
-            NULL);
-        vkDestroyImage(device(), m_renderTargets.back()->image(), NULL);
-        vkFreeMemory(device(), m_renderTargets.back()->memory(), NULL);
+        delete m_renderTargets.back();
         m_renderTargets.pop_back();
     }
 
     delete m_depthStencil;
 
-    // reset the driver
-    delete m_device;
-    if (this->inst)
-        vkDestroyInstance(this->inst, NULL);
+    // reset the driver, unless later tests share it.  Shared state that a
+    // failed test may have left inconsistent, or that holds objects the test
+    // did not destroy, is not handed on either.
+    if (!shared) {
+        delete m_device;
+        if (this->inst)
+            vkDestroyInstance(this->inst, NULL);
+    } else if (::testing::Test::HasFailure() ||
+               (m_GetObjectCount && ObjectCount() > m_initObjectCount)) {
+        ReleaseSharedDevice();
+    }
 }
 
 void VkRenderFramework::InitState() {
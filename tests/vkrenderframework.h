@@ -100,6 +100,16 @@ class VkRenderFramework : public VkTestFramework {
     void ShutdownFramework();
     void InitState();
 
+    // Unless m_fresh_device is set, InitFramework creates the instance and
+    // device only for the first test of the process, and again when a test
+    // asks for different layers or extensions.  Later tests share them, and
+    // ShutdownFramework destroys only what the test itself created.  A test
+    // that failed, or that left objects behind by the count of the object
+    // tracker layer when it is loaded, releases them instead, so that the
+    // next test starts from a fresh device.
+    static bool m_fresh_device;
+    static void ReleaseSharedDevice();
+
     const VkRenderPassBeginInfo &renderPassBeginInfo() const {
         return m_renderPassBeginInfo;
     }
@@ -142,6 +152,9 @@ class VkRenderFramework : public VkTestFramework {
     PFN_vkDebugReportMessageEXT m_DebugReportMessage;
     VkDebugReportCallbackEXT m_globalMsgCallback;
     VkDebugReportCallbackEXT m_devMsgCallback;
+    uint64_t (*m_GetObjectCount)(VkDevice);
+    uint64_t m_initObjectCount;
+    uint64_t ObjectCount();
 
     /*
      * SetUp and TearDown are called by the Google Test framework
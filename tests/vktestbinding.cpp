@@ -26,7 +26,9 @@
  * Author: Tony Barbour <tony@LunarG.com>
  */
 
+#include <algorithm>
 #include <iostream>
+#include <set>
 #include <string.h> // memset(), memcmp()
 #include <assert.h>
 #include <stdarg.h>
@@ -54,6 +56,7 @@ namespace {
                                     __FUNCTION__))
 
 vk_testing::ErrorCallback error_callback;
+bool dedicated_memory;
 
 bool expect_failure(const char *expr, const char *file, unsigned int line,
                     const char *function) {
@@ -93,6 +96,10 @@ namespace vk_testing {
 
 void set_error_callback(ErrorCallback callback) { error_callback = callback; }
 
+void set_dedicated_memory(bool dedicated) { dedicated_memory = dedicated; }
+
+bool get_dedicated_memory() { return dedicated_memory; }
+
 VkPhysicalDeviceProperties PhysicalDevice::properties() const {
     VkPhysicalDeviceProperties info;
 
@@ -269,9 +276,18 @@ Device::~Device() {
         queues_[i].clear();
     }
 
+    delete memory_pool_;
+    memory_pool_ = NULL;
+
     vkDestroyDevice(handle(), NULL);
 }
 
+MemoryPool &Device::memory_pool() const {
+    if (!memory_pool_)
+        memory_pool_ = new MemoryPool(*this);
+    return *memory_pool_;
+}
+
 void Device::init(std::vector<const char *> &layers,
                   std::vector<const char *> &extensions) {
     // request all queues
@@ -439,8 +455,260 @@ void Queue::submit(const CommandBuffer &cmd) {
 
 void Queue::wait() { EXPECT(vkQueueWaitIdle(handle()) == VK_SUCCESS); }
 
+// Blocks are split into power of two ranges of at least MIN_RANGE_SIZE
+// bytes, each aligned to its size.  free_offsets[order] holds the offsets of
+// the free ranges of MIN_RANGE_SIZE << order bytes.
+struct MemoryPool::Block {
+    VkDeviceMemory memory;
+    uint32_t memory_type_index;
+    Kind kind;
+    VkDeviceSize size;
+    bool dedicated;
+    void *mapped;
+    uint32_t range_count;
+    std::vector<std::set<VkDeviceSize>> free_offsets;
+};
+
+namespace {
+
+const VkDeviceSize MIN_RANGE_SIZE = 256;
+const VkDeviceSize MAX_BLOCK_SIZE = 16 * 1024 * 1024;
+
+uint32_t range_order(VkDeviceSize size) {
+    uint32_t order = 0;
+    while ((MIN_RANGE_SIZE << order) < size)
+        order++;
+    return order;
+}
+
+} // namespace
+
+MemoryPool::MemoryPool(const Device &dev)
+    : dev_(dev.handle()), memory_props_(dev.phy().memory_properties()),
+      granularity_(dev.phy().properties().limits.bufferImageGranularity),
+      stats_() {}
+
+MemoryPool::~MemoryPool() {
+    for (uint32_t i = 0; i < VK_MAX_MEMORY_TYPES; i++) {
+        for (int kind = 0; kind < KIND_COUNT; kind++) {
+            for (std::vector<Block *>::iterator it = blocks_[i][kind].begin();
+                 it != blocks_[i][kind].end(); it++)
+                destroy_block(*it);
+        }
+    }
+}
+
+VkDeviceSize MemoryPool::block_size(uint32_t memory_type_index) const {
+    const VkMemoryType &type = memory_props_.memoryTypes[memory_type_index];
+    const VkDeviceSize heap_size =
+        memory_props_.memoryHeaps[type.heapIndex].size;
+
+    // leave most of small heaps to what allocates memory itself
+    VkDeviceSize size = MAX_BLOCK_SIZE;
+    while (size > MIN_RANGE_SIZE && size > heap_size / 8)
+        size /= 2;
+
+    return size;
+}
+
+MemoryPool::Block *MemoryPool::create_block(uint32_t memory_type_index,
+                                            Kind kind, VkDeviceSize size,
+                                            bool dedicated) {
+    VkMemoryAllocateInfo info =
+        DeviceMemory::alloc_info(size, memory_type_index);
+    VkDeviceMemory memory;
+    if (vkAllocateMemory(dev_, &info, NULL, &memory) != VK_SUCCESS)
+        return NULL;
+
+    Block *block = new Block;
+    block->memory = memory;
+    block->memory_type_index = memory_type_index;
+    block->kind = kind;
+    block->size = size;
+    block->dedicated = dedicated;
+    block->mapped = NULL;
+    block->range_count = 0;
+    if (!dedicated) {
+        block->free_offsets.resize(range_order(size) + 1);
+        block->free_offsets.back().insert(0);
+    }
+
+    stats_.vk_allocation_count++;
+
+    return block;
+}
+
+void MemoryPool::destroy_block(Block *block) {
+    if (block->mapped)
+        vkUnmapMemory(dev_, block->memory);
+    vkFreeMemory(dev_, block->memory, NULL);
+    delete block;
+}
+
+VkResult MemoryPool::alloc(const VkMemoryRequirements &reqs,
+                           uint32_t memory_type_index, Kind kind,
+                           bool dedicated, Range &range) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<Block *> &blocks = blocks_[memory_type_index][kind];
+    const VkDeviceSize max_size = block_size(memory_type_index);
+
+    // Ranges are aligned to their size.  Images take whole granules so that
+    // linear and optimal ones never share one.
+    VkDeviceSize size = std::max(reqs.size, reqs.alignment);
+    if (kind == IMAGE)
+        size = std::max(size, granularity_);
+
+    if (dedicated || size > max_size / 2) {
+        Block *block = create_block(memory_type_index, kind, reqs.size, true);
+        if (!block)
+            return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        blocks.push_back(block);
+
+        block->range_count = 1;
+        range.block = block;
+        range.offset = 0;
+        range.order = 0;
+
+        stats_.dedicated_count++;
+        stats_.dedicated_bytes += block->size;
+
+        return VK_SUCCESS;
+    }
+
+    const uint32_t order = range_order(size);
+
+    // the block with the smallest free range that fits, new if none has one
+    Block *block = NULL;
+    uint32_t free_order = 0;
+    for (std::vector<Block *>::iterator it = blocks.begin(); it != blocks.end();
+         it++) {
+        if ((*it)->dedicated)
+            continue;
+        const uint32_t end = block ? free_order
+                                   : static_cast<uint32_t>(
+                                         (*it)->free_offsets.size());
+        for (uint32_t i = order; i < end; i++) {
+            if (!(*it)->free_offsets[i].empty()) {
+                block = *it;
+                free_order = i;
+                break;
+            }
+        }
+        if (block && free_order == order)
+            break;
+    }
+
+    if (!block) {
+        block = create_block(memory_type_index, kind, max_size, false);
+        if (!block)
+            return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        blocks.push_back(block);
+        free_order = static_cast<uint32_t>(block->free_offsets.size() - 1);
+
+        stats_.block_count++;
+        stats_.block_bytes += block->size;
+    }
+
+    // split the free range down to the order asked for, freeing the upper
+    // halves
+    std::set<VkDeviceSize> &free_offsets = block->free_offsets[free_order];
+    const VkDeviceSize offset = *free_offsets.begin();
+    free_offsets.erase(free_offsets.begin());
+    while (free_order > order) {
+        free_order--;
+        block->free_offsets[free_order].insert(offset +
+                                               (MIN_RANGE_SIZE << free_order));
+    }
+
+    block->range_count++;
+    range.block = block;
+    range.offset = offset;
+    range.order = order;
+
+    stats_.suballocation_count++;
+    stats_.suballocated_bytes += MIN_RANGE_SIZE << order;
+    stats_.suballocation_total++;
+
+    return VK_SUCCESS;
+}
+
+void MemoryPool::free(const Range &range) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Block *block = range.block;
+    std::vector<Block *> &blocks =
+        blocks_[block->memory_type_index][block->kind];
+
+    if (block->dedicated) {
+        stats_.dedicated_count--;
+        stats_.dedicated_bytes -= block->size;
+    } else {
+        // merge the range with its free buddies
+        VkDeviceSize offset = range.offset;
+        uint32_t order = range.order;
+        while (order + 1 < block->free_offsets.size()) {
+            const VkDeviceSize buddy = offset ^ (MIN_RANGE_SIZE << order);
+            if (!block->free_offsets[order].erase(buddy))
+                break;
+            offset = std::min(offset, buddy);
+            order++;
+        }
+        block->free_offsets[order].insert(offset);
+
+        stats_.suballocation_count--;
+        stats_.suballocated_bytes -= MIN_RANGE_SIZE << range.order;
+    }
+
+    if (--block->range_count)
+        return;
+
+    // keep one empty block of each list for the next test to reuse
+    if (!block->dedicated) {
+        size_t pooled = 0;
+        for (std::vector<Block *>::iterator it = blocks.begin();
+             it != blocks.end(); it++) {
+            if (!(*it)->dedicated)
+                pooled++;
+        }
+        if (pooled == 1)
+            return;
+
+        stats_.block_count--;
+        stats_.block_bytes -= block->size;
+    }
+
+    blocks.erase(std::find(blocks.begin(), blocks.end(), block));
+    destroy_block(block);
+}
+
+void *MemoryPool::map(const Range &range) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Block *block = range.block;
+    if (!block->mapped &&
+        vkMapMemory(dev_, block->memory, 0, VK_WHOLE_SIZE, 0,
+                    &block->mapped) != VK_SUCCESS)
+        block->mapped = NULL;
+
+    if (!block->mapped)
+        return NULL;
+
+    return static_cast<char *>(block->mapped) + range.offset;
+}
+
+MemoryPool::Stats MemoryPool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
 DeviceMemory::~DeviceMemory() {
-    if (initialized())
+    if (!initialized())
+        return;
+
+    if (pool_)
+        pool_->free(range_);
+    else
         vkFreeMemory(device(), handle(), NULL);
 }
 
@@ -448,7 +716,30 @@ void DeviceMemory::init(const Device &dev, const VkMemoryAllocateInfo &info) {
     NON_DISPATCHABLE_HANDLE_INIT(vkAllocateMemory, dev, &info);
 }
 
+void DeviceMemory::init(const Device &dev, const VkMemoryRequirements &reqs,
+                        uint32_t memory_type_index, MemoryPool::Kind kind,
+                        bool dedicated) {
+    MemoryPool &pool = dev.memory_pool();
+    if (!EXPECT(pool.alloc(reqs, memory_type_index, kind, dedicated, range_) ==
+                VK_SUCCESS))
+        return;
+
+    NonDispHandle::init(dev.handle(), range_.block->memory);
+    pool_ = &pool;
+}
+
+bool DeviceMemory::suballocated() const {
+    return pool_ && !range_.block->dedicated;
+}
+
 const void *DeviceMemory::map(VkFlags flags) const {
+    // ranges of a block share its mapping, which lasts as long as the block
+    if (suballocated()) {
+        void *data = pool_->map(range_);
+        EXPECT(data != NULL);
+        return data;
+    }
+
     void *data;
     if (!EXPECT(vkMapMemory(device(), handle(), 0, VK_WHOLE_SIZE, flags,
                             &data) == VK_SUCCESS))
@@ -458,15 +749,14 @@ const void *DeviceMemory::map(VkFlags flags) const {
 }
 
 void *DeviceMemory::map(VkFlags flags) {
-    void *data;
-    if (!EXPECT(vkMapMemory(device(), handle(), 0, VK_WHOLE_SIZE, flags,
-                            &data) == VK_SUCCESS))
-        data = NULL;
-
-    return data;
+    return const_cast<void *>(
+        static_cast<const DeviceMemory *>(this)->map(flags));
 }
 
-void DeviceMemory::unmap() const { vkUnmapMemory(device(), handle()); }
+void DeviceMemory::unmap() const {
+    if (!suballocated())
+        vkUnmapMemory(device(), handle());
+}
 
 NON_DISPATCHABLE_HANDLE_DTOR(Fence, vkDestroyFence)
 
@@ -510,10 +800,23 @@ NON_DISPATCHABLE_HANDLE_DTOR(Buffer, vkDestroyBuffer)
 void Buffer::init(const Device &dev, const VkBufferCreateInfo &info,
                   VkMemoryPropertyFlags mem_props) {
     init_no_mem(dev, info);
+    init_memory(dev, mem_props, dedicated_memory);
+}
+
+void Buffer::init_dedicated(const Device &dev, const VkBufferCreateInfo &info,
+                            VkMemoryPropertyFlags mem_props) {
+    init_no_mem(dev, info);
+    init_memory(dev, mem_props, true);
+}
 
+void Buffer::init_memory(const Device &dev, VkMemoryPropertyFlags mem_props,
+                         bool dedicated) {
+    const VkMemoryRequirements reqs = memory_requirements();
     internal_mem_.init(
-        dev, get_resource_alloc_info(dev, memory_requirements(), mem_props));
-    bind_memory(internal_mem_, 0);
+        dev, reqs,
+        get_resource_alloc_info(dev, reqs, mem_props).memoryTypeIndex,
+        MemoryPool::BUFFER, dedicated);
+    bind_memory(internal_mem_, internal_mem_.offset());
 }
 
 void Buffer::init_no_mem(const Device &dev, const VkBufferCreateInfo &info) {
@@ -545,10 +848,23 @@ NON_DISPATCHABLE_HANDLE_DTOR(Image, vkDestroyImage)
 void Image::init(const Device &dev, const VkImageCreateInfo &info,
                  VkMemoryPropertyFlags mem_props) {
     init_no_mem(dev, info);
+    init_memory(dev, mem_props, dedicated_memory);
+}
+
+void Image::init_dedicated(const Device &dev, const VkImageCreateInfo &info,
+                           VkMemoryPropertyFlags mem_props) {
+    init_no_mem(dev, info);
+    init_memory(dev, mem_props, true);
+}
 
+void Image::init_memory(const Device &dev, VkMemoryPropertyFlags mem_props,
+                        bool dedicated) {
+    const VkMemoryRequirements reqs = memory_requirements();
     internal_mem_.init(
-        dev, get_resource_alloc_info(dev, memory_requirements(), mem_props));
-    bind_memory(internal_mem_, 0);
+        dev, reqs,
+        get_resource_alloc_info(dev, reqs, mem_props).memoryTypeIndex,
+        MemoryPool::IMAGE, dedicated);
+    bind_memory(internal_mem_, internal_mem_.offset());
 }
 
 void Image::init_no_mem(const Device &dev, const VkImageCreateInfo &info) {
@@ -29,6 +29,7 @@
 #ifndef VKTESTBINDING_H
 #define VKTESTBINDING_H
 
+#include <mutex>
 #include <vector>
 #include <assert.h>
 
@@ -40,9 +41,16 @@ typedef void (*ErrorCallback)(const char *expr, const char *file,
                               unsigned int line, const char *function);
 void set_error_callback(ErrorCallback callback);
 
+// Give every buffer and image created with memory a VkDeviceMemory of its
+// own, as init_dedicated() does, rather than suballocating from the device's
+// MemoryPool.
+void set_dedicated_memory(bool dedicated);
+bool get_dedicated_memory();
+
 class PhysicalDevice;
 class Device;
 class Queue;
+class MemoryPool;
 class DeviceMemory;
 class Fence;
 class Semaphore;
@@ -149,7 +157,7 @@ class PhysicalDevice : public internal::Handle<VkPhysicalDevice> {
 
 class Device : public internal::Handle<VkDevice> {
   public:
-    explicit Device(VkPhysicalDevice phy) : phy_(phy) {}
+    explicit Device(VkPhysicalDevice phy) : phy_(phy), memory_pool_(NULL) {}
     ~Device();
 
     // vkCreateDevice()
@@ -165,6 +173,9 @@ class Device : public internal::Handle<VkDevice> {
 
     const PhysicalDevice &phy() const { return phy_; }
 
+    // where buffers and images created with memory get it from
+    MemoryPool &memory_pool() const;
+
     // vkGetDeviceProcAddr()
     PFN_vkVoidFunction get_proc(const char *name) const {
         return vkGetDeviceProcAddr(handle(), name);
@@ -254,6 +265,8 @@ class Device : public internal::Handle<VkDevice> {
 
     std::vector<Queue *> queues_[QUEUE_COUNT];
     std::vector<Format> formats_;
+
+    mutable MemoryPool *memory_pool_;
 };
 
 class Queue : public internal::Handle<VkQueue> {
@@ -276,13 +289,96 @@ class Queue : public internal::Handle<VkQueue> {
     int family_index_;
 };
 
+// Suballocates the memory of buffers and images from large VkDeviceMemory
+// blocks, so that tests creating many small ones stay far from
+// maxMemoryAllocationCount and rarely call vkAllocateMemory.  Each memory
+// type has blocks for buffers and blocks for images, as mem_tracker reports
+// any buffer and image bound to overlapping granules of the same memory as
+// aliased, even after they are destroyed.  Blocks are split buddy style, so a
+// request gets the smallest power of two range that holds its size and
+// alignment.  Requests for more than half a block, and those asked to be
+// dedicated, get a VkDeviceMemory of their own.
+class MemoryPool {
+  public:
+    enum Kind {
+        BUFFER,
+        IMAGE,
+        KIND_COUNT,
+    };
+
+    struct Block;
+
+    // a range of a block, all of it if the block is dedicated
+    struct Range {
+        Block *block;
+        VkDeviceSize offset;
+        uint32_t order;
+    };
+
+    struct Stats {
+        // buffers and images sharing blocks, and blocks they share
+        uint32_t suballocation_count;
+        uint32_t block_count;
+        VkDeviceSize suballocated_bytes;
+        VkDeviceSize block_bytes;
+        // buffers and images with memory of their own
+        uint32_t dedicated_count;
+        VkDeviceSize dedicated_bytes;
+        // made since the pool was created
+        uint64_t vk_allocation_count;
+        uint64_t suballocation_total;
+    };
+
+    explicit MemoryPool(const Device &dev);
+    ~MemoryPool();
+
+    // vkAllocateMemory(), unless a block has room for reqs
+    VkResult alloc(const VkMemoryRequirements &reqs, uint32_t memory_type_index,
+                   Kind kind, bool dedicated, Range &range);
+    void free(const Range &range);
+
+    // vkMapMemory() of the whole block, on first use
+    void *map(const Range &range);
+
+    Stats stats() const;
+
+  private:
+    // MemoryPool is non-copyable
+    MemoryPool(const MemoryPool &);
+    MemoryPool &operator=(const MemoryPool &);
+
+    VkDeviceSize block_size(uint32_t memory_type_index) const;
+    Block *create_block(uint32_t memory_type_index, Kind kind,
+                        VkDeviceSize size, bool dedicated);
+    void destroy_block(Block *block);
+
+    VkDevice dev_;
+    VkPhysicalDeviceMemoryProperties memory_props_;
+    VkDeviceSize granularity_;
+
+    mutable std::mutex mutex_;
+    std::vector<Block *> blocks_[VK_MAX_MEMORY_TYPES][KIND_COUNT];
+    Stats stats_;
+};
+
 class DeviceMemory : public internal::NonDispHandle<VkDeviceMemory> {
   public:
+    DeviceMemory() : pool_(NULL), range_() {}
     ~DeviceMemory();
 
     // vkAllocateMemory()
     void init(const Device &dev, const VkMemoryAllocateInfo &info);
 
+    // memory for a buffer or an image, from the device's MemoryPool
+    void init(const Device &dev, const VkMemoryRequirements &reqs,
+              uint32_t memory_type_index, MemoryPool::Kind kind,
+              bool dedicated);
+
+    // where the memory starts in handle(), which other buffers or images may
+    // be bound to unless it is dedicated
+    VkDeviceSize offset() const { return range_.offset; }
+    bool suballocated() const;
+
     // vkMapMemory()
     const void *map(VkFlags flags) const;
     void *map(VkFlags flags);
@@ -294,6 +390,10 @@ class DeviceMemory : public internal::NonDispHandle<VkDeviceMemory> {
 
     static VkMemoryAllocateInfo alloc_info(VkDeviceSize size,
                                            uint32_t memory_type_index);
+
+  private:
+    MemoryPool *pool_;
+    MemoryPool::Range range_;
 };
 
 class Fence : public internal::NonDispHandle<VkFence> {
@@ -388,6 +488,9 @@ class Buffer : public internal::NonDispHandle<VkBuffer> {
              reqs);
     }
     void init_no_mem(const Device &dev, const VkBufferCreateInfo &info);
+    // with a VkDeviceMemory of its own rather than a range of a shared one
+    void init_dedicated(const Device &dev, const VkBufferCreateInfo &info,
+                        VkMemoryPropertyFlags mem_props);
 
     // get the internal memory
     const DeviceMemory &memory() const { return internal_mem_; }
@@ -416,6 +519,9 @@ class Buffer : public internal::NonDispHandle<VkBuffer> {
     }
 
   private:
+    void init_memory(const Device &dev, VkMemoryPropertyFlags mem_props,
+                     bool dedicated);
+
     VkBufferCreateInfo create_info_;
 
     DeviceMemory internal_mem_;
@@ -446,6 +552,9 @@ class Image : public internal::NonDispHandle<VkImage> {
         init(dev, info, 0);
     }
     void init_no_mem(const Device &dev, const VkImageCreateInfo &info);
+    // with a VkDeviceMemory of its own rather than a range of a shared one
+    void init_dedicated(const Device &dev, const VkImageCreateInfo &info,
+                        VkMemoryPropertyFlags mem_props);
 
     // get the internal memory
     const DeviceMemory &memory() const { return internal_mem_; }
@@ -527,6 +636,8 @@ class Image : public internal::NonDispHandle<VkImage> {
 
   private:
     void init_info(const Device &dev, const VkImageCreateInfo &info);
+    void init_memory(const Device &dev, VkMemoryPropertyFlags mem_props,
+                     bool dedicated);
 
     VkImageCreateInfo create_info_;
     VkFlags format_features_;
@@ -33,6 +33,7 @@
 #undef BadValue
 #include "SPIRV/GlslangToSpv.h"
 #include "SPIRV/SPVRemapper.h"
+#include "spirv_cache.h"
 #include <limits.h>
 #include <math.h>
 
@@ -133,7 +134,11 @@ void TestEnvironment::SetUp() {
     vk_testing::set_error_callback(test_error_callback);
 }
 
-void TestEnvironment::TearDown() { glslang::FinalizeProcess(); }
+void TestEnvironment::TearDown() {
+    VkRenderFramework::ReleaseSharedDevice();
+
+    glslang::FinalizeProcess();
+}
 
 VkTestFramework::VkTestFramework()
     : m_compile_options(0), m_num_shader_strings(0) {}
@@ -165,6 +170,10 @@ void VkTestFramework::InitArgs(int *argc, char *argv[]) {
             m_strip_spv = true;
         else if (optionMatch("--canonicalize-SPV", argv[i]))
             m_canonicalize_spv = true;
+        else if (optionMatch("--fresh-device", argv[i]))
+            VkRenderFramework::m_fresh_device = true;
+        else if (optionMatch("--dedicated-memory", argv[i]))
+            vk_testing::set_dedicated_memory(true);
         else if (optionMatch("--help", argv[i]) || optionMatch("-h", argv[i])) {
             printf("\nOther options:\n");
             printf("\t--show-images\n"
@@ -192,6 +201,14 @@ void VkTestFramework::InitArgs(int *argc, char *argv[]) {
             printf(
                 "\t--canonicalize-SPV\n"
                 "\t\tRemap SPIR-V ids before submission to aid compression.\n");
+            printf("\t--fresh-device\n"
+                   "\t\tCreate an instance and device for each test rather "
+                   "than\n"
+                   "\t\tsharing them between the tests of the process.\n");
+            printf("\t--dedicated-memory\n"
+                   "\t\tGive each buffer and image memory of its own rather "
+                   "than\n"
+                   "\t\tsuballocating it from blocks shared with others.\n");
             exit(0);
         } else {
             printf("\nUnrecognized option: %s\n", argv[i]);
@@ -733,39 +750,55 @@ VkTestFramework::FindLanguage(const VkShaderStageFlagBits shader_type) {
 bool VkTestFramework::GLSLtoSPV(const VkShaderStageFlagBits shader_type,
                                 const char *pshader,
                                 std::vector<unsigned int> &spirv) {
-    glslang::TProgram program;
     const char *shaderStrings[1];
 
-    // TODO: Do we want to load a special config file depending on the
-    // shader source? Optional name maybe?
-    //    SetConfigFile(fileName);
-
-    ProcessConfigFile();
-
     EShMessages messages = EShMsgDefault;
     SetMessageOptions(messages);
     messages =
         static_cast<EShMessages>(messages | EShMsgSpvRules | EShMsgVulkanRules);
 
     EShLanguage stage = FindLanguage(shader_type);
-    glslang::TShader *shader = new glslang::TShader(stage);
+    const int version =
+        (m_compile_options & EOptionDefaultDesktop) ? 110 : 100;
+
+    // Most tests compile the same few shaders, so reuse earlier compiles
+    // unless a config file may change the resources or reflection is to
+    // be dumped.  The options cover what is done to the SPIR-V below.
+    const bool use_cache =
+        ConfigFile.empty() && !(m_compile_options & EOptionDumpReflection);
+    uint64_t cache_key = 0;
+    if (use_cache) {
+        char options[64];
+        snprintf(options, sizeof(options), "version=%d remap=%d%d%d", version,
+                 m_canonicalize_spv, m_strip_spv, m_do_everything_spv);
+        cache_key = spirv_cache::Key(stage, messages, pshader, options);
+        if (spirv_cache::Lookup(cache_key, spirv))
+            return true;
+    }
+
+    // TODO: Do we want to load a special config file depending on the
+    // shader source? Optional name maybe?
+    //    SetConfigFile(fileName);
+
+    ProcessConfigFile();
+
+    glslang::TShader shader(stage);
+    glslang::TProgram program;
 
     shaderStrings[0] = pshader;
-    shader->setStrings(shaderStrings, 1);
+    shader.setStrings(shaderStrings, 1);
 
-    if (!shader->parse(&Resources,
-                       (m_compile_options & EOptionDefaultDesktop) ? 110 : 100,
-                       false, messages)) {
+    if (!shader.parse(&Resources, version, false, messages)) {
 
         if (!(m_compile_options & EOptionSuppressInfolog)) {
-            puts(shader->getInfoLog());
-            puts(shader->getInfoDebugLog());
+            puts(shader.getInfoLog());
+            puts(shader.getInfoDebugLog());
         }
 
         return false; // something didn't work
     }
 
-    program.addShader(shader);
+    program.addShader(&shader);
 
     //
     // Program-level processing...
@@ -774,8 +807,8 @@ bool VkTestFramework::GLSLtoSPV(const VkShaderStageFlagBits shader_type,
     if (!program.link(messages)) {
 
         if (!(m_compile_options & EOptionSuppressInfolog)) {
-            puts(shader->getInfoLog());
-            puts(shader->getInfoDebugLog());
+            puts(shader.getInfoLog());
+            puts(shader.getInfoDebugLog());
         }
 
         return false;
@@ -803,7 +836,8 @@ bool VkTestFramework::GLSLtoSPV(const VkShaderStageFlagBits shader_type,
         spv::spirvbin_t(0).remap(spirv, spv::spirvbin_t::DO_EVERYTHING);
     }
 
-    delete shader;
+    if (use_cache)
+        spirv_cache::Store(cache_key, spirv);
 
     return true;
 }
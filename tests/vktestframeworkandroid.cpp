@@ -25,6 +25,7 @@
 //  USE OR OTHER DEALINGS IN THE MATERIALS.
 
 #include "vktestframeworkandroid.h"
+#include "vkrenderframework.h"
 
 VkTestFramework::VkTestFramework() {}
 VkTestFramework::~VkTestFramework() {}
@@ -66,4 +67,7 @@ void TestEnvironment::SetUp()
     vk_testing::set_error_callback(test_error_callback);
 }
 
-void TestEnvironment::TearDown() {}
+void TestEnvironment::TearDown()
+{
+    VkRenderFramework::ReleaseSharedDevice();
+}
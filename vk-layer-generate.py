@@ -391,6 +391,16 @@ class Subcommand(object):
           ggep_body.append('        VK_API_VERSION, // specVersion')
           ggep_body.append('        1, // implementationVersion')
           ggep_body.append('        "Google Validation Layer"')
+        elif self.layer_name == 'timing':
+          ggep_body.append('        "VK_LAYER_LUNARG_%s",' % layer)
+          ggep_body.append('        VK_API_VERSION, // specVersion')
+          ggep_body.append('        1, // implementationVersion')
+          ggep_body.append('        "LunarG Timing Layer"')
+        elif self.layer_name == 'capture':
+          ggep_body.append('        "VK_LAYER_LUNARG_%s",' % layer)
+          ggep_body.append('        VK_API_VERSION, // specVersion')
+          ggep_body.append('        1, // implementationVersion')
+          ggep_body.append('        "LunarG Capture Layer"')
         else:
           ggep_body.append('        "VK_LAYER_LUNARG_%s",' % layer)
           ggep_body.append('        VK_API_VERSION, // specVersion')
@@ -417,6 +427,16 @@ class Subcommand(object):
           gpdlp_body.append('        VK_API_VERSION, // specVersion')
           gpdlp_body.append('        1, // implementationVersion')
           gpdlp_body.append('        "Google Validation Layer"')
+        elif self.layer_name == 'timing':
+          gpdlp_body.append('        "VK_LAYER_LUNARG_%s",' % layer)
+          gpdlp_body.append('        VK_API_VERSION, // specVersion')
+          gpdlp_body.append('        1, // implementationVersion')
+          gpdlp_body.append('        "LunarG Timing Layer"')
+        elif self.layer_name == 'capture':
+          gpdlp_body.append('        "VK_LAYER_LUNARG_%s",' % layer)
+          gpdlp_body.append('        VK_API_VERSION, // specVersion')
+          gpdlp_body.append('        1, // implementationVersion')
+          gpdlp_body.append('        "LunarG Capture Layer"')
         else:
           gpdlp_body.append('        "VK_LAYER_LUNARG_%s",' % layer)
           gpdlp_body.append('        VK_API_VERSION, // specVersion')
@@ -524,7 +544,7 @@ class Subcommand(object):
 #
 # New style of GPA Functions for the new layer_data/layer_logging changes
 #
-        if self.layer_name in ['object_tracker', 'threading', 'unique_objects']:
+        if self.layer_name in ['object_tracker', 'threading', 'unique_objects', 'timing', 'capture']:
             func_body.append("VK_LAYER_EXPORT VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetDeviceProcAddr(VkDevice device, const char* funcName)\n"
                              "{\n"
                              "    PFN_vkVoidFunction addr;\n"
@@ -1418,7 +1438,8 @@ class ObjectTrackerSubcommand(Subcommand):
 
     def generate_body(self):
         self.layer_name = "object_tracker"
-        extensions=[('wsi_enabled',
+        extensions=[('', ['objTrackGetObjectCount', 'objTrackGetObjectsOfTypeCount']),
+                    ('wsi_enabled',
                      ['vkCreateSwapchainKHR',
                       'vkDestroySwapchainKHR', 'vkGetSwapchainImagesKHR',
                       'vkAcquireNextImageKHR', 'vkQueuePresentKHR'])]
@@ -2049,6 +2070,446 @@ class ThreadingSubcommand(Subcommand):
                 self._gen_debug_report_msg()]
         return "\n\n".join(body)
 
+class TimingSubcommand(Subcommand):
+    # Entry points the layer answers itself or leaves to the rest of the chain
+    untimed_functions = ['GetInstanceProcAddr',
+                         'GetDeviceProcAddr',
+                         'EnumerateInstanceExtensionProperties',
+                         'EnumerateInstanceLayerProperties',
+                         'EnumerateDeviceExtensionProperties',
+                         'EnumerateDeviceLayerProperties',
+                         ]
+    # Calls that set up or tear down the layer's dispatch tables
+    explicit_timing_functions = ['CreateInstance',
+                                 'DestroyInstance',
+                                 'CreateDevice',
+                                 'DestroyDevice',
+                                 ]
+
+    def _timed_protos(self):
+        return [proto for proto in self.protos if proto.name not in self.untimed_functions]
+
+    def generate_header(self):
+        header_txt = []
+        header_txt.append('%s' % self.lineinfo.get())
+        header_txt.append('enum TimingEntryPoint {')
+        for proto in self._timed_protos():
+            header_txt.append('    TIMING_vk%s,' % proto.name)
+        header_txt.append('    TIMING_ENTRY_POINT_COUNT')
+        header_txt.append('};')
+        header_txt.append('')
+        header_txt.append('static const char *const timingEntryPointNames[TIMING_ENTRY_POINT_COUNT] = {')
+        for proto in self._timed_protos():
+            header_txt.append('    "vk%s",' % proto.name)
+        header_txt.append('};')
+        header_txt.append('')
+        header_txt.append('#include "timing.h"')
+        return "\n".join(header_txt)
+
+    def generate_intercept(self, proto, qual):
+        if proto.name in self.untimed_functions:
+            return None
+        decl = proto.c_func(prefix="vk", attr="VKAPI")
+        ret_val = ''
+        ret_stmt = ''
+        if proto.ret != "void":
+            ret_val = "%s result = " % proto.ret
+            ret_stmt = "    return result;\n"
+        if proto_is_global(proto):
+            table_type = "instance"
+        else:
+            table_type = "device"
+        # Look up the next dispatch table before starting the clock so that the
+        # sample covers only the layers below this one and the driver
+        pre_call_txt = ''
+        if proto.name in self.explicit_timing_functions:
+            call_txt = 'explicit_%s' % proto.c_call()
+        else:
+            pre_call_txt = '    VkLayer%sDispatchTable *pTable = get_dispatch_table(timing_%s_table_map, %s);\n' % (
+                'Instance' if table_type == 'instance' else '', table_type, proto.params[0].name)
+            call_txt = 'pTable->%s' % proto.c_call()
+        post_call_txt = ''
+        if proto.name == 'DestroyDevice':
+            post_call_txt = '    timing_write_report();\n'
+        elif proto.name in ['QueueSubmit', 'QueuePresentKHR']:
+            post_call_txt = '    timing_poll_report();\n'
+        funcs = []
+        if wsi_name(proto.name):
+            funcs.append(wsi_ifdef(proto.name))
+        funcs.append('%s' % self.lineinfo.get())
+        funcs.append('%s%s\n'
+                     '{\n'
+                     '%s'
+                     '    uint64_t start = timing_now();\n'
+                     '    %s%s;\n'
+                     '    timing_record(TIMING_vk%s, start);\n'
+                     '%s'
+                     '%s'
+                     '}' % (qual, decl, pre_call_txt, ret_val, call_txt, proto.name, post_call_txt, ret_stmt))
+        if wsi_name(proto.name):
+            funcs.append(wsi_endif(proto.name))
+        return "\n".join(funcs)
+
+    def generate_body(self):
+        self.layer_name = "timing"
+        # KHR entry points are returned from GetProcAddr only once their extension is enabled
+        extensions=[('wsi_enabled',
+                     ['vk%s' % proto.name for proto in self.protos if 'KHR' in proto.name and not proto_is_global(proto)])]
+        instance_extensions=[('wsi_enabled',
+                              ['vk%s' % proto.name for proto in self.protos if 'KHR' in proto.name and proto_is_global(proto)])]
+        body = [self._generate_dispatch_entrypoints("VK_LAYER_EXPORT"),
+                self._generate_layer_gpa_function(extensions,
+                                                  instance_extensions)]
+        return "\n\n".join(body)
+
+class CaptureSubcommand(Subcommand):
+    # Entry points the layer answers itself or leaves to the rest of the chain
+    uncaptured_functions = ['GetInstanceProcAddr',
+                            'GetDeviceProcAddr',
+                            'EnumerateInstanceExtensionProperties',
+                            'EnumerateInstanceLayerProperties',
+                            'EnumerateDeviceExtensionProperties',
+                            'EnumerateDeviceLayerProperties',
+                            ]
+    # Calls that set up or tear down the layer's dispatch tables
+    explicit_capture_functions = ['CreateInstance',
+                                  'DestroyInstance',
+                                  'CreateDevice',
+                                  'DestroyDevice',
+                                  ]
+    # Untyped input pointers and the parameter holding their size in bytes
+    in_blob_params = {('CmdUpdateBuffer', 'pData') : 'dataSize',
+                      ('CmdPushConstants', 'pValues') : 'size',
+                      }
+    # Untyped output pointers and the expression giving their size in bytes
+    out_blob_params = {('GetQueryPoolResults', 'pData') : 'dataSize',
+                       ('GetPipelineCacheData', 'pData') : '*pDataSize',
+                       }
+    # Returned handle arrays whose length isn't the preceding count parameter
+    out_handle_counts = {'pPhysicalDevices' : '*pPhysicalDeviceCount',
+                         'pCommandBuffers' : 'pAllocateInfo->commandBufferCount',
+                         'pDescriptorSets' : 'pAllocateInfo->descriptorSetCount',
+                         'pPipelines' : 'createInfoCount',
+                         'pSwapchainImages' : '*pSwapchainImageCount',
+                         }
+
+    def _captured_protos(self):
+        return [proto for proto in self.protos if proto.name not in self.uncaptured_functions]
+
+    # Sort each parameter into how it is stored in a trace.  The returned dicts
+    # carry the element type and, for arrays, a count expression that is valid
+    # both in the layer and in the replayer, which declares its locals with
+    # the parameter names.
+    def _classify_params(self, proto):
+        params = []
+        last_count = None
+        for p in proto.params:
+            ty = p.ty.strip()
+            const = ty.startswith('const ')
+            base = ty.replace('const ', '').replace('*', '').strip()
+            depth = ty.count('*')
+            param = {'name' : p.name, 'ty' : ty, 'base' : base, 'count' : '1'}
+            if '[' in ty:
+                param['kind'] = 'fixed_array'
+                param['base'] = base.split('[')[0].strip()
+                param['count'] = base.split('[')[1].split(']')[0]
+            elif depth == 0:
+                param['kind'] = 'handle' if base in vulkan.object_type_list else 'value'
+                if base == 'uint32_t' and p.name.endswith('Count'):
+                    last_count = p.name
+            elif base == 'VkAllocationCallbacks':
+                param['kind'] = 'allocator'
+            elif const and base == 'char':
+                param['kind'] = 'string'
+            elif const and (proto.name, p.name) in self.in_blob_params:
+                param['kind'] = 'in_blob'
+                param['count'] = self.in_blob_params[(proto.name, p.name)]
+            elif const:
+                param['kind'] = 'in_array'
+                if last_count:
+                    param['count'] = last_count
+            elif (proto.name, p.name) in self.out_blob_params:
+                param['kind'] = 'out_blob'
+                param['count'] = self.out_blob_params[(proto.name, p.name)]
+            elif depth == 2:
+                param['kind'] = 'out_pointer'
+            elif base in vulkan.object_type_list:
+                if p.name in self.out_handle_counts:
+                    param['kind'] = 'out_handle_array'
+                    param['count'] = self.out_handle_counts[p.name]
+                else:
+                    param['kind'] = 'out_handle'
+            elif base in ['uint32_t', 'size_t'] and (p.name.endswith('Count') or p.name == 'pDataSize'):
+                param['kind'] = 'inout_count'
+            elif params and params[-1]['kind'] == 'inout_count':
+                param['kind'] = 'out_array'
+                param['count'] = '*%s' % params[-1]['name']
+            elif base.startswith('Vk') or base in ['uint32_t', 'uint64_t', 'size_t', 'float']:
+                param['kind'] = 'out_value'
+            else:
+                # Window system objects that mean nothing in another process
+                param['kind'] = 'opaque'
+            if param['kind'] == 'in_array':
+                if base in vulkan.object_type_list:
+                    param['element'] = 'handle'
+                elif vk_helper.is_type(base, 'struct'):
+                    param['element'] = 'struct'
+                else:
+                    param['element'] = 'value'
+            params.append(param)
+        return params
+
+    def _capture_param(self, param):
+        name = param['name']
+        kind = param['kind']
+        if kind == 'value':
+            return 'w.writeValue(%s);' % name
+        if kind == 'handle':
+            return 'w.writeHandle(%s);' % name
+        if kind == 'fixed_array':
+            return 'w.writeArray<%s>(%s, %s);' % (param['base'], name, param['count'])
+        if kind == 'string':
+            return 'w.writeString(%s);' % name
+        if kind == 'in_blob':
+            return 'w.writeBlob(%s, %s);' % (name, param['count'])
+        if kind == 'in_array' and param['element'] == 'struct':
+            return 'w.writeStructArray(%s, %s);' % (name, param['count'])
+        if kind in ['in_array', 'out_handle_array']:
+            return 'w.writeArray(%s, %s);' % (name, param['count'])
+        if kind == 'out_handle':
+            return 'w.writeHandle(*%s);' % name
+        if kind in ['inout_count', 'out_value']:
+            return 'w.writeArray(%s, 1);' % name
+        if kind in ['out_array', 'out_blob', 'out_pointer']:
+            return 'w.writePresence(%s);' % name
+        return None
+
+    def generate_header(self):
+        header_txt = []
+        header_txt.append('%s' % self.lineinfo.get())
+        header_txt.append('enum CaptureEntryPoint {')
+        for proto in self._captured_protos():
+            header_txt.append('    CAPTURE_vk%s,' % proto.name)
+        header_txt.append('    CAPTURE_ENTRY_POINT_COUNT')
+        header_txt.append('};')
+        header_txt.append('')
+        header_txt.append('static const char *const captureEntryPointNames[CAPTURE_ENTRY_POINT_COUNT] = {')
+        for proto in self._captured_protos():
+            header_txt.append('    "vk%s",' % proto.name)
+        header_txt.append('};')
+        header_txt.append('')
+        header_txt.append('#include "capture.h"')
+        return "\n".join(header_txt)
+
+    def generate_intercept(self, proto, qual):
+        if proto.name in self.uncaptured_functions:
+            return None
+        decl = proto.c_func(prefix="vk", attr="VKAPI")
+        ret_val = ''
+        ret_stmt = ''
+        if proto.ret != "void":
+            ret_val = "%s result = " % proto.ret
+            ret_stmt = "    return result;\n"
+        if proto.name in self.explicit_capture_functions:
+            table_txt = ''
+            call_txt = 'explicit_%s' % proto.c_call()
+        else:
+            table_type = 'instance' if proto_is_global(proto) else 'device'
+            table_txt = '    VkLayer%sDispatchTable *pTable = get_dispatch_table(capture_%s_table_map, %s);\n' % (
+                'Instance' if table_type == 'instance' else '', table_type, proto.params[0].name)
+            call_txt = 'pTable->%s' % proto.c_call()
+        # The record is written once the call returns so that it holds the
+        # handles and counts the driver handed back
+        capture_txt = ['    VkCaptureWriter &w = capture_begin(CAPTURE_vk%s);' % proto.name]
+        for param in self._classify_params(proto):
+            line = self._capture_param(param)
+            if line:
+                capture_txt.append('    %s' % line)
+        if proto.ret != "void":
+            capture_txt.append('    w.writeValue(result);')
+        capture_txt.append('    capture_end(w);')
+        if proto.name in ['DestroyInstance', 'DestroyDevice']:
+            capture_txt.append('    capture_flush();')
+        funcs = []
+        if wsi_name(proto.name):
+            funcs.append(wsi_ifdef(proto.name))
+        funcs.append('%s' % self.lineinfo.get())
+        funcs.append('%s%s\n'
+                     '{\n'
+                     '%s'
+                     '    %s%s;\n'
+                     '%s\n'
+                     '%s'
+                     '}' % (qual, decl, table_txt, ret_val, call_txt, "\n".join(capture_txt), ret_stmt))
+        if wsi_name(proto.name):
+            funcs.append(wsi_endif(proto.name))
+        return "\n".join(funcs)
+
+    def generate_body(self):
+        self.layer_name = "capture"
+        # KHR entry points are returned from GetProcAddr only once their extension is enabled
+        extensions=[('wsi_enabled',
+                     ['vk%s' % proto.name for proto in self.protos if 'KHR' in proto.name and not proto_is_global(proto)])]
+        instance_extensions=[('wsi_enabled',
+                              ['vk%s' % proto.name for proto in self.protos if 'KHR' in proto.name and proto_is_global(proto)])]
+        body = [self._generate_dispatch_entrypoints("VK_LAYER_EXPORT"),
+                self._generate_layer_gpa_function(extensions,
+                                                  instance_extensions)]
+        return "\n\n".join(body)
+
+class ReplaySubcommand(CaptureSubcommand):
+    # Entry points vkreplay.cpp implements itself, with the same signature
+    custom_replay_functions = ['CreateInstance',
+                               'CreateDevice',
+                               'GetDeviceQueue',
+                               'CreateSwapchainKHR',
+                               'DestroySwapchainKHR',
+                               'GetSwapchainImagesKHR',
+                               'AcquireNextImageKHR',
+                               'QueuePresentKHR',
+                               ]
+
+    # Surfaces can't be recreated without the original window, so the surface
+    # calls are decoded and dropped; swapchains are emulated with plain images
+    def _is_skipped(self, proto):
+        return 'KHR' in proto.name and proto.name not in self.custom_replay_functions
+
+    def generate_header(self):
+        header_txt = []
+        header_txt.append('#include "vk_struct_capture.h"')
+        header_txt.append('#include "vkreplay.h"')
+        header_txt.append('')
+        header_txt.append('%s' % self.lineinfo.get())
+        header_txt.append('enum ReplayEntryPoint {')
+        for proto in self._captured_protos():
+            header_txt.append('    REPLAY_vk%s,' % proto.name)
+        header_txt.append('    REPLAY_ENTRY_POINT_COUNT')
+        header_txt.append('};')
+        header_txt.append('')
+        header_txt.append('const uint32_t replayEntryPointCount = REPLAY_ENTRY_POINT_COUNT;')
+        header_txt.append('')
+        header_txt.append('const char *const replayEntryPointNames[REPLAY_ENTRY_POINT_COUNT] = {')
+        for proto in self._captured_protos():
+            header_txt.append('    "vk%s",' % proto.name)
+        header_txt.append('};')
+        return "\n".join(header_txt)
+
+    def _replay_param(self, param):
+        name = param['name']
+        kind = param['kind']
+        base = param['base']
+        count = param['count']
+        decl = []
+        post = []
+        if kind == 'value':
+            decl.append('%s %s = r.readValue<%s>();' % (base, name, base))
+        elif kind == 'handle':
+            decl.append('%s %s = r.readHandle<%s>();' % (base, name, base))
+        elif kind == 'fixed_array':
+            decl.append('const %s *%s = r.readArray<%s>(%s);' % (base, name, base, count))
+        elif kind == 'allocator':
+            decl.append('const VkAllocationCallbacks *%s = NULL;' % name)
+        elif kind == 'string':
+            decl.append('const char *%s = r.readString();' % name)
+        elif kind == 'in_blob':
+            decl.append('%s %s = (%s)r.readBlob(%s);' % (param['ty'], name, param['ty'], count))
+        elif kind == 'in_array' and param['element'] == 'struct':
+            decl.append('const %s *%s = r.readStructArray<%s>(%s);' % (base, name, base, count))
+        elif kind == 'in_array' and param['element'] == 'handle':
+            decl.append('const %s *%s = r.readHandleArray<%s>(%s);' % (base, name, base, count))
+        elif kind == 'in_array':
+            decl.append('const %s *%s = r.readArray<%s>(%s);' % (base, name, base, count))
+        elif kind == 'out_handle':
+            decl.append('%s %s_captured = r.readCapturedHandle<%s>();' % (base, name, base))
+            decl.append('%s %s_replayed = VK_NULL_HANDLE;' % (base, name))
+            decl.append('%s *%s = &%s_replayed;' % (base, name, name))
+            post.append('r.registerHandle((uint64_t)%s_captured, (uint64_t)%s_replayed);' % (name, name))
+        elif kind == 'out_handle_array':
+            decl.append('uint64_t %s_count = %s;' % (name, count))
+            decl.append('const %s *%s_captured = r.readArray<%s>(%s_count);' % (base, name, base, name))
+            decl.append('%s *%s = %s_captured ? r.allocate<%s>(%s_count) : NULL;' % (base, name, name, base, name))
+            post.append('for (uint64_t i = 0; %s && i < %s_count; i++) {' % (name, name))
+            post.append('    r.registerHandle((uint64_t)%s_captured[i], (uint64_t)%s[i]);' % (name, name))
+            post.append('}')
+        elif kind in ['inout_count', 'out_value']:
+            # Outputs start out holding what the application got back, which
+            # is how the custom swapchain calls learn the recorded image index
+            decl.append('const %s *%s_captured = r.readArray<%s>(1);' % (base, name, base))
+            decl.append('%s %s_value = %s_captured ? *%s_captured : %s();' % (base, name, name, name, base))
+            decl.append('%s *%s = %s_captured ? &%s_value : NULL;' % (base, name, name, name))
+        elif kind == 'out_array':
+            decl.append('%s *%s = r.readPresence() ? r.allocate<%s>(%s) : NULL;' % (base, name, base, count))
+        elif kind == 'out_blob':
+            decl.append('void *%s = r.readPresence() ? r.allocate<uint8_t>(%s) : NULL;' % (name, count))
+        elif kind == 'out_pointer':
+            decl.append('void *%s_value = NULL;' % name)
+            decl.append('void **%s = r.readPresence() ? &%s_value : NULL;' % (name, name))
+        elif kind == 'opaque':
+            decl.append('%s %s = NULL;' % (param['ty'], name))
+        return (decl, post)
+
+    def _generate_replay_function(self, proto):
+        body = []
+        post = []
+        for param in self._classify_params(proto):
+            (decl_txt, post_txt) = self._replay_param(param)
+            body += decl_txt
+            post += post_txt
+        if proto.ret != "void":
+            body.append('%s result_captured = r.readValue<%s>();' % (proto.ret, proto.ret))
+        body.append('if (r.overrun()) {')
+        body.append('    return false;')
+        body.append('}')
+        if self._is_skipped(proto):
+            for param in proto.params:
+                body.append('(void)%s;' % param.name)
+            if proto.ret != "void":
+                body.append('(void)result_captured;')
+            body.append('replay_skip(REPLAY_vk%s);' % proto.name)
+        else:
+            prefix = 'replay_vk' if proto.name in self.custom_replay_functions else 'vk'
+            body.append('uint64_t start = replay_now();')
+            if proto.ret != "void":
+                body.append('%s result = %s%s;' % (proto.ret, prefix, proto.c_call()))
+                body.append('replay_record(REPLAY_vk%s, start, result == result_captured);' % proto.name)
+            else:
+                body.append('%s%s;' % (prefix, proto.c_call()))
+                body.append('replay_record(REPLAY_vk%s, start, true);' % proto.name)
+            body += post
+        body.append('return true;')
+        funcs = []
+        if wsi_name(proto.name):
+            funcs.append(wsi_ifdef(proto.name))
+        funcs.append('static bool replay_%s(VkCaptureReader &r) {' % proto.name)
+        funcs.append('    %s' % "\n    ".join(body))
+        funcs.append('}')
+        if wsi_name(proto.name):
+            funcs.append(wsi_endif(proto.name))
+        return "\n".join(funcs)
+
+    def generate_body(self):
+        body = []
+        for proto in self._captured_protos():
+            body.append(self._generate_replay_function(proto))
+        dispatch = []
+        dispatch.append('%s' % self.lineinfo.get())
+        dispatch.append('bool replay_dispatch(uint32_t entryPoint, VkCaptureReader &r) {')
+        dispatch.append('    switch (entryPoint) {')
+        for proto in self._captured_protos():
+            if wsi_name(proto.name):
+                dispatch.append(wsi_ifdef(proto.name))
+            dispatch.append('    case REPLAY_vk%s:' % proto.name)
+            dispatch.append('        return replay_%s(r);' % proto.name)
+            if wsi_name(proto.name):
+                dispatch.append(wsi_endif(proto.name))
+        dispatch.append('    default:')
+        dispatch.append('        replay_skip(entryPoint);')
+        dispatch.append('        return true;')
+        dispatch.append('    }')
+        dispatch.append('}')
+        body.append("\n".join(dispatch))
+        return "\n\n".join(body)
+
 def main():
     wsi = {
             "Win32",
@@ -2063,6 +2524,9 @@ def main():
             "object_tracker" : ObjectTrackerSubcommand,
             "threading" : ThreadingSubcommand,
             "unique_objects" : UniqueObjectsSubcommand,
+            "timing" : TimingSubcommand,
+            "capture" : CaptureSubcommand,
+            "replay" : ReplaySubcommand,
     }
 
     if len(sys.argv) < 4 or sys.argv[1] not in wsi or sys.argv[2] not in subcommands or not os.path.exists(sys.argv[3]):
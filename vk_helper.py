@@ -47,6 +47,7 @@ def handle_args():
     parser.add_argument('--abs_out_dir', required=False, default=None, help='Absolute path to write output files. Will be created if needed.')
     parser.add_argument('--gen_enum_string_helper', required=False, action='store_true', default=False, help='Enable generation of helper header file to print string versions of enums.')
     parser.add_argument('--gen_struct_wrappers', required=False, action='store_true', default=False, help='Enable generation of struct wrapper classes.')
+    parser.add_argument('--gen_struct_serializers', required=False, action='store_true', default=False, help='Enable generation of struct serializers for the capture layer.')
     parser.add_argument('--gen_struct_sizes', required=False, action='store_true', default=False, help='Enable generation of struct sizes.')
     parser.add_argument('--gen_cmake', required=False, action='store_true', default=False, help='Enable generation of cmake file for generated code.')
     parser.add_argument('--gen_graphviz', required=False, action='store_true', default=False, help='Enable generation of graphviz dot file.')
@@ -2083,6 +2084,253 @@ class GraphVizGen:
 
 
 
+# Generates overloads that serialize a struct's pointed-to data for the capture
+#  layer and patch it back into place on replay (see layers/vk_capture.h).
+#  A struct's own bytes are always written raw by the caller; the generated
+#  functions only handle what those bytes can't carry: the data behind pointer
+#  members, and handle members that need remapping on replay.
+class StructCaptureGen:
+    def __init__(self, struct_dict, prefix, out_dir):
+        self.struct_dict = struct_dict
+        self.api = prefix
+        if prefix == "vulkan":
+            self.api_prefix = "vk"
+        else:
+            self.api_prefix = prefix
+        self.header_filename = os.path.join(out_dir, self.api_prefix+"_struct_capture.h")
+        self.source_filename = os.path.join(out_dir, self.api_prefix+"_struct_capture.cpp")
+        self.hfg = CommonFileGen(self.header_filename)
+        self.sfg = CommonFileGen(self.source_filename)
+        self.copyright = StructWrapperGen(struct_dict, prefix, out_dir)._generateCopyright()
+        self.handle_types = vulkan.object_dispatch_list + vulkan.object_non_dispatch_list
+        # Untyped pointers whose size comes from another member
+        self.blob_members = {('VkShaderModuleCreateInfo', 'pCode') : 'codeSize',
+                             ('VkPipelineCacheCreateInfo', 'pInitialData') : 'initialDataSize',
+                             ('VkSpecializationInfo', 'pData') : 'dataSize'}
+        # Arrays that the header doesn't mark as dynamic, or sizes that aren't a plain member
+        self.count_overrides = {('VkPipelineMultisampleStateCreateInfo', 'pSampleMask') : '(s.rasterizationSamples + 31) / 32',
+                                ('VkSubmitInfo', 'pWaitDstStageMask') : 's.waitSemaphoreCount'}
+        # Pointers that may be garbage unless a condition holds
+        self.member_conditions = {('VkWriteDescriptorSet', 'pImageInfo') : 'vk_capture_descriptor_has_image_info(s.descriptorType)',
+                                  ('VkWriteDescriptorSet', 'pBufferInfo') : 'vk_capture_descriptor_has_buffer_info(s.descriptorType)',
+                                  ('VkWriteDescriptorSet', 'pTexelBufferView') : 'vk_capture_descriptor_has_texel_buffer_view(s.descriptorType)'}
+
+    def generate(self):
+        self.hfg.setCopyright(self.copyright)
+        self.hfg.setHeader(self._generateHeader())
+        self.hfg.setBody(self._generateDecls())
+        self.hfg.setFooter(self._generateFooter())
+        self.hfg.generate()
+        self.sfg.setCopyright(self.copyright)
+        self.sfg.setHeader(self._generateSourceHeader())
+        self.sfg.setBody(self._generateSource())
+        self.sfg.generate()
+
+    def _is_handle(self, ty):
+        return ty in self.handle_types
+
+    def _needs_fixup(self, s):
+        for m in self.struct_dict[s]:
+            member = self.struct_dict[s][m]
+            if member['ptr'] or self._is_handle(member['type']):
+                return True
+            if is_type(member['type'], 'struct') and member['type'] != s and self._needs_fixup(member['type']):
+                return True
+        return False
+
+    def _sType(self, s):
+        # VkFooBarKHR -> VK_STRUCTURE_TYPE_FOO_BAR_KHR
+        words = re.findall('[A-Z][a-z0-9]+|[A-Z0-9]+(?![a-z])', s[2:])
+        sType = 'VK_STRUCTURE_TYPE_%s' % '_'.join(words).upper()
+        if sType in enum_val_dict:
+            return sType
+        return None
+
+    def _chained_structs(self):
+        return [s for s in struct_order_list if self.struct_dict[s][0]['name'] == 'sType' and self._sType(s)]
+
+    def _guard(self, s, txt):
+        if s in ifdef_dict:
+            return ['#ifdef %s' % ifdef_dict[s]] + txt + ['#endif']
+        return txt
+
+    def _generateHeader(self):
+        header = []
+        header.append('#ifndef VK_STRUCT_CAPTURE_H')
+        header.append('#define VK_STRUCT_CAPTURE_H\n')
+        header.append('#include "vulkan/vulkan.h"')
+        header.append('#include "vk_capture.h"\n')
+        header.append('// Structs that can be copied to and from a trace as raw bytes')
+        header.append('template <typename T> struct VkCaptureNeedsFixup { static const bool value = false; };\n')
+        header.append('template <typename T> inline void vk_capture_write_members(VkCaptureWriter &, const T &) {}')
+        header.append('template <typename T> inline void vk_capture_read_members(VkCaptureReader &, T &) {}\n')
+        return "\n".join(header)
+
+    def _generateDecls(self):
+        decls = []
+        for s in struct_order_list:
+            if not self._needs_fixup(s):
+                continue
+            decls += self._guard(s, ['template <> struct VkCaptureNeedsFixup<%s> { static const bool value = true; };' % s,
+                                     'void vk_capture_write_members(VkCaptureWriter &w, const %s &s);' % s,
+                                     'void vk_capture_read_members(VkCaptureReader &r, %s &s);' % s])
+        return "\n".join(decls)
+
+    def _generateFooter(self):
+        footer = []
+        footer.append('\ntemplate <typename T> void VkCaptureWriter::writeStructArray(const T *array, uint64_t count) {')
+        footer.append('    if (writePresence(array)) {')
+        footer.append('        writeBytes(array, (size_t)(sizeof(T) * count), 8);')
+        footer.append('        if (VkCaptureNeedsFixup<T>::value) {')
+        footer.append('            for (uint64_t i = 0; i < count; i++) {')
+        footer.append('                vk_capture_write_members(*this, array[i]);')
+        footer.append('            }')
+        footer.append('        }')
+        footer.append('    }')
+        footer.append('}\n')
+        footer.append('template <typename T> const T *VkCaptureReader::readStructArray(uint64_t count) {')
+        footer.append('    if (!readPresence()) {')
+        footer.append('        return NULL;')
+        footer.append('    }')
+        footer.append('    const T *captured = (const T *)readBytes((size_t)(sizeof(T) * count), 8);')
+        footer.append('    if (!VkCaptureNeedsFixup<T>::value) {')
+        footer.append('        return captured;')
+        footer.append('    }')
+        footer.append('    T *structs = allocate<T>(count);')
+        footer.append('    memcpy(structs, captured, (size_t)(sizeof(T) * count));')
+        footer.append('    for (uint64_t i = 0; i < count; i++) {')
+        footer.append('        vk_capture_read_members(*this, structs[i]);')
+        footer.append('    }')
+        footer.append('    return structs;')
+        footer.append('}\n')
+        footer.append('#endif // VK_STRUCT_CAPTURE_H')
+        return "\n".join(footer)
+
+    def _generateSourceHeader(self):
+        header = []
+        header.append('#include "vk_struct_capture.h"\n')
+        header.append('// Layout shared by every struct that can appear in a pNext chain')
+        header.append('struct VkCaptureStructHeader {')
+        header.append('    VkStructureType sType;')
+        header.append('    const void *pNext;')
+        header.append('};\n')
+        header.append('static bool vk_capture_descriptor_has_image_info(VkDescriptorType type) {')
+        header.append('    return type == VK_DESCRIPTOR_TYPE_SAMPLER || type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||')
+        header.append('           type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE || type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ||')
+        header.append('           type == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;')
+        header.append('}\n')
+        header.append('static bool vk_capture_descriptor_has_buffer_info(VkDescriptorType type) {')
+        header.append('    return type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER || type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ||')
+        header.append('           type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC || type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;')
+        header.append('}\n')
+        header.append('static bool vk_capture_descriptor_has_texel_buffer_view(VkDescriptorType type) {')
+        header.append('    return type == VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER || type == VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;')
+        header.append('}\n')
+        return "\n".join(header)
+
+    # Returns (write, read) statements for one member
+    def _member_code(self, s, member):
+        name = member['name']
+        ty = member['type']
+        key = (s, name)
+        if name == 'pNext':
+            return (['    w.writeNextChain(s.pNext);'], ['    s.pNext = r.readNextChain();'])
+        if key in self.blob_members:
+            size = 's.%s' % self.blob_members[key]
+            return (['    w.writeBlob(s.%s, %s);' % (name, size)],
+                    ['    s.%s = (%s)r.readBlob(%s);' % (name, member['full_type'], size)])
+        if member['ptr']:
+            if key in self.count_overrides:
+                count = self.count_overrides[key]
+            elif member['dyn_array']:
+                count = 's.%s' % member['array_size']
+            elif is_type(ty, 'struct') and member['const']:
+                count = '1'
+            elif ty == 'char' and member['const']:
+                return (['    w.writeString(s.%s);' % name], ['    s.%s = r.readString();' % name])
+            else:
+                # Application or platform pointers that mean nothing in another process
+                return ([], ['    s.%s = NULL;' % name])
+            pointer = 's.%s' % name
+            if key in self.member_conditions:
+                pointer = '%s ? s.%s : NULL' % (self.member_conditions[key], name)
+            if ty == 'char':
+                return (['    w.writeStringArray(%s, %s);' % (pointer, count)],
+                        ['    s.%s = r.readStringArray(%s);' % (name, count)])
+            if is_type(ty, 'struct'):
+                return (['    w.writeStructArray<%s>(%s, %s);' % (ty, pointer, count)],
+                        ['    s.%s = r.readStructArray<%s>(%s);' % (name, ty, count)])
+            if self._is_handle(ty):
+                return (['    w.writeArray<%s>(%s, %s);' % (ty, pointer, count)],
+                        ['    s.%s = r.readHandleArray<%s>(%s);' % (name, ty, count)])
+            return (['    w.writeArray<%s>(%s, %s);' % (ty, pointer, count)],
+                    ['    s.%s = r.readArray<%s>(%s);' % (name, ty, count)])
+        if self._is_handle(ty):
+            if member['array']:
+                return ([], ['    for (uint32_t i = 0; i < %s; i++) {' % member['array_size'],
+                             '        s.%s[i] = r.remap(s.%s[i]);' % (name, name),
+                             '    }'])
+            return ([], ['    s.%s = r.remap(s.%s);' % (name, name)])
+        if is_type(ty, 'struct') and self._needs_fixup(ty):
+            if member['array']:
+                return (['    for (uint32_t i = 0; i < %s; i++) {' % member['array_size'],
+                         '        vk_capture_write_members(w, s.%s[i]);' % name,
+                         '    }'],
+                        ['    for (uint32_t i = 0; i < %s; i++) {' % member['array_size'],
+                         '        vk_capture_read_members(r, s.%s[i]);' % name,
+                         '    }'])
+            return (['    vk_capture_write_members(w, s.%s);' % name], ['    vk_capture_read_members(r, s.%s);' % name])
+        return ([], [])
+
+    def _generateSource(self):
+        src = []
+        for s in struct_order_list:
+            if not self._needs_fixup(s):
+                continue
+            write_txt = []
+            read_txt = []
+            for m in sorted(self.struct_dict[s]):
+                (write, read) = self._member_code(s, self.struct_dict[s][m])
+                write_txt += write
+                read_txt += read
+            fn = ['void vk_capture_write_members(VkCaptureWriter &w, const %s &s) {' % s]
+            if not write_txt:
+                fn.append('    (void)w;')
+                fn.append('    (void)s;')
+            fn += write_txt
+            fn.append('}\n')
+            fn.append('void vk_capture_read_members(VkCaptureReader &r, %s &s) {' % s)
+            fn += read_txt
+            fn.append('}')
+            src += self._guard(s, fn)
+            src.append('')
+        # Extension structs are stored as their sType followed by the struct;
+        #  chains are cut at the first sType this header doesn't know
+        src.append('void VkCaptureWriter::writeNextChain(const void *pNext) {')
+        src.append('    const VkCaptureStructHeader *header = (const VkCaptureStructHeader *)pNext;')
+        src.append('    VkStructureType sType = header ? header->sType : VK_STRUCTURE_TYPE_MAX_ENUM;')
+        src.append('    switch (sType) {')
+        for s in self._chained_structs():
+            src += self._guard(s, ['    case %s:' % self._sType(s),
+                                   '        writeValue((uint32_t)sType);',
+                                   '        writeStructArray((const %s *)pNext, 1);' % s,
+                                   '        break;'])
+        src.append('    default:')
+        src.append('        writeValue((uint32_t)VK_STRUCTURE_TYPE_MAX_ENUM);')
+        src.append('        break;')
+        src.append('    }')
+        src.append('}\n')
+        src.append('const void *VkCaptureReader::readNextChain() {')
+        src.append('    switch (readValue<uint32_t>()) {')
+        for s in self._chained_structs():
+            src += self._guard(s, ['    case %s:' % self._sType(s),
+                                   '        return readStructArray<%s>(1);' % s])
+        src.append('    default:')
+        src.append('        return NULL;')
+        src.append('    }')
+        src.append('}')
+        return "\n".join(src)
+
 #    def _generateHeader(self):
 #        hdr = []
 #        hdr.append('digraph g {\ngraph [\nrankdir = "LR"\n];')
@@ -2176,6 +2424,10 @@ def main(argv=None):
         st.set_include_headers(["stdio.h", "stdlib.h", input_header])
         st.generateSizeHelper()
         st.generateSizeHelperC()
+    if opts.gen_struct_serializers:
+        sc = StructCaptureGen(struct_dict, os.path.basename(opts.input_file).strip(".h"), os.path.dirname(enum_sh_filename))
+        print("Generating struct serializers to %s" % sc.source_filename)
+        sc.generate()
     if opts.gen_cmake:
         cmg = CMakeGen(sw, os.path.dirname(enum_sh_filename))
         cmg.generate()